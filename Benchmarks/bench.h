@@ -0,0 +1,57 @@
+#ifndef C_PROGRAMS_BENCH_H
+#define C_PROGRAMS_BENCH_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include <time.h>
+/**
+ * Minimal helpers for the throughput benchmarks, in the same spirit as the
+ * minimal unit testing framework in Tests/test.h.
+ *
+ * Each benchmark module exposes a single function that runs its kernels a
+ * few times over generated data and reports the best observed time.
+ */
+
+/**
+ * @return The current value of a monotonic clock, in seconds.
+ */
+static inline double bench_now(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec * 1e-9;
+}
+
+/**
+ * Runs the statement the given number of times and stores the fastest
+ * single run (in seconds) in the variable named by best.
+ */
+#define bench_best_of(repeats, best, statement)                               \
+  do {                                                                         \
+    best = 1e30;                                                               \
+    for (int bench_run = 0; bench_run < (repeats); bench_run++) {              \
+      double bench_start = bench_now();                                        \
+      statement;                                                               \
+      double bench_elapsed = bench_now() - bench_start;                        \
+      if (bench_elapsed < best) {                                              \
+        best = bench_elapsed;                                                  \
+      }                                                                        \
+    }                                                                          \
+  } while (0)
+
+static inline void report_throughput(const char *name, size_t bytes,
+                                     double seconds) {
+  printf("  %-40s %8.3f GB/s\n", name, (double)bytes / seconds / 1e9);
+}
+
+static inline void report_rate(const char *name, size_t items,
+                               const char *unit, double seconds) {
+  printf("  %-40s %8.2f M%s/s\n", name, (double)items / seconds / 1e6, unit);
+}
+
+/**
+ * Benchmarks must consume their results, otherwise the compiler is free to
+ * remove the work that is being measured.
+ */
+extern volatile size_t bench_sink;
+
+#endif // C_PROGRAMS_BENCH_H
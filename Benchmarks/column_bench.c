@@ -0,0 +1,130 @@
+#include "column_bench.h"
+#include "../StdLib/Data/column.h"
+#include "../StdLib/Data/csv.h"
+#include "../StdLib/String/number.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t ROWS = 1000000;
+
+// A table of an id, a price, a date, a name and a status, as CSV text.
+static string_t *generate_csv(void) {
+  static const char *statuses[] = {"shipped", "pending", "cancelled",
+                                   "returned"};
+  string_t *text = new_string(ROWS * 80);
+  char *out = (char *)text->data;
+  size_t len = (size_t)sprintf(out, "id,price,day,name,status\n");
+  srand(42);
+  for (size_t i = 0; i < ROWS; i++) {
+    len += (size_t)sprintf(
+        out + len, "%zu,%d.%02d,20%02d-%02d-%02d,user%d,%s\n", i,
+        rand() % 1000, rand() % 100, rand() % 25, 1 + rand() % 12,
+        1 + rand() % 28, rand() % 10000, statuses[rand() % 4]);
+  }
+  text->len = len;
+  return text;
+}
+
+void bench_column() {
+  string_t *text = generate_csv();
+  string_cache_t *cache = parse_csv(text->data, text->len, NULL);
+  dataset_t *dataset = new_dataset(cache);
+  free_cache(cache);
+  double best;
+  double sum = 0;
+  printf("Summing a price column of %zu rows\n", ROWS);
+
+  bench_best_of(3, best, {
+    sum = 0;
+    for (size_t row = 0; row < dataset->rows; row++) {
+      double price;
+      if (string_to_double(dataset_value(dataset, row, 1), &price)) {
+        sum += price;
+      }
+    }
+  });
+  report_rate("dataset_value + string_to_double", ROWS, "values", best);
+  bench_sink += (size_t)sum;
+
+  column_table_t *table = NULL;
+  bench_best_of(3, best, {
+    free_column_table(table);
+    table = new_column_table(dataset, 1000);
+  });
+  report_rate("new_column_table (5 columns)", ROWS, "rows", best);
+
+  const column_t *prices = &table->columns[1];
+  bench_best_of(10, best, {
+    sum = 0;
+    for (size_t row = 0; row < prices->rows; row++) {
+      sum += prices->doubles[row];
+    }
+  });
+  report_rate("column doubles", ROWS, "values", best);
+  bench_sink += (size_t)sum;
+
+  // The strings of a packed record take a pointer, a string_t and their
+  // bytes each.
+  printf("Memory of the name and status columns\n");
+  for (size_t col = 3; col < 5; col++) {
+    size_t bytes = 0;
+    for (size_t row = 0; row < ROWS; row++) {
+      bytes += dataset_value(dataset, row, col)->len;
+    }
+    size_t cached = ROWS * (sizeof(string_t *) + sizeof(string_t)) + bytes;
+    size_t plain = (ROWS + 1) * sizeof(size_t) + bytes + ROWS / 8;
+    const column_t *column = &table->columns[col];
+    printf("  %-8s %6.1f MB in records, %6.1f MB as strings, %6.1f MB "
+           "encoded (%zu values, %zu-byte codes)\n",
+           column->name->data[0] == 'n' ? "name" : "status",
+           (double)cached / 1e6, (double)plain / 1e6,
+           (double)column_memory(column) / 1e6, column->cardinality,
+           column->code_width);
+  }
+
+  const column_t *status = &table->columns[4];
+  string_t wanted = {7, (uint8_t *)"pending"};
+  size_t count = 0;
+  bench_best_of(5, best, {
+    count = 0;
+    for (size_t row = 0; row < dataset->rows; row++) {
+      count += string_equals(dataset_value(dataset, row, 4), &wanted);
+    }
+  });
+  report_rate("filter status: string_equals", ROWS, "rows", best);
+  bench_sink += count;
+  bench_best_of(5, best, {
+    size_t *rows = column_rows_equal(status, &wanted, &count);
+    bench_sink += count;
+    free(rows);
+  });
+  report_rate("filter status: column_rows_equal", ROWS, "rows", best);
+
+  record_t **records = malloc(ROWS * sizeof(record_t *));
+  bench_best_of(3, best, {
+    memcpy(records, dataset->cache->records, ROWS * sizeof(record_t *));
+    sort_records_by_column(records, ROWS, 4, 1);
+  });
+  report_rate("sort by status: sort_records_by_column", ROWS, "rows", best);
+  free(records);
+  bench_best_of(3, best, {
+    size_t *rows = column_sorted_rows(status);
+    bench_sink += rows[0];
+    free(rows);
+  });
+  report_rate("sort by status: column_sorted_rows", ROWS, "rows", best);
+
+  bench_best_of(3, best, {
+    dataset_t *back = column_table_to_dataset(table);
+    bench_sink += back->rows;
+    free_dataset(back);
+  });
+  report_rate("column_table_to_dataset", ROWS, "rows", best);
+
+  free_column_table(table);
+  free_dataset(dataset);
+  free_string(text);
+}
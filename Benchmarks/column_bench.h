@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_COLUMN_BENCH_H
+#define C_PROGRAMS_COLUMN_BENCH_H
+
+void bench_column();
+
+#endif // C_PROGRAMS_COLUMN_BENCH_H
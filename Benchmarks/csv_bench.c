@@ -0,0 +1,166 @@
+#include "csv_bench.h"
+#include "../StdLib/Data/csv.h"
+#include "bench.h"
+
+#include <stdlib.h>
+
+static const char *FILENAME = "bench.csv";
+static const size_t RECORDS = 500000;
+static const size_t COLUMNS = 8;
+
+// Writes a file of short fields, like an export of a table, and returns
+// its size. With quoted set, the text fields are quoted and escaped.
+static size_t write_csv(bool quoted) {
+  FILE *output = fopen(FILENAME, "wb");
+  srand(42);
+  for (size_t i = 0; i < RECORDS; i++) {
+    for (size_t j = 0; j < COLUMNS; j++) {
+      if (j > 0) {
+        fputc(',', output);
+      }
+      switch (j % 4) {
+      case 0:
+        fprintf(output, "%zu", i);
+        break;
+      case 1:
+        fprintf(output, "user%d", rand() % 10000);
+        break;
+      case 2:
+        fprintf(output, "%d.%02d", rand() % 1000, rand() % 100);
+        break;
+      default:
+        if (quoted) {
+          fputs(rand() % 2 ? "\"some longer, \"\"quoted\"\" value\""
+                           : "\"short\"",
+                output);
+        } else {
+          fputs(rand() % 2 ? "some longer text value" : "short", output);
+        }
+        break;
+      }
+    }
+    fputc('\n', output);
+  }
+  long size = ftell(output);
+  fclose(output);
+  return (size_t)size;
+}
+
+void bench_csv() {
+  size_t bytes = write_csv(false);
+  double best;
+  size_t fields = 0;
+  printf("Reading %zu records of %zu fields (%zu MB)\n", RECORDS, COLUMNS,
+         bytes >> 20);
+
+  bench_best_of(3, best, {
+    FILE *input = fopen(FILENAME, "rb");
+    record_t *record;
+    fields = 0;
+    while ((record = read_csv_record(input))) {
+      fields += record->count;
+      free_record(record);
+    }
+    fclose(input);
+  });
+  report_rate("read_csv_record", RECORDS, "records", best);
+  // getline's buffer, the value array, the record, and two per field.
+  printf("  %-40s %8.1f\n", "read_csv_record allocations/record",
+         3.0 + 2.0 * (double)fields / (double)RECORDS);
+
+  bench_best_of(3, best, {
+    FILE *input = fopen(FILENAME, "rb");
+    csv_reader_t *reader = new_csv_reader(input, 0, NULL);
+    record_t *record;
+    fields = 0;
+    while ((record = csv_read_record(reader))) {
+      fields += record->count;
+      free_record(record);
+    }
+    free_csv_reader(reader);
+    fclose(input);
+  });
+  report_rate("csv_read_record", RECORDS, "records", best);
+  report_throughput("csv_read_record", bytes, best);
+  printf("  %-40s %8.1f\n", "csv_read_record allocations/record", 1.0);
+
+  bench_best_of(3, best, {
+    csv_map_t *map = map_csv_file(FILENAME, NULL);
+    const record_t *record;
+    fields = 0;
+    while ((record = next_mapped_record(map))) {
+      fields += record->count;
+    }
+    free_csv_map(map);
+  });
+  report_rate("next_mapped_record", RECORDS, "records", best);
+  report_throughput("next_mapped_record", bytes, best);
+
+  bench_best_of(3, best, {
+    csv_map_t *map = map_csv_file(FILENAME, NULL);
+    record_t *record;
+    fields = 0;
+    while ((record = read_mapped_record(map))) {
+      fields += record->count;
+      free_record(record);
+    }
+    free_csv_map(map);
+  });
+  report_rate("read_mapped_record", RECORDS, "records", best);
+
+  csv_map_t *map = map_csv_file(FILENAME, NULL);
+  csv_index_t *index = new_csv_index();
+  bench_best_of(5, best, {
+    index_csv(index, map->data, map->len, false, NULL);
+    bench_sink += index->count;
+  });
+  report_throughput("index_csv (stage one)", bytes, best);
+  free_csv_index(index);
+  bench_best_of(3, best, {
+    string_cache_t *cache = parse_csv(map->data, map->len, NULL);
+    bench_sink += cache->rows;
+    free_cache(cache);
+  });
+  report_rate("parse_csv (both stages)", RECORDS, "records", best);
+  report_throughput("parse_csv (both stages)", bytes, best);
+  free_csv_map(map);
+
+  bench_best_of(3, best, {
+    string_cache_t *cache = load_csv(FILENAME, 0, NULL);
+    bench_sink += cache->rows;
+    free_cache(cache);
+  });
+  report_throughput("load_csv (one thread per processor)", bytes, best);
+  bench_best_of(3, best, {
+    string_cache_t *cache = load_csv(FILENAME, 4, NULL);
+    bench_sink += cache->rows;
+    free_cache(cache);
+  });
+  report_throughput("load_csv (4 threads)", bytes, best);
+
+  bytes = write_csv(true);
+  printf("With quoted text fields (%zu MB)\n", bytes >> 20);
+  bench_best_of(3, best, {
+    FILE *input = fopen(FILENAME, "rb");
+    csv_reader_t *reader = new_csv_reader(input, 0, NULL);
+    record_t *record;
+    fields = 0;
+    while ((record = csv_read_record(reader))) {
+      fields += record->count;
+      free_record(record);
+    }
+    free_csv_reader(reader);
+    fclose(input);
+  });
+  report_rate("csv_read_record (quoted)", RECORDS, "records", best);
+  map = map_csv_file(FILENAME, NULL);
+  bench_best_of(3, best, {
+    string_cache_t *cache = parse_csv(map->data, map->len, NULL);
+    bench_sink += cache->rows;
+    free_cache(cache);
+  });
+  report_rate("parse_csv (quoted)", RECORDS, "records", best);
+  free_csv_map(map);
+  bench_sink += fields;
+  remove(FILENAME);
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_CSV_BENCH_H
+#define C_PROGRAMS_CSV_BENCH_H
+
+void bench_csv();
+
+#endif // C_PROGRAMS_CSV_BENCH_H
@@ -0,0 +1,94 @@
+#include "dataset_bench.h"
+#include "../StdLib/Data/csv.h"
+#include "../StdLib/Data/data.h"
+#include "../StdLib/String/number.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t ROWS = 1000000;
+
+// A table of a city, a price and a name, as CSV text.
+static string_t *generate_csv(void) {
+  static const char *cities[] = {"amsterdam", "berlin", "copenhagen",
+                                 "dublin",    "lisbon", "madrid",
+                                 "oslo",      "paris",  "rome"};
+  string_t *text = new_string(ROWS * 48);
+  char *out = (char *)text->data;
+  size_t len = (size_t)sprintf(out, "city,price,name\n");
+  srand(42);
+  for (size_t i = 0; i < ROWS; i++) {
+    len += (size_t)sprintf(out + len, "%s,%d.%02d,customer-%06d\n",
+                           cities[rand() % 9], rand() % 1000, rand() % 100,
+                           rand() % 100000);
+  }
+  text->len = len;
+  return text;
+}
+
+static const dataset_t *qsort_dataset;
+
+// Sorts by city, then by price from the highest, parsing on every compare.
+static int compare_rows(const void *left, const void *right) {
+  size_t i = *(const size_t *)left;
+  size_t j = *(const size_t *)right;
+  int result = string_cmp(dataset_value(qsort_dataset, i, 0),
+                          dataset_value(qsort_dataset, j, 0));
+  if (result) {
+    return result;
+  }
+  double a = 0, b = 0;
+  string_to_double(dataset_value(qsort_dataset, i, 1), &a);
+  string_to_double(dataset_value(qsort_dataset, j, 1), &b);
+  if (a != b) {
+    return a > b ? -1 : 1;
+  }
+  return (i > j) - (i < j);
+}
+
+static void reset_rows(dataset_t *dataset) {
+  for (size_t i = 0; i < dataset->rows; i++) {
+    dataset->row_arr[i] = i;
+  }
+}
+
+void bench_dataset() {
+  string_t *text = generate_csv();
+  string_cache_t *cache = parse_csv(text->data, text->len, NULL);
+  dataset_t *dataset = new_dataset(cache);
+  free_cache(cache);
+  const dataset_sort_key_t keys[] = {{0, false, false}, {1, true, true}};
+  size_t *rows = malloc(ROWS * sizeof(size_t));
+  double best;
+  printf("Sorting %zu rows by city, then price descending\n", ROWS);
+
+  qsort_dataset = dataset;
+  bench_best_of(3, best, {
+    reset_rows(dataset);
+    memcpy(rows, dataset->row_arr, ROWS * sizeof(size_t));
+    qsort(rows, ROWS, sizeof(size_t), compare_rows);
+  });
+  report_rate("qsort with a parsing comparator", ROWS, "rows", best);
+  bench_sink += rows[0];
+
+  const size_t threads[] = {1, 4};
+  for (size_t t = 0; t < 2; t++) {
+    bench_best_of(3, best, {
+      reset_rows(dataset);
+      sort_dataset(dataset, keys, 2, threads[t]);
+    });
+    char label[64];
+    snprintf(label, sizeof(label), "sort_dataset (%zu threads)", threads[t]);
+    report_rate(label, ROWS, "rows", best);
+    bench_sink += dataset->row_arr[0];
+  }
+  if (memcmp(rows, dataset->row_arr, ROWS * sizeof(size_t)) != 0) {
+    printf("  The sorts disagree.\n");
+  }
+
+  free(rows);
+  free_dataset(dataset);
+  free_string(text);
+}
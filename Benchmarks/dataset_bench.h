@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_DATASET_BENCH_H
+#define C_PROGRAMS_DATASET_BENCH_H
+
+void bench_dataset();
+
+#endif // C_PROGRAMS_DATASET_BENCH_H
@@ -0,0 +1,117 @@
+#include "distance_bench.h"
+#include "../StdLib/String/distance.h"
+#include "bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t WORDS = 100000;
+static const size_t LONG_LEN = 4000;
+
+/**
+ * The textbook dynamic program, for comparison.
+ */
+static size_t table_distance(const string_t *left, const string_t *right,
+                             size_t *row) {
+  for (size_t j = 0; j <= right->len; j++) {
+    row[j] = j;
+  }
+  for (size_t i = 1; i <= left->len; i++) {
+    size_t diagonal = row[0];
+    row[0] = i;
+    for (size_t j = 1; j <= right->len; j++) {
+      size_t best = diagonal + (left->data[i - 1] != right->data[j - 1]);
+      if (row[j] + 1 < best) {
+        best = row[j] + 1;
+      }
+      if (row[j - 1] + 1 < best) {
+        best = row[j - 1] + 1;
+      }
+      diagonal = row[j];
+      row[j] = best;
+    }
+  }
+  return row[right->len];
+}
+
+static void fill_random(uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    data[i] = (uint8_t)('a' + rand() % 26);
+  }
+}
+
+static void bench_words(void) {
+  uint8_t *buffer = malloc(WORDS * 16);
+  string_t *values = malloc(WORDS * sizeof(string_t));
+  string_t **candidates = malloc(WORDS * sizeof(string_t *));
+  srand(42);
+  for (size_t i = 0; i < WORDS; i++) {
+    values[i].data = buffer + i * 16;
+    values[i].len = 4 + (size_t)rand() % 12;
+    fill_random(values[i].data, values[i].len);
+    candidates[i] = &values[i];
+  }
+  string_t query = {10, (uint8_t *)"misspeling"};
+  size_t *distances = malloc(WORDS * sizeof(size_t));
+  size_t row[32];
+  double best;
+  printf("Edit distance of a word to %zu words of 4 to 15 bytes\n", WORDS);
+
+  bench_best_of(3, best, for (size_t i = 0; i < WORDS; i++) {
+    bench_sink += table_distance(&query, &values[i], row);
+  });
+  report_rate("dynamic programming", WORDS, "pairs", best);
+  bench_best_of(3, best, for (size_t i = 0; i < WORDS; i++) {
+    bench_sink += string_edit_distance(&query, &values[i]);
+  });
+  report_rate("string_edit_distance", WORDS, "pairs", best);
+  bench_best_of(3, best, for (size_t i = 0; i < WORDS; i++) {
+    bench_sink += string_edit_distance_within(&query, &values[i], 2);
+  });
+  report_rate("string_edit_distance_within (2)", WORDS, "pairs", best);
+  bench_best_of(3, best, {
+    string_edit_distances(&query, candidates, WORDS, 2, distances);
+    bench_sink += distances[WORDS - 1];
+  });
+  report_rate("string_edit_distances (2)", WORDS, "pairs", best);
+  free(distances);
+  free(candidates);
+  free(values);
+  free(buffer);
+}
+
+static void bench_long(void) {
+  string_t left = {LONG_LEN, malloc(LONG_LEN)};
+  string_t right = {LONG_LEN, malloc(LONG_LEN)};
+  fill_random(left.data, LONG_LEN);
+  memcpy(right.data, left.data, LONG_LEN);
+  for (size_t e = 0; e < 20; e++) {
+    right.data[(size_t)rand() % LONG_LEN] = '#';
+  }
+  size_t *row = malloc((LONG_LEN + 1) * sizeof(size_t));
+  const size_t cells = LONG_LEN * LONG_LEN;
+  double best;
+  printf("Edit distance of two %zu byte strings\n", LONG_LEN);
+
+  bench_best_of(3, best, bench_sink += table_distance(&left, &right, row));
+  report_rate("dynamic programming", cells, "cells", best);
+  bench_best_of(3, best, bench_sink += string_edit_distance(&left, &right));
+  report_rate("string_edit_distance", cells, "cells", best);
+  bench_best_of(3, best,
+                bench_sink += string_edit_distance_within(&left, &right, 32));
+  report_rate("string_edit_distance_within (32)", cells, "cells", best);
+
+  string_t text = {LONG_LEN, left.data};
+  string_t pattern = {40, right.data + LONG_LEN - 60};
+  bench_best_of(3, best,
+                bench_sink += index_of_string_approx(&text, &pattern, 3));
+  report_throughput("index_of_string_approx (3)", LONG_LEN, best);
+  free(row);
+  free(left.data);
+  free(right.data);
+}
+
+void bench_distance() {
+  bench_words();
+  bench_long();
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_DISTANCE_BENCH_H
+#define C_PROGRAMS_DISTANCE_BENCH_H
+
+void bench_distance();
+
+#endif // C_PROGRAMS_DISTANCE_BENCH_H
@@ -0,0 +1,64 @@
+#include "encoding_bench.h"
+#include "../StdLib/String/encoding.h"
+#include "bench.h"
+
+#include <stdlib.h>
+
+static const size_t SIZE = 16 * 1024 * 1024;
+
+/**
+ * Encodes one byte at a time with sprintf-free arithmetic, as a baseline.
+ */
+static void bytewise_hex(const uint8_t *data, size_t len, uint8_t *out) {
+  for (size_t i = 0; i < len; i++) {
+    uint8_t high = data[i] >> 4, low = data[i] & 15;
+    out[2 * i] = (uint8_t)(high < 10 ? '0' + high : 'a' + high - 10);
+    out[2 * i + 1] = (uint8_t)(low < 10 ? '0' + low : 'a' + low - 10);
+  }
+}
+
+void bench_encoding() {
+  string_t *data = new_string(SIZE);
+  srand(42);
+  for (size_t i = 0; i < SIZE; i++) {
+    data->data[i] = (uint8_t)rand();
+  }
+  string_t *encoded = new_string(hex_encoded_len(SIZE));
+  string_t *decoded = new_string(SIZE);
+  double best;
+  printf("Encoding %zu MB of random bytes (GB/s of binary data)\n",
+         SIZE >> 20);
+
+  bench_best_of(3, best, bytewise_hex(data->data, SIZE, encoded->data));
+  report_throughput("hex, one byte at a time", SIZE, best);
+  bench_best_of(3, best, {
+    encoded->len = hex_encoded_len(SIZE);
+    hex_encode(data, encoded);
+  });
+  report_throughput("hex_encode", SIZE, best);
+  bench_best_of(3, best, {
+    decoded->len = SIZE;
+    bench_sink += hex_decode(encoded, decoded);
+  });
+  report_throughput("hex_decode", SIZE, best);
+
+  const char *names[][2] = {{"base64_encode (standard)",
+                             "base64_decode (standard)"},
+                            {"base64_encode (URL)", "base64_decode (URL)"}};
+  for (int a = 0; a < 2; a++) {
+    base64_alphabet_t alphabet = a ? BASE64_URL : BASE64_STANDARD;
+    bench_best_of(3, best, {
+      encoded->len = base64_encoded_len(SIZE, alphabet);
+      base64_encode(data, encoded, alphabet);
+    });
+    report_throughput(names[a][0], SIZE, best);
+    bench_best_of(3, best, {
+      decoded->len = base64_decoded_len(encoded->len);
+      bench_sink += base64_decode(encoded, decoded, alphabet);
+    });
+    report_throughput(names[a][1], SIZE, best);
+  }
+  free_string(data);
+  free_string(encoded);
+  free_string(decoded);
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_ENCODING_BENCH_H
+#define C_PROGRAMS_ENCODING_BENCH_H
+
+void bench_encoding();
+
+#endif // C_PROGRAMS_ENCODING_BENCH_H
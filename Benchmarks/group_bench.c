@@ -0,0 +1,70 @@
+#include "group_bench.h"
+#include "../StdLib/Data/csv.h"
+#include "../StdLib/Data/group.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static const size_t ROWS = 10000000;
+
+// A table of a store (100 values), a customer (1M values) and an amount.
+static string_t *generate_csv(void) {
+  string_t *text = new_string(ROWS * 32);
+  char *out = (char *)text->data;
+  size_t len = (size_t)sprintf(out, "store,customer,amount\n");
+  srand(42);
+  for (size_t i = 0; i < ROWS; i++) {
+    len += (size_t)sprintf(out + len, "s%d,c%d,%d.%02d\n", rand() % 100,
+                           rand() % 1000000, rand() % 1000, rand() % 100);
+  }
+  text->len = len;
+  return text;
+}
+
+void bench_group() {
+  string_t *text = generate_csv();
+  string_cache_t *cache = parse_csv(text->data, text->len, NULL);
+  free_string(text);
+  dataset_t *dataset = new_dataset(cache);
+  free_cache(cache);
+  const size_t by_store[] = {0};
+  const size_t by_customer[] = {1};
+  const aggregate_t sums[] = {{AGGREGATE_COUNT, 0}, {AGGREGATE_SUM, 2}};
+  const aggregate_t customers[] = {{AGGREGATE_COUNT_DISTINCT, 1}};
+  const size_t threads[] = {1, 4};
+  double best;
+  dataset_t *groups = NULL;
+  printf("Grouping %zu rows\n", ROWS);
+
+  for (size_t t = 0; t < 2; t++) {
+    char label[64];
+    bench_best_of(3, best, {
+      free_dataset(groups);
+      groups = group_dataset(dataset, by_store, 1, sums, 2, threads[t]);
+    });
+    snprintf(label, sizeof(label), "count, sum by store (%zu threads)",
+             threads[t]);
+    report_rate(label, ROWS, "rows", best);
+
+    bench_best_of(3, best, {
+      free_dataset(groups);
+      groups = group_dataset(dataset, by_customer, 1, sums, 2, threads[t]);
+    });
+    snprintf(label, sizeof(label), "count, sum by customer (%zu threads)",
+             threads[t]);
+    report_rate(label, ROWS, "rows", best);
+
+    bench_best_of(3, best, {
+      free_dataset(groups);
+      groups = group_dataset(dataset, by_store, 1, customers, 1, threads[t]);
+    });
+    snprintf(label, sizeof(label), "distinct customers (%zu threads)",
+             threads[t]);
+    report_rate(label, ROWS, "rows", best);
+    bench_sink += groups->rows;
+  }
+
+  free_dataset(groups);
+  free_dataset(dataset);
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_GROUP_BENCH_H
+#define C_PROGRAMS_GROUP_BENCH_H
+
+void bench_group();
+
+#endif // C_PROGRAMS_GROUP_BENCH_H
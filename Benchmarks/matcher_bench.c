@@ -0,0 +1,93 @@
+#include "matcher_bench.h"
+#include "../StdLib/String/matcher.h"
+#include "bench.h"
+
+#include <fnmatch.h>
+#include <regex.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t FIELDS = 200000;
+
+/**
+ * Generates fields that look like log lines: a few words, sometimes with an
+ * error code in them. The fields are NUL-terminated for the libc matchers.
+ */
+static string_t *generate_fields(char **buffer) {
+  static const char *words[] = {"request", "served", "user", "cache",  "miss",
+                                "GET",     "POST",   "ok",   "timeout", "db"};
+  *buffer = malloc(FIELDS * 64);
+  string_t *fields = malloc(FIELDS * sizeof(string_t));
+  srand(42);
+  char *cursor = *buffer;
+  for (size_t i = 0; i < FIELDS; i++) {
+    int len = 0;
+    for (int w = 0; w < 5; w++) {
+      len += sprintf(cursor + len, "%s ", words[rand() % 10]);
+    }
+    if (rand() % 20 == 0) {
+      len += sprintf(cursor + len, "error E%d", rand() % 1000);
+    } else {
+      len += sprintf(cursor + len, "id=%d", rand());
+    }
+    fields[i].data = (uint8_t *)cursor;
+    fields[i].len = (size_t)len;
+    cursor += len + 1;
+  }
+  return fields;
+}
+
+static void compare_regex(const string_t *fields, const char *pattern) {
+  double best;
+  size_t bytes = 0;
+  for (size_t i = 0; i < FIELDS; i++) {
+    bytes += fields[i].len;
+  }
+  printf("Regex \"%s\" over %zu fields\n", pattern, FIELDS);
+
+  regex_t posix;
+  regcomp(&posix, pattern, REG_EXTENDED | REG_NOSUB);
+  bench_best_of(3, best, for (size_t i = 0; i < FIELDS; i++) {
+    bench_sink += regexec(&posix, (const char *)fields[i].data, 0, NULL, 0) == 0;
+  });
+  report_throughput("regexec", bytes, best);
+  regfree(&posix);
+
+  matcher_t *matcher = compile_regex(pattern);
+  bench_best_of(3, best, for (size_t i = 0; i < FIELDS; i++) {
+    bench_sink += matcher_matches(matcher, &fields[i]);
+  });
+  report_throughput("matcher_matches", bytes, best);
+  free_matcher(matcher);
+}
+
+static void compare_glob(const string_t *fields, const char *pattern) {
+  double best;
+  size_t bytes = 0;
+  for (size_t i = 0; i < FIELDS; i++) {
+    bytes += fields[i].len;
+  }
+  printf("Glob \"%s\" over %zu fields\n", pattern, FIELDS);
+  bench_best_of(3, best, for (size_t i = 0; i < FIELDS; i++) {
+    bench_sink += fnmatch(pattern, (const char *)fields[i].data, 0) == 0;
+  });
+  report_throughput("fnmatch", bytes, best);
+  matcher_t *matcher = compile_glob(pattern);
+  bench_best_of(3, best, for (size_t i = 0; i < FIELDS; i++) {
+    bench_sink += matcher_matches(matcher, &fields[i]);
+  });
+  report_throughput("matcher_matches", bytes, best);
+  free_matcher(matcher);
+}
+
+void bench_matcher() {
+  char *buffer;
+  string_t *fields = generate_fields(&buffer);
+  compare_regex(fields, "error E[0-9]+");
+  compare_regex(fields, "(timeout|miss) (db|cache)");
+  compare_regex(fields, "^GET .*id=[0-9]{5,}$");
+  compare_glob(fields, "*error*");
+  compare_glob(fields, "request*id=1*");
+  free(fields);
+  free(buffer);
+}
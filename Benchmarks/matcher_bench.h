@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_MATCHER_BENCH_H
+#define C_PROGRAMS_MATCHER_BENCH_H
+
+void bench_matcher();
+
+#endif // C_PROGRAMS_MATCHER_BENCH_H
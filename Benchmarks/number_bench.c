@@ -0,0 +1,139 @@
+#include "number_bench.h"
+#include "../StdLib/String/number.h"
+#include "bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t COUNT = 1000000;
+
+/**
+ * The numbers are printed one after the other, each followed by a NUL byte
+ * so that the libc functions can read them in place too. The views exclude
+ * the terminators.
+ */
+typedef struct number_text {
+  char *text;
+  string_t *views;
+} number_text_t;
+
+static uint64_t next_random(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+static number_text_t generate_numbers(bool floating) {
+  number_text_t numbers;
+  numbers.text = malloc(COUNT * NUMBER_BUFFER_SIZE);
+  numbers.views = malloc(COUNT * sizeof(string_t));
+  uint64_t state = 42;
+  size_t len = 0;
+  for (size_t i = 0; i < COUNT; i++) {
+    uint64_t bits = next_random(&state);
+    int written;
+    if (floating) {
+      // Uniform in [0, 1) with all 17 significant digits, like the output
+      // of most numeric programs.
+      written = snprintf(numbers.text + len, NUMBER_BUFFER_SIZE, "%.17g",
+                         (double)(bits >> 11) * 0x1.0p-53);
+    } else {
+      written = snprintf(numbers.text + len, NUMBER_BUFFER_SIZE, "%lld",
+                         (long long)((int64_t)bits >> (bits % 48)));
+    }
+    numbers.views[i].data = (uint8_t *)numbers.text + len;
+    numbers.views[i].len = (size_t)written;
+    len += (size_t)written + 1;
+  }
+  return numbers;
+}
+
+static void free_numbers(number_text_t numbers) {
+  free(numbers.text);
+  free(numbers.views);
+}
+
+static void parse_with_strtod(const number_text_t *numbers) {
+  double sum = 0;
+  for (size_t i = 0; i < COUNT; i++) {
+    sum += strtod((const char *)numbers->views[i].data, NULL);
+  }
+  bench_sink += (size_t)sum;
+}
+
+static void parse_with_string_to_double(const number_text_t *numbers) {
+  double sum = 0;
+  for (size_t i = 0; i < COUNT; i++) {
+    double value;
+    string_to_double(&numbers->views[i], &value);
+    sum += value;
+  }
+  bench_sink += (size_t)sum;
+}
+
+static void parse_with_strtoll(const number_text_t *numbers) {
+  long long sum = 0;
+  for (size_t i = 0; i < COUNT; i++) {
+    sum += strtoll((const char *)numbers->views[i].data, NULL, 10);
+  }
+  bench_sink += (size_t)sum;
+}
+
+static void parse_with_string_to_int64(const number_text_t *numbers) {
+  uint64_t sum = 0;
+  for (size_t i = 0; i < COUNT; i++) {
+    int64_t value;
+    string_to_int64(&numbers->views[i], &value);
+    sum += (uint64_t)value;
+  }
+  bench_sink += (size_t)sum;
+}
+
+void bench_number() {
+  double best;
+  char buffer[NUMBER_BUFFER_SIZE];
+  printf("Numbers, %zu values\n", COUNT);
+
+  number_text_t doubles = generate_numbers(true);
+  bench_best_of(5, best, parse_with_strtod(&doubles));
+  report_rate("strtod", COUNT, "numbers", best);
+  bench_best_of(5, best, parse_with_string_to_double(&doubles));
+  report_rate("string_to_double", COUNT, "numbers", best);
+
+  number_text_t integers = generate_numbers(false);
+  bench_best_of(5, best, parse_with_strtoll(&integers));
+  report_rate("strtoll", COUNT, "numbers", best);
+  bench_best_of(5, best, parse_with_string_to_int64(&integers));
+  report_rate("string_to_int64", COUNT, "numbers", best);
+
+  // Format the values back; the parsed doubles double as the input.
+  double *values = malloc(COUNT * sizeof(double));
+  int64_t *whole = malloc(COUNT * sizeof(int64_t));
+  for (size_t i = 0; i < COUNT; i++) {
+    string_to_double(&doubles.views[i], &values[i]);
+    string_to_int64(&integers.views[i], &whole[i]);
+  }
+  bench_best_of(5, best, for (size_t i = 0; i < COUNT; i++) {
+    bench_sink += (size_t)snprintf(buffer, sizeof(buffer), "%.17g", values[i]);
+  });
+  report_rate("snprintf %.17g (not shortest)", COUNT, "numbers", best);
+  bench_best_of(5, best, for (size_t i = 0; i < COUNT; i++) {
+    bench_sink += format_double(values[i], (uint8_t *)buffer);
+  });
+  report_rate("format_double (shortest)", COUNT, "numbers", best);
+  bench_best_of(5, best, for (size_t i = 0; i < COUNT; i++) {
+    bench_sink += (size_t)snprintf(buffer, sizeof(buffer), "%lld",
+                                   (long long)whole[i]);
+  });
+  report_rate("snprintf %lld", COUNT, "numbers", best);
+  bench_best_of(5, best, for (size_t i = 0; i < COUNT; i++) {
+    bench_sink += format_int64(whole[i], (uint8_t *)buffer);
+  });
+  report_rate("format_int64", COUNT, "numbers", best);
+
+  free(values);
+  free(whole);
+  free_numbers(doubles);
+  free_numbers(integers);
+}
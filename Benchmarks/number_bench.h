@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_NUMBER_BENCH_H
+#define C_PROGRAMS_NUMBER_BENCH_H
+
+void bench_number();
+
+#endif // C_PROGRAMS_NUMBER_BENCH_H
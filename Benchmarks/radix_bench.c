@@ -0,0 +1,131 @@
+#include "radix_bench.h"
+#include "../StdLib/String/intern.h"
+#include "../StdLib/String/radix.h"
+#include "bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t PREFIXES = 2000;
+static const size_t KEYS = 1000000;
+static const size_t QUERIES = 100000;
+
+// Strings like URL paths: a few segments from a small vocabulary.
+static string_t *make_path(size_t segments) {
+  static const char *words[] = {"api", "v1", "v2", "users", "items", "search",
+                                "static", "img", "css", "admin", "login",
+                                "orders", "cart", "help", "docs", "blog"};
+  char buffer[256];
+  size_t len = 0;
+  for (size_t i = 0; i < segments; i++) {
+    buffer[len++] = '/';
+    for (const char *word = words[rand() % 16]; *word; word++) {
+      buffer[len++] = *word;
+    }
+    if (rand() % 4 == 0) {
+      len += (size_t)sprintf(buffer + len, "%d", rand() % 1000);
+    }
+  }
+  string_t *path = new_string(len);
+  memcpy(path->data, buffer, len);
+  return path;
+}
+
+// The linear scan that radix_longest_prefix replaces.
+static const string_t *scan_longest_prefix(string_t **prefixes, size_t count,
+                                           const string_t *string) {
+  const string_t *best = NULL;
+  for (size_t i = 0; i < count; i++) {
+    if (prefixes[i]->len > string->len ||
+        (best && prefixes[i]->len <= best->len)) {
+      continue;
+    }
+    string_t *start = left_string(string, prefixes[i]->len);
+    if (string_cmp(start, prefixes[i]) == 0) {
+      best = prefixes[i];
+    }
+    free_string(start);
+  }
+  return best;
+}
+
+void bench_radix() {
+  srand(42);
+  string_t **prefixes = malloc(PREFIXES * sizeof(string_t *));
+  string_t **keys = malloc(KEYS * sizeof(string_t *));
+  string_t **queries = malloc(QUERIES * sizeof(string_t *));
+  for (size_t i = 0; i < PREFIXES; i++) {
+    prefixes[i] = make_path(1 + (size_t)rand() % 3);
+  }
+  for (size_t i = 0; i < KEYS; i++) {
+    keys[i] = make_path(2 + (size_t)rand() % 4);
+  }
+  for (size_t i = 0; i < QUERIES; i++) {
+    queries[i] = make_path(1 + (size_t)rand() % 5);
+  }
+  double best;
+  printf("Longest prefix among %zu prefixes, %zu keys\n", PREFIXES, KEYS);
+
+  radix_tree_t *routes = new_radix_tree();
+  for (size_t i = 0; i < PREFIXES; i++) {
+    radix_insert(routes, prefixes[i], prefixes[i]);
+  }
+  bench_best_of(3, best, {
+    for (size_t i = 0; i < QUERIES / 100; i++) {
+      bench_sink += scan_longest_prefix(prefixes, PREFIXES, queries[i]) != 0;
+    }
+  });
+  report_rate("left_string and string_cmp scan", QUERIES / 100, "queries",
+              best);
+  bench_best_of(3, best, {
+    for (size_t i = 0; i < QUERIES; i++) {
+      bench_sink += radix_longest_prefix(routes, queries[i]) != 0;
+    }
+  });
+  report_rate("radix_longest_prefix", QUERIES, "queries", best);
+  free_radix_tree(routes);
+
+  radix_tree_t *tree = NULL;
+  bench_best_of(3, best, {
+    free_radix_tree(tree);
+    tree = new_radix_tree();
+    for (size_t i = 0; i < KEYS; i++) {
+      radix_insert(tree, keys[i], keys[i]);
+    }
+  });
+  report_rate("radix_insert", KEYS, "keys", best);
+  bench_best_of(3, best, {
+    for (size_t i = 0; i < KEYS; i++) {
+      bench_sink += radix_find(tree, keys[i]) != 0;
+    }
+  });
+  report_rate("radix_find", KEYS, "keys", best);
+  printf("  %-40s %8.1f bytes/key\n", "radix tree memory",
+         (double)tree->memory / (double)tree->count);
+
+  intern_pool_t *pool = new_intern_pool();
+  for (size_t i = 0; i < KEYS; i++) {
+    intern_string(pool, keys[i]);
+  }
+  bench_best_of(3, best, {
+    for (size_t i = 0; i < KEYS; i++) {
+      bench_sink += find_interned(pool, keys[i]) != 0;
+    }
+  });
+  report_rate("find_interned (hash table)", KEYS, "keys", best);
+  free_intern_pool(pool);
+  free_radix_tree(tree);
+
+  for (size_t i = 0; i < PREFIXES; i++) {
+    free_string(prefixes[i]);
+  }
+  for (size_t i = 0; i < KEYS; i++) {
+    free_string(keys[i]);
+  }
+  for (size_t i = 0; i < QUERIES; i++) {
+    free_string(queries[i]);
+  }
+  free(prefixes);
+  free(keys);
+  free(queries);
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_RADIX_BENCH_H
+#define C_PROGRAMS_RADIX_BENCH_H
+
+void bench_radix();
+
+#endif // C_PROGRAMS_RADIX_BENCH_H
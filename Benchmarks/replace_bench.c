@@ -0,0 +1,97 @@
+#include "replace_bench.h"
+#include "../StdLib/String/replace.h"
+#include "bench.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const size_t TEXT_LEN = 1 << 20;
+static const size_t NAIVE_LEN = 1 << 16;
+
+// The loop that string_replace_all replaces.
+static string_t *naive_replace_all(const string_t *source,
+                                   const string_t *needle,
+                                   const string_t *replacement) {
+  string_t *result = new_string(0);
+  string_t *rest = copy_string(source);
+  size_t index;
+  while ((index = index_of_string(rest, needle)) <= rest->len) {
+    string_t *before = substring(rest, 0, index);
+    string_t *joined = concat_string(result, before);
+    free_string(result);
+    result = concat_string(joined, replacement);
+    free_string(joined);
+    free_string(before);
+    string_t *after = substring(rest, index + needle->len, rest->len);
+    free_string(rest);
+    rest = after;
+  }
+  string_t *joined = concat_string(result, rest);
+  free_string(result);
+  free_string(rest);
+  return joined;
+}
+
+void bench_replace() {
+  // Words of log-like text with a needle about every 60 bytes.
+  static const char *words[] = {"GET", "/index.html", "200", "user=alice",
+                                "POST", "/api/v1/items", "404", "latency"};
+  string_t *text = new_string(TEXT_LEN);
+  srand(42);
+  for (size_t i = 0; i < TEXT_LEN;) {
+    const char *word = words[rand() % 8];
+    for (size_t j = 0; word[j] && i < TEXT_LEN; j++) {
+      text->data[i++] = (uint8_t)word[j];
+    }
+    if (i < TEXT_LEN) {
+      text->data[i++] = ' ';
+    }
+  }
+  string_t needle = {10, (uint8_t *)"user=alice"};
+  string_t replacement = {13, (uint8_t *)"user=redacted"};
+  string_t small = {NAIVE_LEN, text->data};
+  double best;
+  printf("Replacing \"user=alice\" in %zu KB of text\n", TEXT_LEN >> 10);
+
+  bench_best_of(3, best, {
+    string_t *result = naive_replace_all(&small, &needle, &replacement);
+    bench_sink += result->len;
+    free_string(result);
+  });
+  report_throughput("index_of_string and concat (64 KB)", NAIVE_LEN, best);
+
+  bench_best_of(3, best, {
+    string_t *result = string_replace_all(&small, &needle, &replacement);
+    bench_sink += result->len;
+    free_string(result);
+  });
+  report_throughput("string_replace_all (64 KB)", NAIVE_LEN, best);
+
+  bench_best_of(5, best, {
+    string_t *result = string_replace_all(text, &needle, &replacement);
+    bench_sink += result->len;
+    free_string(result);
+  });
+  report_throughput("string_replace_all", TEXT_LEN, best);
+
+  int fd = open("/dev/null", O_WRONLY);
+  string_writer_t *writer = new_fd_writer(fd, 0);
+  stream_replacer_t *replacer = new_stream_replacer(&needle, &replacement);
+  string_t chunk;
+  chunk.len = 4096;
+  bench_best_of(5, best, {
+    for (size_t i = 0; i < TEXT_LEN; i += chunk.len) {
+      chunk.data = text->data + i;
+      stream_replace(replacer, &chunk, writer);
+    }
+    stream_replace_finish(replacer, writer);
+    writer_flush(writer);
+  });
+  report_throughput("stream replacer (4 KB chunks)", TEXT_LEN, best);
+  free_stream_replacer(replacer);
+  free_writer(writer);
+  close(fd);
+  free_string(text);
+}
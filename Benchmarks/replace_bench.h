@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_REPLACE_BENCH_H
+#define C_PROGRAMS_REPLACE_BENCH_H
+
+void bench_replace();
+
+#endif // C_PROGRAMS_REPLACE_BENCH_H
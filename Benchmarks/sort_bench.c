@@ -0,0 +1,60 @@
+#include "sort_bench.h"
+#include "../StdLib/String/sort.h"
+#include "bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t COUNT = 2000000;
+
+static int compare_pointers(const void *left, const void *right) {
+  return string_cmp(*(string_t *const *)left, *(string_t *const *)right);
+}
+
+/**
+ * Generates paths such as "/api/v2/users/48213/orders", which share long
+ * prefixes like the values of a real column. Every string is allocated on
+ * its own, in random order, as a loaded dataset would be.
+ */
+static string_t **generate_paths(void) {
+  const char *sections[] = {"users", "orders", "items", "accounts"};
+  string_t **strings = malloc(COUNT * sizeof(string_t *));
+  char buffer[64];
+  srand(42);
+  for (size_t i = 0; i < COUNT; i++) {
+    snprintf(buffer, sizeof(buffer), "/api/v%d/%s/%d/%s", 1 + rand() % 2,
+             sections[rand() % 4], rand() % 100000, sections[rand() % 4]);
+    strings[i] = convert_string(buffer);
+  }
+  return strings;
+}
+
+void bench_sort() {
+  string_t **strings = generate_paths();
+  string_t **copy = malloc(COUNT * sizeof(string_t *));
+  double best;
+  printf("Sorting %zu paths\n", COUNT);
+
+  bench_best_of(3, best, {
+    memcpy(copy, strings, COUNT * sizeof(string_t *));
+    qsort(copy, COUNT, sizeof(string_t *), compare_pointers);
+  });
+  report_rate("qsort with string_cmp", COUNT, "strings", best);
+  bench_best_of(3, best, {
+    memcpy(copy, strings, COUNT * sizeof(string_t *));
+    sort_strings(copy, COUNT, 1);
+  });
+  report_rate("sort_strings (1 thread)", COUNT, "strings", best);
+  bench_best_of(3, best, {
+    memcpy(copy, strings, COUNT * sizeof(string_t *));
+    sort_strings(copy, COUNT, 0);
+  });
+  report_rate("sort_strings (all processors)", COUNT, "strings", best);
+  bench_sink += copy[0]->len;
+
+  for (size_t i = 0; i < COUNT; i++) {
+    free_string(strings[i]);
+  }
+  free(copy);
+  free(strings);
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_SORT_BENCH_H
+#define C_PROGRAMS_SORT_BENCH_H
+
+void bench_sort();
+
+#endif // C_PROGRAMS_SORT_BENCH_H
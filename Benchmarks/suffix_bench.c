@@ -0,0 +1,112 @@
+#include "suffix_bench.h"
+#include "../StdLib/String/fm_index.h"
+#include "../StdLib/String/search.h"
+#include "../StdLib/String/suffix.h"
+#include "bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t SIZE = 16 * 1024 * 1024;
+static const size_t QUERIES = 1000;
+
+/**
+ * Generates text made of random words from a small vocabulary, so that the
+ * queries have many occurrences, as in natural language.
+ */
+static string_t *generate_words(void) {
+  string_t *text = new_string(SIZE);
+  char words[512][8];
+  srand(42);
+  for (size_t w = 0; w < 512; w++) {
+    size_t len = 2 + (size_t)rand() % 6;
+    for (size_t i = 0; i < len; i++) {
+      words[w][i] = (char)('a' + rand() % 26);
+    }
+    words[w][len] = '\0';
+  }
+  size_t len = 0;
+  while (len + 9 <= SIZE) {
+    const char *word = words[rand() % 512];
+    size_t word_len = strlen(word);
+    memcpy(text->data + len, word, word_len);
+    len += word_len;
+    text->data[len++] = ' ';
+  }
+  text->len = len;
+  return text;
+}
+
+static size_t scan_count(const string_t *text, const string_t *pattern) {
+  size_t count = 0;
+  size_t offset = 0;
+  while (offset < text->len) {
+    size_t found = search_bytes(text->data + offset, text->len - offset,
+                                pattern->data, pattern->len);
+    if (found == text->len - offset) {
+      break;
+    }
+    count++;
+    offset += found + 1;
+  }
+  return count;
+}
+
+void bench_suffix() {
+  string_t *text = generate_words();
+  string_t *patterns = malloc(QUERIES * sizeof(string_t));
+  for (size_t q = 0; q < QUERIES; q++) {
+    patterns[q].len = 4 + (size_t)rand() % 8;
+    patterns[q].data = text->data + (size_t)rand() % (text->len - 16);
+  }
+  double best, start;
+  printf("Suffix array and FM-index, %zu MB of words, %zu queries\n",
+         text->len >> 20, QUERIES);
+
+  start = bench_now();
+  size_t *suffixes = build_suffix_array(text);
+  report_throughput("build_suffix_array (SA-IS)", text->len,
+                    bench_now() - start);
+  start = bench_now();
+  size_t *lcp = build_lcp_array(text, suffixes);
+  report_throughput("build_lcp_array", text->len, bench_now() - start);
+  start = bench_now();
+  fm_index_t *index = new_fm_index(text, 0);
+  report_throughput("new_fm_index", text->len, bench_now() - start);
+  printf("  %-40s %8.2f bytes/byte\n", "suffix array size",
+         (double)sizeof(size_t));
+  printf("  %-40s %8.2f bytes/byte\n", "FM-index size",
+         (double)index->size / (double)text->len);
+
+  // A full scan per query is slow, so it only runs on a tenth of them.
+  bench_best_of(1, best, for (size_t q = 0; q < QUERIES / 10; q++) {
+    bench_sink += scan_count(text, &patterns[q]);
+  });
+  printf("  %-40s %8.0f queries/s\n", "scan with search_bytes",
+         (double)(QUERIES / 10) / best);
+  bench_best_of(3, best, for (size_t q = 0; q < QUERIES; q++) {
+    bench_sink += count_occurrences(text, suffixes, &patterns[q]);
+  });
+  printf("  %-40s %8.0f queries/s\n", "count_occurrences (suffix array)",
+         (double)QUERIES / best);
+  bench_best_of(3, best, for (size_t q = 0; q < QUERIES; q++) {
+    bench_sink += fm_index_count(index, &patterns[q]);
+  });
+  printf("  %-40s %8.0f queries/s\n", "fm_index_count", (double)QUERIES / best);
+
+  // Locating costs up to the sample rate in steps per occurrence.
+  size_t located = 0;
+  bench_best_of(1, best, for (size_t q = 0; q < QUERIES / 10; q++) {
+    size_t count;
+    size_t *positions = fm_index_locate(index, &patterns[q], &count);
+    located += count;
+    free(positions);
+  });
+  report_rate("fm_index_locate", located, "positions", best);
+
+  free_fm_index(index);
+  free(lcp);
+  free(suffixes);
+  free(patterns);
+  free_string(text);
+}
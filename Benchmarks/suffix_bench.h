@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_SUFFIX_BENCH_H
+#define C_PROGRAMS_SUFFIX_BENCH_H
+
+void bench_suffix();
+
+#endif // C_PROGRAMS_SUFFIX_BENCH_H
@@ -0,0 +1,80 @@
+#include "utf8_bench.h"
+#include "../StdLib/String/utf8.h"
+#include "bench.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t SIZE = 64 * 1024 * 1024;
+
+/**
+ * Fills the string with text where roughly the given percentage of the
+ * characters are non-ASCII (a mix of two, three and four byte sequences).
+ */
+static string_t *generate_text(unsigned percent) {
+  static const char *samples[] = {"\xc3\xa9", "\xe2\x82\xac",
+                                  "\xf0\x9f\x98\x80"};
+  string_t *text = new_string(SIZE);
+  size_t len = 0;
+  srand(42);
+  while (len + 4 <= SIZE) {
+    if ((unsigned)(rand() % 100) < percent) {
+      const char *sample = samples[rand() % 3];
+      size_t sample_len = strlen(sample);
+      memcpy(text->data + len, sample, sample_len);
+      len += sample_len;
+    } else {
+      text->data[len++] = (uint8_t)('a' + rand() % 26);
+    }
+  }
+  text->len = len;
+  return text;
+}
+
+/**
+ * The per-byte state machine this library replaces, kept as the baseline.
+ */
+static bool naive_validate(const uint8_t *data, size_t len) {
+  size_t remaining = 0;
+  for (size_t i = 0; i < len; i++) {
+    uint8_t byte = data[i];
+    if (remaining) {
+      if ((byte & 0xc0) != 0x80) {
+        return false;
+      }
+      remaining--;
+    } else if (byte >= 0xf0) {
+      remaining = 3;
+    } else if (byte >= 0xe0) {
+      remaining = 2;
+    } else if (byte >= 0xc0) {
+      remaining = 1;
+    } else if (byte >= 0x80) {
+      return false;
+    }
+  }
+  return remaining == 0;
+}
+
+void bench_utf8() {
+  const unsigned mixes[] = {0, 10, 50};
+  uint32_t *output = malloc(SIZE * sizeof(uint32_t));
+
+  for (size_t m = 0; m < sizeof(mixes) / sizeof(mixes[0]); m++) {
+    string_t *text = generate_text(mixes[m]);
+    double best;
+    printf("UTF-8, %u%% non-ASCII, %zu MB\n", mixes[m], text->len >> 20);
+
+    bench_best_of(5, best, bench_sink += naive_validate(text->data, text->len));
+    report_throughput("per-byte state machine", text->len, best);
+    bench_best_of(5, best, bench_sink += utf8_is_valid(text));
+    report_throughput("utf8_is_valid", text->len, best);
+    bench_best_of(5, best, bench_sink += utf8_count_code_points(text));
+    report_throughput("utf8_count_code_points", text->len, best);
+    bench_best_of(5, best, bench_sink += utf8_to_utf32(text, output));
+    report_throughput("utf8_to_utf32", text->len, best);
+
+    free_string(text);
+  }
+  free(output);
+}
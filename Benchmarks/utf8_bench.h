@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_UTF8_BENCH_H
+#define C_PROGRAMS_UTF8_BENCH_H
+
+void bench_utf8();
+
+#endif // C_PROGRAMS_UTF8_BENCH_H
@@ -0,0 +1,62 @@
+#include "writer_bench.h"
+#include "../StdLib/String/writer.h"
+#include "bench.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static const size_t FIELDS = 4000000;
+
+void bench_writer() {
+  static uint8_t letters[32] = "abcdefghijklmnopqrstuvwxyz012345";
+  string_t *fields = malloc(FIELDS * sizeof(string_t));
+  size_t bytes = 0;
+  srand(42);
+  for (size_t i = 0; i < FIELDS; i++) {
+    fields[i].len = 1 + (size_t)rand() % 16;
+    fields[i].data = letters;
+    bytes += fields[i].len + 1;
+  }
+  FILE *stream = fopen("/dev/null", "wb");
+  int fd = open("/dev/null", O_WRONLY);
+  double best;
+  printf("Writing %zu fields to /dev/null\n", FIELDS);
+
+  bench_best_of(3, best, {
+    for (size_t i = 0; i < FIELDS; i++) {
+      fprint_string(&fields[i], stream);
+      fputc(i % 8 == 7 ? '\n' : ',', stream);
+    }
+    fflush(stream);
+  });
+  report_throughput("fprint_string and fputc", bytes, best);
+
+  string_writer_t *writer = new_stream_writer(stream, 0);
+  bench_best_of(3, best, {
+    for (size_t i = 0; i < FIELDS; i++) {
+      writer_write(writer, &fields[i]);
+      writer_write_byte(writer, i % 8 == 7 ? '\n' : ',');
+    }
+    writer_flush(writer);
+    fflush(stream);
+  });
+  report_throughput("stream writer", bytes, best);
+  free_writer(writer);
+
+  writer = new_fd_writer(fd, 0);
+  bench_best_of(3, best, {
+    for (size_t i = 0; i < FIELDS; i++) {
+      writer_write(writer, &fields[i]);
+      writer_write_byte(writer, i % 8 == 7 ? '\n' : ',');
+    }
+    writer_flush(writer);
+  });
+  report_throughput("fd writer (writev)", bytes, best);
+  printf("  %-40s %8zu\n", "fd writer flushes", writer->flushes);
+  free_writer(writer);
+
+  fclose(stream);
+  close(fd);
+  free(fields);
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_WRITER_BENCH_H
+#define C_PROGRAMS_WRITER_BENCH_H
+
+void bench_writer();
+
+#endif // C_PROGRAMS_WRITER_BENCH_H
@@ -0,0 +1,93 @@
+#include "arena.h"
+#include "../Panic/panic.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+static arena_block_t *new_block(size_t size) {
+  arena_block_t *block = malloc(sizeof(arena_block_t) + size);
+  if (!block) {
+    panic(stderr, "Could not allocate a new arena block.");
+  }
+  block->next = NULL;
+  block->used = 0;
+  block->size = size;
+  return block;
+}
+
+arena_t *new_arena(size_t block_size) {
+  arena_t *arena = malloc(sizeof(arena_t));
+  if (!arena) {
+    panic(stderr, "Could not allocate the arena.");
+  }
+  arena->block_size = block_size ? block_size : DEFAULT_BLOCK_SIZE;
+  arena->allocated = 0;
+  arena->reserved = 0;
+  arena->head = NULL;
+  return arena;
+}
+
+void *arena_alloc(arena_t *arena, size_t size, size_t align) {
+  if (!arena) {
+    panic(stderr, "Arena pointer is null.");
+  }
+  if (align == 0 || (align & (align - 1))) {
+    panic(stderr, "Arena alignment must be a power of two.");
+  }
+  arena_block_t *block = arena->head;
+  if (block) {
+    uintptr_t base = (uintptr_t)block->data;
+    size_t offset = ((base + block->used + align - 1) & ~(align - 1)) - base;
+    if (offset + size <= block->size) {
+      block->used = offset + size;
+      arena->allocated += size;
+      return block->data + offset;
+    }
+  }
+
+  // The head block is full. Oversized requests get a block of their own,
+  // which is linked behind the head so the head's free space is not lost.
+  size_t needed = size + align;
+  if (needed > arena->block_size / 4 && block) {
+    arena_block_t *big = new_block(needed);
+    big->next = block->next;
+    block->next = big;
+    arena->reserved += needed;
+    arena->allocated += size;
+    uintptr_t base = (uintptr_t)big->data;
+    size_t offset = ((base + align - 1) & ~(align - 1)) - base;
+    big->used = offset + size;
+    return big->data + offset;
+  }
+
+  size_t block_size = needed > arena->block_size ? needed : arena->block_size;
+  block = new_block(block_size);
+  block->next = arena->head;
+  arena->head = block;
+  arena->reserved += block_size;
+  return arena_alloc(arena, size, align);
+}
+
+uint8_t *arena_copy(arena_t *arena, const uint8_t *data, size_t len) {
+  uint8_t *copy = arena_alloc(arena, len ? len : 1, 1);
+  if (len) {
+    memcpy(copy, data, len);
+  }
+  return copy;
+}
+
+void free_arena(arena_t *arena) {
+  if (!arena) {
+    return;
+  }
+  arena_block_t *block = arena->head;
+  while (block) {
+    arena_block_t *next = block->next;
+    free(block);
+    block = next;
+  }
+  free(arena);
+}
@@ -0,0 +1,80 @@
+#ifndef C_PROGRAMS_ARENA_H
+#define C_PROGRAMS_ARENA_H
+/**
+ * A simple region (arena) allocator.
+ *
+ * Memory is handed out from large blocks by bumping a pointer, and it is
+ * only ever released all at once with free_arena. This makes it ideal for
+ * data that has the same lifetime, e.g. the contents of a string pool.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct arena_block {
+  struct arena_block *next;
+  size_t used;
+  size_t size;
+  uint8_t data[];
+} arena_block_t;
+
+/**
+ * The arena keeps a singly linked list of blocks. Allocations are always
+ * served from the head block; when it runs out of room, a new block is
+ * pushed in front of it.
+ *
+ * allocated counts the bytes handed out to the user, reserved counts the
+ * bytes obtained from malloc (including unused tails of older blocks).
+ */
+typedef struct arena {
+  size_t block_size;
+  size_t allocated;
+  size_t reserved;
+  arena_block_t *head;
+} arena_t;
+
+/**
+ * Creates a new, empty arena. No memory is reserved until the first
+ * allocation is made.
+ *
+ * @param block_size The default size of each block in bytes. A value of 0
+ *                   selects a sensible default.
+ * @return A new arena that must be freed with free_arena.
+ */
+arena_t *new_arena(size_t block_size);
+
+/**
+ * Allocates the requested number of bytes from the arena, from the free
+ * space of the current block when they fit. Otherwise, a request whose size
+ * plus alignment exceeds a quarter of the block size receives a dedicated
+ * block of exactly that many bytes, linked behind the current one so that
+ * its free space is still used; any other request starts a new block of the
+ * block size. The very first allocation always starts a block, of the block
+ * size or of the size plus alignment if that is larger. The memory is not
+ * zeroed.
+ *
+ * @param arena The arena to allocate from.
+ * @param size  The number of bytes required.
+ * @param align The required alignment (must be a power of two).
+ * @return A pointer to the memory, valid until the arena is freed.
+ */
+void *arena_alloc(arena_t *arena, size_t size, size_t align);
+
+/**
+ * Copies the given bytes into the arena.
+ *
+ * @param arena The arena to allocate from.
+ * @param data  The bytes to copy.
+ * @param len   The number of bytes to copy.
+ * @return A pointer to the copy inside the arena.
+ */
+uint8_t *arena_copy(arena_t *arena, const uint8_t *data, size_t len);
+
+/**
+ * Releases every block owned by the arena along with the arena itself.
+ * All pointers obtained from it become invalid.
+ *
+ * @param arena The arena to be deallocated.
+ */
+void free_arena(arena_t *arena);
+
+#endif // C_PROGRAMS_ARENA_H
@@ -0,0 +1,878 @@
+#include "column.h"
+#include "../Panic/panic.h"
+#include "../String/number.h"
+
+#include <math.h>
+#include <string.h>
+#include <strings.h>
+
+// SECTION: Dates.
+
+/*
+ * The conversions between civil dates and days since 1970-01-01 of Howard
+ * Hinnant ("chrono-Compatible Low-Level Date Algorithms"), which count in
+ * eras of 400 years that start on March 1st.
+ */
+static int32_t days_from_civil(int32_t year, int32_t month, int32_t day) {
+  year -= month <= 2;
+  const int32_t era = (year >= 0 ? year : year - 399) / 400;
+  const int32_t year_of_era = year - era * 400;
+  const int32_t day_of_year =
+      (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  const int32_t day_of_era =
+      year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+  return era * 146097 + day_of_era - 719468;
+}
+
+static bool is_leap_year(int32_t year) {
+  return year % 4 == 0 && (year % 100 != 0 || year % 400 == 0);
+}
+
+// Reads count digits; false if any byte is not a digit.
+static bool read_digits(const uint8_t *data, size_t count, int32_t *value) {
+  *value = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (data[i] < '0' || data[i] > '9') {
+      return false;
+    }
+    *value = *value * 10 + (data[i] - '0');
+  }
+  return true;
+}
+
+bool string_to_date(const string_t *string, int32_t *days) {
+  if (!string || !days) {
+    panic(stderr, "String or days pointer is empty.");
+  }
+  const uint8_t *data = string->data;
+  int32_t year, month, day;
+  if (string->len != 10 || data[4] != '-' || data[7] != '-' ||
+      !read_digits(data, 4, &year) || !read_digits(data + 5, 2, &month) ||
+      !read_digits(data + 8, 2, &day)) {
+    return false;
+  }
+  static const int32_t month_days[12] = {31, 28, 31, 30, 31, 30,
+                                         31, 31, 30, 31, 30, 31};
+  if (month < 1 || month > 12 || day < 1 ||
+      day > month_days[month - 1] + (month == 2 && is_leap_year(year))) {
+    return false;
+  }
+  *days = days_from_civil(year, month, day);
+  return true;
+}
+
+static void write_digits(uint8_t *buffer, size_t count, int32_t value) {
+  for (size_t i = count; i > 0; i--) {
+    buffer[i - 1] = (uint8_t)('0' + value % 10);
+    value /= 10;
+  }
+}
+
+size_t format_date(int32_t days, uint8_t *buffer) {
+  if (!buffer) {
+    panic(stderr, "Buffer pointer is empty.");
+  }
+  days += 719468;
+  const int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+  const int32_t day_of_era = days - era * 146097;
+  const int32_t year_of_era =
+      (day_of_era - day_of_era / 1460 + day_of_era / 36524 -
+       day_of_era / 146096) /
+      365;
+  const int32_t day_of_year =
+      day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+  const int32_t shifted_month = (5 * day_of_year + 2) / 153;
+  const int32_t day = day_of_year - (153 * shifted_month + 2) / 5 + 1;
+  const int32_t month = shifted_month < 10 ? shifted_month + 3
+                                           : shifted_month - 9;
+  const int32_t year = year_of_era + era * 400 + (month <= 2);
+  if (year < 0 || year > 9999) {
+    panic(stderr, "Date is out of the range of four digit years.");
+  }
+  write_digits(buffer, 4, year);
+  buffer[4] = '-';
+  write_digits(buffer + 5, 2, month);
+  buffer[7] = '-';
+  write_digits(buffer + 8, 2, day);
+  return 10;
+}
+
+// SECTION: Type inference.
+
+static bool is_null(const string_t *value) {
+  return !value || value->len == 0;
+}
+
+static bool string_to_bool(const string_t *value, bool *result) {
+  if (value->len == 4 &&
+      strncasecmp((const char *)value->data, "true", 4) == 0) {
+    *result = true;
+    return true;
+  }
+  if (value->len == 5 &&
+      strncasecmp((const char *)value->data, "false", 5) == 0) {
+    *result = false;
+    return true;
+  }
+  return false;
+}
+
+// Every integer up to 2^53 in magnitude is a double, but not every larger one.
+static const int64_t EXACT_DOUBLE_LIMIT = (int64_t)1 << 53;
+
+// No shortest representation of a double has more significant digits.
+#define MAX_DOUBLE_DIGITS 17
+
+/*
+ * The significant digits of a decimal number, without leading or trailing
+ * zeros, and the power of ten of the first one: "-0.0250" and "2.5e-2" are
+ * both "25" at -2. Zero has no digits.
+ */
+typedef struct decimal_digits {
+  uint8_t digits[MAX_DOUBLE_DIGITS];
+  size_t count;
+  int64_t exponent;
+} decimal_digits_t;
+
+/*
+ * Reads the digits of a number written as string_to_double reads it, or as
+ * format_double writes it. Returns false for text without any digit, and
+ * for numbers with more significant digits than a double keeps.
+ */
+static bool read_decimal_digits(const uint8_t *data, size_t len,
+                                decimal_digits_t *decimal) {
+  size_t i = 0;
+  if (i < len && (data[i] == '-' || data[i] == '+')) {
+    i++;
+  }
+  bool any = false;
+  bool point = false;
+  int64_t integer_digits = 0;
+  int64_t first = -1; // The position of the first nonzero digit.
+  int64_t position = 0;
+  size_t zeros = 0; // Zeros after the last nonzero digit, not yet kept.
+  decimal->count = 0;
+  for (; i < len; i++) {
+    uint8_t c = data[i];
+    if (c == '.' && !point) {
+      point = true;
+      continue;
+    }
+    if (c < '0' || c > '9') {
+      break;
+    }
+    any = true;
+    if (!point) {
+      integer_digits++;
+    }
+    if (c == '0') {
+      zeros += first >= 0;
+    } else {
+      if (first < 0) {
+        first = position;
+      }
+      if (decimal->count + zeros + 1 > MAX_DOUBLE_DIGITS) {
+        return false;
+      }
+      for (; zeros > 0; zeros--) {
+        decimal->digits[decimal->count++] = 0;
+      }
+      decimal->digits[decimal->count++] = c - '0';
+    }
+    position++;
+  }
+  if (!any) {
+    return false;
+  }
+  int64_t exponent = 0;
+  if (i < len && (data[i] == 'e' || data[i] == 'E')) {
+    i++;
+    bool negative = i < len && data[i] == '-';
+    if (i < len && (data[i] == '-' || data[i] == '+')) {
+      i++;
+    }
+    for (; i < len && data[i] >= '0' && data[i] <= '9'; i++) {
+      if (exponent < 100000) {
+        exponent = exponent * 10 + (data[i] - '0');
+      }
+    }
+    exponent = negative ? -exponent : exponent;
+  }
+  decimal->exponent = first < 0 ? 0 : integer_digits - first - 1 + exponent;
+  return true;
+}
+
+static bool has_digit(const string_t *value) {
+  for (size_t i = 0; i < value->len; i++) {
+    if (value->data[i] >= '0' && value->data[i] <= '9') {
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+ * Parses a value as a double, but only if the double keeps the number
+ * exactly as written, up to its form: the shortest representation of the
+ * double must have the same significant digits at the same power of ten.
+ * So numbers beyond the range of doubles (which string_to_double turns into
+ * infinities or zeros) and numbers with more digits than a double holds,
+ * integers beyond 2^53 among them, do not fit. Text without digits, such as
+ * "inf", is kept as string_to_double reads it.
+ */
+static bool string_to_exact_double(const string_t *value, double *result) {
+  int64_t integer;
+  if (string_to_int64(value, &integer)) {
+    *result = (double)integer;
+    return integer >= -EXACT_DOUBLE_LIMIT && integer <= EXACT_DOUBLE_LIMIT;
+  }
+  if (!string_to_double(value, result)) {
+    return false;
+  }
+  if (!isfinite(*result) && !has_digit(value)) {
+    return true; // "inf" or "nan", as written.
+  }
+  decimal_digits_t written;
+  if (!read_decimal_digits(value->data, value->len, &written)) {
+    return false;
+  }
+  uint8_t buffer[NUMBER_BUFFER_SIZE];
+  size_t len = format_double(*result, buffer);
+  decimal_digits_t kept;
+  return read_decimal_digits(buffer, len, &kept) &&
+         kept.count == written.count && kept.exponent == written.exponent &&
+         memcmp(kept.digits, written.digits, kept.count) == 0;
+}
+
+static bool fits_type(column_type_t type, const string_t *value) {
+  bool flag;
+  int64_t integer;
+  double real;
+  int32_t days;
+  switch (type) {
+  case COLUMN_BOOL:
+    return string_to_bool(value, &flag);
+  case COLUMN_INT64:
+    return string_to_int64(value, &integer);
+  case COLUMN_DOUBLE:
+    return string_to_exact_double(value, &real);
+  case COLUMN_DATE:
+    return string_to_date(value, &days);
+  default:
+    return true;
+  }
+}
+
+column_type_t infer_column_type(const dataset_t *dataset, size_t col,
+                                size_t sample) {
+  if (!dataset) {
+    panic(stderr, "Dataset pointer is empty.");
+  }
+  if (sample == 0 || sample > dataset->rows) {
+    sample = dataset->rows;
+  }
+  // The types that every value so far fits, one bit per type.
+  unsigned candidates = (1u << COLUMN_STRING) - 1;
+  bool seen = false;
+  for (size_t row = 0; row < sample && candidates; row++) {
+    const string_t *value = dataset_value(dataset, row, col);
+    if (is_null(value)) {
+      continue;
+    }
+    seen = true;
+    for (column_type_t type = COLUMN_BOOL; type < COLUMN_STRING; type++) {
+      if ((candidates >> type & 1) && !fits_type(type, value)) {
+        candidates &= ~(1u << type);
+      }
+    }
+  }
+  if (!seen || !candidates) {
+    return COLUMN_STRING;
+  }
+  column_type_t type = COLUMN_BOOL;
+  while (!(candidates >> type & 1)) {
+    type++;
+  }
+  return type;
+}
+
+// SECTION: Conversion.
+
+static size_t bitmap_words(size_t rows) {
+  return (rows + 63) / 64;
+}
+
+static uint64_t *new_bitmap(size_t rows) {
+  uint64_t *bitmap = calloc(bitmap_words(rows) + 1, sizeof(uint64_t));
+  if (!bitmap) {
+    panic(stderr, "Could not allocate the column bitmap.");
+  }
+  return bitmap;
+}
+
+static void set_bit(uint64_t *bitmap, size_t row) {
+  bitmap[row / 64] |= 1ULL << (row % 64);
+}
+
+static void free_values(column_t *column) {
+  switch (column->type) {
+  case COLUMN_BOOL:
+    free(column->bools);
+    break;
+  case COLUMN_STRING:
+    free(column->offsets);
+    free(column->bytes);
+    break;
+  case COLUMN_DICTIONARY:
+    free(column->offsets);
+    free(column->bytes);
+    free(column->codes);
+    break;
+  default:
+    // The arrays of the other types share one pointer.
+    free(column->int64s);
+    break;
+  }
+}
+
+static void *allocate_values(size_t count, size_t size) {
+  // One more value, so that empty columns have arrays too.
+  void *values = calloc(count + 1, size);
+  if (!values) {
+    panic(stderr, "Could not allocate the column values.");
+  }
+  return values;
+}
+
+static void fill_strings(column_t *column, const dataset_t *dataset,
+                         size_t col) {
+  column->offsets = allocate_values(column->rows, sizeof(size_t));
+  size_t total = 0;
+  for (size_t row = 0; row < column->rows; row++) {
+    const string_t *value = dataset_value(dataset, row, col);
+    total += value ? value->len : 0;
+    column->offsets[row + 1] = total;
+  }
+  column->bytes = allocate_values(total, 1);
+  for (size_t row = 0; row < column->rows; row++) {
+    const string_t *value = dataset_value(dataset, row, col);
+    if (value && value->len > 0) {
+      memcpy(column->bytes + column->offsets[row], value->data, value->len);
+    }
+  }
+}
+
+/*
+ * Parses the values of a column into the array of its type. Returns false
+ * at the first value that does not fit the type, with the array released.
+ */
+static bool fill_values(column_t *column, const dataset_t *dataset,
+                        size_t col) {
+  const size_t rows = column->rows;
+  switch (column->type) {
+  case COLUMN_BOOL:
+    column->bools = new_bitmap(rows);
+    break;
+  case COLUMN_INT64:
+    column->int64s = allocate_values(rows, sizeof(int64_t));
+    break;
+  case COLUMN_DOUBLE:
+    column->doubles = allocate_values(rows, sizeof(double));
+    break;
+  case COLUMN_DATE:
+    column->dates = allocate_values(rows, sizeof(int32_t));
+    break;
+  default:
+    fill_strings(column, dataset, col);
+    return true;
+  }
+  for (size_t row = 0; row < rows; row++) {
+    const string_t *value = dataset_value(dataset, row, col);
+    if (is_null(value)) {
+      continue;
+    }
+    bool fits = false;
+    switch (column->type) {
+    case COLUMN_BOOL: {
+      bool flag = false;
+      fits = string_to_bool(value, &flag);
+      if (flag) {
+        set_bit(column->bools, row);
+      }
+      break;
+    }
+    case COLUMN_INT64:
+      fits = string_to_int64(value, &column->int64s[row]);
+      break;
+    case COLUMN_DOUBLE:
+      fits = string_to_exact_double(value, &column->doubles[row]);
+      break;
+    default:
+      fits = string_to_date(value, &column->dates[row]);
+      break;
+    }
+    if (!fits) {
+      free_values(column);
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool encode_strings(column_t *column, size_t limit);
+
+static void convert_column(column_t *column, const dataset_t *dataset,
+                           size_t col, size_t sample) {
+  const string_t *name = dataset_column_name(dataset, col);
+  column->name = name ? copy_string(name) : NULL;
+  column->rows = dataset->rows;
+  column->nulls = 0;
+  column->validity = new_bitmap(dataset->rows);
+  for (size_t row = 0; row < dataset->rows; row++) {
+    if (is_null(dataset_value(dataset, row, col))) {
+      column->nulls++;
+    } else {
+      set_bit(column->validity, row);
+    }
+  }
+  column->type = infer_column_type(dataset, col, sample);
+  /*
+   * A value past the sample that does not fit widens the column. Doubles
+   * are parsed again from the values, so an int64 column with an integer
+   * beyond 2^53 becomes a string column rather than lose its digits.
+   */
+  while (!fill_values(column, dataset, col)) {
+    column->type =
+        column->type == COLUMN_INT64 ? COLUMN_DOUBLE : COLUMN_STRING;
+  }
+  if (column->type == COLUMN_STRING && column->rows > 1) {
+    encode_strings(column, column->rows / 2);
+  }
+}
+
+column_table_t *new_column_table(const dataset_t *dataset, size_t sample) {
+  if (!dataset) {
+    panic(stderr, "Dataset pointer is empty.");
+  }
+  column_table_t *table = malloc(sizeof(column_table_t));
+  column_t *columns = allocate_values(dataset->cols, sizeof(column_t));
+  if (!table) {
+    panic(stderr, "Could not allocate the column table.");
+  }
+  table->rows = dataset->rows;
+  table->cols = dataset->cols;
+  table->columns = columns;
+  for (size_t col = 0; col < dataset->cols; col++) {
+    convert_column(&columns[col], dataset, col, sample);
+  }
+  return table;
+}
+
+// SECTION: Dictionaries.
+
+typedef struct dictionary_slot {
+  uint64_t hash;
+  size_t code; // One more than the provisional code; 0 for an empty slot.
+} dictionary_slot_t;
+
+typedef struct distinct_value {
+  string_t value;
+  size_t code;
+} distinct_value_t;
+
+static int distinct_value_cmp(const void *left, const void *right) {
+  return string_cmp(&((const distinct_value_t *)left)->value,
+                    &((const distinct_value_t *)right)->value);
+}
+
+static void *allocate_array(size_t count, size_t size) {
+  void *array = malloc((count > 0 ? count : 1) * size);
+  if (!array) {
+    panic(stderr, "Could not allocate the dictionary.");
+  }
+  return array;
+}
+
+static void grow_slots(dictionary_slot_t **slots, size_t *capacity) {
+  size_t grown = *capacity * 2;
+  dictionary_slot_t *moved = calloc(grown, sizeof(dictionary_slot_t));
+  if (!moved) {
+    panic(stderr, "Could not grow the dictionary.");
+  }
+  for (size_t i = 0; i < *capacity; i++) {
+    if ((*slots)[i].code) {
+      size_t j = (*slots)[i].hash & (grown - 1);
+      while (moved[j].code) {
+        j = (j + 1) & (grown - 1);
+      }
+      moved[j] = (*slots)[i];
+    }
+  }
+  free(*slots);
+  *slots = moved;
+  *capacity = grown;
+}
+
+/*
+ * Numbers the distinct values of a string column in the order they first
+ * appear, with a hash table, then sorts them to turn those numbers into
+ * codes. Gives up, leaving the column as it is, if there are more than
+ * limit distinct values.
+ */
+static bool encode_strings(column_t *column, size_t limit) {
+  const size_t rows = column->rows;
+  uint32_t *provisional = allocate_array(rows, sizeof(uint32_t));
+  size_t *firsts = allocate_array(16, sizeof(size_t));
+  size_t firsts_capacity = 16;
+  size_t capacity = 64;
+  dictionary_slot_t *slots = calloc(capacity, sizeof(dictionary_slot_t));
+  if (!slots) {
+    panic(stderr, "Could not allocate the dictionary.");
+  }
+  size_t count = 0;
+  for (size_t row = 0; row < rows; row++) {
+    string_t value = column_string(column, row);
+    uint64_t hash = string_hash(&value, 0);
+    size_t i = hash & (capacity - 1);
+    for (; slots[i].code; i = (i + 1) & (capacity - 1)) {
+      string_t first = column_string(column, firsts[slots[i].code - 1]);
+      if (string_equals_hashed(&value, hash, &first, slots[i].hash)) {
+        break;
+      }
+    }
+    if (!slots[i].code) {
+      if (count == limit) {
+        free(provisional);
+        free(firsts);
+        free(slots);
+        return false;
+      }
+      if (count == firsts_capacity) {
+        firsts_capacity *= 2;
+        firsts = realloc(firsts, firsts_capacity * sizeof(size_t));
+        if (!firsts) {
+          panic(stderr, "Could not grow the dictionary.");
+        }
+      }
+      firsts[count] = row;
+      slots[i].hash = hash;
+      slots[i].code = ++count;
+    }
+    provisional[row] = (uint32_t)(slots[i].code - 1);
+    if (count * 2 > capacity) {
+      grow_slots(&slots, &capacity);
+    }
+  }
+  free(slots);
+
+  distinct_value_t *distinct = allocate_array(count, sizeof(distinct_value_t));
+  size_t total = 0;
+  for (size_t code = 0; code < count; code++) {
+    distinct[code].value = column_string(column, firsts[code]);
+    distinct[code].code = code;
+    total += distinct[code].value.len;
+  }
+  free(firsts);
+  qsort(distinct, count, sizeof(distinct_value_t), distinct_value_cmp);
+  size_t *rank = allocate_array(count, sizeof(size_t));
+  size_t *offsets = allocate_values(count, sizeof(size_t));
+  uint8_t *bytes = allocate_values(total, 1);
+  for (size_t code = 0; code < count; code++) {
+    rank[distinct[code].code] = code;
+    const string_t *value = &distinct[code].value;
+    if (value->len > 0) {
+      memcpy(bytes + offsets[code], value->data, value->len);
+    }
+    offsets[code + 1] = offsets[code] + value->len;
+  }
+  free(distinct);
+
+  const size_t width = count <= 256 ? 1 : count <= 65536 ? 2 : 4;
+  void *codes = allocate_values(rows, width);
+  for (size_t row = 0; row < rows; row++) {
+    size_t code = rank[provisional[row]];
+    if (width == 1) {
+      ((uint8_t *)codes)[row] = (uint8_t)code;
+    } else if (width == 2) {
+      ((uint16_t *)codes)[row] = (uint16_t)code;
+    } else {
+      ((uint32_t *)codes)[row] = (uint32_t)code;
+    }
+  }
+  free(rank);
+  free(provisional);
+  free(column->offsets);
+  free(column->bytes);
+  column->type = COLUMN_DICTIONARY;
+  column->offsets = offsets;
+  column->bytes = bytes;
+  column->codes = codes;
+  column->cardinality = count;
+  column->code_width = width;
+  return true;
+}
+
+static void assert_column(const column_t *column, column_type_t type) {
+  if (!column) {
+    panic(stderr, "Column pointer is empty.");
+  }
+  if (column->type != type) {
+    panic(stderr, "Column has the wrong type.");
+  }
+}
+
+void encode_column(column_t *column) {
+  assert_column(column, COLUMN_STRING);
+  encode_strings(column, SIZE_MAX);
+}
+
+bool column_find_code(const column_t *column, const string_t *value,
+                      size_t *code) {
+  assert_column(column, COLUMN_DICTIONARY);
+  if (!value || !code) {
+    panic(stderr, "Value or code pointer is empty.");
+  }
+  size_t low = 0;
+  size_t high = column->cardinality;
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    string_t entry = {column->offsets[middle + 1] - column->offsets[middle],
+                      column->bytes + column->offsets[middle]};
+    int order = string_cmp(&entry, value);
+    if (order == 0) {
+      *code = middle;
+      return true;
+    }
+    if (order < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return false;
+}
+
+// Collects the rows of a dictionary column with the given code.
+#define COLLECT_CODES(type)                                                    \
+  do {                                                                         \
+    const type *codes = column->codes;                                         \
+    for (size_t row = 0; row < column->rows; row++) {                          \
+      if (codes[row] == wanted) {                                              \
+        if (rows) {                                                            \
+          rows[found] = row;                                                   \
+        }                                                                      \
+        found++;                                                               \
+      }                                                                        \
+    }                                                                          \
+  } while (0)
+
+// Finds the rows with the value; with rows NULL, only counts them.
+static size_t find_equal(const column_t *column, const string_t *value,
+                         size_t *rows) {
+  size_t found = 0;
+  if (column->type == COLUMN_STRING) {
+    for (size_t row = 0; row < column->rows; row++) {
+      string_t other = column_string(column, row);
+      if (other.len == value->len &&
+          (value->len == 0 ||
+           memcmp(other.data, value->data, value->len) == 0)) {
+        if (rows) {
+          rows[found] = row;
+        }
+        found++;
+      }
+    }
+    return found;
+  }
+  size_t code;
+  if (!column_find_code(column, value, &code)) {
+    return 0;
+  }
+  if (column->code_width == 1) {
+    const uint8_t wanted = (uint8_t)code;
+    COLLECT_CODES(uint8_t);
+  } else if (column->code_width == 2) {
+    const uint16_t wanted = (uint16_t)code;
+    COLLECT_CODES(uint16_t);
+  } else {
+    const uint32_t wanted = (uint32_t)code;
+    COLLECT_CODES(uint32_t);
+  }
+  return found;
+}
+
+#undef COLLECT_CODES
+
+size_t *column_rows_equal(const column_t *column, const string_t *value,
+                          size_t *count) {
+  if (!column || !value || !count) {
+    panic(stderr, "Column, value or count pointer is empty.");
+  }
+  if (column->type != COLUMN_STRING && column->type != COLUMN_DICTIONARY) {
+    panic(stderr, "Column does not hold strings.");
+  }
+  *count = find_equal(column, value, NULL);
+  if (*count == 0) {
+    return NULL;
+  }
+  size_t *rows = allocate_array(*count, sizeof(size_t));
+  find_equal(column, value, rows);
+  return rows;
+}
+
+size_t *column_code_counts(const column_t *column) {
+  assert_column(column, COLUMN_DICTIONARY);
+  size_t *counts = allocate_values(column->cardinality, sizeof(size_t));
+  for (size_t row = 0; row < column->rows; row++) {
+    counts[column_code(column, row)]++;
+  }
+  return counts;
+}
+
+size_t *column_sorted_rows(const column_t *column) {
+  size_t *starts = column_code_counts(column);
+  size_t start = 0;
+  for (size_t code = 0; code < column->cardinality; code++) {
+    size_t count = starts[code];
+    starts[code] = start;
+    start += count;
+  }
+  size_t *rows = allocate_array(column->rows, sizeof(size_t));
+  for (size_t row = 0; row < column->rows; row++) {
+    rows[starts[column_code(column, row)]++] = row;
+  }
+  free(starts);
+  return rows;
+}
+
+size_t column_memory(const column_t *column) {
+  if (!column) {
+    panic(stderr, "Column pointer is empty.");
+  }
+  const size_t rows = column->rows;
+  size_t memory = bitmap_words(rows) * sizeof(uint64_t);
+  switch (column->type) {
+  case COLUMN_BOOL:
+    return memory + bitmap_words(rows) * sizeof(uint64_t);
+  case COLUMN_INT64:
+  case COLUMN_DOUBLE:
+    return memory + rows * sizeof(int64_t);
+  case COLUMN_DATE:
+    return memory + rows * sizeof(int32_t);
+  case COLUMN_STRING:
+    return memory + (rows + 1) * sizeof(size_t) + column->offsets[rows];
+  default:
+    return memory + (column->cardinality + 1) * sizeof(size_t) +
+           column->offsets[column->cardinality] + rows * column->code_width;
+  }
+}
+
+// SECTION: Back to records.
+
+// Writes the text of a value to the buffer and returns its length.
+static size_t format_value(const column_t *column, size_t row,
+                           uint8_t *buffer) {
+  if (!column_is_valid(column, row)) {
+    return 0;
+  }
+  switch (column->type) {
+  case COLUMN_BOOL:
+    if (column_bool(column, row)) {
+      memcpy(buffer, "true", 4);
+      return 4;
+    }
+    memcpy(buffer, "false", 5);
+    return 5;
+  case COLUMN_INT64:
+    return format_int64(column->int64s[row], buffer);
+  case COLUMN_DOUBLE:
+    return format_double(column->doubles[row], buffer);
+  case COLUMN_DATE:
+    return format_date(column->dates[row], buffer);
+  default:
+    return 0;
+  }
+}
+
+// Packs the values of a row into a record. Row SIZE_MAX is the header.
+static record_t *pack_row(const column_table_t *table, size_t row,
+                          uint8_t *scratch) {
+  const size_t count = table->cols;
+  size_t len = 0;
+  size_t *ends = (size_t *)scratch;
+  uint8_t *text = scratch + count * sizeof(size_t);
+  for (size_t col = 0; col < count; col++) {
+    const column_t *column = &table->columns[col];
+    if (row == SIZE_MAX) {
+      if (column->name) {
+        memcpy(text + len, column->name->data, column->name->len);
+        len += column->name->len;
+      }
+    } else if (column->type >= COLUMN_STRING) {
+      string_t value = column_string(column, row);
+      memcpy(text + len, value.data, value.len);
+      len += value.len;
+    } else {
+      len += format_value(column, row, text + len);
+    }
+    ends[col] = len;
+  }
+  return new_packed_record(count, ends, 0, text, len, true);
+}
+
+// The longest text a value of the column, or its name, can take.
+static size_t widest_value(const column_t *column) {
+  size_t widest = column->name ? column->name->len : 0;
+  if (column->type >= COLUMN_STRING) {
+    size_t count = column->type == COLUMN_DICTIONARY ? column->cardinality
+                                                     : column->rows;
+    for (size_t i = 0; i < count; i++) {
+      size_t len = column->offsets[i + 1] - column->offsets[i];
+      widest = len > widest ? len : widest;
+    }
+  } else if (widest < NUMBER_BUFFER_SIZE) {
+    widest = NUMBER_BUFFER_SIZE;
+  }
+  return widest;
+}
+
+dataset_t *column_table_to_dataset(const column_table_t *table) {
+  if (!table) {
+    panic(stderr, "Table pointer is empty.");
+  }
+  size_t room = table->cols * sizeof(size_t);
+  for (size_t col = 0; col < table->cols; col++) {
+    room += widest_value(&table->columns[col]);
+  }
+  uint8_t *scratch = malloc(room + 1);
+  string_cache_t *cache = malloc(sizeof(string_cache_t));
+  record_t **records = allocate_values(table->rows, sizeof(record_t *));
+  if (!scratch || !cache) {
+    panic(stderr, "Could not allocate the string cache.");
+  }
+  cache->cols = table->cols;
+  cache->rows = table->rows;
+  cache->header = pack_row(table, SIZE_MAX, scratch);
+  cache->records = records;
+  cache->references = 1;
+  for (size_t row = 0; row < table->rows; row++) {
+    records[row] = pack_row(table, row, scratch);
+  }
+  free(scratch);
+  dataset_t *dataset = new_dataset(cache);
+  free_cache(cache);
+  return dataset;
+}
+
+void free_column_table(column_table_t *table) {
+  if (!table) {
+    return;
+  }
+  for (size_t col = 0; col < table->cols; col++) {
+    free_string(table->columns[col].name);
+    free(table->columns[col].validity);
+    free_values(&table->columns[col]);
+  }
+  free(table->columns);
+  free(table);
+}
@@ -0,0 +1,268 @@
+#ifndef C_PROGRAMS_COLUMN_H
+#define C_PROGRAMS_COLUMN_H
+/**
+ * Columnar storage for datasets, in the manner of Apache Arrow.
+ *
+ * A dataset keeps every value as a string of its own, reached through a
+ * record, so reading a number means two pointer chases and a parse on every
+ * access. A column table stores each column of a dataset as one typed,
+ * contiguous array instead: numbers, booleans and dates are parsed once,
+ * and the strings of a column share a single byte buffer. Whether each row
+ * has a value is kept in a separate validity bitmap.
+ *
+ * The type of each column is inferred from a sample of its values. Empty
+ * values (and values missing from short records) are nulls and fit any
+ * type. If a value after the sample does not fit the inferred type, the
+ * column falls back to a wider type (int64 to double, and anything to
+ * string), so no value is ever lost. For the same reason, a number only
+ * fits the double type if the double keeps every significant digit of it:
+ * numbers out of the range of doubles, and numbers with more digits than a
+ * double holds (integers beyond 2^53 among them), only fit strings. Only
+ * the form of a number may change, as with "1.50" read back as "1.5".
+ *
+ * A string column with few distinct values is dictionary encoded: each
+ * distinct value is stored once, in the order of string_cmp, and each row
+ * only holds the code of its value, its rank in that order, in as few bytes
+ * as the number of distinct values allows. Codes compare like the values
+ * they stand for, so equality filters, group-by and sorts can work on the
+ * codes alone.
+ */
+#include "data.h"
+#include "../String/string.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The types of columns, from the narrowest to the widest. Dates are written
+ * as YYYY-MM-DD and stored as the number of days since 1970-01-01. Booleans
+ * are "true" or "false", in any case. A dictionary column is a string
+ * column that is dictionary encoded.
+ */
+typedef enum column_type {
+  COLUMN_BOOL,
+  COLUMN_INT64,
+  COLUMN_DOUBLE,
+  COLUMN_DATE,
+  COLUMN_STRING,
+  COLUMN_DICTIONARY
+} column_type_t;
+
+/**
+ * One column of a table. Bit i of validity (bit i % 64 of word i / 64) is
+ * set if row i has a value; nulls counts the rows that do not. The values
+ * are in the array of the column's type, and are 0 (or empty) in null rows:
+ *
+ * - bools is a bitmap like validity.
+ * - The value of row i of a string column is bytes[offsets[i],
+ *   offsets[i + 1]).
+ * - A dictionary column has cardinality distinct values, and value c is
+ *   bytes[offsets[c], offsets[c + 1]). codes holds the code of each row,
+ *   code_width (1, 2 or 4) bytes each. Null rows have the code of the empty
+ *   value, which is 0.
+ */
+typedef struct column {
+  column_type_t type;
+  string_t *name;
+  size_t rows;
+  size_t nulls;
+  uint64_t *validity;
+  union {
+    uint64_t *bools;
+    int64_t *int64s;
+    double *doubles;
+    int32_t *dates;
+    struct {
+      size_t *offsets;
+      uint8_t *bytes;
+      void *codes;
+      size_t cardinality;
+      size_t code_width;
+    };
+  };
+} column_t;
+
+/**
+ * A table of columns with the same number of rows. Unlike a dataset it does
+ * not refer to any cache.
+ */
+typedef struct column_table {
+  size_t rows;
+  size_t cols;
+  column_t *columns;
+} column_table_t;
+
+/**
+ * Infers the narrowest type that fits the values of a column: bool, then
+ * int64, double and date, and string if none does. A column with no values
+ * in the sample is a string column.
+ *
+ * @param dataset The dataset.
+ * @param col     The column, less than dataset->cols.
+ * @param sample  The number of rows to look at, from the first one; 0 for
+ *                all of them.
+ * @return The inferred type.
+ */
+column_type_t infer_column_type(const dataset_t *dataset, size_t col,
+                                size_t sample);
+
+/**
+ * Converts a dataset (or any view of a cache) into a column table. The names
+ * of the columns are copied from the header of the cache. String columns
+ * with at most half as many distinct values as values are encoded with
+ * encode_column.
+ *
+ * @param dataset The dataset to convert.
+ * @param sample  The number of rows to infer the types from, 0 for all.
+ * @return A new table, to be freed with free_column_table.
+ */
+column_table_t *new_column_table(const dataset_t *dataset, size_t sample);
+
+/**
+ * Converts a column table back into a dataset over a new cache, whose
+ * header holds the names of the columns. Null values become empty strings.
+ * Numbers and dates are written in their shortest form, so a value may
+ * differ from the text it was parsed from ("007" becomes "7").
+ *
+ * @param table The table to convert.
+ * @return A new dataset; free_dataset also releases its cache.
+ */
+dataset_t *column_table_to_dataset(const column_table_t *table);
+
+/**
+ * @param table The table to be deallocated.
+ */
+void free_column_table(column_table_t *table);
+
+/**
+ * @param column The column.
+ * @param row    The row, less than column->rows.
+ * @return Whether the row has a value.
+ */
+static inline bool column_is_valid(const column_t *column, size_t row) {
+  return (column->validity[row / 64] >> (row % 64)) & 1;
+}
+
+/**
+ * @param column A bool column.
+ * @param row    The row, less than column->rows.
+ * @return The value of the row; false for nulls.
+ */
+static inline bool column_bool(const column_t *column, size_t row) {
+  return (column->bools[row / 64] >> (row % 64)) & 1;
+}
+
+/**
+ * @param column A dictionary column.
+ * @param row    The row, less than column->rows.
+ * @return The code of the row's value.
+ */
+static inline size_t column_code(const column_t *column, size_t row) {
+  switch (column->code_width) {
+  case 1:
+    return ((const uint8_t *)column->codes)[row];
+  case 2:
+    return ((const uint16_t *)column->codes)[row];
+  default:
+    return ((const uint32_t *)column->codes)[row];
+  }
+}
+
+/**
+ * @param column A string or dictionary column.
+ * @param row    The row, less than column->rows.
+ * @return A view of the value of the row, which must not be freed.
+ */
+static inline string_t column_string(const column_t *column, size_t row) {
+  size_t index =
+      column->type == COLUMN_DICTIONARY ? column_code(column, row) : row;
+  string_t view = {column->offsets[index + 1] - column->offsets[index],
+                   column->bytes + column->offsets[index]};
+  return view;
+}
+
+/**
+ * Dictionary encodes a string column in place, whatever the number of its
+ * distinct values. The codes take 1 byte for up to 256 distinct values, 2
+ * for up to 65536 and 4 beyond that.
+ *
+ * @param column A string column.
+ */
+void encode_column(column_t *column);
+
+/**
+ * Finds the code of a value in a dictionary column, by binary search.
+ *
+ * @param column A dictionary column.
+ * @param value  The value to look for.
+ * @param code   Receives the code of the value if it is found.
+ * @return Whether the column has the value.
+ */
+bool column_find_code(const column_t *column, const string_t *value,
+                      size_t *code);
+
+/**
+ * Finds the rows whose value equals the given one. Null rows are empty
+ * values, so only an empty value finds them. On a dictionary column the
+ * value is looked up once and only codes are compared. The rows can be
+ * passed to take_rows to filter the dataset that the table was made from.
+ *
+ * @param column A string or dictionary column.
+ * @param value  The value to look for.
+ * @param count  Receives the number of rows found.
+ * @return The rows, in increasing order, to be freed with free; NULL if
+ *         there are none.
+ */
+size_t *column_rows_equal(const column_t *column, const string_t *value,
+                          size_t *count);
+
+/**
+ * Groups the rows of a dictionary column by value: counts[c] is the number
+ * of rows whose code is c. Null rows count as empty values.
+ *
+ * @param column A dictionary column.
+ * @return The counts, column->cardinality of them, to be freed with free.
+ */
+size_t *column_code_counts(const column_t *column);
+
+/**
+ * Sorts the rows of a dictionary column by value with a counting sort of the
+ * codes, in linear time. Null rows, which are empty values, come first, as
+ * they would with record_cmp. Rows with equal values keep their order. The
+ * rows can be passed to take_rows to sort the dataset that the table was
+ * made from.
+ *
+ * @param column A dictionary column.
+ * @return The rows in sorted order, to be freed with free.
+ */
+size_t *column_sorted_rows(const column_t *column);
+
+/**
+ * @param column The column.
+ * @return The number of bytes taken by the arrays of the column, including
+ *         its validity bitmap.
+ */
+size_t column_memory(const column_t *column);
+
+/**
+ * Parses a date written as YYYY-MM-DD, with years from 0000 to 9999.
+ *
+ * @param string The string to parse.
+ * @param days   Receives the number of days since 1970-01-01 on success.
+ * @return true on success; false if the string is not a valid date.
+ */
+bool string_to_date(const string_t *string, int32_t *days);
+
+/**
+ * Writes a date as YYYY-MM-DD to a buffer of at least 10 bytes. No NUL
+ * terminator is written.
+ *
+ * @param days   The number of days since 1970-01-01, of a year from 0000 to
+ *               9999.
+ * @param buffer The buffer.
+ * @return The number of bytes written, which is 10.
+ */
+size_t format_date(int32_t days, uint8_t *buffer);
+
+#endif // C_PROGRAMS_COLUMN_H
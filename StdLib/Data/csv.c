@@ -1,8 +1,15 @@
 #include "csv.h"
+#include "../Panic/panic.h"
+#include "../Parallel/parallel.h"
+#include "../String/simd.h"
 #include "../String/string.h"
 #include "data.h"
 
+#include <fcntl.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 static size_t count_columns(char *line) {
   size_t count = 1;
@@ -57,4 +64,787 @@ record_t *read_csv_record(FILE *input) {
   }
 
   return extract_data(line);
-}
\ No newline at end of file
+}
+
+// SECTION: Formats.
+
+const csv_format_t CSV_RFC4180 = {',', '"'};
+
+static csv_format_t check_format(const csv_format_t *format) {
+  if (!format) {
+    return CSV_RFC4180;
+  }
+  if (format->delimiter == format->quote || format->delimiter == '\n' ||
+      format->quote == '\n') {
+    panic(stderr, "The CSV delimiter and quote must be distinct bytes other "
+                  "than a line break.");
+  }
+  return *format;
+}
+
+// The bytes at which the scan of a record stops.
+static byte_set_t field_stops(const csv_format_t *format) {
+  const uint8_t stops[3] = {format->delimiter, '\n', format->quote};
+  return new_byte_set(stops, 3);
+}
+
+// SECTION: Fields.
+
+static void init_fields(csv_fields_t *fields) {
+  fields->count = 0;
+  fields->capacity = 16;
+  fields->ends = malloc(fields->capacity * sizeof(size_t));
+  if (!fields->ends) {
+    panic(stderr, "Could not allocate the CSV field array.");
+  }
+  fields->unescaped = NULL;
+  fields->unescaped_capacity = 0;
+}
+
+static void free_fields(csv_fields_t *fields) {
+  free(fields->ends);
+  free(fields->unescaped);
+}
+
+static void add_field_end(csv_fields_t *fields, size_t end) {
+  if (fields->count == fields->capacity) {
+    fields->capacity *= 2;
+    fields->ends = realloc(fields->ends, fields->capacity * sizeof(size_t));
+    if (!fields->ends) {
+      panic(stderr, "Could not grow the CSV field array.");
+    }
+  }
+  fields->ends[fields->count++] = end;
+}
+
+/*
+ * Finds the delimiters of the record at the start of data, from offset on,
+ * and stops at the end of its line or at its first quote. Returns the
+ * offset of the line break or quote, or available if there is neither.
+ */
+static size_t scan_fields(const csv_format_t *format, const byte_set_t *stops,
+                          const uint8_t *data, size_t available,
+                          size_t offset, csv_fields_t *fields) {
+  for (;;) {
+    size_t found =
+        offset + search_byte_set(data + offset, available - offset, stops);
+    if (found == available || data[found] != format->delimiter) {
+      return found;
+    }
+    add_field_end(fields, found);
+    offset = found + 1;
+  }
+}
+
+/*
+ * The slow path for a record that holds a quote: copies the record at the
+ * start of data into fields->unescaped without its quotes, and finds the
+ * ends of its fields there. Each unquoted run is still copied whole.
+ *
+ * Returns false if the record does not end within the available bytes and
+ * more could follow (at_end is not set). Otherwise *len is set to the number
+ * of bytes of the record, with its line break. At the end of the input an
+ * unterminated quote ends the record.
+ */
+static bool unescape_record(const csv_format_t *format,
+                            const byte_set_t *stops, const uint8_t *data,
+                            size_t available, bool at_end,
+                            csv_fields_t *fields, size_t *len) {
+  // Unescaping never makes a record longer.
+  if (fields->unescaped_capacity < available) {
+    fields->unescaped_capacity = available;
+    free(fields->unescaped);
+    fields->unescaped = malloc(available);
+    if (!fields->unescaped) {
+      panic(stderr, "Could not grow the CSV unescaping buffer.");
+    }
+  }
+  uint8_t *out = fields->unescaped;
+  size_t used = 0;
+  size_t from = 0;
+  fields->count = 0;
+  for (;;) {
+    size_t found = from + search_byte_set(data + from, available - from, stops);
+    memcpy(out + used, data + from, found - from);
+    used += found - from;
+    if (found == available && !at_end) {
+      return false;
+    }
+    if (found == available || data[found] == '\n') {
+      // A '\r' before the line break, but not one inside quotes, ends the
+      // line too.
+      if (found > from && data[found - 1] == '\r') {
+        used--;
+      }
+      add_field_end(fields, used);
+      *len = found < available ? found + 1 : found;
+      return true;
+    }
+    if (data[found] == format->delimiter) {
+      add_field_end(fields, used);
+      out[used++] = format->delimiter;
+      from = found + 1;
+      continue;
+    }
+    // A quoted part, up to the first quote that is not doubled.
+    from = found + 1;
+    for (;;) {
+      size_t quote =
+          from + search_byte(data + from, available - from, format->quote);
+      memcpy(out + used, data + from, quote - from);
+      used += quote - from;
+      if (quote + 1 >= available) {
+        // Whether the quote is doubled depends on the next byte.
+        if (!at_end) {
+          return false;
+        }
+        from = available;
+        break;
+      }
+      from = quote + 1;
+      if (data[from] != format->quote) {
+        break;
+      }
+      out[used++] = format->quote;
+      from++;
+    }
+  }
+}
+
+// Ends the last field of a line, without the '\r' of a "\r\n" line break.
+static size_t end_line(const uint8_t *line, size_t len,
+                       csv_fields_t *fields) {
+  if (len > 0 && line[len - 1] == '\r') {
+    len--;
+  }
+  add_field_end(fields, len);
+  return len;
+}
+
+// The length of the unescaped bytes of a record.
+static size_t unescaped_len(const csv_fields_t *fields) {
+  return fields->ends[fields->count - 1];
+}
+
+/*
+ * Builds a packed record from a line and the offsets at which its fields
+ * end. The bytes are copied if copy is set; otherwise the values are views
+ * of the line.
+ */
+static record_t *pack_record(const uint8_t *line, size_t len,
+                             const csv_fields_t *fields, bool copy) {
+  return new_packed_record(fields->count, fields->ends, 1, line, len, copy);
+}
+
+// SECTION: Buffered reader.
+
+csv_reader_t *new_csv_reader(FILE *input, size_t capacity,
+                             const csv_format_t *format) {
+  if (!input) {
+    panic(stderr, "Input pointer is null.");
+  }
+  if (capacity == 0) {
+    capacity = CSV_READER_CAPACITY;
+  }
+  csv_reader_t *reader = malloc(sizeof(csv_reader_t));
+  uint8_t *buffer = malloc(capacity);
+  if (!reader || !buffer) {
+    panic(stderr, "Could not allocate the CSV reader.");
+  }
+  reader->input = input;
+  reader->buffer = buffer;
+  reader->start = 0;
+  reader->end = 0;
+  reader->capacity = capacity;
+  init_fields(&reader->fields);
+  reader->format = check_format(format);
+  reader->stops = field_stops(&reader->format);
+  reader->records = 0;
+  reader->eof = false;
+  return reader;
+}
+
+/*
+ * Moves the unparsed bytes to the front of the buffer, growing it if they
+ * fill all of it, and reads more input after them.
+ */
+static void refill(csv_reader_t *reader) {
+  size_t pending = reader->end - reader->start;
+  memmove(reader->buffer, reader->buffer + reader->start, pending);
+  reader->start = 0;
+  reader->end = pending;
+  if (pending == reader->capacity) {
+    reader->capacity *= 2;
+    reader->buffer = realloc(reader->buffer, reader->capacity);
+    if (!reader->buffer) {
+      panic(stderr, "Could not grow the CSV reader buffer.");
+    }
+  }
+  size_t read = fread(reader->buffer + reader->end, 1,
+                      reader->capacity - reader->end, reader->input);
+  reader->end += read;
+  reader->eof = read == 0;
+}
+
+record_t *csv_read_record(csv_reader_t *reader) {
+  if (!reader) {
+    panic(stderr, "Reader pointer is empty.");
+  }
+  reader->fields.count = 0;
+  // Offsets count from the start of the record, so they survive a refill.
+  size_t offset = 0;
+  size_t available;
+  size_t len;
+  for (;;) {
+    available = reader->end - reader->start;
+    len = scan_fields(&reader->format, &reader->stops,
+                      reader->buffer + reader->start, available, offset,
+                      &reader->fields);
+    if (len < available) {
+      break;
+    }
+    if (reader->eof) {
+      if (available == 0 && reader->fields.count == 0) {
+        return NULL;
+      }
+      break;
+    }
+    offset = available;
+    refill(reader);
+  }
+  const uint8_t *line = reader->buffer + reader->start;
+  if (len < available && line[len] == reader->format.quote) {
+    // Quoted line breaks can make the record run past the buffer.
+    while (!unescape_record(&reader->format, &reader->stops,
+                            reader->buffer + reader->start,
+                            reader->end - reader->start, reader->eof,
+                            &reader->fields, &len)) {
+      refill(reader);
+    }
+    reader->start += len;
+    reader->records++;
+    return pack_record(reader->fields.unescaped,
+                       unescaped_len(&reader->fields), &reader->fields, true);
+  }
+  // The newline is not part of the record.
+  reader->start += len < reader->end - reader->start ? len + 1 : len;
+  len = end_line(line, len, &reader->fields);
+  reader->records++;
+  return pack_record(line, len, &reader->fields, true);
+}
+
+void free_csv_reader(csv_reader_t *reader) {
+  if (!reader) {
+    return;
+  }
+  free(reader->buffer);
+  free_fields(&reader->fields);
+  free(reader);
+}
+
+// SECTION: Mapped files.
+
+csv_map_t *map_csv_file(const char *path, const csv_format_t *format) {
+  if (!path) {
+    panic(stderr, "Path pointer is empty.");
+  }
+  const csv_format_t checked = check_format(format);
+  int file = open(path, O_RDONLY);
+  if (file < 0) {
+    return NULL;
+  }
+  struct stat status;
+  if (fstat(file, &status) != 0) {
+    close(file);
+    return NULL;
+  }
+  size_t size = (size_t)status.st_size;
+  void *memory = NULL;
+  if (size > 0) {
+    memory = mmap(NULL, size, PROT_READ, MAP_SHARED, file, 0);
+  }
+  close(file);
+  if (memory == MAP_FAILED) {
+    return NULL;
+  }
+  if (memory) {
+    // The file is read front to back once: read ahead aggressively and
+    // drop pages soon after they were used.
+    madvise(memory, size, MADV_SEQUENTIAL);
+  }
+  csv_map_t *map = malloc(sizeof(csv_map_t));
+  if (!map) {
+    panic(stderr, "Could not allocate the CSV map.");
+  }
+  map->data = memory;
+  map->len = size;
+  map->position = 0;
+  init_fields(&map->fields);
+  map->views = NULL;
+  map->views_capacity = 0;
+  map->record.count = 0;
+  map->record.values = NULL;
+  map->record.packed = false;
+  map->format = checked;
+  map->stops = field_stops(&map->format);
+  map->records = 0;
+  return map;
+}
+
+/*
+ * Finds the next line and the ends of its fields; false at the end. The
+ * line is in the file, unless it held quotes and unescaped is set.
+ */
+static bool next_line(csv_map_t *map, const uint8_t **line, size_t *len,
+                      bool *unescaped) {
+  if (map->position == map->len) {
+    return false;
+  }
+  size_t available = map->len - map->position;
+  *line = map->data + map->position;
+  map->fields.count = 0;
+  *len = scan_fields(&map->format, &map->stops, *line, available, 0,
+                     &map->fields);
+  *unescaped = *len < available && (*line)[*len] == map->format.quote;
+  if (*unescaped) {
+    unescape_record(&map->format, &map->stops, *line, available, true,
+                    &map->fields, len);
+    map->position += *len;
+    *line = map->fields.unescaped;
+    *len = unescaped_len(&map->fields);
+  } else {
+    map->position += *len < available ? *len + 1 : *len;
+    *len = end_line(*line, *len, &map->fields);
+  }
+  map->records++;
+  return true;
+}
+
+const record_t *next_mapped_record(csv_map_t *map) {
+  if (!map) {
+    panic(stderr, "Map pointer is empty.");
+  }
+  const uint8_t *line;
+  size_t len;
+  bool unescaped;
+  if (!next_line(map, &line, &len, &unescaped)) {
+    return NULL;
+  }
+  const size_t count = map->fields.count;
+  if (count > map->views_capacity) {
+    map->views_capacity = count * 2;
+    map->views = realloc(map->views, map->views_capacity *
+                                         (sizeof(string_t) + sizeof(string_t *)));
+    if (!map->views) {
+      panic(stderr, "Could not grow the CSV view array.");
+    }
+  }
+  string_t **values = (string_t **)(map->views + map->views_capacity);
+  size_t start = 0;
+  for (size_t i = 0; i < count; i++) {
+    map->views[i].len = map->fields.ends[i] - start;
+    map->views[i].data = (uint8_t *)line + start;
+    values[i] = &map->views[i];
+    start = map->fields.ends[i] + 1;
+  }
+  map->record.count = count;
+  map->record.values = values;
+  return &map->record;
+}
+
+record_t *read_mapped_record(csv_map_t *map) {
+  if (!map) {
+    panic(stderr, "Map pointer is empty.");
+  }
+  const uint8_t *line;
+  size_t len;
+  bool unescaped;
+  if (!next_line(map, &line, &len, &unescaped)) {
+    return NULL;
+  }
+  return pack_record(line, len, &map->fields, unescaped);
+}
+
+void free_csv_map(csv_map_t *map) {
+  if (!map) {
+    return;
+  }
+  if (map->data) {
+    munmap(map->data, map->len);
+  }
+  free_fields(&map->fields);
+  free(map->views);
+  free(map);
+}
+
+// SECTION: Structural index.
+
+csv_index_t *new_csv_index(void) {
+  csv_index_t *index = malloc(sizeof(csv_index_t));
+  if (!index) {
+    panic(stderr, "Could not allocate the CSV index.");
+  }
+  index->count = 0;
+  index->capacity = 1024;
+  index->quotes = false;
+  index->offsets = malloc(index->capacity * sizeof(size_t));
+  if (!index->offsets) {
+    panic(stderr, "Could not allocate the CSV index.");
+  }
+  return index;
+}
+
+typedef struct block_masks {
+  uint64_t quotes;
+  uint64_t delimiters;
+  uint64_t newlines;
+} block_masks_t;
+
+// Classifies 64 bytes, one bit per byte.
+static block_masks_t classify_block(const uint8_t *block,
+                                    const csv_format_t *format) {
+  block_masks_t masks;
+#if defined(STRING_HAS_AVX2)
+  __m256i low = _mm256_loadu_si256((const __m256i *)block);
+  __m256i high = _mm256_loadu_si256((const __m256i *)(block + 32));
+#define CSV_MASK(byte)                                                         \
+  ((uint64_t)(uint32_t)_mm256_movemask_epi8(                                   \
+       _mm256_cmpeq_epi8(low, _mm256_set1_epi8(byte))) |                       \
+   (uint64_t)(uint32_t)_mm256_movemask_epi8(                                   \
+       _mm256_cmpeq_epi8(high, _mm256_set1_epi8(byte)))                        \
+       << 32)
+  masks.quotes = CSV_MASK(format->quote);
+  masks.delimiters = CSV_MASK(format->delimiter);
+  masks.newlines = CSV_MASK('\n');
+#undef CSV_MASK
+#elif defined(STRING_HAS_SSE2)
+  __m128i parts[4];
+  for (size_t i = 0; i < 4; i++) {
+    parts[i] = _mm_loadu_si128((const __m128i *)(block + 16 * i));
+  }
+  const char bytes[3] = {(char)format->quote, (char)format->delimiter, '\n'};
+  uint64_t found[3];
+  for (size_t b = 0; b < 3; b++) {
+    __m128i wanted = _mm_set1_epi8(bytes[b]);
+    found[b] = 0;
+    for (size_t i = 0; i < 4; i++) {
+      found[b] |= (uint64_t)(uint32_t)_mm_movemask_epi8(
+                      _mm_cmpeq_epi8(parts[i], wanted))
+                  << (16 * i);
+    }
+  }
+  masks.quotes = found[0];
+  masks.delimiters = found[1];
+  masks.newlines = found[2];
+#else
+  masks.quotes = masks.delimiters = masks.newlines = 0;
+  for (size_t i = 0; i < 8; i++) {
+    uint64_t word = load_u64(block + 8 * i);
+    masks.quotes |= swar_byte_mask(word, format->quote) << (8 * i);
+    masks.delimiters |= swar_byte_mask(word, format->delimiter) << (8 * i);
+    masks.newlines |= swar_byte_mask(word, '\n') << (8 * i);
+  }
+#endif
+  return masks;
+}
+
+bool index_csv(csv_index_t *index, const uint8_t *data, size_t len,
+               bool in_quotes, const csv_format_t *format) {
+  if (!index || (!data && len > 0)) {
+    panic(stderr, "Index or data pointer is empty.");
+  }
+  const csv_format_t checked = check_format(format);
+  index->count = 0;
+  // All ones while the previous block ended inside quotes.
+  uint64_t carry = in_quotes ? ~0ULL : 0;
+  uint64_t quotes = 0;
+  uint8_t tail[64];
+  for (size_t base = 0; base < len; base += 64) {
+    const uint8_t *block = data + base;
+    if (len - base < 64) {
+      memset(tail, 0, sizeof(tail));
+      memcpy(tail, block, len - base);
+      block = tail;
+    }
+    block_masks_t masks = classify_block(block, &checked);
+    quotes |= masks.quotes;
+    uint64_t quoted = prefix_xor(masks.quotes) ^ carry;
+    carry = (uint64_t)((int64_t)quoted >> 63);
+    uint64_t structural = (masks.delimiters | masks.newlines) & ~quoted;
+
+    // Room for a whole block, so that the offsets are written without
+    // checking the capacity for each of them.
+    if (index->capacity - index->count < 64) {
+      index->capacity *= 2;
+      index->offsets =
+          realloc(index->offsets, index->capacity * sizeof(size_t));
+      if (!index->offsets) {
+        panic(stderr, "Could not grow the CSV index.");
+      }
+    }
+    size_t *out = index->offsets + index->count;
+    index->count += population_count(structural);
+    while (structural) {
+      *out++ = base + trailing_zeros(structural);
+      structural &= structural - 1;
+    }
+  }
+  index->quotes = quotes != 0;
+  return carry != 0;
+}
+
+void free_csv_index(csv_index_t *index) {
+  if (!index) {
+    return;
+  }
+  free(index->offsets);
+  free(index);
+}
+
+typedef struct record_list {
+  record_t **items;
+  size_t count;
+  size_t capacity;
+} record_list_t;
+
+static void add_record(record_list_t *list, record_t *record) {
+  if (list->count == list->capacity) {
+    list->capacity = list->capacity ? list->capacity * 2 : 64;
+    list->items = realloc(list->items, list->capacity * sizeof(record_t *));
+    if (!list->items) {
+      panic(stderr, "Could not grow the record array.");
+    }
+  }
+  list->items[list->count++] = record;
+}
+
+// Text is indexed in blocks of this size, so the index stays small.
+static const size_t RANGE_BLOCK = 64 * 1024;
+
+/*
+ * Packs the record of a line, without its line break, from the ends of its
+ * fields. A line that may hold quotes is searched for them first, and
+ * unescaped if it does.
+ */
+static record_t *line_record(const csv_format_t *format,
+                             const byte_set_t *stops, const uint8_t *line,
+                             size_t len, bool may_quote,
+                             csv_fields_t *fields) {
+  if (may_quote && search_byte(line, len, format->quote) < len) {
+    unescape_record(format, stops, line, len, true, fields, &len);
+    return pack_record(fields->unescaped, unescaped_len(fields), fields,
+                       true);
+  }
+  len = end_line(line, len, fields);
+  return pack_record(line, len, fields, true);
+}
+
+/*
+ * Stage two: parses the records in [from, to) of data, which must start
+ * outside quotes, and packs a record for every line. The range must end
+ * right after a line break or at the end of the text; a last line without
+ * a line break is a record too.
+ */
+static void parse_range(const uint8_t *data, size_t from, size_t to,
+                        const csv_format_t *format, record_list_t *list) {
+  csv_index_t *index = new_csv_index();
+  csv_fields_t fields;
+  init_fields(&fields);
+  const byte_set_t stops = field_stops(format);
+  bool quoted = false;
+  // Whether a block that the current line overlaps holds quotes.
+  bool may_quote = false;
+  size_t start = from;
+  for (size_t block = from; block < to; block += RANGE_BLOCK) {
+    size_t len = to - block < RANGE_BLOCK ? to - block : RANGE_BLOCK;
+    quoted = index_csv(index, data + block, len, quoted, format);
+    may_quote = may_quote || index->quotes;
+    for (size_t i = 0; i < index->count; i++) {
+      size_t offset = block + index->offsets[i];
+      if (data[offset] == format->delimiter) {
+        add_field_end(&fields, offset - start);
+        continue;
+      }
+      add_record(list, line_record(format, &stops, data + start,
+                                   offset - start, may_quote, &fields));
+      fields.count = 0;
+      start = offset + 1;
+      may_quote = index->quotes;
+    }
+  }
+  if (start < to) {
+    add_record(list, line_record(format, &stops, data + start, to - start,
+                                 may_quote, &fields));
+  }
+  free_fields(&fields);
+  free_csv_index(index);
+}
+
+// Makes the first record the header of the cache and the others its rows.
+static string_cache_t *new_cache(record_list_t *list) {
+  string_cache_t *cache = malloc(sizeof(string_cache_t));
+  if (!cache) {
+    panic(stderr, "Could not allocate the string cache.");
+  }
+  cache->header = list->count > 0 ? list->items[0] : NULL;
+  cache->cols = cache->header ? cache->header->count : 0;
+  cache->rows = list->count > 0 ? list->count - 1 : 0;
+  cache->records = list->items;
+  cache->references = 1;
+  if (list->count > 0) {
+    memmove(list->items, list->items + 1, cache->rows * sizeof(record_t *));
+  }
+  return cache;
+}
+
+string_cache_t *parse_csv(const uint8_t *data, size_t len,
+                          const csv_format_t *format) {
+  if (!data && len > 0) {
+    panic(stderr, "Data pointer is empty.");
+  }
+  const csv_format_t checked = check_format(format);
+  record_list_t list = {NULL, 0, 0};
+  parse_range(data, 0, len, &checked, &list);
+  return new_cache(&list);
+}
+
+// SECTION: Parallel parsing.
+
+/*
+ * The text is cut into one chunk per thread at arbitrary bytes. A chunk
+ * may start inside a quoted field, and only the quotes before it tell. So
+ * each thread first counts the quotes in its chunk: the chunk flips the
+ * quote state if and only if the count is odd, whatever the state at its
+ * start. The states at the chunk starts then follow in one quick pass.
+ * With the state known, each thread moves the start of its chunk to the
+ * first line break that is not inside quotes and parses its records.
+ */
+typedef struct csv_job {
+  const uint8_t *data;
+  size_t len;
+  size_t threads;
+  csv_format_t format;
+  size_t *starts;
+  bool *odd;
+  bool *quoted;
+  record_list_t *lists;
+} csv_job_t;
+
+static bool odd_quotes(const uint8_t *data, size_t len,
+                       const csv_format_t *format) {
+  size_t count = 0;
+  size_t base = 0;
+  for (; base + 64 <= len; base += 64) {
+    count += population_count(classify_block(data + base, format).quotes);
+  }
+  uint8_t tail[64] = {0};
+  memcpy(tail, data + base, len - base);
+  count += population_count(classify_block(tail, format).quotes);
+  return count % 2;
+}
+
+// Finds the first record that starts after a line break at or after from.
+static size_t record_start(const csv_job_t *job, size_t from, bool quoted) {
+  csv_index_t *index = new_csv_index();
+  size_t result = job->len;
+  for (size_t block = from; block < job->len; block += RANGE_BLOCK) {
+    size_t len =
+        job->len - block < RANGE_BLOCK ? job->len - block : RANGE_BLOCK;
+    bool next = index_csv(index, job->data + block, len, quoted, &job->format);
+    for (size_t i = 0; i < index->count; i++) {
+      if (job->data[block + index->offsets[i]] == '\n') {
+        result = block + index->offsets[i] + 1;
+        break;
+      }
+    }
+    if (result < job->len) {
+      break;
+    }
+    quoted = next;
+  }
+  free_csv_index(index);
+  return result;
+}
+
+static void count_quotes(void *context, size_t t) {
+  csv_job_t *job = context;
+  job->odd[t] = odd_quotes(job->data + job->starts[t],
+                           job->starts[t + 1] - job->starts[t], &job->format);
+}
+
+static void parse_chunk(void *context, size_t t) {
+  csv_job_t *job = context;
+  size_t from = t == 0 ? 0 : record_start(job, job->starts[t], job->quoted[t]);
+  size_t to = t + 1 == job->threads
+                  ? job->len
+                  : record_start(job, job->starts[t + 1], job->quoted[t + 1]);
+  // A record can span whole chunks; then the chunks after it are empty.
+  if (from < to) {
+    parse_range(job->data, from, to, &job->format, &job->lists[t]);
+  }
+}
+
+string_cache_t *parse_csv_parallel(const uint8_t *data, size_t len,
+                                   size_t threads, const csv_format_t *format) {
+  if (!data && len > 0) {
+    panic(stderr, "Data pointer is empty.");
+  }
+  threads = resolve_threads(threads);
+  if (threads > len / CSV_PARALLEL_CHUNK) {
+    threads = len / CSV_PARALLEL_CHUNK;
+  }
+  if (threads <= 1) {
+    return parse_csv(data, len, format);
+  }
+  csv_job_t job;
+  job.data = data;
+  job.len = len;
+  job.threads = threads;
+  job.format = check_format(format);
+  job.starts = malloc((threads + 1) * sizeof(size_t));
+  job.odd = malloc(threads * sizeof(bool));
+  job.quoted = malloc(threads * sizeof(bool));
+  job.lists = calloc(threads, sizeof(record_list_t));
+  if (!job.starts || !job.odd || !job.quoted || !job.lists) {
+    panic(stderr, "Could not allocate the parsing job.");
+  }
+  for (size_t t = 0; t <= threads; t++) {
+    job.starts[t] = len / threads * t;
+  }
+  job.starts[threads] = len;
+
+  run_workers(threads, count_quotes, &job);
+  job.quoted[0] = false;
+  for (size_t t = 1; t < threads; t++) {
+    job.quoted[t] = job.quoted[t - 1] != job.odd[t - 1];
+  }
+  run_workers(threads, parse_chunk, &job);
+
+  // The records of the chunks, in file order, in the first chunk's array.
+  record_list_t *all = &job.lists[0];
+  for (size_t t = 1; t < threads; t++) {
+    for (size_t i = 0; i < job.lists[t].count; i++) {
+      add_record(all, job.lists[t].items[i]);
+    }
+    free(job.lists[t].items);
+  }
+  string_cache_t *cache = new_cache(all);
+  free(job.starts);
+  free(job.odd);
+  free(job.quoted);
+  free(job.lists);
+  return cache;
+}
+
+string_cache_t *load_csv(const char *path, size_t threads,
+                         const csv_format_t *format) {
+  csv_map_t *map = map_csv_file(path, format);
+  if (!map) {
+    return NULL;
+  }
+  madvise(map->data, map->len, MADV_WILLNEED);
+  string_cache_t *cache =
+      parse_csv_parallel(map->data, map->len, threads, format);
+  free_csv_map(map);
+  return cache;
+}
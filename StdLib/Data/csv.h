@@ -2,9 +2,266 @@
 #define C_PROGRAMS_CSV_H
 
 #include "data.h"
+#include "../String/search.h"
 
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 
 record_t *read_csv_record(FILE *input);
 
+/**
+ * The default size of the buffer of a CSV reader. The buffer grows when a
+ * single record does not fit.
+ */
+#define CSV_READER_CAPACITY (256 * 1024)
+
+/**
+ * The bytes that separate and quote fields. A quote starts a quoted part of
+ * a field, which ends at the next quote that is not doubled. Inside it,
+ * delimiters and line breaks (including "\r\n") belong to the value, and a
+ * doubled quote stands for one quote; the quotes around the part are not
+ * part of the value. This reads every field of RFC 4180 as it defines it.
+ *
+ * The delimiter and the quote must differ, and neither can be a line break.
+ */
+typedef struct csv_format {
+  uint8_t delimiter;
+  uint8_t quote;
+} csv_format_t;
+
+/**
+ * Comma separated values with double quotes, as in RFC 4180. Functions that
+ * take a format use it when they are given NULL.
+ */
+extern const csv_format_t CSV_RFC4180;
+
+/**
+ * The offsets, from the start of a record, at which its fields end. Field i
+ * starts one byte after the end of field i - 1. The array is reused from
+ * record to record.
+ *
+ * Records without quotes are split where they are. Records with quotes are
+ * first unescaped into the unescaped buffer, with one byte between fields,
+ * and then the ends refer to that buffer instead.
+ */
+typedef struct csv_fields {
+  size_t *ends;
+  size_t count;
+  size_t capacity;
+  uint8_t *unescaped;
+  size_t unescaped_capacity;
+} csv_fields_t;
+
+/**
+ * A CSV reader reads its input in large blocks into one buffer that it
+ * reuses for every record, instead of allocating a line per record.
+ *
+ * The bytes in [start, end) of the buffer have been read but not parsed
+ * yet. fields holds the ends of the fields of the current record. records
+ * counts the records read.
+ */
+typedef struct csv_reader {
+  FILE *input;
+  uint8_t *buffer;
+  size_t start;
+  size_t end;
+  size_t capacity;
+  csv_fields_t fields;
+  csv_format_t format;
+  byte_set_t stops;
+  size_t records;
+  bool eof;
+} csv_reader_t;
+
+/**
+ * Creates a reader for a stream of delimited records, one per line. The
+ * stream is not closed by the reader.
+ *
+ * @param input    The stream to read from.
+ * @param capacity The size of the buffer, or 0 for CSV_READER_CAPACITY.
+ * @param format   The delimiter and quote, or NULL for CSV_RFC4180.
+ * @return A new reader.
+ */
+csv_reader_t *new_csv_reader(FILE *input, size_t capacity,
+                             const csv_format_t *format);
+
+/**
+ * Reads the next record. The fields are found in one pass over the line,
+ * and the record is packed into a single allocation. Lines end with "\n"
+ * or "\r\n", which is not part of the last field; an empty line is a
+ * record with one empty field. Line breaks inside quotes do not end a
+ * record.
+ *
+ * The pass stops at the first quote of a record, if any. Only records with
+ * quotes are unescaped; the others cost no more than a split at the
+ * delimiters.
+ *
+ * @param reader The reader.
+ * @return The next record, to be freed with free_record, or NULL at the end
+ *         of the input.
+ */
+record_t *csv_read_record(csv_reader_t *reader);
+
+/**
+ * @param reader The reader to be deallocated.
+ */
+void free_csv_reader(csv_reader_t *reader);
+
+/**
+ * A CSV map parses a file that is mapped into memory with mmap, without
+ * copying or allocating per record: the values of its records are views
+ * (string_t values held by value) of the mapped bytes. The offset of a value
+ * in the file is value->data - map->data. Views must not be passed to
+ * free_string; use copy_string to keep a value beyond free_csv_map.
+ *
+ * position is the offset of the next record in the file, and records counts
+ * the records read. The file must not be modified while it is mapped.
+ *
+ * The values of a record with quotes cannot be views of the file, since
+ * their bytes differ from it; they refer to a buffer of the map instead.
+ */
+typedef struct csv_map {
+  uint8_t *data;
+  size_t len;
+  size_t position;
+  csv_fields_t fields;
+  string_t *views;
+  size_t views_capacity;
+  record_t record;
+  csv_format_t format;
+  byte_set_t stops;
+  size_t records;
+} csv_map_t;
+
+/**
+ * Maps a CSV file into memory for a single front to back pass, and tells
+ * the kernel so with madvise.
+ *
+ * @param path   The path of the file.
+ * @param format The delimiter and quote, or NULL for CSV_RFC4180.
+ * @return The map, or NULL if the file could not be opened or mapped.
+ */
+csv_map_t *map_csv_file(const char *path, const csv_format_t *format);
+
+/**
+ * Reads the next record without allocating. Records are split like those of
+ * csv_read_record.
+ *
+ * @param map The map.
+ * @return The next record, or NULL at the end of the file. The record and
+ *         its strings are owned by the map and only valid until the next
+ *         call. The bytes of a record without quotes stay valid until the
+ *         map is freed; those of a record with quotes only until the next
+ *         call.
+ */
+const record_t *next_mapped_record(csv_map_t *map);
+
+/**
+ * Reads the next record into a packed record of its own, whose values are
+ * views of the map. It works with record_cmp and sort_records_by_column
+ * like any other record and does not copy any bytes, except for a record
+ * with quotes, whose unescaped bytes are packed with it.
+ *
+ * @param map The map.
+ * @return The next record, to be freed with free_record before the map is
+ *         freed, or NULL at the end of the file.
+ */
+record_t *read_mapped_record(csv_map_t *map);
+
+/**
+ * Unmaps the file and releases the map.
+ *
+ * @param map The map to be deallocated.
+ */
+void free_csv_map(csv_map_t *map);
+
+/**
+ * A structural index of CSV text: the offsets of all delimiters and line
+ * breaks that are not inside a quoted field, in increasing order. quotes
+ * tells whether the text holds any quote at all.
+ */
+typedef struct csv_index {
+  size_t *offsets;
+  size_t count;
+  size_t capacity;
+  bool quotes;
+} csv_index_t;
+
+/**
+ * @return A new, empty index that can be reused for any number of texts.
+ */
+csv_index_t *new_csv_index(void);
+
+/**
+ * Builds the structural index of a text, 64 bytes per step (in the manner
+ * of Langdale and Lemire's simdjson, 2019). Each block is classified into
+ * bitmasks of quotes, delimiters and line breaks with vector compares. The
+ * prefix XOR of the quote mask, a carry-less multiplication where PCLMUL is
+ * available, marks the bytes inside quotes, and the remaining delimiters
+ * and line breaks are written out from the bits of their masks.
+ *
+ * @param index     Receives the offsets; its previous contents are dropped.
+ * @param data      The text.
+ * @param len       The length of the text.
+ * @param in_quotes Whether the text starts inside a quoted field, for texts
+ *                  that are parts of a larger one.
+ * @param format    The delimiter and quote, or NULL for CSV_RFC4180.
+ * @return Whether the text ends inside a quoted field.
+ */
+bool index_csv(csv_index_t *index, const uint8_t *data, size_t len,
+               bool in_quotes, const csv_format_t *format);
+
+/**
+ * @param index The index to be deallocated.
+ */
+void free_csv_index(csv_index_t *index);
+
+/**
+ * Parses a whole CSV text in two stages: index_csv finds the delimiters and
+ * line breaks, and then a packed record is built for each line. Delimiters
+ * and line breaks inside quotes do not split a field. Lines are only
+ * searched for quotes, and unescaped, in blocks of the text that hold any.
+ *
+ * @param data   The text, for example the data of a csv_map_t.
+ * @param len    The length of the text.
+ * @param format The delimiter and quote, or NULL for CSV_RFC4180.
+ * @return A new cache whose header is the first record and whose rows are
+ *         the others; the records do not refer to the text.
+ */
+string_cache_t *parse_csv(const uint8_t *data, size_t len,
+                          const csv_format_t *format);
+
+/**
+ * Texts with fewer bytes than this per thread are parsed by fewer threads.
+ */
+#define CSV_PARALLEL_CHUNK (1024 * 1024)
+
+/**
+ * Parses a whole CSV text like parse_csv, on several threads. The text is
+ * cut into equal byte ranges, one per thread. The quote state at the start
+ * of every range is resolved from the parity of the quote counts of the
+ * ranges before it, so line breaks inside quoted fields never end a range.
+ * The records of the threads are merged in text order.
+ *
+ * @param data    The text.
+ * @param len     The length of the text.
+ * @param threads The number of threads to use, 0 for one per processor.
+ * @param format  The delimiter and quote, or NULL for CSV_RFC4180.
+ * @return A new cache, the same as parse_csv(data, len, format) returns.
+ */
+string_cache_t *parse_csv_parallel(const uint8_t *data, size_t len,
+                                   size_t threads, const csv_format_t *format);
+
+/**
+ * Maps a CSV file and parses it with parse_csv_parallel.
+ *
+ * @param path    The path of the file.
+ * @param threads The number of threads to use, 0 for one per processor.
+ * @param format  The delimiter and quote, or NULL for CSV_RFC4180.
+ * @return A new cache, or NULL if the file could not be opened or mapped.
+ */
+string_cache_t *load_csv(const char *path, size_t threads,
+                         const csv_format_t *format);
+
 #endif // C_PROGRAMS_CSV_H
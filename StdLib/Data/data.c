@@ -1,9 +1,21 @@
 #include "data.h"
+#include "../Panic/panic.h"
+#include "../Parallel/parallel.h"
+#include "../String/number.h"
+#include "../String/search.h"
+#include "../String/simd.h"
+#include "../String/sort.h"
+
+#include <string.h>
 
 void free_record(record_t *record) {
   if (!record) {
     return;
   }
+  if (record->packed) {
+    free(record);
+    return;
+  }
   for (size_t i = 0; i < record->count; i++) {
     free_string(record->values[i]);
   }
@@ -15,10 +27,14 @@ void free_cache(string_cache_t *cache) {
   if (!cache) {
     return;
   }
+  if (--cache->references > 0) {
+    return;
+  }
   for (size_t i = 0; i < cache->rows; i++) {
     free_record(cache->records[i]);
   }
   free(cache->records);
+  free_record(cache->header);
   free(cache);
 }
 
@@ -31,13 +47,48 @@ void free_dataset(dataset_t *dataset) {
   free_cache(dataset->cache);
   free(dataset);
 }
+
 record_t *new_record(size_t count, string_t **values) {
   record_t *result = malloc(sizeof(record_t));
   result->count = count;
   result->values = values;
+  result->packed = false;
   return result;
 }
 
+record_t *new_packed_record(size_t count, const size_t *ends, size_t gap,
+                            const uint8_t *bytes, size_t len, bool copy) {
+  if ((!ends && count > 0) || (!bytes && len > 0)) {
+    panic(stderr, "Value ends or bytes are empty.");
+  }
+  size_t header = sizeof(record_t) + count * sizeof(string_t *);
+  uint8_t *block =
+      malloc(header + count * sizeof(string_t) + (copy ? len : 0));
+  if (!block) {
+    panic(stderr, "Could not allocate the record.");
+  }
+  record_t *record = (record_t *)block;
+  string_t *strings = (string_t *)(block + header);
+  if (copy) {
+    uint8_t *copied = (uint8_t *)(strings + count);
+    if (len > 0) {
+      memcpy(copied, bytes, len);
+    }
+    bytes = copied;
+  }
+  record->count = count;
+  record->values = (string_t **)(record + 1);
+  record->packed = true;
+  size_t start = 0;
+  for (size_t i = 0; i < count; i++) {
+    strings[i].len = ends[i] - start;
+    strings[i].data = (uint8_t *)bytes + start;
+    record->values[i] = &strings[i];
+    start = ends[i] + gap;
+  }
+  return record;
+}
+
 int record_cmp(const record_t *left, const record_t *right) {
   // Handling null cases. Null is considered to be lesser value than
   // that of all non-null values. This also facilitates moving the null
@@ -62,3 +113,479 @@ int record_cmp(const record_t *left, const record_t *right) {
   }
   return 0;
 }
+
+static const string_t *column_value(const void *item, const void *context) {
+  const record_t *record = item;
+  size_t column = *(const size_t *)context;
+  if (!record || column >= record->count) {
+    panic(stderr, "Record is empty or has no such column.");
+  }
+  return record->values[column];
+}
+
+void sort_records_by_column(record_t **records, size_t count, size_t column,
+                            size_t threads) {
+  sort_by_string_key((void **)records, count, column_value, &column, threads);
+}
+
+// SECTION: Views.
+
+static size_t *new_indices(size_t count) {
+  // Never NULL, even for an empty view, so that it can be copied from.
+  size_t *indices = malloc((count > 0 ? count : 1) * sizeof(size_t));
+  if (!indices) {
+    panic(stderr, "Could not allocate the dataset indices.");
+  }
+  return indices;
+}
+
+// A dataset with room for its indices, which the caller fills in.
+static dataset_t *new_view(string_cache_t *cache, size_t rows, size_t cols) {
+  dataset_t *view = malloc(sizeof(dataset_t));
+  if (!view) {
+    panic(stderr, "Could not allocate the dataset.");
+  }
+  view->rows = rows;
+  view->cols = cols;
+  view->row_arr = new_indices(rows);
+  view->col_arr = new_indices(cols);
+  view->cache = cache;
+  cache->references++;
+  return view;
+}
+
+static void assert_dataset(const dataset_t *dataset) {
+  if (!dataset) {
+    panic(stderr, "Dataset pointer is empty.");
+  }
+}
+
+// The view keeps the columns of the dataset; the rows are left to fill in.
+static dataset_t *new_row_view(const dataset_t *dataset, size_t rows) {
+  dataset_t *view = new_view(dataset->cache, rows, dataset->cols);
+  memcpy(view->col_arr, dataset->col_arr, dataset->cols * sizeof(size_t));
+  return view;
+}
+
+dataset_t *new_dataset(string_cache_t *cache) {
+  if (!cache) {
+    panic(stderr, "Cache pointer is empty.");
+  }
+  dataset_t *dataset = new_view(cache, cache->rows, cache->cols);
+  for (size_t i = 0; i < cache->rows; i++) {
+    dataset->row_arr[i] = i;
+  }
+  for (size_t j = 0; j < cache->cols; j++) {
+    dataset->col_arr[j] = j;
+  }
+  return dataset;
+}
+
+const string_t *dataset_value(const dataset_t *dataset, size_t row,
+                              size_t col) {
+  assert_dataset(dataset);
+  if (row >= dataset->rows || col >= dataset->cols) {
+    panic(stderr, "Row or column is out of the dataset.");
+  }
+  const record_t *record = dataset->cache->records[dataset->row_arr[row]];
+  size_t index = dataset->col_arr[col];
+  return index < record->count ? record->values[index] : NULL;
+}
+
+const string_t *dataset_column_name(const dataset_t *dataset, size_t col) {
+  assert_dataset(dataset);
+  if (col >= dataset->cols) {
+    panic(stderr, "Column is out of the dataset.");
+  }
+  const record_t *header = dataset->cache->header;
+  size_t index = dataset->col_arr[col];
+  return header && index < header->count ? header->values[index] : NULL;
+}
+
+dataset_t *select_rows(const dataset_t *dataset, row_predicate_t predicate,
+                       void *context) {
+  assert_dataset(dataset);
+  if (!predicate) {
+    panic(stderr, "Predicate pointer is empty.");
+  }
+  // Sized for every row, then trimmed to the rows that were selected.
+  dataset_t *view = new_row_view(dataset, dataset->rows);
+  size_t count = 0;
+  for (size_t i = 0; i < dataset->rows; i++) {
+    if (predicate(dataset, i, context)) {
+      view->row_arr[count++] = dataset->row_arr[i];
+    }
+  }
+  view->rows = count;
+  if (count > 0 && count < dataset->rows) {
+    size_t *trimmed = realloc(view->row_arr, count * sizeof(size_t));
+    if (trimmed) {
+      view->row_arr = trimmed;
+    }
+  }
+  return view;
+}
+
+dataset_t *take_rows(const dataset_t *dataset, const size_t *rows,
+                     size_t count) {
+  assert_dataset(dataset);
+  if (!rows && count > 0) {
+    panic(stderr, "Row array is empty.");
+  }
+  dataset_t *view = new_row_view(dataset, count);
+  for (size_t i = 0; i < count; i++) {
+    if (rows[i] >= dataset->rows) {
+      panic(stderr, "Row is out of the dataset.");
+    }
+    view->row_arr[i] = dataset->row_arr[rows[i]];
+  }
+  return view;
+}
+
+dataset_t *slice_rows(const dataset_t *dataset, size_t from, size_t to) {
+  assert_dataset(dataset);
+  if (from > to || to > dataset->rows) {
+    panic(stderr, "Slice is out of the dataset.");
+  }
+  dataset_t *view = new_row_view(dataset, to - from);
+  memcpy(view->row_arr, dataset->row_arr + from, (to - from) * sizeof(size_t));
+  return view;
+}
+
+dataset_t *select_columns(const dataset_t *dataset, const size_t *cols,
+                          size_t count) {
+  assert_dataset(dataset);
+  if (!cols && count > 0) {
+    panic(stderr, "Column array is empty.");
+  }
+  dataset_t *view = new_view(dataset->cache, dataset->rows, count);
+  memcpy(view->row_arr, dataset->row_arr, dataset->rows * sizeof(size_t));
+  for (size_t j = 0; j < count; j++) {
+    if (cols[j] >= dataset->cols) {
+      panic(stderr, "Column is out of the dataset.");
+    }
+    view->col_arr[j] = dataset->col_arr[cols[j]];
+  }
+  return view;
+}
+
+// SECTION: Sorting datasets.
+
+// Merge sort finishes runs shorter than this with insertion sort.
+static const size_t INSERTION_RUN = 16;
+
+/*
+ * The normalized key of a row, with its first eight bytes as a big endian
+ * integer padded with zeros. Keys are prefix free, so two different keys
+ * differ within the shorter one and the padding never decides an order.
+ */
+typedef struct key_entry {
+  uint64_t prefix;
+  const uint8_t *key;
+  size_t len;
+  size_t row;
+} key_entry_t;
+
+typedef struct key_buffer {
+  uint8_t *bytes;
+  size_t len;
+  size_t capacity;
+} key_buffer_t;
+
+static uint8_t *reserve_key(key_buffer_t *buffer, size_t len) {
+  if (buffer->capacity - buffer->len < len) {
+    while (buffer->capacity - buffer->len < len) {
+      buffer->capacity = buffer->capacity ? buffer->capacity * 2 : 4096;
+    }
+    buffer->bytes = realloc(buffer->bytes, buffer->capacity);
+    if (!buffer->bytes) {
+      panic(stderr, "Could not grow the sort key buffer.");
+    }
+  }
+  uint8_t *out = buffer->bytes + buffer->len;
+  buffer->len += len;
+  return out;
+}
+
+static inline uint64_t big_endian(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_bswap64(word);
+#else
+  uint64_t result = 0;
+  for (int i = 0; i < 8; i++) {
+    result = result << 8 | ((word >> (8 * i)) & 0xff);
+  }
+  return result;
+#endif
+}
+
+/*
+ * A number is a tag byte and the bits of the double, with the sign bit
+ * flipped for positive numbers and all bits flipped for negative ones, so
+ * that their unsigned order is the numeric order. Values that are not
+ * numbers get a larger tag.
+ */
+static void encode_number(key_buffer_t *buffer, const string_t *value) {
+  uint8_t *out = reserve_key(buffer, 9);
+  double number;
+  if (!value || !string_to_double(value, &number) || number != number) {
+    memset(out, 0, 9);
+    out[0] = 2;
+    return;
+  }
+  if (number == 0) {
+    number = 0; // -0 and 0 are equal.
+  }
+  uint64_t bits;
+  memcpy(&bits, &number, sizeof(bits));
+  bits ^= bits >> 63 ? ~0ULL : 1ULL << 63;
+  out[0] = 1;
+  bits = big_endian(bits);
+  memcpy(out + 1, &bits, 8);
+}
+
+/*
+ * A string is its bytes with every zero byte escaped as 0x00 0xff, and ends
+ * with 0x00 0x00, which sorts before any escaped or other byte.
+ */
+static void encode_string(key_buffer_t *buffer, const string_t *value) {
+  const size_t len = value ? value->len : 0;
+  size_t from = 0;
+  while (from < len) {
+    size_t zero = from + search_byte(value->data + from, len - from, 0);
+    uint8_t *out = reserve_key(buffer, zero - from);
+    memcpy(out, value->data + from, zero - from);
+    if (zero < len) {
+      out = reserve_key(buffer, 2);
+      out[0] = 0;
+      out[1] = 0xff;
+      zero++;
+    }
+    from = zero;
+  }
+  uint8_t *end = reserve_key(buffer, 2);
+  end[0] = end[1] = 0;
+}
+
+static inline int compare_keys(const key_entry_t *left,
+                               const key_entry_t *right) {
+  if (left->prefix != right->prefix) {
+    return left->prefix < right->prefix ? -1 : 1;
+  }
+  size_t len = left->len < right->len ? left->len : right->len;
+  if (len <= 8) {
+    return 0;
+  }
+  int result = memcmp(left->key + 8, right->key + 8, len - 8);
+  if (result) {
+    return result;
+  }
+  return left->len == right->len ? 0 : left->len < right->len ? -1 : 1;
+}
+
+// Merges two sorted runs into out; ties are taken from the left run first.
+static void merge_runs(const key_entry_t *left, size_t left_count,
+                       const key_entry_t *right, size_t right_count,
+                       key_entry_t *out) {
+  size_t i = 0, j = 0;
+  while (i < left_count && j < right_count) {
+    if (compare_keys(&right[j], &left[i]) < 0) {
+      *out++ = right[j++];
+    } else {
+      *out++ = left[i++];
+    }
+  }
+  memcpy(out, left + i, (left_count - i) * sizeof(key_entry_t));
+  memcpy(out + left_count - i, right + j,
+         (right_count - j) * sizeof(key_entry_t));
+}
+
+static void merge_sort(key_entry_t *entries, key_entry_t *buffer,
+                       size_t count) {
+  if (count <= INSERTION_RUN) {
+    for (size_t i = 1; i < count; i++) {
+      key_entry_t entry = entries[i];
+      size_t j = i;
+      for (; j > 0 && compare_keys(&entry, &entries[j - 1]) < 0; j--) {
+        entries[j] = entries[j - 1];
+      }
+      entries[j] = entry;
+    }
+    return;
+  }
+  size_t half = count / 2;
+  merge_sort(entries, buffer, half);
+  merge_sort(entries + half, buffer + half, count - half);
+  if (compare_keys(&entries[half], &entries[half - 1]) >= 0) {
+    return;
+  }
+  memcpy(buffer, entries, count * sizeof(key_entry_t));
+  merge_runs(buffer, half, buffer + half, count - half, entries);
+}
+
+/*
+ * The number of entries of the left run among the first diagonal entries
+ * of the merge of two runs: the point where the diagonal crosses the merge
+ * path.
+ */
+static size_t merge_path(const key_entry_t *left, size_t left_count,
+                         const key_entry_t *right, size_t right_count,
+                         size_t diagonal) {
+  size_t low = diagonal > right_count ? diagonal - right_count : 0;
+  size_t high = diagonal < left_count ? diagonal : left_count;
+  while (low < high) {
+    size_t i = low + (high - low) / 2;
+    if (compare_keys(&right[diagonal - i - 1], &left[i]) < 0) {
+      high = i;
+    } else {
+      low = i + 1;
+    }
+  }
+  return low;
+}
+
+typedef struct dataset_sort_job {
+  dataset_t *dataset;
+  const dataset_sort_key_t *keys;
+  size_t count;
+  size_t threads;
+  key_entry_t *entries;
+  key_entry_t *buffer;
+  key_buffer_t *key_buffers;
+  // The sorted runs in entries are [bounds[r], bounds[r + 1]).
+  size_t *bounds;
+  size_t runs;
+} dataset_sort_job_t;
+
+// Builds the keys of the rows of one slice and sorts the slice.
+static void sort_slice(void *context, size_t index) {
+  dataset_sort_job_t *job = context;
+  const dataset_t *dataset = job->dataset;
+  key_buffer_t *buffer = &job->key_buffers[index];
+  const size_t start = job->bounds[index];
+  const size_t end = job->bounds[index + 1];
+  // Keys are found by offset while the buffer may still move.
+  for (size_t i = start; i < end; i++) {
+    size_t offset = buffer->len;
+    for (size_t k = 0; k < job->count; k++) {
+      const dataset_sort_key_t *key = &job->keys[k];
+      const string_t *value = dataset_value(dataset, i, key->column);
+      size_t from = buffer->len;
+      if (key->numeric) {
+        encode_number(buffer, value);
+      } else {
+        encode_string(buffer, value);
+      }
+      if (key->descending) {
+        for (size_t b = from; b < buffer->len; b++) {
+          buffer->bytes[b] = (uint8_t)~buffer->bytes[b];
+        }
+      }
+    }
+    job->entries[i].len = buffer->len - offset;
+    job->entries[i].row = dataset->row_arr[i];
+    job->entries[i].key = (const uint8_t *)offset;
+  }
+  for (size_t i = start; i < end; i++) {
+    key_entry_t *entry = &job->entries[i];
+    entry->key = buffer->bytes + (size_t)entry->key;
+    uint8_t padded[8] = {0};
+    memcpy(padded, entry->key, entry->len < 8 ? entry->len : 8);
+    entry->prefix = big_endian(load_u64(padded));
+  }
+  merge_sort(job->entries + start, job->buffer + start, end - start);
+}
+
+/*
+ * Merges the runs in pairs into the buffer. Each pair gets a share of the
+ * threads in proportion to its size, and each thread merges the part of the
+ * output between two diagonals of the merge path.
+ */
+static void merge_slice(void *context, size_t index) {
+  dataset_sort_job_t *job = context;
+  const size_t total = job->bounds[job->runs];
+  // The share of the output of this thread.
+  const size_t from = total / job->threads * index;
+  const size_t to =
+      index + 1 == job->threads ? total : total / job->threads * (index + 1);
+  for (size_t r = 0; r < job->runs; r += 2) {
+    const size_t start = job->bounds[r];
+    const size_t middle = job->bounds[r + 1];
+    const size_t end = r + 2 <= job->runs ? job->bounds[r + 2] : middle;
+    if (end <= from || start >= to) {
+      continue;
+    }
+    const size_t low = (from > start ? from : start) - start;
+    const size_t high = (to < end ? to : end) - start;
+    const key_entry_t *left = job->entries + start;
+    const key_entry_t *right = job->entries + middle;
+    const size_t left_count = middle - start;
+    const size_t right_count = end - middle;
+    size_t i = merge_path(left, left_count, right, right_count, low);
+    size_t i_end = merge_path(left, left_count, right, right_count, high);
+    merge_runs(left + i, i_end - i, right + (low - i),
+               (high - i_end) - (low - i), job->buffer + start + low);
+  }
+}
+
+void sort_dataset(dataset_t *dataset, const dataset_sort_key_t *keys,
+                  size_t count, size_t threads) {
+  assert_dataset(dataset);
+  if (!keys && count > 0) {
+    panic(stderr, "Key array is empty.");
+  }
+  for (size_t k = 0; k < count; k++) {
+    if (keys[k].column >= dataset->cols) {
+      panic(stderr, "Sort key column is out of the dataset.");
+    }
+  }
+  const size_t rows = dataset->rows;
+  if (count == 0 || rows < 2) {
+    return; // A stable sort leaves the rows where they are.
+  }
+  threads = resolve_threads(threads);
+  if (rows < SORT_PARALLEL_THRESHOLD) {
+    threads = 1;
+  }
+  dataset_sort_job_t job;
+  job.dataset = dataset;
+  job.keys = keys;
+  job.count = count;
+  job.threads = threads;
+  job.entries = malloc((rows + 1) * sizeof(key_entry_t));
+  job.buffer = malloc((rows + 1) * sizeof(key_entry_t));
+  job.key_buffers = calloc(threads, sizeof(key_buffer_t));
+  job.bounds = malloc((threads + 1) * sizeof(size_t));
+  if (!job.entries || !job.buffer || !job.key_buffers || !job.bounds) {
+    panic(stderr, "Could not allocate the sort of the dataset.");
+  }
+  for (size_t t = 0; t <= threads; t++) {
+    job.bounds[t] = rows / threads * t;
+  }
+  job.bounds[threads] = rows;
+  job.runs = threads;
+  run_workers(threads, sort_slice, &job);
+
+  while (job.runs > 1) {
+    run_workers(threads, merge_slice, &job);
+    key_entry_t *merged = job.buffer;
+    job.buffer = job.entries;
+    job.entries = merged;
+    size_t runs = 0;
+    for (size_t r = 0; r < job.runs; r += 2) {
+      job.bounds[runs++] = job.bounds[r];
+    }
+    job.bounds[runs] = rows;
+    job.runs = runs;
+  }
+  for (size_t i = 0; i < rows; i++) {
+    dataset->row_arr[i] = job.entries[i].row;
+  }
+  for (size_t t = 0; t < threads; t++) {
+    free(job.key_buffers[t].bytes);
+  }
+  free(job.entries);
+  free(job.buffer);
+  free(job.key_buffers);
+  free(job.bounds);
+}
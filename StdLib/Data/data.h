@@ -2,20 +2,41 @@
 #define C_PROGRAMS_DATA_H
 
 #include "../String/string.h"
+#include <stdbool.h>
 #include <stdlib.h>
 
+/**
+ * A packed record is a single allocation that holds the record, its array
+ * of values, the strings and (unless the strings are views of a mapped
+ * file) their bytes; free_record releases it with one call to free.
+ */
 typedef struct record {
   size_t count;
   string_t **values;
+  bool packed;
 } record_t;
 
+/**
+ * A table of records with an optional header. A cache can be shared by any
+ * number of datasets: references counts its owners, one for whoever created
+ * it and one for every dataset over it, and free_cache only releases the
+ * records when the last owner lets go. The count is not atomic, so a cache
+ * must not be shared or released on several threads at once.
+ */
 typedef struct string_cache {
   size_t cols;
   size_t rows;
   record_t *header;
   record_t **records;
+  size_t references;
 } string_cache_t;
 
+/**
+ * A dataset is a view of a cache: row i of the dataset is record row_arr[i]
+ * of the cache, and column j is value col_arr[j] of each record. Selecting,
+ * slicing and projecting only build new index arrays, so views are cheap and
+ * never copy a record. A view of a view refers to the cache directly.
+ */
 typedef struct dataset {
   size_t cols;
   size_t rows;
@@ -24,6 +45,12 @@ typedef struct dataset {
   string_cache_t *cache;
 } dataset_t;
 
+/**
+ * Decides whether a row belongs in a selection.
+ */
+typedef bool (*row_predicate_t)(const dataset_t *dataset, size_t row,
+                                void *context);
+
 /**
  * Note: The record created will contain a reference to the string
  * array provided. So any changes made on the original string array
@@ -36,6 +63,24 @@ typedef struct dataset {
  */
 record_t *new_record(size_t count, string_t *values[]);
 
+/**
+ * Builds a packed record (see record_t) from values that lie one after the
+ * other in a buffer: value i ends at ends[i], and starts gap bytes after
+ * the end of value i - 1 (value 0 starts at 0). A gap skips the separators
+ * between values, such as the delimiters of a line.
+ *
+ * @param count The number of values.
+ * @param ends  The offsets in bytes at which the values end.
+ * @param gap   The number of bytes between two values.
+ * @param bytes The buffer.
+ * @param len   The length of the buffer.
+ * @param copy  Whether to copy the buffer into the record; otherwise the
+ *              values are views of it, which must outlive the record.
+ * @return A new record, to be freed with free_record.
+ */
+record_t *new_packed_record(size_t count, const size_t *ends, size_t gap,
+                            const uint8_t *bytes, size_t len, bool copy);
+
 /**
  * Note: Do not call any of the free functions if the actual source
  * of data is a concrete, statically defined array of string_t*'s. Deallocate
@@ -47,9 +92,150 @@ record_t *new_record(size_t count, string_t *values[]);
  */
 
 void free_record(record_t *record);
+
+/**
+ * Drops one reference to the cache, and releases it with all of its records
+ * if that was the last one.
+ *
+ * @param cache The cache to be released.
+ */
 void free_cache(string_cache_t *cache);
+
+/**
+ * Releases the index arrays of a dataset and its reference to the cache.
+ *
+ * @param dataset The dataset to be deallocated.
+ */
 void free_dataset(dataset_t *dataset);
 
+/**
+ * Creates a dataset of all the rows and columns of a cache. The dataset
+ * takes a reference of its own; the caller still has to free_cache its
+ * reference when it no longer needs the cache.
+ *
+ * @param cache The cache to view.
+ * @return A new dataset.
+ */
+dataset_t *new_dataset(string_cache_t *cache);
+
+/**
+ * @param dataset The dataset.
+ * @param row     The row, less than dataset->rows.
+ * @param col     The column, less than dataset->cols.
+ * @return The value, or NULL if the record of the row is too short to have
+ *         that column.
+ */
+const string_t *dataset_value(const dataset_t *dataset, size_t row,
+                              size_t col);
+
+/**
+ * @param dataset The dataset.
+ * @param col     The column, less than dataset->cols.
+ * @return The value of the header for the column, or NULL if the cache has
+ *         no header or the header has no such column.
+ */
+const string_t *dataset_column_name(const dataset_t *dataset, size_t col);
+
+/**
+ * Creates a view of the rows for which a predicate holds, in their order.
+ *
+ * @param dataset   The dataset to select from.
+ * @param predicate Called once for each row of the dataset.
+ * @param context   Passed on to the predicate.
+ * @return A new dataset with the same columns.
+ */
+dataset_t *select_rows(const dataset_t *dataset, row_predicate_t predicate,
+                       void *context);
+
+/**
+ * Creates a view of the given rows, in the given order. Rows may repeat.
+ *
+ * @param dataset The dataset to select from.
+ * @param rows    The rows, each less than dataset->rows.
+ * @param count   The number of rows.
+ * @return A new dataset with the same columns.
+ */
+dataset_t *take_rows(const dataset_t *dataset, const size_t *rows,
+                     size_t count);
+
+/**
+ * Creates a view of the rows in [from, to).
+ *
+ * @param dataset The dataset to slice.
+ * @param from    The first row.
+ * @param to      One past the last row; at most dataset->rows.
+ * @return A new dataset with the same columns.
+ */
+dataset_t *slice_rows(const dataset_t *dataset, size_t from, size_t to);
+
+/**
+ * Creates a view of the given columns, in the given order, which projects
+ * and reorders the columns. Columns may repeat.
+ *
+ * @param dataset The dataset to project.
+ * @param cols    The columns, each less than dataset->cols.
+ * @param count   The number of columns.
+ * @return A new dataset with the same rows.
+ */
+dataset_t *select_columns(const dataset_t *dataset, const size_t *cols,
+                          size_t count);
+
 int record_cmp(const record_t *left, const record_t *right);
 
+/**
+ * Sorts records by the value in one of their columns, in the order of
+ * string_cmp, with the radix sort of sort.h. Records with equal values may
+ * end up in any order.
+ *
+ * @param records The records to sort; none of them may be NULL.
+ * @param count   The number of records.
+ * @param column  The index of the value to sort by, less than the count of
+ *                every record.
+ * @param threads The number of threads to use, 0 for one per processor.
+ */
+void sort_records_by_column(record_t **records, size_t count, size_t column,
+                            size_t threads);
+
+/**
+ * One key of a dataset sort. Lexical keys compare values with string_cmp;
+ * a missing value is an empty one. Numeric keys compare values as doubles,
+ * and values that are not numbers (including empty ones and "nan") come
+ * after all numbers, in their original order. Descending keys reverse
+ * both, so that, as in PostgreSQL, non-numbers come first.
+ */
+typedef struct dataset_sort_key {
+  size_t column;
+  bool descending;
+  bool numeric;
+} dataset_sort_key_t;
+
+/**
+ * Sorts the rows of a dataset by several keys, the first key first, by
+ * permuting its row_arr only; no record moves, and other views of the cache
+ * are not affected. The sort is stable: rows that are equal on every key
+ * keep their order.
+ *
+ * Every row gets a normalized key first: the keys of the row encoded into
+ * one byte string that memcmp orders as the keys would be. Numbers become
+ * eight bytes whose unsigned order is that of the doubles, strings are
+ * escaped and terminated so that they never run into the next key, and the
+ * bytes of descending keys are inverted. The rows are then sorted with a
+ * merge sort that compares the first eight bytes of two keys as integers
+ * and only calls memcmp when they are equal. With several threads, each
+ * thread builds the keys of a slice of the rows and sorts it, and the
+ * sorted slices are merged in rounds in which every thread merges an equal
+ * share of the output, found by binary search (Odeh, Green, Mwassi,
+ * Shmueli and Birk, "Merge Path", 2012).
+ *
+ * @param dataset The dataset to sort.
+ * @param keys    The keys to sort by, each of a column less than
+ *                dataset->cols.
+ * @param count   The number of keys.
+ * @param threads The number of threads to use, 0 for one per processor.
+ *                Datasets with fewer than SORT_PARALLEL_THRESHOLD rows are
+ *                sorted by one thread.
+ */
+void sort_dataset(dataset_t *dataset, const dataset_sort_key_t *keys,
+                  size_t count, size_t threads);
+
 #endif // C_PROGRAMS_DATA_H
@@ -0,0 +1,698 @@
+#include "group.h"
+#include "../Panic/panic.h"
+#include "../Parallel/parallel.h"
+#include "../String/number.h"
+
+#include <stdint.h>
+#include <string.h>
+
+static const size_t INITIAL_CAPACITY = 64;
+
+// Seeds the hashes of distinct values apart from those of the groups.
+static const uint64_t DISTINCT_SEED = 0x9e3779b97f4a7c15ULL;
+
+static const char *AGGREGATE_NAMES[] = {"count", "sum",  "min",
+                                        "max",   "mean", "count_distinct"};
+
+static const string_t EMPTY = {0, (uint8_t *)""};
+
+// SECTION: Hash tables.
+
+// A slot refers to entry index - 1 of its table; 0 marks an empty slot.
+typedef struct group_slot {
+  uint64_t hash;
+  size_t index;
+} group_slot_t;
+
+typedef struct slot_table {
+  size_t count;
+  size_t capacity;
+  group_slot_t *slots;
+} slot_table_t;
+
+static void init_slots(slot_table_t *table) {
+  table->count = 0;
+  table->capacity = INITIAL_CAPACITY;
+  table->slots = calloc(INITIAL_CAPACITY, sizeof(group_slot_t));
+  if (!table->slots) {
+    panic(stderr, "Could not allocate the group table.");
+  }
+}
+
+static group_slot_t *free_slot(slot_table_t *table, uint64_t hash) {
+  size_t mask = table->capacity - 1;
+  size_t index = hash & mask;
+  while (table->slots[index].index) {
+    index = (index + 1) & mask;
+  }
+  return &table->slots[index];
+}
+
+static void grow_slots(slot_table_t *table) {
+  group_slot_t *old = table->slots;
+  size_t old_capacity = table->capacity;
+  table->capacity *= 2;
+  table->slots = calloc(table->capacity, sizeof(group_slot_t));
+  if (!table->slots) {
+    panic(stderr, "Could not grow the group table.");
+  }
+  for (size_t i = 0; i < old_capacity; i++) {
+    if (old[i].index) {
+      *free_slot(table, old[i].hash) = old[i];
+    }
+  }
+  free(old);
+}
+
+// Fills the empty slot that a probe for the hash ended at.
+static void claim_slot(slot_table_t *table, group_slot_t *slot, uint64_t hash,
+                       size_t index) {
+  // Keep the load factor below 3/4 so probe sequences stay short.
+  if (4 * (table->count + 1) > 3 * table->capacity) {
+    grow_slots(table);
+    slot = free_slot(table, hash);
+  }
+  slot->hash = hash;
+  slot->index = index + 1;
+  table->count++;
+}
+
+// SECTION: Partitions.
+
+// Rows are hashed a block at a time, so that the slots of the whole block
+// can be prefetched before the first one is probed.
+#define BLOCK_ROWS 16
+
+typedef struct accumulator {
+  double value;
+  size_t count;
+} accumulator_t;
+
+// The bytes [start, start + len) of the bytes of a partition.
+typedef struct byte_span {
+  size_t start;
+  size_t len;
+} byte_span_t;
+
+// A distinct value of the column of an aggregate in a group.
+typedef struct distinct_value {
+  uint64_t hash;
+  size_t group;
+  size_t aggregate;
+  byte_span_t value;
+} distinct_value_t;
+
+/*
+ * The groups that one thread found in one partition of the hash space.
+ * Group i was first seen in rows[i], and its aggregates are
+ * accumulators[i * aggregate_count] onwards. The key values of the groups
+ * and the distinct values are copied into bytes, so that a probe compares
+ * them in a few contiguous bytes instead of in a record anywhere in the
+ * dataset. Counts of distinct values are only known once every distinct
+ * value of the partition is in values.
+ */
+typedef struct partition {
+  slot_table_t groups;
+  uint64_t *hashes;
+  size_t *rows;
+  byte_span_t *keys;
+  accumulator_t *accumulators;
+  size_t count;
+  size_t capacity;
+  slot_table_t distinct;
+  distinct_value_t *values;
+  size_t value_count;
+  size_t value_capacity;
+  uint8_t *bytes;
+  size_t byte_count;
+  size_t byte_capacity;
+} partition_t;
+
+typedef struct group_job {
+  const dataset_t *dataset;
+  const size_t *keys;
+  size_t key_count;
+  const aggregate_t *aggregates;
+  size_t aggregate_count;
+  size_t threads;
+  // Partition p of thread t is partitions[t * threads + p].
+  partition_t *partitions;
+} group_job_t;
+
+static inline const string_t *value_at(const dataset_t *dataset, size_t row,
+                                       size_t col) {
+  const string_t *value = dataset_value(dataset, row, col);
+  return value ? value : &EMPTY;
+}
+
+// Appends bytes to a growable buffer, and returns where they start.
+static size_t append_bytes(uint8_t **bytes, size_t *count, size_t *capacity,
+                           const void *data, size_t len) {
+  if (*capacity - *count < len) {
+    while (*capacity - *count < len) {
+      *capacity = *capacity ? *capacity * 2 : 4096;
+    }
+    *bytes = realloc(*bytes, *capacity);
+    if (!*bytes) {
+      panic(stderr, "Could not grow the group bytes.");
+    }
+  }
+  size_t start = *count;
+  if (len > 0) {
+    memcpy(*bytes + start, data, len);
+  }
+  *count += len;
+  return start;
+}
+
+static byte_span_t store_bytes(partition_t *partition, const uint8_t *data,
+                               size_t len) {
+  byte_span_t span;
+  span.start = append_bytes(&partition->bytes, &partition->byte_count,
+                            &partition->byte_capacity, data, len);
+  span.len = len;
+  return span;
+}
+
+static inline bool span_equals(const partition_t *partition, byte_span_t span,
+                               const uint8_t *data, size_t len) {
+  return span.len == len &&
+         (len == 0 || memcmp(partition->bytes + span.start, data, len) == 0);
+}
+
+/*
+ * The key values of a row, each but the last after its length, so that two
+ * rows have the same keys exactly when their keys have the same bytes. The
+ * bytes of a single key are just its value.
+ */
+static void serialize_keys(const group_job_t *job, size_t row, uint8_t **bytes,
+                           size_t *count, size_t *capacity) {
+  for (size_t k = 0; k < job->key_count; k++) {
+    const string_t *value = value_at(job->dataset, row, job->keys[k]);
+    if (k + 1 < job->key_count) {
+      append_bytes(bytes, count, capacity, &value->len, sizeof(value->len));
+    }
+    append_bytes(bytes, count, capacity, value->data, value->len);
+  }
+}
+
+// The high bits of the hash pick the partition, the low bits the slot.
+static inline size_t partition_of(uint64_t hash, size_t partitions) {
+  return (size_t)(((hash >> 32) * partitions) >> 32);
+}
+
+static group_slot_t *find_group(const partition_t *partition, uint64_t hash,
+                                const uint8_t *key, size_t len) {
+  const slot_table_t *table = &partition->groups;
+  size_t mask = table->capacity - 1;
+  size_t index = hash & mask;
+  while (true) {
+    group_slot_t *slot = &table->slots[index];
+    if (!slot->index) {
+      return slot;
+    }
+    if (slot->hash == hash &&
+        span_equals(partition, partition->keys[slot->index - 1], key, len)) {
+      return slot;
+    }
+    index = (index + 1) & mask;
+  }
+}
+
+static size_t add_group(const group_job_t *job, partition_t *partition,
+                        group_slot_t *slot, uint64_t hash, size_t row,
+                        const uint8_t *key, size_t len) {
+  const size_t width = job->aggregate_count;
+  if (partition->count == partition->capacity) {
+    partition->capacity =
+        partition->capacity ? partition->capacity * 2 : INITIAL_CAPACITY;
+    partition->hashes =
+        realloc(partition->hashes, partition->capacity * sizeof(uint64_t));
+    partition->rows =
+        realloc(partition->rows, partition->capacity * sizeof(size_t));
+    partition->keys =
+        realloc(partition->keys, partition->capacity * sizeof(byte_span_t));
+    partition->accumulators =
+        realloc(partition->accumulators,
+                (partition->capacity * width + 1) * sizeof(accumulator_t));
+    if (!partition->hashes || !partition->rows || !partition->keys ||
+        !partition->accumulators) {
+      panic(stderr, "Could not grow the groups.");
+    }
+  }
+  size_t group = partition->count++;
+  partition->hashes[group] = hash;
+  partition->rows[group] = row;
+  partition->keys[group] = store_bytes(partition, key, len);
+  memset(&partition->accumulators[group * width], 0,
+         width * sizeof(accumulator_t));
+  claim_slot(&partition->groups, slot, hash, group);
+  return group;
+}
+
+static group_slot_t *find_value(const partition_t *partition, uint64_t hash,
+                                size_t group, size_t aggregate,
+                                const uint8_t *data, size_t len) {
+  const slot_table_t *table = &partition->distinct;
+  size_t mask = table->capacity - 1;
+  size_t index = hash & mask;
+  while (true) {
+    group_slot_t *slot = &table->slots[index];
+    if (!slot->index) {
+      return slot;
+    }
+    const distinct_value_t *value = &partition->values[slot->index - 1];
+    if (slot->hash == hash && value->group == group &&
+        value->aggregate == aggregate &&
+        span_equals(partition, value->value, data, len)) {
+      return slot;
+    }
+    index = (index + 1) & mask;
+  }
+}
+
+static void add_value(partition_t *partition, group_slot_t *slot,
+                      uint64_t hash, size_t group, size_t aggregate,
+                      const uint8_t *data, size_t len) {
+  if (partition->value_count == partition->value_capacity) {
+    partition->value_capacity = partition->value_capacity
+                                    ? partition->value_capacity * 2
+                                    : INITIAL_CAPACITY;
+    partition->values =
+        realloc(partition->values,
+                partition->value_capacity * sizeof(distinct_value_t));
+    if (!partition->values) {
+      panic(stderr, "Could not grow the distinct values.");
+    }
+  }
+  distinct_value_t *value = &partition->values[partition->value_count];
+  value->hash = hash;
+  value->group = group;
+  value->aggregate = aggregate;
+  value->value = store_bytes(partition, data, len);
+  claim_slot(&partition->distinct, slot, hash, partition->value_count++);
+}
+
+static void free_partition(partition_t *partition) {
+  free(partition->groups.slots);
+  free(partition->hashes);
+  free(partition->rows);
+  free(partition->keys);
+  free(partition->accumulators);
+  free(partition->distinct.slots);
+  free(partition->values);
+  free(partition->bytes);
+}
+
+// SECTION: Aggregation.
+
+static void accumulate(accumulator_t *accumulator, aggregate_kind_t kind,
+                       const string_t *value) {
+  double number;
+  if (!string_to_double(value, &number) || number != number) {
+    return;
+  }
+  switch (kind) {
+  case AGGREGATE_MIN:
+    if (!accumulator->count || number < accumulator->value) {
+      accumulator->value = number;
+    }
+    break;
+  case AGGREGATE_MAX:
+    if (!accumulator->count || number > accumulator->value) {
+      accumulator->value = number;
+    }
+    break;
+  default:
+    accumulator->value += number;
+    break;
+  }
+  accumulator->count++;
+}
+
+static void combine(accumulator_t *into, const accumulator_t *from,
+                    aggregate_kind_t kind) {
+  if (from->count == 0) {
+    return;
+  }
+  switch (kind) {
+  case AGGREGATE_MIN:
+    if (!into->count || from->value < into->value) {
+      into->value = from->value;
+    }
+    break;
+  case AGGREGATE_MAX:
+    if (!into->count || from->value > into->value) {
+      into->value = from->value;
+    }
+    break;
+  default:
+    into->value += from->value;
+    break;
+  }
+  into->count += from->count;
+}
+
+static void aggregate_row(const group_job_t *job, partition_t *partition,
+                          size_t group, size_t row) {
+  const size_t width = job->aggregate_count;
+  accumulator_t *accumulators = &partition->accumulators[group * width];
+  for (size_t a = 0; a < width; a++) {
+    const aggregate_t *aggregate = &job->aggregates[a];
+    if (aggregate->kind == AGGREGATE_COUNT) {
+      accumulators[a].count++;
+      continue;
+    }
+    const string_t *value = value_at(job->dataset, row, aggregate->column);
+    if (aggregate->kind != AGGREGATE_COUNT_DISTINCT) {
+      accumulate(&accumulators[a], aggregate->kind, value);
+    } else if (value->len > 0) {
+      uint64_t hash = string_hash(
+          value, partition->hashes[group] ^ DISTINCT_SEED * (a + 1));
+      group_slot_t *slot =
+          find_value(partition, hash, group, a, value->data, value->len);
+      if (!slot->index) {
+        add_value(partition, slot, hash, group, a, value->data, value->len);
+      }
+    }
+  }
+}
+
+// Adds the rows of one slice of the dataset to the partitions of a thread.
+static void aggregate_slice(void *context, size_t index) {
+  group_job_t *job = context;
+  const size_t rows = job->dataset->rows;
+  const size_t threads = job->threads;
+  partition_t *partitions = &job->partitions[index * threads];
+  const size_t start = rows / threads * index;
+  const size_t end =
+      index + 1 == threads ? rows : rows / threads * (index + 1);
+  uint8_t *keys = NULL;
+  size_t capacity = 0;
+  const uint8_t *key_data[BLOCK_ROWS];
+  size_t key_lens[BLOCK_ROWS];
+  uint64_t hashes[BLOCK_ROWS];
+  for (size_t block = start; block < end; block += BLOCK_ROWS) {
+    const size_t count = end - block < BLOCK_ROWS ? end - block : BLOCK_ROWS;
+    if (job->key_count == 1) {
+      // The value is its own key, and needs no copy.
+      for (size_t i = 0; i < count; i++) {
+        const string_t *value =
+            value_at(job->dataset, block + i, job->keys[0]);
+        key_data[i] = value->data;
+        key_lens[i] = value->len;
+      }
+    } else {
+      size_t len = 0;
+      for (size_t i = 0; i < count; i++) {
+        size_t from = len;
+        serialize_keys(job, block + i, &keys, &len, &capacity);
+        key_lens[i] = len - from;
+      }
+      for (size_t i = 0, from = 0; i < count; from += key_lens[i++]) {
+        key_data[i] = keys + from;
+      }
+    }
+    for (size_t i = 0; i < count; i++) {
+      hashes[i] = string_hash_bytes(key_data[i], key_lens[i], 0);
+      const slot_table_t *table =
+          &partitions[partition_of(hashes[i], threads)].groups;
+      __builtin_prefetch(&table->slots[hashes[i] & (table->capacity - 1)]);
+    }
+    for (size_t i = 0; i < count; i++) {
+      partition_t *partition = &partitions[partition_of(hashes[i], threads)];
+      group_slot_t *slot =
+          find_group(partition, hashes[i], key_data[i], key_lens[i]);
+      size_t group = slot->index ? slot->index - 1
+                                 : add_group(job, partition, slot, hashes[i],
+                                             block + i, key_data[i],
+                                             key_lens[i]);
+      aggregate_row(job, partition, group, block + i);
+    }
+  }
+  free(keys);
+}
+
+/*
+ * Merges one partition of every thread into that of the first thread, and
+ * then counts the distinct values of its groups.
+ */
+static void merge_partition(void *context, size_t index) {
+  group_job_t *job = context;
+  const size_t width = job->aggregate_count;
+  partition_t *into = &job->partitions[index];
+  for (size_t t = 1; t < job->threads; t++) {
+    const partition_t *from = &job->partitions[t * job->threads + index];
+    size_t *targets = malloc((from->count + 1) * sizeof(size_t));
+    if (!targets) {
+      panic(stderr, "Could not allocate the merge of the groups.");
+    }
+    // The slices are in row order, so a group keeps its first row.
+    for (size_t g = 0; g < from->count; g++) {
+      const uint8_t *key = from->bytes + from->keys[g].start;
+      const size_t len = from->keys[g].len;
+      group_slot_t *slot = find_group(into, from->hashes[g], key, len);
+      size_t target = slot->index ? slot->index - 1
+                                  : add_group(job, into, slot, from->hashes[g],
+                                              from->rows[g], key, len);
+      targets[g] = target;
+      for (size_t a = 0; a < width; a++) {
+        combine(&into->accumulators[target * width + a],
+                &from->accumulators[g * width + a], job->aggregates[a].kind);
+      }
+    }
+    for (size_t v = 0; v < from->value_count; v++) {
+      const distinct_value_t *value = &from->values[v];
+      const uint8_t *data = from->bytes + value->value.start;
+      size_t group = targets[value->group];
+      group_slot_t *slot = find_value(into, value->hash, group,
+                                      value->aggregate, data, value->value.len);
+      if (!slot->index) {
+        add_value(into, slot, value->hash, group, value->aggregate, data,
+                  value->value.len);
+      }
+    }
+    free(targets);
+  }
+  for (size_t v = 0; v < into->value_count; v++) {
+    const distinct_value_t *value = &into->values[v];
+    into->accumulators[value->group * width + value->aggregate].count++;
+  }
+}
+
+// SECTION: Results.
+
+typedef struct group_ref {
+  size_t row;
+  const partition_t *partition;
+  size_t group;
+} group_ref_t;
+
+static int compare_refs(const void *left, const void *right) {
+  size_t a = ((const group_ref_t *)left)->row;
+  size_t b = ((const group_ref_t *)right)->row;
+  return (a > b) - (a < b);
+}
+
+// A growable text with the end of every value of one output row.
+typedef struct row_text {
+  size_t *ends;
+  size_t count;
+  uint8_t *bytes;
+  size_t len;
+  size_t capacity;
+} row_text_t;
+
+static uint8_t *reserve_text(row_text_t *text, size_t len) {
+  if (text->capacity - text->len < len) {
+    while (text->capacity - text->len < len) {
+      text->capacity = text->capacity ? text->capacity * 2 : 256;
+    }
+    text->bytes = realloc(text->bytes, text->capacity);
+    if (!text->bytes) {
+      panic(stderr, "Could not grow the group text.");
+    }
+  }
+  return text->bytes + text->len;
+}
+
+static void append_text(row_text_t *text, const uint8_t *data, size_t len) {
+  if (len > 0) {
+    memcpy(reserve_text(text, len), data, len);
+    text->len += len;
+  }
+}
+
+static void end_value(row_text_t *text) {
+  text->ends[text->count++] = text->len;
+}
+
+static record_t *pack_text(const row_text_t *text) {
+  return new_packed_record(text->count, text->ends, 0, text->bytes, text->len,
+                           true);
+}
+
+static record_t *pack_header(const group_job_t *job, row_text_t *text) {
+  text->count = 0;
+  text->len = 0;
+  for (size_t k = 0; k < job->key_count; k++) {
+    const string_t *name = dataset_column_name(job->dataset, job->keys[k]);
+    name = name ? name : &EMPTY;
+    append_text(text, name->data, name->len);
+    end_value(text);
+  }
+  for (size_t a = 0; a < job->aggregate_count; a++) {
+    const aggregate_t *aggregate = &job->aggregates[a];
+    const char *kind = AGGREGATE_NAMES[aggregate->kind];
+    append_text(text, (const uint8_t *)kind, strlen(kind));
+    if (aggregate->kind != AGGREGATE_COUNT) {
+      const string_t *name =
+          dataset_column_name(job->dataset, aggregate->column);
+      name = name ? name : &EMPTY;
+      append_text(text, (const uint8_t *)"(", 1);
+      append_text(text, name->data, name->len);
+      append_text(text, (const uint8_t *)")", 1);
+    }
+    end_value(text);
+  }
+  return pack_text(text);
+}
+
+static record_t *pack_group(const group_job_t *job, const group_ref_t *ref,
+                            row_text_t *text) {
+  text->count = 0;
+  text->len = 0;
+  for (size_t k = 0; k < job->key_count; k++) {
+    const string_t *value = value_at(job->dataset, ref->row, job->keys[k]);
+    append_text(text, value->data, value->len);
+    end_value(text);
+  }
+  const accumulator_t *accumulators =
+      &ref->partition->accumulators[ref->group * job->aggregate_count];
+  for (size_t a = 0; a < job->aggregate_count; a++) {
+    const accumulator_t *accumulator = &accumulators[a];
+    uint8_t *out = reserve_text(text, NUMBER_BUFFER_SIZE);
+    switch (job->aggregates[a].kind) {
+    case AGGREGATE_COUNT:
+    case AGGREGATE_COUNT_DISTINCT:
+      text->len += format_int64((int64_t)accumulator->count, out);
+      break;
+    case AGGREGATE_SUM:
+      text->len += format_double(accumulator->value, out);
+      break;
+    case AGGREGATE_MEAN:
+      if (accumulator->count) {
+        text->len += format_double(
+            accumulator->value / (double)accumulator->count, out);
+      }
+      break;
+    default:
+      if (accumulator->count) {
+        text->len += format_double(accumulator->value, out);
+      }
+      break;
+    }
+    end_value(text);
+  }
+  return pack_text(text);
+}
+
+static dataset_t *collect_groups(const group_job_t *job) {
+  size_t total = 0;
+  for (size_t p = 0; p < job->threads; p++) {
+    total += job->partitions[p].count;
+  }
+  group_ref_t *refs = malloc((total + 1) * sizeof(group_ref_t));
+  string_cache_t *cache = malloc(sizeof(string_cache_t));
+  record_t **records = malloc((total + 1) * sizeof(record_t *));
+  row_text_t text = {NULL, 0, NULL, 0, 0};
+  text.ends = malloc((job->key_count + job->aggregate_count + 1) *
+                     sizeof(size_t));
+  if (!refs || !cache || !records || !text.ends) {
+    panic(stderr, "Could not allocate the groups.");
+  }
+  size_t count = 0;
+  for (size_t p = 0; p < job->threads; p++) {
+    const partition_t *partition = &job->partitions[p];
+    for (size_t g = 0; g < partition->count; g++) {
+      refs[count].row = partition->rows[g];
+      refs[count].partition = partition;
+      refs[count].group = g;
+      count++;
+    }
+  }
+  qsort(refs, total, sizeof(group_ref_t), compare_refs);
+  cache->cols = job->key_count + job->aggregate_count;
+  cache->rows = total;
+  cache->header = pack_header(job, &text);
+  cache->records = records;
+  cache->references = 1;
+  for (size_t i = 0; i < total; i++) {
+    records[i] = pack_group(job, &refs[i], &text);
+  }
+  free(text.ends);
+  free(text.bytes);
+  free(refs);
+  dataset_t *result = new_dataset(cache);
+  free_cache(cache);
+  return result;
+}
+
+dataset_t *group_dataset(const dataset_t *dataset, const size_t *keys,
+                         size_t key_count, const aggregate_t *aggregates,
+                         size_t aggregate_count, size_t threads) {
+  if (!dataset) {
+    panic(stderr, "Dataset pointer is empty.");
+  }
+  if ((!keys && key_count > 0) || (!aggregates && aggregate_count > 0)) {
+    panic(stderr, "Key or aggregate array is empty.");
+  }
+  for (size_t k = 0; k < key_count; k++) {
+    if (keys[k] >= dataset->cols) {
+      panic(stderr, "Key column is out of the dataset.");
+    }
+  }
+  for (size_t a = 0; a < aggregate_count; a++) {
+    if (aggregates[a].kind > AGGREGATE_COUNT_DISTINCT) {
+      panic(stderr, "Unknown aggregate.");
+    }
+    if (aggregates[a].kind != AGGREGATE_COUNT &&
+        aggregates[a].column >= dataset->cols) {
+      panic(stderr, "Aggregate column is out of the dataset.");
+    }
+  }
+  threads = resolve_threads(threads);
+  size_t most = dataset->rows / GROUP_PARALLEL_ROWS;
+  threads = threads < most ? threads : most;
+  threads = threads > 0 ? threads : 1;
+
+  group_job_t job;
+  job.dataset = dataset;
+  job.keys = keys;
+  job.key_count = key_count;
+  job.aggregates = aggregates;
+  job.aggregate_count = aggregate_count;
+  job.threads = threads;
+  job.partitions = calloc(threads * threads, sizeof(partition_t));
+  if (!job.partitions) {
+    panic(stderr, "Could not allocate the partitions.");
+  }
+  for (size_t p = 0; p < threads * threads; p++) {
+    init_slots(&job.partitions[p].groups);
+    init_slots(&job.partitions[p].distinct);
+  }
+  run_workers(threads, aggregate_slice, &job);
+  run_workers(threads, merge_partition, &job);
+  if (key_count == 0 && job.partitions[0].count == 0) {
+    // Without keys there is one group, even of no rows.
+    partition_t *partition = &job.partitions[0];
+    add_group(&job, partition, find_group(partition, 0, NULL, 0), 0, 0, NULL,
+              0);
+  }
+  dataset_t *result = collect_groups(&job);
+  for (size_t p = 0; p < threads * threads; p++) {
+    free_partition(&job.partitions[p]);
+  }
+  free(job.partitions);
+  return result;
+}
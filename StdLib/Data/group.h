@@ -0,0 +1,91 @@
+#ifndef C_PROGRAMS_GROUP_H
+#define C_PROGRAMS_GROUP_H
+/**
+ * Group-by and aggregation over datasets.
+ *
+ * The rows of a dataset are grouped by the values of one or more key
+ * columns, and every group gets one row of aggregates: counts, sums,
+ * minimums, maximums, means and counts of distinct values. A missing value
+ * is the same as an empty one, both in keys and in aggregates.
+ *
+ * Groups are found with open-addressing hash tables keyed by the hash of the
+ * key values of a row. Each table keeps a copy of the key values of its
+ * groups in one buffer, so a probe compares contiguous bytes rather than
+ * chasing the record of another row, and rows are hashed in small blocks
+ * whose slots are prefetched together.
+ *
+ * With several threads, every thread aggregates a slice of the rows into
+ * one table per partition of the hash space, and then every thread merges
+ * the tables of one partition from all the threads. A group only ever lives
+ * in one partition, so the merges need no locks.
+ */
+#include "data.h"
+
+#include <stddef.h>
+
+/**
+ * The aggregates of a group. Sums, minimums, maximums and means are over the
+ * values of a column that are numbers, as read by string_to_double; other
+ * values (empty ones, "nan", text) are skipped, like nulls in SQL.
+ *
+ * - AGGREGATE_COUNT counts the rows of the group, whatever the column.
+ * - AGGREGATE_SUM is 0 for a group without numbers.
+ * - AGGREGATE_MIN, AGGREGATE_MAX and AGGREGATE_MEAN are empty for a group
+ *   without numbers.
+ * - AGGREGATE_COUNT_DISTINCT counts the distinct values of the column in the
+ *   group, without the empty value.
+ */
+typedef enum aggregate_kind {
+  AGGREGATE_COUNT,
+  AGGREGATE_SUM,
+  AGGREGATE_MIN,
+  AGGREGATE_MAX,
+  AGGREGATE_MEAN,
+  AGGREGATE_COUNT_DISTINCT
+} aggregate_kind_t;
+
+typedef struct aggregate {
+  aggregate_kind_t kind;
+  size_t column;
+} aggregate_t;
+
+/**
+ * Datasets with fewer rows than this per thread are grouped by fewer
+ * threads.
+ */
+#define GROUP_PARALLEL_ROWS (64 * 1024)
+
+/**
+ * Groups the rows of a dataset and computes aggregates for every group.
+ *
+ * The result has one row per group, in the order in which the groups first
+ * appear in the dataset. Its columns are the key columns, with their values
+ * taken from the first row of each group, and then one column per
+ * aggregate, named after the aggregate and its column: "count",
+ * "sum(price)", "min(price)", "max(price)", "mean(price)" and
+ * "count_distinct(name)". Numbers are written as format_double and
+ * format_int64 write them.
+ *
+ * Without keys, all rows form a single group, and the result has one row
+ * even if the dataset has none.
+ *
+ * Sums and means may differ in the last bits with the number of threads,
+ * since the values are added in another order.
+ *
+ * @param dataset         The dataset to group.
+ * @param keys            The columns to group by, each less than
+ *                        dataset->cols.
+ * @param key_count       The number of key columns.
+ * @param aggregates      The aggregates to compute, each of a column less
+ *                        than dataset->cols (any column for counts).
+ * @param aggregate_count The number of aggregates.
+ * @param threads         The number of threads to use, 0 for one per
+ *                        processor.
+ * @return A new dataset over a new cache; free_dataset also releases the
+ *         cache.
+ */
+dataset_t *group_dataset(const dataset_t *dataset, const size_t *keys,
+                         size_t key_count, const aggregate_t *aggregates,
+                         size_t aggregate_count, size_t threads);
+
+#endif // C_PROGRAMS_GROUP_H
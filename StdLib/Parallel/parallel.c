@@ -0,0 +1,52 @@
+#include "parallel.h"
+#include "../Panic/panic.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+size_t resolve_threads(size_t threads) {
+  if (threads > 0) {
+    return threads;
+  }
+  long processors = sysconf(_SC_NPROCESSORS_ONLN);
+  return processors > 0 ? (size_t)processors : 1;
+}
+
+typedef struct worker {
+  worker_func_t work;
+  void *context;
+  size_t index;
+} worker_t;
+
+static void *start_worker(void *argument) {
+  worker_t *worker = argument;
+  worker->work(worker->context, worker->index);
+  return NULL;
+}
+
+void run_workers(size_t workers, worker_func_t work, void *context) {
+  if (!work || workers == 0) {
+    panic(stderr, "Work function is empty or there are no workers.");
+  }
+  pthread_t *threads = malloc(workers * sizeof(pthread_t));
+  worker_t *states = malloc(workers * sizeof(worker_t));
+  if (!threads || !states) {
+    panic(stderr, "Could not allocate the worker threads.");
+  }
+  for (size_t t = 0; t < workers; t++) {
+    states[t].work = work;
+    states[t].context = context;
+    states[t].index = t;
+    if (t > 0 &&
+        pthread_create(&threads[t], NULL, start_worker, &states[t]) != 0) {
+      panic(stderr, "Could not start a worker thread.");
+    }
+  }
+  work(context, 0);
+  for (size_t t = 1; t < workers; t++) {
+    pthread_join(threads[t], NULL);
+  }
+  free(threads);
+  free(states);
+}
@@ -0,0 +1,34 @@
+#ifndef C_PROGRAMS_PARALLEL_H
+#define C_PROGRAMS_PARALLEL_H
+/**
+ * Fork-join parallelism for the parts of the library that split their work
+ * between threads: a number of workers run the same function on a shared
+ * job, each with its own index, and the caller waits for all of them.
+ */
+#include <stddef.h>
+
+/**
+ * The work of one worker. Every worker gets the same context and an index
+ * of its own, from 0 to the number of workers - 1.
+ */
+typedef void (*worker_func_t)(void *context, size_t index);
+
+/**
+ * @param threads A number of threads, or 0 for one per processor.
+ * @return The number of threads to use: threads itself, or the number of
+ *         online processors (at least 1) if it is 0.
+ */
+size_t resolve_threads(size_t threads);
+
+/**
+ * Runs work(context, index) for every index below workers, and returns when
+ * all of them have finished. Worker 0 runs on the calling thread and every
+ * other one on a thread of its own.
+ *
+ * @param workers The number of workers, at least 1.
+ * @param work    The function every worker runs.
+ * @param context The job that the workers share.
+ */
+void run_workers(size_t workers, worker_func_t work, void *context);
+
+#endif // C_PROGRAMS_PARALLEL_H
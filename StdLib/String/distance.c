@@ -0,0 +1,309 @@
+#include "distance.h"
+#include "../Panic/panic.h"
+#include "simd.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// SECTION: Patterns.
+//
+// One string (the pattern) is turned into bit masks: bit i of
+// masks[b * 256 + c] is set when byte 64 * b + i of the pattern is c. The
+// other string (the text) is then read one byte at a time, and each byte
+// advances a column of the dynamic programming table by one. A column is
+// stored as its vertical differences: bit i of positive (negative) is set
+// when cell i + 1 is one more (one less) than cell i.
+
+typedef struct pattern {
+  size_t len;
+  size_t blocks;
+  uint64_t *masks;
+  uint64_t *positive;
+  uint64_t *negative;
+  size_t *scores; // The value of the last cell of each block.
+  uint64_t small_masks[256];
+  uint64_t small_state[2];
+  size_t small_score;
+} pattern_t;
+
+static void prepare(pattern_t *pattern, const uint8_t *data, size_t len,
+                    bool reversed) {
+  pattern->len = len;
+  pattern->blocks = (len + 63) / 64;
+  if (pattern->blocks <= 1) {
+    pattern->masks = pattern->small_masks;
+    pattern->positive = pattern->small_state;
+    pattern->negative = pattern->small_state + 1;
+    pattern->scores = &pattern->small_score;
+    memset(pattern->small_masks, 0, sizeof(pattern->small_masks));
+  } else {
+    const size_t blocks = pattern->blocks;
+    uint64_t *memory = calloc(blocks * (256 + 3), sizeof(uint64_t));
+    if (!memory) {
+      panic(stderr, "Could not allocate the pattern masks.");
+    }
+    pattern->masks = memory;
+    pattern->positive = memory + blocks * 256;
+    pattern->negative = pattern->positive + blocks;
+    pattern->scores = (size_t *)(pattern->negative + blocks);
+  }
+  for (size_t i = 0; i < len; i++) {
+    uint8_t byte = reversed ? data[len - 1 - i] : data[i];
+    pattern->masks[(i >> 6) * 256 + byte] |= 1ULL << (i & 63);
+  }
+}
+
+static void release(pattern_t *pattern) {
+  if (pattern->masks != pattern->small_masks) {
+    free(pattern->masks);
+  }
+}
+
+// Resets block b to the first column, where cell i holds i.
+static void reset_block(pattern_t *pattern, size_t b) {
+  pattern->positive[b] = ~0ULL;
+  pattern->negative[b] = 0;
+  size_t bottom = 64 * (b + 1);
+  pattern->scores[b] = bottom < pattern->len ? bottom : pattern->len;
+}
+
+// Advances one block by a column. carry is the horizontal difference of the
+// cell above the block (-1, 0 or 1); the horizontal differences of the
+// block's own cells are returned in up and down.
+static inline void advance(uint64_t *positive, uint64_t *negative,
+                           uint64_t matches, int carry, uint64_t *up,
+                           uint64_t *down) {
+  uint64_t pv = *positive, nv = *negative;
+  uint64_t xv = matches | nv;
+  if (carry < 0) {
+    matches |= 1;
+  }
+  uint64_t xh = (((matches & pv) + pv) ^ pv) | matches;
+  uint64_t ph = nv | ~(xh | pv);
+  uint64_t nh = pv & xh;
+  *up = ph;
+  *down = nh;
+  ph = ph << 1 | (uint64_t)(carry > 0);
+  nh = nh << 1 | (uint64_t)(carry < 0);
+  *positive = nh | ~(xv | ph);
+  *negative = ph & xv;
+}
+
+static inline int difference(uint64_t up, uint64_t down, unsigned bit) {
+  return (int)((up >> bit) & 1) - (int)((down >> bit) & 1);
+}
+
+// SECTION: Distances.
+
+// Checks whether every cell of a block is above the bound. A cell is at
+// least the last cell of its block minus the increases below it.
+static bool block_exceeds(const pattern_t *pattern, size_t b, size_t score,
+                          uint64_t positive, size_t bound) {
+  if (b == pattern->blocks - 1 && (pattern->len & 63)) {
+    positive &= (1ULL << (pattern->len & 63)) - 1;
+  }
+  return score > bound + population_count(positive);
+}
+
+static size_t single_block_distance(pattern_t *pattern, const uint8_t *text,
+                                    size_t n, size_t bound) {
+  const unsigned last = (unsigned)((pattern->len - 1) & 63);
+  const uint64_t *masks = pattern->masks;
+  uint64_t positive = ~0ULL, negative = 0, up, down;
+  size_t score = pattern->len;
+  for (size_t j = 0; j < n; j++) {
+    advance(&positive, &negative, masks[text[j]], 1, &up, &down);
+    score += (size_t)difference(up, down, last);
+    // Every path to the last cell crosses this column, and the cell in the
+    // first row is j + 1.
+    if (j >= bound && block_exceeds(pattern, 0, score, positive, bound)) {
+      return bound + 1;
+    }
+  }
+  return score <= bound ? score : bound + 1;
+}
+
+// The edit distance between the pattern and the text if it is at most
+// bound, and bound + 1 otherwise.
+//
+// A cell in row i and column j is at least |i - j|, so only the rows within
+// bound of the column can be part of a path with a cost of at most bound.
+// The blocks outside that band are not computed: the band ends at a block
+// whose top is taken to grow by one per column, and new blocks join the band
+// as if their cells increased by one from the cell above them. Both only
+// overestimate cells that are above the bound anyway, which leaves every
+// cell within the bound exact (Ukkonen's cutoff).
+static size_t global_distance(pattern_t *pattern, const uint8_t *text,
+                              size_t n, size_t bound) {
+  const size_t m = pattern->len;
+  if (m == 0 || n == 0) {
+    size_t distance = m + n;
+    return distance <= bound ? distance : bound + 1;
+  }
+  if ((m > n ? m - n : n - m) > bound) {
+    return bound + 1;
+  }
+  if (bound > m + n) {
+    bound = m + n;
+  }
+  if (pattern->blocks == 1) {
+    return single_block_distance(pattern, text, n, bound);
+  }
+
+  const size_t last_block = pattern->blocks - 1;
+  const unsigned last = (unsigned)((m - 1) & 63);
+  size_t top = 0, bottom = 0;
+  reset_block(pattern, 0);
+  for (size_t j = 1; j <= n; j++) {
+    size_t lowest = j + bound < m ? j + bound : m;
+    size_t highest = j > bound ? j - bound : 1;
+    while (bottom < (lowest - 1) / 64) {
+      bottom++;
+      pattern->positive[bottom] = ~0ULL;
+      pattern->negative[bottom] = 0;
+      size_t rows = bottom == last_block ? m - 64 * bottom : 64;
+      pattern->scores[bottom] = pattern->scores[bottom - 1] + rows;
+    }
+    top = (highest - 1) / 64;
+
+    const uint8_t byte = text[j - 1];
+    int carry = 1;
+    for (size_t b = top; b <= bottom; b++) {
+      uint64_t up, down;
+      advance(pattern->positive + b, pattern->negative + b,
+              pattern->masks[b * 256 + byte], carry, &up, &down);
+      carry = difference(up, down, 63);
+      pattern->scores[b] +=
+          (size_t)(b == last_block ? difference(up, down, last) : carry);
+    }
+
+    if (j > bound) {
+      bool exceeds = true;
+      for (size_t b = top; b <= bottom && exceeds; b++) {
+        exceeds = block_exceeds(pattern, b, pattern->scores[b],
+                                pattern->positive[b], bound);
+      }
+      if (exceeds) {
+        return bound + 1;
+      }
+    }
+  }
+  size_t score = pattern->scores[last_block];
+  return score <= bound ? score : bound + 1;
+}
+
+size_t string_edit_distance_within(const string_t *left, const string_t *right,
+                                   size_t max_distance) {
+  if (!left || !right) {
+    panic(stderr, "String pointer is empty.");
+  }
+  // The shorter string becomes the pattern, which needs fewer blocks.
+  if (left->len > right->len) {
+    const string_t *swap = left;
+    left = right;
+    right = swap;
+  }
+  pattern_t pattern;
+  prepare(&pattern, left->data, left->len, false);
+  size_t distance =
+      global_distance(&pattern, right->data, right->len, max_distance);
+  release(&pattern);
+  return distance;
+}
+
+size_t string_edit_distance(const string_t *left, const string_t *right) {
+  if (!left || !right) {
+    panic(stderr, "String pointer is empty.");
+  }
+  return string_edit_distance_within(left, right, left->len + right->len);
+}
+
+void string_edit_distances(const string_t *query, string_t *const candidates[],
+                           size_t count, size_t max_distance,
+                           size_t *distances) {
+  if (!query || !candidates || !distances) {
+    panic(stderr, "String or array pointer is empty.");
+  }
+  pattern_t pattern;
+  prepare(&pattern, query->data, query->len, false);
+  for (size_t i = 0; i < count; i++) {
+    if (!candidates[i]) {
+      panic(stderr, "String pointer is empty.");
+    }
+    distances[i] = global_distance(&pattern, candidates[i]->data,
+                                   candidates[i]->len, max_distance);
+  }
+  release(&pattern);
+}
+
+// SECTION: Approximate search.
+
+// Returns the first j such that the pattern is within bound edits of a
+// substring of the text ending at j, or n + 1 if there is none. With
+// anchored, the substring must start at 0; otherwise it may start anywhere,
+// which makes the first row 0 instead of j.
+static size_t first_end(pattern_t *pattern, const uint8_t *text, size_t n,
+                        size_t bound, bool anchored) {
+  const size_t m = pattern->len;
+  if (m <= bound) {
+    return 0;
+  }
+  const size_t last_block = pattern->blocks - 1;
+  const unsigned last = (unsigned)((m - 1) & 63);
+  for (size_t b = 0; b <= last_block; b++) {
+    reset_block(pattern, b);
+  }
+  size_t score = m;
+  for (size_t j = 0; j < n; j++) {
+    int carry = anchored ? 1 : 0;
+    for (size_t b = 0; b <= last_block; b++) {
+      uint64_t up, down;
+      advance(pattern->positive + b, pattern->negative + b,
+              pattern->masks[b * 256 + text[j]], carry, &up, &down);
+      carry = difference(up, down, 63);
+      if (b == last_block) {
+        score += (size_t)difference(up, down, last);
+      }
+    }
+    if (score <= bound) {
+      return j + 1;
+    }
+  }
+  return n + 1;
+}
+
+size_t index_of_string_approx(const string_t *bigger, const string_t *smaller,
+                              size_t max_distance) {
+  if (!bigger || !smaller) {
+    panic(stderr, "String pointer is empty.");
+  }
+  pattern_t pattern;
+  prepare(&pattern, smaller->data, smaller->len, false);
+  size_t end =
+      first_end(&pattern, bigger->data, bigger->len, max_distance, false);
+  release(&pattern);
+  if (end > bigger->len) {
+    return bigger->len + 1;
+  }
+
+  // The occurrence ending there that starts last is found by matching the
+  // reversed pattern against the text read backwards from the end. It is at
+  // most max_distance bytes longer than the pattern.
+  size_t window = smaller->len + max_distance;
+  if (window > end || window < smaller->len) {
+    window = end;
+  }
+  uint8_t *backwards = malloc(window ? window : 1);
+  if (!backwards) {
+    panic(stderr, "Could not allocate the search window.");
+  }
+  for (size_t i = 0; i < window; i++) {
+    backwards[i] = bigger->data[end - 1 - i];
+  }
+  prepare(&pattern, smaller->data, smaller->len, true);
+  size_t len = first_end(&pattern, backwards, window, max_distance, true);
+  release(&pattern);
+  free(backwards);
+  return end - len;
+}
@@ -0,0 +1,78 @@
+#ifndef C_PROGRAMS_DISTANCE_H
+#define C_PROGRAMS_DISTANCE_H
+/**
+ * Edit distances and approximate matching with Myers' bit-parallel
+ * algorithm ("A Fast Bit-Vector Algorithm for Approximate String Matching
+ * Based on Dynamic Programming", 1999), in the formulation of Hyyrö.
+ *
+ * The edit (Levenshtein) distance is the smallest number of single byte
+ * insertions, deletions and substitutions that turn one string into the
+ * other. The textbook dynamic program fills in a table of m x n cells; here
+ * one column of 64 cells is computed with a handful of word operations, so
+ * strings of up to 64 bytes cost a few instructions per byte of the other
+ * string. Longer strings are split into blocks of 64 bytes.
+ *
+ * When only small distances are of interest, the bounded variants compute
+ * just the cells that can still lead to a distance within the bound (a band
+ * around the diagonal), and give up as soon as every cell of a column is
+ * above it. Comparing dissimilar strings is then much cheaper than computing
+ * their exact distance.
+ */
+#include "string.h"
+
+#include <stddef.h>
+
+/**
+ * Computes the edit distance between two strings.
+ *
+ * @param left  The first string.
+ * @param right The second string.
+ * @return The number of insertions, deletions and substitutions needed to
+ *         turn one string into the other.
+ */
+size_t string_edit_distance(const string_t *left, const string_t *right);
+
+/**
+ * Same as string_edit_distance, but stops early once the distance is known
+ * to be larger than max_distance.
+ *
+ * @param left         The first string.
+ * @param right        The second string.
+ * @param max_distance The largest distance of interest.
+ * @return The edit distance if it is at most max_distance, otherwise
+ *         max_distance + 1.
+ */
+size_t string_edit_distance_within(const string_t *left, const string_t *right,
+                                   size_t max_distance);
+
+/**
+ * Computes the bounded edit distance between one query and many candidates,
+ * for example the values of a column. The query is preprocessed only once.
+ *
+ * @param query        The string to compare with every candidate.
+ * @param candidates   The candidates.
+ * @param count        The number of candidates.
+ * @param max_distance The largest distance of interest.
+ * @param distances    Receives count distances, each the same as the result
+ *                     of string_edit_distance_within.
+ */
+void string_edit_distances(const string_t *query, string_t *const candidates[],
+                           size_t count, size_t max_distance,
+                           size_t *distances);
+
+/**
+ * Finds the first approximate occurrence of the smaller string: a substring
+ * of the bigger one within max_distance edits of it. Of all such substrings,
+ * the one that ends first is chosen, and of those ending there, the shortest.
+ * With a max_distance of 0 this is the same as index_of_string.
+ *
+ * @param bigger       The string to be searched in.
+ * @param smaller      The string to be searched for.
+ * @param max_distance The number of edits allowed.
+ * @return The start of the occurrence, or a value greater than the length of
+ *         bigger if there is none.
+ */
+size_t index_of_string_approx(const string_t *bigger, const string_t *smaller,
+                              size_t max_distance);
+
+#endif // C_PROGRAMS_DISTANCE_H
@@ -0,0 +1,426 @@
+#include "encoding.h"
+#include "../Panic/panic.h"
+#include "simd.h"
+
+#include <stdint.h>
+
+// SECTION: Tables.
+//
+// The value of every byte as a digit, or X if it is not one.
+
+#define X 0xff
+static const uint8_t HEX_VALUES[256] = {
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, X, X, X, X, X, X,
+    X, 10, 11, 12, 13, 14, 15, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, 10, 11, 12, 13, 14, 15, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+};
+
+static const uint8_t BASE64_VALUES[2][256] = {{
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, 62, X, X, X, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, X, X, X, X, X, X,
+    X, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, X, X, X, X, X,
+    X, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+}, {
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, 62, X, X,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, X, X, X, X, X, X,
+    X, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, X, X, X, X, 63,
+    X, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+    X, X, X, X, X, X, X, X, X, X, X, X, X, X, X, X,
+}};
+#undef X
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+// What the alphabets need besides their digits: how the AVX2 code turns the
+// indices 62 and 63 into characters (added to the index), and, for the
+// other direction, a bit mask per high and per low nibble that have no bit
+// in common exactly for the characters of the alphabet, the value to add to
+// a character to get its index, by high nibble, and the one character that
+// needs a different value.
+typedef struct base64_info {
+  const char *digits;
+  const uint8_t *values;
+  int8_t encode_offsets[2];
+  uint8_t check_high[16];
+  uint8_t check_low[16];
+  int8_t shifts[16];
+  uint8_t special;
+  int8_t special_shift;
+} base64_info_t;
+
+static const base64_info_t ALPHABETS[2] = {
+    {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+     BASE64_VALUES[0],
+     {'+' - 62, '/' - 63},
+     {0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x08, 0x10, 0x01, 0x01, 0x01, 0x01,
+      0x01, 0x01, 0x01, 0x01},
+     {0x0b, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x07, 0x15,
+      0x17, 0x17, 0x17, 0x15},
+     {0, 0, 62 - '+', 52 - '0', -'A', -'A', 26 - 'a', 26 - 'a'},
+     '/',
+     63 - '/'},
+    {"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_",
+     BASE64_VALUES[1],
+     {'-' - 62, '_' - 63},
+     {0x01, 0x01, 0x02, 0x04, 0x08, 0x10, 0x08, 0x20, 0x01, 0x01, 0x01, 0x01,
+      0x01, 0x01, 0x01, 0x01},
+     {0x0b, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x07, 0x37,
+      0x37, 0x35, 0x37, 0x27},
+     {0, 0, 62 - '-', 52 - '0', -'A', -'A', 26 - 'a', 26 - 'a'},
+     '_',
+     63 - '_'},
+};
+
+static const base64_info_t *alphabet_info(base64_alphabet_t alphabet) {
+  if (alphabet != BASE64_STANDARD && alphabet != BASE64_URL) {
+    panic(stderr, "Unknown Base64 alphabet.");
+  }
+  return &ALPHABETS[alphabet];
+}
+
+static void check_output(const string_t *input, const string_t *output,
+                         size_t (*needed)(size_t)) {
+  if (!input || !output) {
+    panic(stderr, "String pointer is empty.");
+  }
+  if (output->len < needed(input->len)) {
+    panic(stderr, "Output string is too short.");
+  }
+}
+
+// SECTION: Hexadecimal.
+
+size_t hex_encoded_len(size_t len) { return 2 * len; }
+
+static size_t hex_decoded_len(size_t len) { return len / 2; }
+
+#if defined(STRING_HAS_SSE2)
+// Turns bytes holding values below 16 into digits.
+static inline __m128i hex_digits(__m128i values) {
+  __m128i letters = _mm_cmpgt_epi8(values, _mm_set1_epi8(9));
+  __m128i offsets = _mm_add_epi8(
+      _mm_set1_epi8('0'), _mm_and_si128(letters, _mm_set1_epi8('a' - '0' - 10)));
+  return _mm_add_epi8(values, offsets);
+}
+
+// Turns 16 digits into 8 bytes, each in the low half of a 16-bit lane.
+// Clears the bits of *valid for characters that are not digits.
+static inline __m128i hex_pairs(__m128i chars, __m128i *valid) {
+  __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+  __m128i letters = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)),
+                                 _mm_set1_epi8('a'));
+  __m128i is_digit =
+      _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+  __m128i is_letter =
+      _mm_cmpeq_epi8(_mm_min_epu8(letters, _mm_set1_epi8(5)), letters);
+  *valid = _mm_and_si128(*valid, _mm_or_si128(is_digit, is_letter));
+  __m128i values = _mm_or_si128(
+      _mm_and_si128(is_digit, digits),
+      _mm_and_si128(is_letter, _mm_add_epi8(letters, _mm_set1_epi8(10))));
+  // The first digit of a pair is the low byte of its lane.
+  return _mm_or_si128(
+      _mm_and_si128(_mm_slli_epi16(values, 4), _mm_set1_epi16(0xf0)),
+      _mm_srli_epi16(values, 8));
+}
+#endif
+
+void hex_encode(const string_t *input, string_t *output) {
+  check_output(input, output, hex_encoded_len);
+  const uint8_t *in = input->data;
+  uint8_t *out = output->data;
+  const size_t n = input->len;
+  size_t i = 0;
+#if defined(STRING_HAS_SSE2)
+  const __m128i low_nibbles = _mm_set1_epi8(0x0f);
+  for (; i + 16 <= n; i += 16) {
+    __m128i bytes = _mm_loadu_si128((const __m128i *)(in + i));
+    __m128i high = hex_digits(_mm_and_si128(_mm_srli_epi16(bytes, 4), low_nibbles));
+    __m128i low = hex_digits(_mm_and_si128(bytes, low_nibbles));
+    _mm_storeu_si128((__m128i *)(out + 2 * i), _mm_unpacklo_epi8(high, low));
+    _mm_storeu_si128((__m128i *)(out + 2 * i + 16),
+                     _mm_unpackhi_epi8(high, low));
+  }
+#endif
+  for (; i < n; i++) {
+    out[2 * i] = (uint8_t)HEX_DIGITS[in[i] >> 4];
+    out[2 * i + 1] = (uint8_t)HEX_DIGITS[in[i] & 0x0f];
+  }
+  output->len = 2 * n;
+}
+
+bool hex_decode(const string_t *input, string_t *output) {
+  check_output(input, output, hex_decoded_len);
+  if (input->len % 2 != 0) {
+    return false;
+  }
+  const uint8_t *in = input->data;
+  uint8_t *out = output->data;
+  const size_t n = input->len / 2;
+  size_t i = 0;
+#if defined(STRING_HAS_SSE2)
+  for (; i + 16 <= n; i += 16) {
+    __m128i valid = _mm_set1_epi8(-1);
+    __m128i first = hex_pairs(_mm_loadu_si128((const __m128i *)(in + 2 * i)),
+                              &valid);
+    __m128i second = hex_pairs(
+        _mm_loadu_si128((const __m128i *)(in + 2 * i + 16)), &valid);
+    if (_mm_movemask_epi8(valid) != 0xffff) {
+      return false;
+    }
+    _mm_storeu_si128((__m128i *)(out + i), _mm_packus_epi16(first, second));
+  }
+#endif
+  for (; i < n; i++) {
+    uint8_t high = HEX_VALUES[in[2 * i]], low = HEX_VALUES[in[2 * i + 1]];
+    if ((high | low) & 0x80) {
+      return false;
+    }
+    out[i] = (uint8_t)(high << 4 | low);
+  }
+  output->len = n;
+  return true;
+}
+
+// SECTION: Base64 encoding.
+
+size_t base64_encoded_len(size_t len, base64_alphabet_t alphabet) {
+  if (alphabet == BASE64_STANDARD) {
+    return (len + 2) / 3 * 4;
+  }
+  return len / 3 * 4 + (len % 3 ? len % 3 + 1 : 0);
+}
+
+#if defined(STRING_HAS_AVX2)
+// Encodes 24 bytes into 32 characters.
+static inline __m256i encode_block(const uint8_t *in, __m256i offsets) {
+  // Each lane gets 12 bytes; every three of them are spread over four bytes
+  // as [b1, b0, b2, b1], and the four 6-bit indices are then moved into
+  // place with multiplications.
+  __m256i bytes = _mm256_inserti128_si256(
+      _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)in)),
+      _mm_loadu_si128((const __m128i *)(in + 12)), 1);
+  bytes = _mm256_shuffle_epi8(
+      bytes, _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11,
+                              10, 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9,
+                              11, 10));
+  __m256i first = _mm256_mulhi_epu16(
+      _mm256_and_si256(bytes, _mm256_set1_epi32(0x0fc0fc00)),
+      _mm256_set1_epi32(0x04000040));
+  __m256i second = _mm256_mullo_epi16(
+      _mm256_and_si256(bytes, _mm256_set1_epi32(0x003f03f0)),
+      _mm256_set1_epi32(0x01000010));
+  __m256i indices = _mm256_or_si256(first, second);
+
+  // Pick the offset of each index's range: A-Z, a-z, 0-9 and the last two.
+  __m256i ranges = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+  ranges = _mm256_sub_epi8(
+      ranges, _mm256_cmpgt_epi8(indices, _mm256_set1_epi8(25)));
+  return _mm256_add_epi8(indices, _mm256_shuffle_epi8(offsets, ranges));
+}
+#endif
+
+void base64_encode(const string_t *input, string_t *output,
+                   base64_alphabet_t alphabet) {
+  const base64_info_t *info = alphabet_info(alphabet);
+  if (!input || !output) {
+    panic(stderr, "String pointer is empty.");
+  }
+  const size_t needed = base64_encoded_len(input->len, alphabet);
+  if (output->len < needed) {
+    panic(stderr, "Output string is too short.");
+  }
+  const uint8_t *in = input->data;
+  uint8_t *out = output->data;
+  const char *digits = info->digits;
+  const size_t n = input->len;
+  size_t i = 0;
+#if defined(STRING_HAS_AVX2)
+  const int8_t high = info->encode_offsets[0], low = info->encode_offsets[1];
+  const __m256i offsets = _mm256_setr_epi8(
+      'A', 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, high, low, 0, 0, 'A',
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, high, low, 0, 0);
+  for (; i + 28 <= n; i += 24, out += 32) {
+    _mm256_storeu_si256((__m256i *)out, encode_block(in + i, offsets));
+  }
+#endif
+  for (; i + 3 <= n; i += 3, out += 4) {
+    uint32_t triple = (uint32_t)in[i] << 16 | (uint32_t)in[i + 1] << 8 | in[i + 2];
+    out[0] = (uint8_t)digits[triple >> 18];
+    out[1] = (uint8_t)digits[(triple >> 12) & 63];
+    out[2] = (uint8_t)digits[(triple >> 6) & 63];
+    out[3] = (uint8_t)digits[triple & 63];
+  }
+  if (i < n) {
+    uint32_t triple = (uint32_t)in[i] << 16;
+    if (i + 1 < n) {
+      triple |= (uint32_t)in[i + 1] << 8;
+    }
+    *out++ = (uint8_t)digits[triple >> 18];
+    *out++ = (uint8_t)digits[(triple >> 12) & 63];
+    if (i + 1 < n) {
+      *out++ = (uint8_t)digits[(triple >> 6) & 63];
+    }
+    if (alphabet == BASE64_STANDARD) {
+      while ((size_t)(out - output->data) < needed) {
+        *out++ = '=';
+      }
+    }
+  }
+  output->len = needed;
+}
+
+// SECTION: Base64 decoding.
+
+size_t base64_decoded_len(size_t len) {
+  return len / 4 * 3 + (len % 4 ? len % 4 - 1 : 0);
+}
+
+#if defined(STRING_HAS_AVX2)
+static inline __m256i broadcast(const void *table) {
+  return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)table));
+}
+#endif
+
+// Decodes the groups of four characters in in[0, n), n being a multiple of
+// four, into out. Returns false if one of them is not a digit.
+static bool decode_groups(const base64_info_t *info, const uint8_t *in,
+                          size_t n, uint8_t *out) {
+  size_t i = 0;
+#if defined(STRING_HAS_AVX2)
+  const __m256i check_high = broadcast(info->check_high);
+  const __m256i check_low = broadcast(info->check_low);
+  const __m256i shifts = broadcast(info->shifts);
+  const __m256i special = _mm256_set1_epi8((char)info->special);
+  const __m256i special_shift = _mm256_set1_epi8(info->special_shift);
+  const __m256i nibbles = _mm256_set1_epi8(0x0f);
+  for (; i + 32 <= n; i += 32, out += 24) {
+    __m256i chars = _mm256_loadu_si256((const __m256i *)(in + i));
+    __m256i high = _mm256_and_si256(_mm256_srli_epi32(chars, 4), nibbles);
+    __m256i low = _mm256_and_si256(chars, nibbles);
+    if (!_mm256_testz_si256(_mm256_shuffle_epi8(check_high, high),
+                            _mm256_shuffle_epi8(check_low, low))) {
+      // Let the scalar code below find the invalid character.
+      break;
+    }
+    __m256i shift = _mm256_blendv_epi8(_mm256_shuffle_epi8(shifts, high),
+                                       special_shift,
+                                       _mm256_cmpeq_epi8(chars, special));
+    __m256i values = _mm256_add_epi8(chars, shift);
+
+    // Join the four 6-bit values of every 32-bit lane into 24 bits, then
+    // gather the three bytes of every lane in order.
+    __m256i pairs =
+        _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+    __m256i triples = _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+    triples = _mm256_shuffle_epi8(
+        triples, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1,
+                                  -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14,
+                                  13, 12, -1, -1, -1, -1));
+    triples = _mm256_permutevar8x32_epi32(
+        triples, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 7, 7));
+    _mm_storeu_si128((__m128i *)out, _mm256_castsi256_si128(triples));
+    _mm_storel_epi64((__m128i *)(out + 16),
+                     _mm256_extracti128_si256(triples, 1));
+  }
+#endif
+  const uint8_t *values = info->values;
+  for (; i < n; i += 4, out += 3) {
+    uint32_t a = values[in[i]], b = values[in[i + 1]], c = values[in[i + 2]],
+             d = values[in[i + 3]];
+    if ((a | b | c | d) & 0x80) {
+      return false;
+    }
+    uint32_t triple = a << 18 | b << 12 | c << 6 | d;
+    out[0] = (uint8_t)(triple >> 16);
+    out[1] = (uint8_t)(triple >> 8);
+    out[2] = (uint8_t)triple;
+  }
+  return true;
+}
+
+bool base64_decode(const string_t *input, string_t *output,
+                   base64_alphabet_t alphabet) {
+  const base64_info_t *info = alphabet_info(alphabet);
+  check_output(input, output, base64_decoded_len);
+  const uint8_t *in = input->data;
+  size_t n = input->len;
+
+  // The last group may be incomplete: two or three digits, followed by
+  // padding in the standard alphabet.
+  size_t tail;
+  if (alphabet == BASE64_STANDARD) {
+    if (n % 4 != 0) {
+      return false;
+    }
+    tail = 0;
+    if (n > 0 && in[n - 1] == '=') {
+      tail = in[n - 2] == '=' ? 2 : 3;
+      n -= 4;
+    }
+  } else {
+    tail = n % 4;
+    if (tail == 1) {
+      return false;
+    }
+    n -= tail;
+  }
+  if (!decode_groups(info, in, n, output->data)) {
+    return false;
+  }
+
+  size_t len = n / 4 * 3;
+  if (tail > 0) {
+    const uint8_t *values = info->values;
+    uint32_t a = values[in[n]], b = values[in[n + 1]];
+    uint32_t c = tail == 3 ? values[in[n + 2]] : 0;
+    // The bits after the last byte must be zero.
+    if ((a | b | c) & 0x80 || (tail == 2 ? b & 0x0f : c & 0x03)) {
+      return false;
+    }
+    uint32_t triple = a << 18 | b << 12 | c << 6;
+    output->data[len++] = (uint8_t)(triple >> 16);
+    if (tail == 3) {
+      output->data[len++] = (uint8_t)(triple >> 8);
+    }
+  }
+  output->len = len;
+  return true;
+}
@@ -0,0 +1,99 @@
+#ifndef C_PROGRAMS_ENCODING_H
+#define C_PROGRAMS_ENCODING_H
+/**
+ * Hexadecimal and Base64 (RFC 4648) encoding and decoding of binary data
+ * held in a string_t.
+ *
+ * The functions write into an output string allocated by the caller (for
+ * example with new_string and the *_len functions below) and set its length
+ * to the number of bytes written, so no intermediate strings are created.
+ * The output must not overlap the input.
+ *
+ * With AVX2, Base64 is encoded and decoded 24 bytes at a time with the
+ * vector algorithms of Muła and Lemire ("Faster Base64 Encoding and Decoding
+ * Using AVX2 Instructions", 2018). Hexadecimal uses SSE2, 16 bytes at a
+ * time. Other targets use table driven scalar code. All paths produce the
+ * same output and accept exactly the same inputs.
+ *
+ * Decoding is strict: it accepts only what encoding produces. Whitespace,
+ * characters outside the alphabet, misplaced or missing padding and unused
+ * bits that are not zero all make decoding fail. Hexadecimal digits may be
+ * in either case.
+ */
+#include "string.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * BASE64_STANDARD uses '+' and '/' for the last two digits and pads the
+ * output with '=' to a multiple of four characters. BASE64_URL uses '-' and
+ * '_', which are safe in URLs and file names, and does not pad.
+ */
+typedef enum base64_alphabet { BASE64_STANDARD, BASE64_URL } base64_alphabet_t;
+
+/**
+ * @param len The number of bytes to encode.
+ * @return The length of their hexadecimal encoding.
+ */
+size_t hex_encoded_len(size_t len);
+
+/**
+ * Encodes the input as lower case hexadecimal digits, two per byte.
+ *
+ * @param input  The bytes to encode.
+ * @param output Receives the digits; it must be at least
+ *               hex_encoded_len(input->len) bytes long.
+ */
+void hex_encode(const string_t *input, string_t *output);
+
+/**
+ * Decodes hexadecimal digits, two per byte.
+ *
+ * @param input  The digits to decode.
+ * @param output Receives the bytes; it must be at least input->len / 2
+ *               bytes long.
+ * @return true on success; false if the input has an odd length or a byte
+ *         that is not a hexadecimal digit, in which case the contents of
+ *         output are unspecified.
+ */
+bool hex_decode(const string_t *input, string_t *output);
+
+/**
+ * @param len      The number of bytes to encode.
+ * @param alphabet The alphabet to use.
+ * @return The length of their Base64 encoding.
+ */
+size_t base64_encoded_len(size_t len, base64_alphabet_t alphabet);
+
+/**
+ * @param len The length of a Base64 encoded input.
+ * @return An upper bound of the number of bytes it decodes to.
+ */
+size_t base64_decoded_len(size_t len);
+
+/**
+ * Encodes the input in Base64.
+ *
+ * @param input    The bytes to encode.
+ * @param output   Receives the encoding; it must be at least
+ *                 base64_encoded_len(input->len, alphabet) bytes long.
+ * @param alphabet The alphabet to use.
+ */
+void base64_encode(const string_t *input, string_t *output,
+                   base64_alphabet_t alphabet);
+
+/**
+ * Decodes Base64 written in the given alphabet.
+ *
+ * @param input    The encoded input.
+ * @param output   Receives the bytes; it must be at least
+ *                 base64_decoded_len(input->len) bytes long.
+ * @param alphabet The alphabet the input is written in.
+ * @return true on success; false if the input is not valid, in which case
+ *         the contents of output are unspecified.
+ */
+bool base64_decode(const string_t *input, string_t *output,
+                   base64_alphabet_t alphabet);
+
+#endif // C_PROGRAMS_ENCODING_H
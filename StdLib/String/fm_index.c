@@ -0,0 +1,341 @@
+#include "fm_index.h"
+#include "../Panic/panic.h"
+#include "simd.h"
+#include "suffix.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char MAGIC[8] = {'F', 'M', 'I', 'N', 'D', 'E', 'X', '1'};
+
+// SECTION: Layout.
+//
+// The tables follow the header in a fixed order, each starting at a multiple
+// of eight bytes. Their offsets are computed from the header alone, which is
+// all that is needed to attach an index to a block of memory.
+
+typedef struct fm_layout {
+  size_t superblocks;
+  size_t blocks;
+  size_t sampled;
+  size_t sampled_ranks;
+  size_t samples;
+  size_t bwt;
+  size_t size;
+} fm_layout_t;
+
+static size_t align8(size_t size) { return (size + 7) & ~(size_t)7; }
+
+static size_t sample_count(const fm_header_t *header) {
+  return (size_t)(header->len / header->sample_rate + 1);
+}
+
+static fm_layout_t compute_layout(const fm_header_t *header) {
+  const size_t rows = (size_t)header->len + 1;
+  const size_t symbols = (size_t)header->symbols;
+  const size_t words = rows / 64 + 1;
+  fm_layout_t layout;
+  layout.superblocks = align8(sizeof(fm_header_t));
+  layout.blocks = layout.superblocks + ((rows >> 16) + 1) * symbols * 8;
+  layout.sampled = layout.blocks + align8(((rows >> 8) + 1) * symbols * 2);
+  layout.sampled_ranks = layout.sampled + words * 8;
+  layout.samples = layout.sampled_ranks + words * 8;
+  layout.bwt = layout.samples + sample_count(header) * 8;
+  layout.size = layout.bwt + align8(rows);
+  return layout;
+}
+
+static fm_index_t *attach(void *memory, size_t size, bool mapped) {
+  fm_index_t *index = malloc(sizeof(fm_index_t));
+  if (!index) {
+    panic(stderr, "Could not allocate the index.");
+  }
+  const uint8_t *base = memory;
+  fm_layout_t layout = compute_layout(memory);
+  index->header = memory;
+  index->superblocks = (const uint64_t *)(base + layout.superblocks);
+  index->blocks = (const uint16_t *)(base + layout.blocks);
+  index->sampled = (const uint64_t *)(base + layout.sampled);
+  index->sampled_ranks = (const uint64_t *)(base + layout.sampled_ranks);
+  index->samples = (const uint64_t *)(base + layout.samples);
+  index->bwt = base + layout.bwt;
+  index->memory = memory;
+  index->size = size;
+  index->mapped = mapped;
+  return index;
+}
+
+// SECTION: Construction.
+
+fm_index_t *new_fm_index(const string_t *text, size_t sample_rate) {
+  if (!text) {
+    panic(stderr, "String pointer is empty.");
+  }
+  if (sample_rate == 0) {
+    sample_rate = FM_INDEX_SAMPLE_RATE;
+  }
+  const size_t n = text->len;
+  const size_t rows = n + 1;
+
+  fm_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MAGIC, sizeof(MAGIC));
+  header.len = n;
+  header.sample_rate = sample_rate;
+  size_t occurrences[256] = {0};
+  for (size_t i = 0; i < n; i++) {
+    occurrences[text->data[i]]++;
+  }
+  header.counts[0] = 1;
+  for (size_t c = 0; c < 256; c++) {
+    header.counts[c + 1] = header.counts[c] + occurrences[c];
+    if (occurrences[c]) {
+      header.codes[c] = (uint8_t)header.symbols++;
+    }
+  }
+
+  size_t *suffixes = build_suffix_array(text);
+  // Row 0 is the empty suffix; row r > 0 is suffixes[r - 1].
+  header.primary = 0;
+  for (size_t r = 1; r < rows; r++) {
+    if (suffixes[r - 1] == 0) {
+      header.primary = r;
+    }
+  }
+
+  fm_layout_t layout = compute_layout(&header);
+  uint8_t *memory = calloc(layout.size, 1);
+  if (!memory) {
+    panic(stderr, "Could not allocate the index.");
+  }
+  memcpy(memory, &header, sizeof(header));
+  fm_index_t *index = attach(memory, layout.size, false);
+  uint8_t *bwt = memory + layout.bwt;
+  uint64_t *superblocks = (uint64_t *)(memory + layout.superblocks);
+  uint16_t *blocks = (uint16_t *)(memory + layout.blocks);
+  uint64_t *sampled = (uint64_t *)(memory + layout.sampled);
+  uint64_t *sampled_ranks = (uint64_t *)(memory + layout.sampled_ranks);
+  uint64_t *samples = (uint64_t *)(memory + layout.samples);
+
+  const size_t symbols = (size_t)header.symbols;
+  uint64_t running[256] = {0};
+  size_t taken = 0;
+  for (size_t r = 0; r <= rows; r++) {
+    if ((r & 0xffff) == 0) {
+      memcpy(superblocks + (r >> 16) * symbols, running,
+             symbols * sizeof(uint64_t));
+    }
+    if ((r & 0xff) == 0) {
+      const uint64_t *base = superblocks + (r >> 16) * symbols;
+      for (size_t s = 0; s < symbols; s++) {
+        blocks[(r >> 8) * symbols + s] = (uint16_t)(running[s] - base[s]);
+      }
+    }
+    if (r == rows) {
+      break;
+    }
+    size_t position = r == 0 ? n : suffixes[r - 1];
+    if (position > 0) {
+      bwt[r] = text->data[position - 1];
+      running[header.codes[bwt[r]]]++;
+    }
+    if (position % sample_rate == 0) {
+      sampled[r >> 6] |= 1ULL << (r & 63);
+      samples[taken++] = position;
+    }
+  }
+  free(suffixes);
+
+  uint64_t rank = 0;
+  for (size_t w = 0; w < rows / 64 + 1; w++) {
+    sampled_ranks[w] = rank;
+    rank += population_count(sampled[w]);
+  }
+  return index;
+}
+
+// SECTION: Queries.
+
+// Counts the bytes equal to byte in data[0, len), with len below 256.
+static size_t count_byte(const uint8_t *data, size_t len, uint8_t byte) {
+  size_t count = 0;
+  size_t index = 0;
+#if defined(STRING_HAS_AVX2)
+  const __m256i wanted = _mm256_set1_epi8((char)byte);
+  for (; index + 32 <= len; index += 32) {
+    __m256i block = _mm256_loadu_si256((const __m256i *)(data + index));
+    count += population_count(
+        (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, wanted)));
+  }
+#elif defined(STRING_HAS_SSE2)
+  const __m128i wanted = _mm_set1_epi8((char)byte);
+  for (; index + 16 <= len; index += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i *)(data + index));
+    count += population_count(
+        (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, wanted)));
+  }
+#else
+  const uint64_t low_bits = 0x7f7f7f7f7f7f7f7fULL;
+  for (; index + 8 <= len; index += 8) {
+    // Exact per-byte zero test: no carries cross byte boundaries.
+    uint64_t word = load_u64(data + index) ^ (0x0101010101010101ULL * byte);
+    uint64_t nonzero = ((word & low_bits) + low_bits) | word;
+    count += population_count(~nonzero & ~low_bits);
+  }
+#endif
+  for (; index < len; index++) {
+    count += data[index] == byte;
+  }
+  return count;
+}
+
+// The number of rows before the given row whose last byte is byte.
+static size_t occurrences_before(const fm_index_t *index, uint8_t byte,
+                                 size_t row) {
+  const size_t symbols = (size_t)index->header->symbols;
+  const size_t code = index->header->codes[byte];
+  size_t start = row & ~(size_t)0xff;
+  size_t count = (size_t)index->superblocks[(row >> 16) * symbols + code] +
+                 index->blocks[(row >> 8) * symbols + code] +
+                 count_byte(index->bwt + start, row - start, byte);
+  // The primary row has no last byte; its slot holds a zero.
+  size_t primary = (size_t)index->header->primary;
+  if (byte == 0 && primary >= start && primary < row) {
+    count--;
+  }
+  return count;
+}
+
+// Narrows the rows down to those starting with the pattern, processing it
+// from the last byte to the first.
+static suffix_range_t backward_search(const fm_index_t *index,
+                                      const string_t *pattern) {
+  const uint64_t *counts = index->header->counts;
+  suffix_range_t range = {0, (size_t)index->header->len + 1};
+  if (pattern->len == 0) {
+    // Every row but the one of the empty suffix.
+    range.start = 1;
+    return range;
+  }
+  for (size_t k = pattern->len; k-- > 0 && range.start < range.end;) {
+    uint8_t byte = pattern->data[k];
+    if (counts[byte + 1] == counts[byte]) {
+      range.start = range.end = 0;
+      break;
+    }
+    range.start =
+        (size_t)counts[byte] + occurrences_before(index, byte, range.start);
+    range.end = (size_t)counts[byte] + occurrences_before(index, byte, range.end);
+  }
+  return range;
+}
+
+static void assert_index(const fm_index_t *index, const void *pointer) {
+  if (!index || !pointer) {
+    panic(stderr, "Index or argument pointer is empty.");
+  }
+}
+
+size_t fm_index_length(const fm_index_t *index) {
+  assert_index(index, index);
+  return (size_t)index->header->len;
+}
+
+size_t fm_index_count(const fm_index_t *index, const string_t *pattern) {
+  assert_index(index, pattern);
+  suffix_range_t range = backward_search(index, pattern);
+  return range.end - range.start;
+}
+
+static bool is_sampled(const fm_index_t *index, size_t row) {
+  return (index->sampled[row >> 6] >> (row & 63)) & 1;
+}
+
+size_t *fm_index_locate(const fm_index_t *index, const string_t *pattern,
+                        size_t *count) {
+  assert_index(index, pattern);
+  assert_index(index, count);
+  suffix_range_t range = backward_search(index, pattern);
+  *count = range.end - range.start;
+  size_t *positions = malloc((*count ? *count : 1) * sizeof(size_t));
+  if (!positions) {
+    panic(stderr, "Could not allocate the positions array.");
+  }
+  const uint64_t *counts = index->header->counts;
+  for (size_t r = range.start; r < range.end; r++) {
+    // Step backwards through the text (the LF mapping) until a row with a
+    // sampled position is reached.
+    size_t row = r;
+    size_t steps = 0;
+    while (!is_sampled(index, row)) {
+      uint8_t byte = index->bwt[row];
+      row = (size_t)counts[byte] + occurrences_before(index, byte, row);
+      steps++;
+    }
+    uint64_t word = index->sampled[row >> 6] & ((1ULL << (row & 63)) - 1);
+    size_t rank = (size_t)index->sampled_ranks[row >> 6] +
+                  population_count(word);
+    positions[r - range.start] = (size_t)index->samples[rank] + steps;
+  }
+  return positions;
+}
+
+// SECTION: Persistence.
+
+bool save_fm_index(const fm_index_t *index, const char *path) {
+  assert_index(index, path);
+  FILE *output = fopen(path, "wb");
+  if (!output) {
+    return false;
+  }
+  bool written = fwrite(index->memory, 1, index->size, output) == index->size;
+  return fclose(output) == 0 && written;
+}
+
+fm_index_t *load_fm_index(const char *path) {
+  if (!path) {
+    panic(stderr, "Path pointer is empty.");
+  }
+  int file = open(path, O_RDONLY);
+  if (file < 0) {
+    return NULL;
+  }
+  struct stat status;
+  if (fstat(file, &status) != 0 ||
+      (size_t)status.st_size < sizeof(fm_header_t)) {
+    close(file);
+    return NULL;
+  }
+  size_t size = (size_t)status.st_size;
+  void *memory = mmap(NULL, size, PROT_READ, MAP_SHARED, file, 0);
+  close(file);
+  if (memory == MAP_FAILED) {
+    return NULL;
+  }
+  const fm_header_t *header = memory;
+  if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      header->sample_rate == 0 || header->symbols > 256 ||
+      header->primary > header->len ||
+      compute_layout(header).size != size) {
+    munmap(memory, size);
+    return NULL;
+  }
+  return attach(memory, size, true);
+}
+
+void free_fm_index(fm_index_t *index) {
+  if (!index) {
+    return;
+  }
+  if (index->mapped) {
+    munmap(index->memory, index->size);
+  } else {
+    free(index->memory);
+  }
+  free(index);
+}
@@ -0,0 +1,144 @@
+#ifndef C_PROGRAMS_FM_INDEX_H
+#define C_PROGRAMS_FM_INDEX_H
+/**
+ * A compressed full-text index (Ferragina and Manzini, "Opportunistic Data
+ * Structures with Applications", 2000).
+ *
+ * The index stores the Burrows-Wheeler transform of the text together with
+ * occurrence counts, which is enough to count the occurrences of a pattern
+ * of length m in O(m) time, independently of the length of the text. A
+ * sample of the suffix array is kept to locate the occurrences as well; a
+ * sample rate of s costs about 8 / s bytes per byte of text and makes each
+ * located occurrence take at most s steps.
+ *
+ * With the default sample rate the index takes between about 1.5 and 3.5
+ * bytes per byte of text (depending on the number of distinct bytes),
+ * compared to sizeof(size_t) bytes for the suffix array alone plus the text.
+ * The text is not needed once the index is built.
+ *
+ * The index is a single block of memory that can be written to a file as is
+ * and mapped back into memory with load_fm_index, so a large index is
+ * available immediately without being parsed or copied. Index files use the
+ * byte order of the machine that wrote them.
+ */
+#include "string.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The default number of rows between two suffix array samples.
+ */
+#define FM_INDEX_SAMPLE_RATE 32
+
+/**
+ * The fixed part at the start of an index (and of an index file). The
+ * variable length tables follow it; their sizes are all determined by the
+ * values in the header.
+ *
+ * Rows are the n + 1 suffixes of the text (including the empty one) in
+ * sorted order. counts[c] is the number of rows whose suffix starts with a
+ * byte smaller than c, plus one for the empty suffix. codes maps each byte
+ * that occurs in the text to its column in the occurrence tables.
+ */
+typedef struct fm_header {
+  char magic[8];
+  uint64_t len;
+  uint64_t primary;
+  uint64_t sample_rate;
+  uint64_t symbols;
+  uint64_t counts[257];
+  uint8_t codes[256];
+} fm_header_t;
+
+/**
+ * An FM-index. The pointers refer into the memory block, which is either
+ * owned by the index or mapped from a file.
+ *
+ * - bwt holds the last byte of every rotation (row primary has none).
+ * - superblocks and blocks hold the occurrence counts of every byte before
+ *   each multiple of 65536 and 256 rows, the latter relative to the former.
+ * - sampled marks the rows whose position is a multiple of the sample rate,
+ *   sampled_ranks counts the marked rows before each word of sampled and
+ *   samples holds their positions in row order.
+ */
+typedef struct fm_index {
+  const fm_header_t *header;
+  const uint8_t *bwt;
+  const uint64_t *superblocks;
+  const uint16_t *blocks;
+  const uint64_t *sampled;
+  const uint64_t *sampled_ranks;
+  const uint64_t *samples;
+  void *memory;
+  size_t size;
+  bool mapped;
+} fm_index_t;
+
+/**
+ * Builds the index of the text. This temporarily needs the memory of a
+ * suffix array (see suffix.h) on top of the index itself.
+ *
+ * @param text        The text to index.
+ * @param sample_rate The distance between suffix array samples, or 0 for
+ *                    FM_INDEX_SAMPLE_RATE.
+ * @return A new index.
+ */
+fm_index_t *new_fm_index(const string_t *text, size_t sample_rate);
+
+/**
+ * @param index The index to search.
+ * @return The length of the indexed text.
+ */
+size_t fm_index_length(const fm_index_t *index);
+
+/**
+ * Counts the (possibly overlapping) occurrences of the pattern in O(m) time
+ * for a pattern of length m. The empty pattern occurs at every position.
+ *
+ * @param index   The index to search.
+ * @param pattern The pattern to count.
+ * @return The number of occurrences.
+ */
+size_t fm_index_count(const fm_index_t *index, const string_t *pattern);
+
+/**
+ * Finds the positions of all occurrences of the pattern.
+ *
+ * @param index   The index to search.
+ * @param pattern The pattern to look for.
+ * @param count   Receives the number of occurrences.
+ * @return A newly allocated array of the positions, in no particular order.
+ *         Release it with free.
+ */
+size_t *fm_index_locate(const fm_index_t *index, const string_t *pattern,
+                        size_t *count);
+
+/**
+ * Writes the index to a file.
+ *
+ * @param index The index to save.
+ * @param path  The path of the file to create or overwrite.
+ * @return true on success, false if the file could not be written.
+ */
+bool save_fm_index(const fm_index_t *index, const char *path);
+
+/**
+ * Maps an index file written by save_fm_index into memory. The file must not
+ * be modified while the index is in use.
+ *
+ * @param path The path of the index file.
+ * @return The index, or NULL if the file could not be mapped or is not a
+ *         valid index.
+ */
+fm_index_t *load_fm_index(const char *path);
+
+/**
+ * Releases the index, unmapping its file if it was loaded from one.
+ *
+ * @param index The index to be deallocated.
+ */
+void free_fm_index(fm_index_t *index);
+
+#endif // C_PROGRAMS_FM_INDEX_H
@@ -0,0 +1,183 @@
+#include "intern.h"
+#include "../Arena/arena.h"
+#include "../Panic/panic.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t INITIAL_CAPACITY = 64;
+
+static void init_shard(intern_shard_t *shard) {
+  shard->count = 0;
+  shard->capacity = INITIAL_CAPACITY;
+  shard->slots = calloc(INITIAL_CAPACITY, sizeof(intern_slot_t));
+  if (!shard->slots) {
+    panic(stderr, "Could not allocate the intern table.");
+  }
+  shard->arena = new_arena(0);
+  pthread_mutex_init(&shard->lock, NULL);
+}
+
+static intern_pool_t *allocate_pool(size_t shards, bool concurrent) {
+  intern_pool_t *pool = malloc(sizeof(intern_pool_t));
+  if (!pool) {
+    panic(stderr, "Could not allocate the intern pool.");
+  }
+  pool->concurrent = concurrent;
+  pool->shard_count = shards;
+  pool->shards = malloc(shards * sizeof(intern_shard_t));
+  if (!pool->shards) {
+    panic(stderr, "Could not allocate the intern pool shards.");
+  }
+  for (size_t i = 0; i < shards; i++) {
+    init_shard(&pool->shards[i]);
+  }
+  return pool;
+}
+
+intern_pool_t *new_intern_pool(void) { return allocate_pool(1, false); }
+
+intern_pool_t *new_concurrent_intern_pool(size_t shards) {
+  size_t count = 1;
+  while (count < shards) {
+    count <<= 1;
+  }
+  return allocate_pool(count, true);
+}
+
+// The low bits of the hash pick the slot, the high bits pick the shard, so
+// the two choices stay independent.
+static intern_shard_t *shard_for(intern_pool_t *pool, uint64_t hash) {
+  return &pool->shards[(hash >> 48) & (pool->shard_count - 1)];
+}
+
+static intern_slot_t *probe(intern_shard_t *shard, uint64_t hash,
+                            const uint8_t *data, size_t len) {
+  size_t mask = shard->capacity - 1;
+  size_t index = hash & mask;
+  while (true) {
+    intern_slot_t *slot = &shard->slots[index];
+    if (!slot->string) {
+      return slot;
+    }
+    if (slot->hash == hash && slot->string->len == len &&
+        (len == 0 || memcmp(slot->string->data, data, len) == 0)) {
+      return slot;
+    }
+    index = (index + 1) & mask;
+  }
+}
+
+static void grow_shard(intern_shard_t *shard) {
+  intern_slot_t *old = shard->slots;
+  size_t old_capacity = shard->capacity;
+  shard->capacity *= 2;
+  shard->slots = calloc(shard->capacity, sizeof(intern_slot_t));
+  if (!shard->slots) {
+    panic(stderr, "Could not grow the intern table.");
+  }
+  size_t mask = shard->capacity - 1;
+  for (size_t i = 0; i < old_capacity; i++) {
+    if (!old[i].string) {
+      continue;
+    }
+    size_t index = old[i].hash & mask;
+    while (shard->slots[index].string) {
+      index = (index + 1) & mask;
+    }
+    shard->slots[index] = old[i];
+  }
+  free(old);
+}
+
+static const string_t *insert(intern_shard_t *shard, uint64_t hash,
+                              const uint8_t *data, size_t len) {
+  intern_slot_t *slot = probe(shard, hash, data, len);
+  if (slot->string) {
+    return slot->string;
+  }
+  // Keep the load factor below 3/4 so probe sequences stay short.
+  if (4 * (shard->count + 1) > 3 * shard->capacity) {
+    grow_shard(shard);
+    slot = probe(shard, hash, data, len);
+  }
+  string_t *canonical =
+      arena_alloc(shard->arena, sizeof(string_t), _Alignof(string_t));
+  canonical->len = len;
+  canonical->data = arena_copy(shard->arena, data, len);
+  slot->hash = hash;
+  slot->string = canonical;
+  shard->count++;
+  return canonical;
+}
+
+const string_t *intern_bytes(intern_pool_t *pool, const uint8_t *data,
+                             size_t len) {
+  if (!pool) {
+    panic(stderr, "Intern pool pointer is null.");
+  }
+  uint64_t hash = string_hash_bytes(data, len, 0);
+  intern_shard_t *shard = shard_for(pool, hash);
+  if (!pool->concurrent) {
+    return insert(shard, hash, data, len);
+  }
+  pthread_mutex_lock(&shard->lock);
+  const string_t *canonical = insert(shard, hash, data, len);
+  pthread_mutex_unlock(&shard->lock);
+  return canonical;
+}
+
+const string_t *intern_string(intern_pool_t *pool, const string_t *string) {
+  if (!string) {
+    panic(stderr, "String pointer is empty.");
+  }
+  return intern_bytes(pool, string->data, string->len);
+}
+
+const string_t *find_interned(intern_pool_t *pool, const string_t *string) {
+  if (!pool || !string) {
+    panic(stderr, "Intern pool or string pointer is null.");
+  }
+  uint64_t hash = string_hash_bytes(string->data, string->len, 0);
+  intern_shard_t *shard = shard_for(pool, hash);
+  if (pool->concurrent) {
+    pthread_mutex_lock(&shard->lock);
+  }
+  const string_t *found =
+      probe(shard, hash, string->data, string->len)->string;
+  if (pool->concurrent) {
+    pthread_mutex_unlock(&shard->lock);
+  }
+  return found;
+}
+
+size_t intern_pool_size(intern_pool_t *pool) {
+  if (!pool) {
+    return 0;
+  }
+  size_t total = 0;
+  for (size_t i = 0; i < pool->shard_count; i++) {
+    intern_shard_t *shard = &pool->shards[i];
+    if (pool->concurrent) {
+      pthread_mutex_lock(&shard->lock);
+    }
+    total += shard->count;
+    if (pool->concurrent) {
+      pthread_mutex_unlock(&shard->lock);
+    }
+  }
+  return total;
+}
+
+void free_intern_pool(intern_pool_t *pool) {
+  if (!pool) {
+    return;
+  }
+  for (size_t i = 0; i < pool->shard_count; i++) {
+    free(pool->shards[i].slots);
+    free_arena(pool->shards[i].arena);
+    pthread_mutex_destroy(&pool->shards[i].lock);
+  }
+  free(pool->shards);
+  free(pool);
+}
@@ -0,0 +1,110 @@
+#ifndef C_PROGRAMS_INTERN_H
+#define C_PROGRAMS_INTERN_H
+/**
+ * A string interning pool.
+ *
+ * Interning maps every distinct sequence of bytes to a single, canonical
+ * string_t. Once two strings have been interned, they are equal if and only
+ * if their pointers are equal, which turns comparisons into a single
+ * instruction and de-duplicates the storage of repeated values.
+ *
+ * The canonical strings (both the string_t and its data) live inside arenas
+ * owned by the pool. They must never be passed to free_string; they are
+ * released all at once by free_intern_pool.
+ */
+#include "string.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct arena;
+
+typedef struct intern_slot {
+  uint64_t hash;
+  const string_t *string;
+} intern_slot_t;
+
+/**
+ * A shard is an independent open-addressing hash table with its own arena.
+ * The concurrent pool guards each shard with its own mutex so that threads
+ * interning different values rarely contend with each other.
+ */
+typedef struct intern_shard {
+  size_t count;
+  size_t capacity;
+  intern_slot_t *slots;
+  struct arena *arena;
+  pthread_mutex_t lock;
+} intern_shard_t;
+
+typedef struct intern_pool {
+  bool concurrent;
+  size_t shard_count;
+  intern_shard_t *shards;
+} intern_pool_t;
+
+/**
+ * Creates a new single-threaded intern pool.
+ *
+ * @return A new, empty pool that must be freed with free_intern_pool.
+ */
+intern_pool_t *new_intern_pool(void);
+
+/**
+ * Creates a new thread-safe intern pool, split into the given number of
+ * independently locked shards. The shard count is rounded up to a power
+ * of two.
+ *
+ * @param shards The desired number of shards (e.g. a small multiple of the
+ *               number of threads that will use the pool).
+ * @return A new, empty pool that must be freed with free_intern_pool.
+ */
+intern_pool_t *new_concurrent_intern_pool(size_t shards);
+
+/**
+ * Returns the canonical string_t for the given contents, adding a copy of
+ * them to the pool if they have not been seen before.
+ *
+ * @param pool   The pool to intern into.
+ * @param string The (non-null) string whose contents are to be interned.
+ * @return The canonical string, owned by the pool.
+ */
+const string_t *intern_string(intern_pool_t *pool, const string_t *string);
+
+/**
+ * Same as intern_string, but takes a raw byte range. Useful to intern
+ * fields straight out of a line buffer without building a string_t first.
+ *
+ * @param pool The pool to intern into.
+ * @param data The bytes to intern.
+ * @param len  The number of bytes.
+ * @return The canonical string, owned by the pool.
+ */
+const string_t *intern_bytes(intern_pool_t *pool, const uint8_t *data,
+                             size_t len);
+
+/**
+ * Looks up the canonical string for the given contents without inserting.
+ *
+ * @param pool   The pool to search.
+ * @param string The string to look for.
+ * @return The canonical string, or NULL if it has not been interned.
+ */
+const string_t *find_interned(intern_pool_t *pool, const string_t *string);
+
+/**
+ * @param pool The pool to inspect.
+ * @return The number of distinct strings stored in the pool.
+ */
+size_t intern_pool_size(intern_pool_t *pool);
+
+/**
+ * De-allocates the pool, including every canonical string it handed out.
+ *
+ * @param pool The pool to be deallocated.
+ */
+void free_intern_pool(intern_pool_t *pool);
+
+#endif // C_PROGRAMS_INTERN_H
@@ -0,0 +1,898 @@
+#include "matcher.h"
+#include "../Panic/panic.h"
+#include "search.h"
+#include "simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Patterns that would compile to more instructions than this (typically
+// through nested counted repetition) are rejected.
+static const size_t MAX_PROGRAM = 1 << 18;
+static const int MAX_NESTING = 1000;
+
+static void *allocate(size_t size) {
+  void *memory = malloc(size ? size : 1);
+  if (!memory) {
+    panic(stderr, "Could not allocate memory for the matcher.");
+  }
+  return memory;
+}
+
+static void *reallocate(void *memory, size_t size) {
+  memory = realloc(memory, size ? size : 1);
+  if (!memory) {
+    panic(stderr, "Could not allocate memory for the matcher.");
+  }
+  return memory;
+}
+
+// SECTION: Parsing.
+
+enum node_type {
+  NODE_EMPTY,
+  NODE_SET,
+  NODE_CONCAT,
+  NODE_ALTERNATE,
+  NODE_REPEAT,
+  NODE_START,
+  NODE_END
+};
+
+typedef struct node {
+  enum node_type type;
+  int32_t left;
+  int32_t right;
+  int32_t min;
+  int32_t max; // -1 for unbounded repetition.
+  uint32_t set;
+} node_t;
+
+typedef struct parser {
+  const char *pattern;
+  size_t position;
+  node_t *nodes;
+  size_t node_count;
+  size_t node_capacity;
+  uint64_t (*sets)[4];
+  size_t set_count;
+  size_t set_capacity;
+  bool failed;
+  int nesting;
+} parser_t;
+
+static int32_t add_node(parser_t *parser, enum node_type type, int32_t left,
+                        int32_t right) {
+  if (parser->node_count == parser->node_capacity) {
+    parser->node_capacity = parser->node_capacity ? 2 * parser->node_capacity
+                                                  : 16;
+    parser->nodes =
+        reallocate(parser->nodes, parser->node_capacity * sizeof(node_t));
+  }
+  node_t *node = &parser->nodes[parser->node_count];
+  memset(node, 0, sizeof(node_t));
+  node->type = type;
+  node->left = left;
+  node->right = right;
+  return (int32_t)parser->node_count++;
+}
+
+static int32_t add_set(parser_t *parser, const uint64_t bits[4]) {
+  if (parser->set_count == parser->set_capacity) {
+    parser->set_capacity = parser->set_capacity ? 2 * parser->set_capacity : 8;
+    parser->sets =
+        reallocate(parser->sets, parser->set_capacity * sizeof(uint64_t[4]));
+  }
+  memcpy(parser->sets[parser->set_count], bits, sizeof(uint64_t[4]));
+  int32_t node = add_node(parser, NODE_SET, -1, -1);
+  parser->nodes[node].set = (uint32_t)parser->set_count++;
+  return node;
+}
+
+static void set_add(uint64_t bits[4], unsigned byte) {
+  bits[byte >> 6] |= 1ULL << (byte & 63);
+}
+
+static void set_add_range(uint64_t bits[4], unsigned first, unsigned last) {
+  for (unsigned byte = first; byte <= last; byte++) {
+    set_add(bits, byte);
+  }
+}
+
+static void set_invert(uint64_t bits[4]) {
+  for (int i = 0; i < 4; i++) {
+    bits[i] = ~bits[i];
+  }
+}
+
+static bool set_contains(const uint64_t bits[4], uint8_t byte) {
+  return (bits[byte >> 6] >> (byte & 63)) & 1;
+}
+
+static int hex_value(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if ((c | 0x20) >= 'a' && (c | 0x20) <= 'f') {
+    return (c | 0x20) - 'a' + 10;
+  }
+  return -1;
+}
+
+// Reads the escape sequence after a '\' into the set. Returns false for
+// unknown escapes of letters and digits, which are reserved.
+static bool parse_escape(parser_t *parser, uint64_t bits[4]) {
+  char c = parser->pattern[parser->position];
+  if (c == '\0') {
+    return false;
+  }
+  parser->position++;
+  bool invert = false;
+  switch (c) {
+  case 'D':
+    invert = true;
+    // fall through
+  case 'd':
+    set_add_range(bits, '0', '9');
+    break;
+  case 'W':
+    invert = true;
+    // fall through
+  case 'w':
+    set_add_range(bits, '0', '9');
+    set_add_range(bits, 'a', 'z');
+    set_add_range(bits, 'A', 'Z');
+    set_add(bits, '_');
+    break;
+  case 'S':
+    invert = true;
+    // fall through
+  case 's':
+    set_add_range(bits, '\t', '\r');
+    set_add(bits, ' ');
+    break;
+  case 'n':
+    set_add(bits, '\n');
+    break;
+  case 't':
+    set_add(bits, '\t');
+    break;
+  case 'r':
+    set_add(bits, '\r');
+    break;
+  case 'x': {
+    int high = hex_value(parser->pattern[parser->position]);
+    int low = high < 0 ? -1 : hex_value(parser->pattern[parser->position + 1]);
+    if (low < 0) {
+      return false;
+    }
+    parser->position += 2;
+    set_add(bits, (unsigned)(high * 16 + low));
+    break;
+  }
+  default:
+    if ((c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'z')) {
+      return false;
+    }
+    set_add(bits, (uint8_t)c);
+  }
+  if (invert) {
+    set_invert(bits);
+  }
+  return true;
+}
+
+// Parses a bracket expression after the '['. A ']' right after the '[' or
+// "[^" is a literal, as is a '-' at either end.
+static int32_t parse_class(parser_t *parser, bool glob) {
+  uint64_t bits[4] = {0};
+  const char *pattern = parser->pattern;
+  bool invert = false;
+  if (pattern[parser->position] == '^' ||
+      (glob && pattern[parser->position] == '!')) {
+    invert = true;
+    parser->position++;
+  }
+  bool first = true;
+  while (pattern[parser->position] != ']' || first) {
+    char c = pattern[parser->position];
+    if (c == '\0') {
+      parser->failed = true;
+      return -1;
+    }
+    first = false;
+    parser->position++;
+    unsigned low = (uint8_t)c;
+    if (c == '\\') {
+      uint64_t escaped[4] = {0};
+      if (!parse_escape(parser, escaped)) {
+        parser->failed = true;
+        return -1;
+      }
+      // Only a single escaped byte can start a range.
+      if (population_count(escaped[0]) + population_count(escaped[1]) +
+              population_count(escaped[2]) + population_count(escaped[3]) !=
+          1) {
+        for (int i = 0; i < 4; i++) {
+          bits[i] |= escaped[i];
+        }
+        continue;
+      }
+      for (low = 0; !set_contains(escaped, (uint8_t)low); low++) {
+      }
+    }
+    if (pattern[parser->position] == '-' &&
+        pattern[parser->position + 1] != ']' &&
+        pattern[parser->position + 1] != '\0') {
+      parser->position++;
+      unsigned high = (uint8_t)pattern[parser->position++];
+      if (high == '\\') {
+        uint64_t escaped[4] = {0};
+        if (!parse_escape(parser, escaped)) {
+          parser->failed = true;
+          return -1;
+        }
+        for (high = 0; high < 256 && !set_contains(escaped, (uint8_t)high);
+             high++) {
+        }
+      }
+      if (high < low || high > 255) {
+        parser->failed = true;
+        return -1;
+      }
+      set_add_range(bits, low, high);
+    } else {
+      set_add(bits, low);
+    }
+  }
+  parser->position++;
+  if (invert) {
+    set_invert(bits);
+  }
+  return add_set(parser, bits);
+}
+
+static int32_t parse_alternation(parser_t *parser);
+
+static int32_t parse_atom(parser_t *parser) {
+  uint64_t bits[4] = {0};
+  char c = parser->pattern[parser->position++];
+  switch (c) {
+  case '(': {
+    if (++parser->nesting > MAX_NESTING) {
+      parser->failed = true;
+      return -1;
+    }
+    if (parser->pattern[parser->position] == '?') {
+      if (parser->pattern[parser->position + 1] != ':') {
+        parser->failed = true;
+        return -1;
+      }
+      parser->position += 2;
+    }
+    int32_t inner = parse_alternation(parser);
+    if (parser->pattern[parser->position] != ')') {
+      parser->failed = true;
+      return -1;
+    }
+    parser->position++;
+    parser->nesting--;
+    return inner;
+  }
+  case '[':
+    return parse_class(parser, false);
+  case '.':
+    set_invert(bits);
+    return add_set(parser, bits);
+  case '^':
+    return add_node(parser, NODE_START, -1, -1);
+  case '$':
+    return add_node(parser, NODE_END, -1, -1);
+  case '\\':
+    if (!parse_escape(parser, bits)) {
+      parser->failed = true;
+      return -1;
+    }
+    return add_set(parser, bits);
+  case '*':
+  case '+':
+  case '?':
+  case '{':
+  case ')':
+  case ']':
+    // Nothing to repeat, or unbalanced.
+    parser->failed = true;
+    return -1;
+  default:
+    set_add(bits, (uint8_t)c);
+    return add_set(parser, bits);
+  }
+}
+
+static bool parse_count(parser_t *parser, int32_t *count) {
+  const char *pattern = parser->pattern;
+  if (pattern[parser->position] < '0' || pattern[parser->position] > '9') {
+    return false;
+  }
+  int32_t value = 0;
+  while (pattern[parser->position] >= '0' && pattern[parser->position] <= '9') {
+    value = value * 10 + (pattern[parser->position++] - '0');
+    if (value > MATCHER_MAX_REPEAT) {
+      return false;
+    }
+  }
+  *count = value;
+  return true;
+}
+
+static int32_t parse_repeat(parser_t *parser) {
+  int32_t atom = parse_atom(parser);
+  while (!parser->failed) {
+    int32_t min, max;
+    char c = parser->pattern[parser->position];
+    if (c == '*') {
+      min = 0;
+      max = -1;
+    } else if (c == '+') {
+      min = 1;
+      max = -1;
+    } else if (c == '?') {
+      min = 0;
+      max = 1;
+    } else if (c == '{') {
+      parser->position++;
+      if (!parse_count(parser, &min)) {
+        parser->failed = true;
+        return -1;
+      }
+      max = min;
+      if (parser->pattern[parser->position] == ',') {
+        parser->position++;
+        max = -1;
+        if (parser->pattern[parser->position] != '}' &&
+            (!parse_count(parser, &max) || max < min)) {
+          parser->failed = true;
+          return -1;
+        }
+      }
+      if (parser->pattern[parser->position] != '}') {
+        parser->failed = true;
+        return -1;
+      }
+    } else {
+      break;
+    }
+    parser->position++;
+    atom = add_node(parser, NODE_REPEAT, atom, -1);
+    parser->nodes[atom].min = min;
+    parser->nodes[atom].max = max;
+  }
+  return atom;
+}
+
+static int32_t parse_concatenation(parser_t *parser) {
+  int32_t result = add_node(parser, NODE_EMPTY, -1, -1);
+  while (!parser->failed) {
+    char c = parser->pattern[parser->position];
+    if (c == '\0' || c == '|' || c == ')') {
+      break;
+    }
+    int32_t next = parse_repeat(parser);
+    result = add_node(parser, NODE_CONCAT, result, next);
+  }
+  return result;
+}
+
+static int32_t parse_alternation(parser_t *parser) {
+  int32_t result = parse_concatenation(parser);
+  while (!parser->failed && parser->pattern[parser->position] == '|') {
+    parser->position++;
+    int32_t next = parse_concatenation(parser);
+    result = add_node(parser, NODE_ALTERNATE, result, next);
+  }
+  return result;
+}
+
+static int32_t parse_regex(parser_t *parser) {
+  int32_t root = parse_alternation(parser);
+  if (parser->pattern[parser->position] != '\0') {
+    parser->failed = true; // An unbalanced ')'.
+  }
+  return root;
+}
+
+// Globs are anchored at both ends.
+static int32_t parse_glob(parser_t *parser) {
+  int32_t result = add_node(parser, NODE_START, -1, -1);
+  while (!parser->failed && parser->pattern[parser->position] != '\0') {
+    uint64_t bits[4] = {0};
+    char c = parser->pattern[parser->position++];
+    int32_t next;
+    if (c == '*' || c == '?') {
+      set_invert(bits);
+      next = add_set(parser, bits);
+      if (c == '*') {
+        next = add_node(parser, NODE_REPEAT, next, -1);
+        parser->nodes[next].max = -1;
+      }
+    } else if (c == '[') {
+      next = parse_class(parser, true);
+    } else if (c == '\\') {
+      c = parser->pattern[parser->position];
+      if (c == '\0') {
+        parser->failed = true;
+        break;
+      }
+      parser->position++;
+      set_add(bits, (uint8_t)c);
+      next = add_set(parser, bits);
+    } else {
+      set_add(bits, (uint8_t)c);
+      next = add_set(parser, bits);
+    }
+    result = add_node(parser, NODE_CONCAT, result, next);
+  }
+  return add_node(parser, NODE_CONCAT, result,
+                  add_node(parser, NODE_END, -1, -1));
+}
+
+// SECTION: Compilation.
+
+enum op { OP_BYTE, OP_SPLIT, OP_MATCH, OP_START, OP_END };
+
+typedef struct compiler {
+  const parser_t *parser;
+  matcher_instruction_t *program;
+  size_t len;
+  size_t capacity;
+  bool failed;
+} compiler_t;
+
+static uint32_t emit(compiler_t *compiler, enum op op, uint32_t out,
+                     uint32_t alternative, uint32_t set) {
+  if (compiler->len == MAX_PROGRAM) {
+    compiler->failed = true;
+    return 0;
+  }
+  if (compiler->len == compiler->capacity) {
+    compiler->capacity = compiler->capacity ? 2 * compiler->capacity : 64;
+    compiler->program = reallocate(
+        compiler->program, compiler->capacity * sizeof(matcher_instruction_t));
+  }
+  matcher_instruction_t *instruction = &compiler->program[compiler->len];
+  instruction->op = (uint8_t)op;
+  instruction->out = out;
+  instruction->alternative = alternative;
+  instruction->set = set;
+  return (uint32_t)compiler->len++;
+}
+
+// Compiles the node so that it continues at next, working backwards from the
+// end of the pattern; returns the entry point of the node.
+static uint32_t compile_node(compiler_t *compiler, int32_t index,
+                             uint32_t next) {
+  if (compiler->failed) {
+    return next;
+  }
+  const node_t node = compiler->parser->nodes[index];
+  switch (node.type) {
+  case NODE_EMPTY:
+    return next;
+  case NODE_SET:
+    return emit(compiler, OP_BYTE, next, 0, node.set);
+  case NODE_START:
+    return emit(compiler, OP_START, next, 0, 0);
+  case NODE_END:
+    return emit(compiler, OP_END, next, 0, 0);
+  case NODE_CONCAT:
+    return compile_node(compiler, node.left,
+                        compile_node(compiler, node.right, next));
+  case NODE_ALTERNATE: {
+    uint32_t left = compile_node(compiler, node.left, next);
+    uint32_t right = compile_node(compiler, node.right, next);
+    return emit(compiler, OP_SPLIT, left, right, 0);
+  }
+  default: {
+    // Counted repetition is unrolled: x{2,4} becomes x x (x (x)?)?.
+    uint32_t tail = next;
+    if (node.max < 0) {
+      uint32_t loop = emit(compiler, OP_SPLIT, 0, next, 0);
+      uint32_t body = compile_node(compiler, node.left, loop);
+      if (!compiler->failed) {
+        compiler->program[loop].out = body;
+      }
+      tail = loop;
+    } else {
+      for (int32_t i = node.min; i < node.max && !compiler->failed; i++) {
+        uint32_t body = compile_node(compiler, node.left, tail);
+        tail = emit(compiler, OP_SPLIT, body, next, 0);
+      }
+    }
+    for (int32_t i = 0; i < node.min && !compiler->failed; i++) {
+      tail = compile_node(compiler, node.left, tail);
+    }
+    return tail;
+  }
+  }
+}
+
+static bool is_single_byte(const uint64_t bits[4], uint8_t *byte) {
+  unsigned count = 0;
+  for (int i = 0; i < 4; i++) {
+    count += population_count(bits[i]);
+  }
+  if (count != 1) {
+    return false;
+  }
+  for (unsigned b = 0;; b++) {
+    if (set_contains(bits, (uint8_t)b)) {
+      *byte = (uint8_t)b;
+      return true;
+    }
+  }
+}
+
+// Collects the literal bytes that every match must start with. Returns
+// false once the prefix ends.
+static bool collect_prefix(const parser_t *parser, int32_t index,
+                           matcher_t *matcher) {
+  const node_t *node = &parser->nodes[index];
+  uint8_t byte;
+  switch (node->type) {
+  case NODE_EMPTY:
+    return true;
+  case NODE_CONCAT:
+    return collect_prefix(parser, node->left, matcher) &&
+           collect_prefix(parser, node->right, matcher);
+  case NODE_SET:
+    if (matcher->prefix_len < MATCHER_MAX_PREFIX &&
+        is_single_byte(parser->sets[node->set], &byte)) {
+      matcher->prefix[matcher->prefix_len++] = byte;
+      return true;
+    }
+    return false;
+  default:
+    return false;
+  }
+}
+
+// Assigns bytes to classes such that bytes in the same class are members of
+// exactly the same sets.
+static void compute_byte_classes(matcher_t *matcher) {
+  bool boundary[256] = {false};
+  for (size_t s = 0; s < matcher->set_count; s++) {
+    for (unsigned b = 0; b < 255; b++) {
+      if (set_contains(matcher->sets[s], (uint8_t)b) !=
+          set_contains(matcher->sets[s], (uint8_t)(b + 1))) {
+        boundary[b] = true;
+      }
+    }
+  }
+  matcher->classes[0] = 0;
+  for (unsigned b = 1; b < 256; b++) {
+    matcher->classes[b] = (uint8_t)(matcher->classes[b - 1] + boundary[b - 1]);
+  }
+  matcher->class_count = (size_t)matcher->classes[255] + 1;
+}
+
+static void reset_cache(matcher_t *matcher);
+
+static matcher_t *compile(const char *pattern, bool glob) {
+  if (!pattern) {
+    panic(stderr, "Pattern pointer is empty.");
+  }
+  parser_t parser;
+  memset(&parser, 0, sizeof(parser));
+  parser.pattern = pattern;
+  int32_t root = glob ? parse_glob(&parser) : parse_regex(&parser);
+
+  compiler_t compiler;
+  memset(&compiler, 0, sizeof(compiler));
+  compiler.parser = &parser;
+  uint32_t start = 0;
+  if (!parser.failed) {
+    uint32_t match = emit(&compiler, OP_MATCH, 0, 0, 0);
+    start = compile_node(&compiler, root, match);
+  }
+  if (parser.failed || compiler.failed) {
+    free(parser.nodes);
+    free(parser.sets);
+    free(compiler.program);
+    return NULL;
+  }
+
+  matcher_t *matcher = allocate(sizeof(matcher_t));
+  memset(matcher, 0, sizeof(matcher_t));
+  matcher->program = compiler.program;
+  matcher->program_len = compiler.len;
+  matcher->start = start;
+  matcher->sets = parser.sets;
+  matcher->set_count = parser.set_count;
+  compute_byte_classes(matcher);
+  collect_prefix(&parser, root, matcher);
+  free(parser.nodes);
+
+  const size_t len = matcher->program_len;
+  matcher->dense = allocate(len * sizeof(uint32_t));
+  matcher->sparse = calloc(len, sizeof(uint32_t));
+  matcher->stack = allocate((3 * len + 2) * sizeof(uint32_t));
+  matcher->key = allocate(len * sizeof(uint32_t));
+  matcher->current = allocate(len * sizeof(uint32_t));
+  matcher->states = allocate(MATCHER_MAX_STATES * sizeof(matcher_state_t));
+  matcher->transitions = allocate(MATCHER_MAX_STATES * matcher->class_count *
+                                  sizeof(int32_t));
+  matcher->table_capacity = 2 * MATCHER_MAX_STATES;
+  matcher->table = allocate(matcher->table_capacity * sizeof(int32_t));
+  matcher->pool_capacity = 4 * len + 16;
+  matcher->pool = allocate(matcher->pool_capacity * sizeof(uint32_t));
+  if (!matcher->sparse) {
+    panic(stderr, "Could not allocate memory for the matcher.");
+  }
+  reset_cache(matcher);
+  return matcher;
+}
+
+matcher_t *compile_regex(const char *pattern) { return compile(pattern, false); }
+
+matcher_t *compile_glob(const char *pattern) { return compile(pattern, true); }
+
+// SECTION: The lazy DFA.
+
+static bool set_has(const matcher_t *matcher, uint32_t pc) {
+  uint32_t slot = matcher->sparse[pc];
+  return slot < matcher->set_len && matcher->dense[slot] == pc;
+}
+
+// Adds the instruction and everything reachable from it without consuming a
+// byte to the current set.
+static void add_closure(matcher_t *matcher, uint32_t pc, bool at_start,
+                        bool at_end) {
+  size_t top = 0;
+  matcher->stack[top++] = pc;
+  while (top > 0) {
+    pc = matcher->stack[--top];
+    if (set_has(matcher, pc)) {
+      continue;
+    }
+    matcher->sparse[pc] = (uint32_t)matcher->set_len;
+    matcher->dense[matcher->set_len++] = pc;
+    const matcher_instruction_t *instruction = &matcher->program[pc];
+    switch (instruction->op) {
+    case OP_SPLIT:
+      matcher->stack[top++] = instruction->alternative;
+      matcher->stack[top++] = instruction->out;
+      break;
+    case OP_START:
+      if (at_start) {
+        matcher->stack[top++] = instruction->out;
+      }
+      break;
+    case OP_END:
+      if (at_end) {
+        matcher->stack[top++] = instruction->out;
+      }
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+static int compare_pcs(const void *a, const void *b) {
+  uint32_t left = *(const uint32_t *)a, right = *(const uint32_t *)b;
+  return left < right ? -1 : left > right;
+}
+
+// Extracts the instructions that identify a state from the current set:
+// the ones that consume a byte, matches and pending end assertions.
+static size_t build_key(matcher_t *matcher) {
+  size_t count = 0;
+  for (size_t i = 0; i < matcher->set_len; i++) {
+    uint32_t pc = matcher->dense[i];
+    uint8_t op = matcher->program[pc].op;
+    if (op == OP_BYTE || op == OP_MATCH || op == OP_END) {
+      matcher->key[count++] = pc;
+    }
+  }
+  qsort(matcher->key, count, sizeof(uint32_t), compare_pcs);
+  return count;
+}
+
+static uint64_t hash_key(const uint32_t *key, size_t count, bool initial) {
+  uint64_t hash = 0xcbf29ce484222325ULL ^ initial;
+  for (size_t i = 0; i < count; i++) {
+    hash = (hash ^ key[i]) * 0x100000001b3ULL;
+  }
+  return hash ^ (hash >> 29);
+}
+
+// Finds or creates the state for the current key. The cache must have room
+// for one more state.
+static int32_t intern_state(matcher_t *matcher, size_t count, bool initial) {
+  const size_t mask = matcher->table_capacity - 1;
+  size_t slot = (size_t)hash_key(matcher->key, count, initial) & mask;
+  for (;; slot = (slot + 1) & mask) {
+    int32_t id = matcher->table[slot];
+    if (id < 0) {
+      break;
+    }
+    const matcher_state_t *state = &matcher->states[id];
+    if (state->count == count && state->initial == initial &&
+        memcmp(matcher->pool + state->offset, matcher->key,
+               count * sizeof(uint32_t)) == 0) {
+      return id;
+    }
+  }
+
+  int32_t id = (int32_t)matcher->state_count++;
+  matcher->table[slot] = id;
+  if (matcher->pool_len + count > matcher->pool_capacity) {
+    matcher->pool_capacity = 2 * (matcher->pool_len + count);
+    matcher->pool = reallocate(matcher->pool,
+                               matcher->pool_capacity * sizeof(uint32_t));
+  }
+  matcher_state_t *state = &matcher->states[id];
+  state->offset = matcher->pool_len;
+  state->count = count;
+  state->initial = initial;
+  state->matching = false;
+  memcpy(matcher->pool + matcher->pool_len, matcher->key,
+         count * sizeof(uint32_t));
+  matcher->pool_len += count;
+  for (size_t i = 0; i < matcher->class_count; i++) {
+    matcher->transitions[(size_t)id * matcher->class_count + i] = -1;
+  }
+
+  // Follow the pending end assertions to see if the state matches when the
+  // input ends here.
+  matcher->set_len = 0;
+  for (size_t i = 0; i < count; i++) {
+    uint32_t pc = matcher->pool[state->offset + i];
+    if (matcher->program[pc].op == OP_MATCH) {
+      state->matching = true;
+    } else if (matcher->program[pc].op == OP_END) {
+      add_closure(matcher, matcher->program[pc].out, initial, true);
+    }
+  }
+  state->matching_at_end = state->matching;
+  for (size_t i = 0; i < matcher->set_len; i++) {
+    if (matcher->program[matcher->dense[i]].op == OP_MATCH) {
+      state->matching_at_end = true;
+    }
+  }
+  return id;
+}
+
+// Clears the cache and creates the two entry states: the initial one (at the
+// start of the input) and the one that every other state falls back to,
+// which starts a new match attempt at the current position.
+static void reset_cache(matcher_t *matcher) {
+  matcher->state_count = 0;
+  matcher->pool_len = 0;
+  for (size_t i = 0; i < matcher->table_capacity; i++) {
+    matcher->table[i] = -1;
+  }
+  matcher->set_len = 0;
+  add_closure(matcher, matcher->start, true, false);
+  matcher->initial = intern_state(matcher, build_key(matcher), true);
+  matcher->set_len = 0;
+  add_closure(matcher, matcher->start, false, false);
+  matcher->restart = intern_state(matcher, build_key(matcher), false);
+}
+
+// Transitions store the row of the target state in the transition table,
+// tagged when the matching loop has to look at the state itself: when it is
+// a match, when no match is possible any more, or when it can skip ahead to
+// the next occurrence of the prefix.
+static const int32_t SPECIAL = 1 << 30;
+
+static int32_t tag_state(const matcher_t *matcher, int32_t id) {
+  const matcher_state_t *state = &matcher->states[id];
+  int32_t row = id * (int32_t)matcher->class_count;
+  if (state->matching || state->count == 0 ||
+      (id == matcher->restart && matcher->prefix_len > 0)) {
+    row |= SPECIAL;
+  }
+  return row;
+}
+
+static int32_t compute_transition(matcher_t *matcher, int32_t row,
+                                  uint8_t byte) {
+  int32_t from = row / (int32_t)matcher->class_count;
+  const matcher_state_t *state = &matcher->states[from];
+  size_t count = state->count;
+  memcpy(matcher->current, matcher->pool + state->offset,
+         count * sizeof(uint32_t));
+  if (matcher->state_count == MATCHER_MAX_STATES) {
+    reset_cache(matcher);
+    from = -1;
+  }
+
+  matcher->set_len = 0;
+  for (size_t i = 0; i < count; i++) {
+    const matcher_instruction_t *instruction =
+        &matcher->program[matcher->current[i]];
+    if (instruction->op == OP_BYTE &&
+        set_contains(matcher->sets[instruction->set], byte)) {
+      add_closure(matcher, instruction->out, false, false);
+    }
+  }
+  // Unanchored search: a new match may start after every byte.
+  add_closure(matcher, matcher->start, false, false);
+  int32_t to = tag_state(matcher, intern_state(matcher, build_key(matcher),
+                                               false));
+  if (from >= 0) {
+    matcher->transitions[(size_t)from * matcher->class_count +
+                         matcher->classes[byte]] = to;
+  }
+  return to;
+}
+
+bool matcher_matches(matcher_t *matcher, const string_t *string) {
+  if (!matcher || !string) {
+    panic(stderr, "Matcher or string pointer is empty.");
+  }
+  const uint8_t *data = string->data;
+  const size_t len = string->len;
+  size_t position = 0;
+  int32_t current = matcher->initial;
+  if (matcher->prefix_len > 0) {
+    // Every match starts with the prefix, so skip to its first occurrence.
+    position = search_bytes(data, len, matcher->prefix, matcher->prefix_len);
+    if (position == len) {
+      return false;
+    }
+    if (position > 0) {
+      current = matcher->restart;
+    }
+  }
+  if (matcher->states[current].matching) {
+    return true;
+  }
+  const uint8_t *classes = matcher->classes;
+  int32_t row = current * (int32_t)matcher->class_count;
+  while (position < len) {
+    uint8_t byte = data[position++];
+    int32_t next = matcher->transitions[row + classes[byte]];
+    if (next < 0) {
+      next = compute_transition(matcher, row, byte);
+    }
+    row = next & ~SPECIAL;
+    if (next & SPECIAL) {
+      current = row / (int32_t)matcher->class_count;
+      const matcher_state_t *state = &matcher->states[current];
+      if (state->matching) {
+        return true;
+      }
+      if (state->count == 0) {
+        return false; // No match can start or continue any more.
+      }
+      // Back at the restart state: skip to the next possible match.
+      size_t skip = search_bytes(data + position, len - position,
+                                 matcher->prefix, matcher->prefix_len);
+      if (skip == len - position) {
+        return false;
+      }
+      position += skip;
+    }
+  }
+  return matcher->states[row / (int32_t)matcher->class_count].matching_at_end;
+}
+
+void free_matcher(matcher_t *matcher) {
+  if (!matcher) {
+    return;
+  }
+  free(matcher->program);
+  free(matcher->sets);
+  free(matcher->states);
+  free(matcher->transitions);
+  free(matcher->pool);
+  free(matcher->table);
+  free(matcher->dense);
+  free(matcher->sparse);
+  free(matcher->stack);
+  free(matcher->key);
+  free(matcher->current);
+  free(matcher);
+}
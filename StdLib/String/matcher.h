@@ -0,0 +1,147 @@
+#ifndef C_PROGRAMS_MATCHER_H
+#define C_PROGRAMS_MATCHER_H
+/**
+ * Compiled regular expressions and globs, matched with a lazily built DFA.
+ *
+ * A pattern is compiled once into a Thompson NFA. The states of the
+ * equivalent DFA are then built on demand, the first time the input leads
+ * to them, and cached; after a short warm up every byte of input costs a
+ * single table lookup and matching does not allocate. Bytes that no part of
+ * the pattern tells apart share one column of the transition table (byte
+ * classes), which keeps the table small. When every match must begin with
+ * the same literal bytes, the matcher skips ahead to them with search_bytes
+ * instead of stepping through the DFA.
+ *
+ * Supported regular expression syntax (a subset of POSIX extended and Perl
+ * syntax, working on bytes):
+ *
+ * - literals, and '\' to escape any of the special characters .[]()|*+?{}^$\
+ * - '.' (any byte), classes such as [abc], [^a-z] and [-.0-9]
+ * - \d \w \s and their complements \D \W \S, \n \t \r, \xHH
+ * - groups (...) or (?:...), which do not capture, and alternation a|b
+ * - repetition *, +, ?, {m}, {m,} and {m,n} with m, n <= MATCHER_MAX_REPEAT
+ * - anchors ^ (start of the string) and $ (end of the string)
+ *
+ * A regular expression matches if it matches any part of the string, as
+ * with regexec; use ^ and $ to match the whole string. Globs always match
+ * the whole string; they support *, ?, [...] and [!...] (or [^...]), and
+ * '\' to escape. Unlike in file name matching, * and ? also match '/'.
+ *
+ * A matcher updates its cache while matching, so one matcher must not be
+ * used by several threads at once; compile one per thread instead.
+ */
+#include "string.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The largest count allowed in a {m,n} repetition.
+ */
+#define MATCHER_MAX_REPEAT 1000
+
+/**
+ * The most DFA states that are cached at once. When a pattern and its input
+ * need more, the cache is cleared and rebuilt as matching goes on.
+ */
+#define MATCHER_MAX_STATES 4096
+
+/**
+ * The longest literal prefix used to skip ahead.
+ */
+#define MATCHER_MAX_PREFIX 32
+
+/**
+ * An NFA instruction. Byte instructions consume a byte that is a member of
+ * set and continue at out; splits continue at both out and alternative;
+ * assertions continue at out only at the start or end of the input.
+ */
+typedef struct matcher_instruction {
+  uint8_t op;
+  uint32_t out;
+  uint32_t alternative;
+  uint32_t set;
+} matcher_instruction_t;
+
+/**
+ * A cached DFA state: the sorted NFA instructions it stands for (a slice of
+ * the matcher's pool), whether one of them is a match, and whether it
+ * matches if the input ends here (which also takes $ into account).
+ */
+typedef struct matcher_state {
+  size_t offset;
+  size_t count;
+  bool initial;
+  bool matching;
+  bool matching_at_end;
+} matcher_state_t;
+
+typedef struct matcher {
+  // The NFA.
+  matcher_instruction_t *program;
+  size_t program_len;
+  uint32_t start;
+  uint64_t (*sets)[4];
+  size_t set_count;
+
+  // The byte classes and the literal prefix.
+  uint8_t classes[256];
+  size_t class_count;
+  uint8_t prefix[MATCHER_MAX_PREFIX];
+  size_t prefix_len;
+
+  // The DFA cache. transitions holds class_count entries per state: the
+  // offset of the target state's entries (tagged, see matcher.c), or -1 for
+  // transitions that were not computed yet.
+  matcher_state_t *states;
+  size_t state_count;
+  int32_t *transitions;
+  uint32_t *pool;
+  size_t pool_len;
+  size_t pool_capacity;
+  int32_t *table;
+  size_t table_capacity;
+  int32_t initial;
+  int32_t restart;
+
+  // Scratch space for building states.
+  uint32_t *dense;
+  uint32_t *sparse;
+  size_t set_len;
+  uint32_t *stack;
+  uint32_t *key;
+  uint32_t *current;
+} matcher_t;
+
+/**
+ * Compiles a regular expression (see above for the syntax).
+ *
+ * @param pattern The NUL-terminated regular expression.
+ * @return A new matcher, or NULL if the pattern is not valid.
+ */
+matcher_t *compile_regex(const char *pattern);
+
+/**
+ * Compiles a glob such as "*.csv" or "data-[0-9]?".
+ *
+ * @param pattern The NUL-terminated glob.
+ * @return A new matcher, or NULL if the pattern is not valid.
+ */
+matcher_t *compile_glob(const char *pattern);
+
+/**
+ * Checks whether the string matches, reading it once from left to right.
+ *
+ * @param matcher The compiled pattern.
+ * @param string  The string to check.
+ * @return true if the pattern matches the string.
+ */
+bool matcher_matches(matcher_t *matcher, const string_t *string);
+
+/**
+ * @param matcher The matcher to be deallocated.
+ */
+void free_matcher(matcher_t *matcher);
+
+#endif // C_PROGRAMS_MATCHER_H
@@ -0,0 +1,642 @@
+#include "number.h"
+#include "../Panic/panic.h"
+#include "number_tables.h"
+#include "simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void assert_not_null(const void *pointer) {
+  if (!pointer) {
+    panic(stderr, "String or value pointer is empty.");
+  }
+}
+
+static void full_multiply(uint64_t a, uint64_t b, uint64_t *high,
+                          uint64_t *low) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t product = (__uint128_t)a * b;
+  *low = (uint64_t)product;
+  *high = (uint64_t)(product >> 64);
+#else
+  uint64_t a_low = (uint32_t)a, a_high = a >> 32;
+  uint64_t b_low = (uint32_t)b, b_high = b >> 32;
+  uint64_t low_low = a_low * b_low, high_low = a_high * b_low;
+  uint64_t low_high = a_low * b_high, high_high = a_high * b_high;
+  uint64_t cross = (low_low >> 32) + (uint32_t)high_low + low_high;
+  *low = (cross << 32) | (uint32_t)low_low;
+  *high = (high_low >> 32) + (cross >> 32) + high_high;
+#endif
+}
+
+static inline int leading_zeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_clzll(value);
+#else
+  int count = 0;
+  while (!(value & 0x8000000000000000ULL)) {
+    value <<= 1;
+    count++;
+  }
+  return count;
+#endif
+}
+
+// SECTION: Digits.
+
+static inline bool is_digit(uint8_t byte) { return (uint8_t)(byte - '0') < 10; }
+
+// Checks that all eight bytes are in '0'..'9': adding 6 pushes any byte above
+// '9' into the next sixteen, so both nibbles must come out as 3.
+static inline bool is_eight_digits(uint64_t word) {
+  return ((word & 0xf0f0f0f0f0f0f0f0ULL) |
+          (((word + 0x0606060606060606ULL) & 0xf0f0f0f0f0f0f0f0ULL) >> 4)) ==
+         0x3333333333333333ULL;
+}
+
+// Converts eight ASCII digits (first digit in the lowest byte) to their value
+// with three multiplications, combining pairs, then quads, then the halves.
+static inline uint32_t parse_eight_digits(uint64_t word) {
+  const uint64_t mask = 0x000000ff000000ffULL;
+  const uint64_t mul1 = 0x000f424000000064ULL; // 100 + (1000000 << 32)
+  const uint64_t mul2 = 0x0000271000000001ULL; // 1 + (10000 << 32)
+  word -= 0x3030303030303030ULL;
+  word = (word * 10) + (word >> 8);
+  word = (((word & mask) * mul1) + (((word >> 16) & mask) * mul2)) >> 32;
+  return (uint32_t)word;
+}
+
+// Accumulates the run of digits starting at index into value and returns the
+// index just past the run.
+static size_t read_digits(const uint8_t *data, size_t len, size_t index,
+                          uint64_t *value) {
+  uint64_t result = *value;
+  while (index + 8 <= len && is_eight_digits(load_u64(data + index))) {
+    result = result * 100000000 + parse_eight_digits(load_u64(data + index));
+    index += 8;
+  }
+  while (index < len && is_digit(data[index])) {
+    result = result * 10 + (uint64_t)(data[index] - '0');
+    index++;
+  }
+  *value = result;
+  return index;
+}
+
+bool string_to_int64(const string_t *string, int64_t *value) {
+  assert_not_null(string);
+  assert_not_null(value);
+  const uint8_t *data = string->data;
+  const size_t len = string->len;
+  size_t index = 0;
+  bool negative = false;
+  if (index < len && (data[index] == '-' || data[index] == '+')) {
+    negative = data[index] == '-';
+    index++;
+  }
+  size_t start = index;
+  while (index < len && data[index] == '0') {
+    index++;
+  }
+  bool had_zeros = index > start;
+  size_t significant_start = index;
+  uint64_t magnitude = 0;
+  index = read_digits(data, len, index, &magnitude);
+  size_t significant = index - significant_start;
+  // 19 digits always fit in a uint64_t, 20 digits never fit in an int64_t.
+  if (index != len || (significant == 0 && !had_zeros) ||
+      significant > 19) {
+    return false;
+  }
+  if (negative) {
+    if (magnitude > (uint64_t)INT64_MAX + 1) {
+      return false;
+    }
+    *value = magnitude == (uint64_t)INT64_MAX + 1 ? INT64_MIN
+                                                  : -(int64_t)magnitude;
+  } else {
+    if (magnitude > (uint64_t)INT64_MAX) {
+      return false;
+    }
+    *value = (int64_t)magnitude;
+  }
+  return true;
+}
+
+// SECTION: Decimal to binary.
+
+static const double EXACT_POWERS_OF_TEN[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static const int MANTISSA_BITS = 52;
+static const int EXPONENT_BIAS = 1023;
+static const int INFINITE_POWER = 0x7ff;
+
+typedef struct adjusted_mantissa {
+  uint64_t mantissa;
+  int32_t power2; // Biased exponent; -1 asks the caller to fall back.
+} adjusted_mantissa_t;
+
+// Computes the double nearest to w * 10^q from a 128-bit approximation of
+// 5^q. Reports failure (power2 < 0) in the rare cases where the truncated
+// product does not determine the rounding.
+static adjusted_mantissa_t eisel_lemire(int64_t q, uint64_t w) {
+  adjusted_mantissa_t answer = {0, 0};
+  if (q < POW5_128_SMALLEST_POWER) {
+    return answer;
+  }
+  if (q > POW5_128_LARGEST_POWER) {
+    answer.power2 = INFINITE_POWER;
+    return answer;
+  }
+  int lz = leading_zeros(w);
+  w <<= lz;
+
+  size_t index = 2 * (size_t)(q - POW5_128_SMALLEST_POWER);
+  uint64_t high, low;
+  full_multiply(w, POW5_128[index], &high, &low);
+  // Only the top MANTISSA_BITS + 3 bits of the product matter. If the bits
+  // below them are all ones, a carry from the low word could still change
+  // them, so the second half of the power is multiplied in too.
+  const uint64_t precision_mask = UINT64_MAX >> (MANTISSA_BITS + 3);
+  if ((high & precision_mask) == precision_mask) {
+    uint64_t second_high, second_low;
+    full_multiply(w, POW5_128[index + 1], &second_high, &second_low);
+    low += second_high;
+    if (second_high > low) {
+      high++;
+    }
+  }
+  if (low == UINT64_MAX && (q < -27 || q > 55)) {
+    answer.power2 = -1;
+    return answer;
+  }
+
+  int upper_bit = (int)(high >> 63);
+  int shift = upper_bit + 64 - MANTISSA_BITS - 3;
+  answer.mantissa = high >> shift;
+  // floor(log2(10^q)) + 63, computed as q * log2(10) in fixed point.
+  int64_t power = (((152170 + 65536) * q) >> 16) + 63;
+  answer.power2 = (int32_t)(power + upper_bit - lz + EXPONENT_BIAS);
+
+  if (answer.power2 <= 0) {
+    // Subnormal numbers.
+    if (-answer.power2 + 1 >= 64) {
+      answer.mantissa = 0;
+      answer.power2 = 0;
+      return answer;
+    }
+    answer.mantissa >>= -answer.power2 + 1;
+    answer.mantissa += answer.mantissa & 1;
+    answer.mantissa >>= 1;
+    // Rounding up may have produced the smallest normal number.
+    answer.power2 = answer.mantissa < (1ULL << MANTISSA_BITS) ? 0 : 1;
+    return answer;
+  }
+
+  // Exactly halfway between two doubles: round to even. This can only
+  // happen for small exponents, where 5^q is exact.
+  if (low <= 1 && q >= -4 && q <= 23 && (answer.mantissa & 3) == 1 &&
+      (answer.mantissa << shift) == high) {
+    answer.mantissa &= ~1ULL;
+  }
+  answer.mantissa += answer.mantissa & 1;
+  answer.mantissa >>= 1;
+  if (answer.mantissa >= (2ULL << MANTISSA_BITS)) {
+    answer.mantissa = 1ULL << MANTISSA_BITS;
+    answer.power2++;
+  }
+  answer.mantissa &= ~(1ULL << MANTISSA_BITS);
+  if (answer.power2 >= INFINITE_POWER) {
+    answer.power2 = INFINITE_POWER;
+    answer.mantissa = 0;
+  }
+  return answer;
+}
+
+static bool fallback_to_strtod(const uint8_t *data, size_t len,
+                               double *value) {
+  char small[64];
+  char *buffer = len < sizeof(small) ? small : malloc(len + 1);
+  if (!buffer) {
+    panic(stderr, "Could not allocate the number buffer.");
+  }
+  memcpy(buffer, data, len);
+  buffer[len] = '\0';
+  *value = strtod(buffer, NULL);
+  if (buffer != small) {
+    free(buffer);
+  }
+  return true;
+}
+
+static bool matches_ignore_case(const uint8_t *data, size_t len,
+                                const char *word) {
+  size_t word_len = strlen(word);
+  if (len != word_len) {
+    return false;
+  }
+  for (size_t i = 0; i < len; i++) {
+    if ((data[i] | 0x20) != (uint8_t)word[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool string_to_double(const string_t *string, double *value) {
+  assert_not_null(string);
+  assert_not_null(value);
+  const uint8_t *data = string->data;
+  const size_t len = string->len;
+  size_t index = 0;
+  bool negative = false;
+  if (index < len && (data[index] == '-' || data[index] == '+')) {
+    negative = data[index] == '-';
+    index++;
+  }
+  if (index < len && !is_digit(data[index]) && data[index] != '.') {
+    const uint8_t *word = data + index;
+    size_t word_len = len - index;
+    double special;
+    if (matches_ignore_case(word, word_len, "inf") ||
+        matches_ignore_case(word, word_len, "infinity")) {
+      special = __builtin_inf();
+    } else if (matches_ignore_case(word, word_len, "nan")) {
+      special = __builtin_nan("");
+    } else {
+      return false;
+    }
+    *value = negative ? -special : special;
+    return true;
+  }
+
+  // Leading zeros are skipped so that only significant digits are counted;
+  // at most 19 of them are guaranteed to fit in w.
+  uint64_t w = 0;
+  int64_t exponent = 0;
+  size_t start = index;
+  while (index < len && data[index] == '0') {
+    index++;
+  }
+  size_t significant_start = index;
+  index = read_digits(data, len, index, &w);
+  size_t significant = index - significant_start;
+  bool any_digits = index > start;
+  if (index < len && data[index] == '.') {
+    index++;
+    size_t fraction_start = index;
+    if (significant == 0) {
+      while (index < len && data[index] == '0') {
+        index++;
+      }
+    }
+    significant_start = index;
+    index = read_digits(data, len, index, &w);
+    significant += index - significant_start;
+    exponent -= (int64_t)(index - fraction_start);
+    any_digits |= index > fraction_start;
+  }
+  if (!any_digits) {
+    return false;
+  }
+  if (index < len && (data[index] == 'e' || data[index] == 'E')) {
+    index++;
+    bool negative_exponent = false;
+    if (index < len && (data[index] == '-' || data[index] == '+')) {
+      negative_exponent = data[index] == '-';
+      index++;
+    }
+    if (index == len || !is_digit(data[index])) {
+      return false;
+    }
+    int64_t explicit_exponent = 0;
+    for (; index < len && is_digit(data[index]); index++) {
+      // Anything this large overflows or underflows anyway.
+      if (explicit_exponent < 0x10000000) {
+        explicit_exponent = explicit_exponent * 10 + (data[index] - '0');
+      }
+    }
+    exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+  }
+  if (index != len) {
+    return false;
+  }
+
+  double result;
+  if (significant > 19) {
+    return fallback_to_strtod(data, len, value);
+  } else if (w == 0) {
+    result = 0.0;
+  } else if (exponent >= -22 && exponent <= 22 && w <= (1ULL << 53)) {
+    // Both w and 10^|exponent| are exact doubles, so a single rounding
+    // operation gives the correctly rounded result (Clinger).
+    result = (double)w;
+    result = exponent < 0 ? result / EXACT_POWERS_OF_TEN[-exponent]
+                          : result * EXACT_POWERS_OF_TEN[exponent];
+  } else {
+    adjusted_mantissa_t adjusted = eisel_lemire(exponent, w);
+    if (adjusted.power2 < 0) {
+      return fallback_to_strtod(data, len, value);
+    }
+    uint64_t bits =
+        adjusted.mantissa | ((uint64_t)adjusted.power2 << MANTISSA_BITS);
+    memcpy(&result, &bits, sizeof(result));
+  }
+  *value = negative ? -result : result;
+  return true;
+}
+
+// SECTION: Integer to decimal.
+
+static const char DIGIT_PAIRS[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536"
+    "37383940414243444546474849505152535455565758596061626364656667686970717273"
+    "7475767778798081828384858687888990919293949596979899";
+
+// Writes the digits of value to the buffer and returns how many there are.
+static size_t write_unsigned(uint64_t value, uint8_t *buffer) {
+  uint8_t digits[20];
+  size_t position = sizeof(digits);
+  while (value >= 100) {
+    size_t pair = (size_t)(value % 100) * 2;
+    value /= 100;
+    digits[--position] = (uint8_t)DIGIT_PAIRS[pair + 1];
+    digits[--position] = (uint8_t)DIGIT_PAIRS[pair];
+  }
+  if (value >= 10) {
+    digits[--position] = (uint8_t)DIGIT_PAIRS[value * 2 + 1];
+    digits[--position] = (uint8_t)DIGIT_PAIRS[value * 2];
+  } else {
+    digits[--position] = (uint8_t)('0' + value);
+  }
+  size_t count = sizeof(digits) - position;
+  memcpy(buffer, digits + position, count);
+  return count;
+}
+
+size_t format_int64(int64_t value, uint8_t *buffer) {
+  assert_not_null(buffer);
+  if (value < 0) {
+    buffer[0] = '-';
+    return 1 + write_unsigned(0 - (uint64_t)value, buffer + 1);
+  }
+  return write_unsigned((uint64_t)value, buffer);
+}
+
+// SECTION: Binary to decimal (Ryu).
+
+static inline int32_t pow5_bits(int32_t e) {
+  return (int32_t)((((uint32_t)e * 1217359) >> 19) + 1);
+}
+
+static inline uint32_t log10_pow2(int32_t e) {
+  return ((uint32_t)e * 78913) >> 18;
+}
+
+static inline uint32_t log10_pow5(int32_t e) {
+  return ((uint32_t)e * 732923) >> 20;
+}
+
+static inline bool multiple_of_pow5(uint64_t value, uint32_t p) {
+  uint32_t count = 0;
+  while (value % 5 == 0 && value) {
+    value /= 5;
+    count++;
+  }
+  return count >= p;
+}
+
+static inline bool multiple_of_pow2(uint64_t value, uint32_t p) {
+  return (value & ((1ULL << p) - 1)) == 0;
+}
+
+// Returns (m * mul) >> j, where mul is a 128-bit number (low word first)
+// and 64 < j < 128.
+static inline uint64_t mul_shift(uint64_t m, const uint64_t *mul, int32_t j) {
+  uint64_t high0, low0, high1, low1;
+  full_multiply(m, mul[0], &high0, &low0);
+  full_multiply(m, mul[1], &high1, &low1);
+  uint64_t sum = high0 + low1;
+  if (sum < high0) {
+    high1++;
+  }
+  int32_t distance = j - 64;
+  return (high1 << (64 - distance)) | (sum >> distance);
+}
+
+// Computes the shortest decimal digits (and their decimal exponent) that
+// lie within the rounding interval of the given (finite, non-zero) double.
+static void shortest_digits(uint64_t ieee_mantissa, uint32_t ieee_exponent,
+                            uint64_t *digits, int32_t *exponent) {
+  int32_t e2;
+  uint64_t m2;
+  if (ieee_exponent == 0) {
+    e2 = 1 - EXPONENT_BIAS - MANTISSA_BITS - 2;
+    m2 = ieee_mantissa;
+  } else {
+    e2 = (int32_t)ieee_exponent - EXPONENT_BIAS - MANTISSA_BITS - 2;
+    m2 = (1ULL << MANTISSA_BITS) | ieee_mantissa;
+  }
+  const bool accept_bounds = (m2 & 1) == 0;
+
+  // The interval of decimals that round to this double is [mm, mp] (or the
+  // open interval, for odd mantissas), where mv is the double itself, all
+  // scaled by 4 so that the bounds are integers.
+  const uint64_t mv = 4 * m2;
+  const uint32_t mm_shift = ieee_mantissa != 0 || ieee_exponent <= 1;
+  uint64_t vr, vp, vm;
+  int32_t e10;
+  bool vm_trailing_zeros = false;
+  bool vr_trailing_zeros = false;
+  if (e2 >= 0) {
+    const uint32_t q = log10_pow2(e2) - (e2 > 3);
+    e10 = (int32_t)q;
+    const int32_t k = POW5_INV_BITCOUNT + pow5_bits((int32_t)q) - 1;
+    const int32_t i = -e2 + (int32_t)q + k;
+    vr = mul_shift(4 * m2, POW5_INV_SPLIT[q], i);
+    vp = mul_shift(4 * m2 + 2, POW5_INV_SPLIT[q], i);
+    vm = mul_shift(4 * m2 - 1 - mm_shift, POW5_INV_SPLIT[q], i);
+    if (q <= 21) {
+      // Only one of mm, mv and mp can be a multiple of 5, if any.
+      if (mv % 5 == 0) {
+        vr_trailing_zeros = multiple_of_pow5(mv, q);
+      } else if (accept_bounds) {
+        vm_trailing_zeros = multiple_of_pow5(mv - 1 - mm_shift, q);
+      } else {
+        vp -= multiple_of_pow5(mv + 2, q);
+      }
+    }
+  } else {
+    const uint32_t q = log10_pow5(-e2) - (-e2 > 1);
+    e10 = (int32_t)q + e2;
+    const int32_t i = -e2 - (int32_t)q;
+    const int32_t k = pow5_bits(i) - POW5_BITCOUNT;
+    const int32_t j = (int32_t)q - k;
+    vr = mul_shift(4 * m2, POW5_SPLIT[i], j);
+    vp = mul_shift(4 * m2 + 2, POW5_SPLIT[i], j);
+    vm = mul_shift(4 * m2 - 1 - mm_shift, POW5_SPLIT[i], j);
+    if (q <= 1) {
+      vr_trailing_zeros = true;
+      if (accept_bounds) {
+        vm_trailing_zeros = mm_shift == 1;
+      } else {
+        --vp;
+      }
+    } else if (q < 63) {
+      vr_trailing_zeros = multiple_of_pow2(mv, q);
+    }
+  }
+
+  // Remove digits while the bounds still differ, keeping track of the last
+  // removed digit to round correctly.
+  int32_t removed = 0;
+  uint8_t last_removed = 0;
+  uint64_t output;
+  if (vm_trailing_zeros || vr_trailing_zeros) {
+    while (vp / 10 > vm / 10) {
+      vm_trailing_zeros &= vm % 10 == 0;
+      vr_trailing_zeros &= last_removed == 0;
+      last_removed = (uint8_t)(vr % 10);
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      removed++;
+    }
+    if (vm_trailing_zeros) {
+      while (vm % 10 == 0) {
+        vr_trailing_zeros &= last_removed == 0;
+        last_removed = (uint8_t)(vr % 10);
+        vr /= 10;
+        vp /= 10;
+        vm /= 10;
+        removed++;
+      }
+    }
+    if (vr_trailing_zeros && last_removed == 5 && vr % 2 == 0) {
+      // Exactly halfway: round to even.
+      last_removed = 4;
+    }
+    output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) ||
+                   last_removed >= 5);
+  } else {
+    bool round_up = false;
+    if (vp / 100 > vm / 100) {
+      round_up = vr % 100 >= 50;
+      vr /= 100;
+      vp /= 100;
+      vm /= 100;
+      removed += 2;
+    }
+    while (vp / 10 > vm / 10) {
+      round_up = vr % 10 >= 5;
+      vr /= 10;
+      vp /= 10;
+      vm /= 10;
+      removed++;
+    }
+    output = vr + (vr == vm || round_up);
+  }
+  *digits = output;
+  *exponent = e10 + removed;
+}
+
+// Lays out the digits (with value digits * 10^exponent) like JavaScript's
+// Number.prototype.toString does.
+static size_t write_decimal(uint8_t *buffer, bool negative, uint64_t digits,
+                            int32_t exponent) {
+  uint8_t text[20];
+  const int32_t count = (int32_t)write_unsigned(digits, text);
+  const int32_t point = count + exponent; // Digits before the decimal point.
+  size_t len = 0;
+  if (negative) {
+    buffer[len++] = '-';
+  }
+  if (count <= point && point <= 21) {
+    memcpy(buffer + len, text, (size_t)count);
+    len += (size_t)count;
+    memset(buffer + len, '0', (size_t)(point - count));
+    len += (size_t)(point - count);
+  } else if (0 < point && point <= 21) {
+    memcpy(buffer + len, text, (size_t)point);
+    len += (size_t)point;
+    buffer[len++] = '.';
+    memcpy(buffer + len, text + point, (size_t)(count - point));
+    len += (size_t)(count - point);
+  } else if (-6 < point && point <= 0) {
+    buffer[len++] = '0';
+    buffer[len++] = '.';
+    memset(buffer + len, '0', (size_t)-point);
+    len += (size_t)-point;
+    memcpy(buffer + len, text, (size_t)count);
+    len += (size_t)count;
+  } else {
+    buffer[len++] = text[0];
+    if (count > 1) {
+      buffer[len++] = '.';
+      memcpy(buffer + len, text + 1, (size_t)(count - 1));
+      len += (size_t)(count - 1);
+    }
+    buffer[len++] = 'e';
+    int32_t scientific = point - 1;
+    buffer[len++] = scientific < 0 ? '-' : '+';
+    len += write_unsigned((uint64_t)(scientific < 0 ? -scientific : scientific),
+                          buffer + len);
+  }
+  return len;
+}
+
+size_t format_double(double value, uint8_t *buffer) {
+  assert_not_null(buffer);
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const bool negative = bits >> 63;
+  const uint64_t ieee_mantissa = bits & ((1ULL << MANTISSA_BITS) - 1);
+  const uint32_t ieee_exponent =
+      (uint32_t)((bits >> MANTISSA_BITS) & INFINITE_POWER);
+
+  if (ieee_exponent == (uint32_t)INFINITE_POWER) {
+    if (ieee_mantissa) {
+      memcpy(buffer, "nan", 3);
+      return 3;
+    }
+    memcpy(buffer, negative ? "-inf" : "inf", negative ? 4 : 3);
+    return negative ? 4 : 3;
+  }
+  if (ieee_exponent == 0 && ieee_mantissa == 0) {
+    memcpy(buffer, negative ? "-0" : "0", negative ? 2 : 1);
+    return negative ? 2 : 1;
+  }
+
+  // Integers below 2^53 are exact; print them without running Ryu.
+  const int32_t e2 = (int32_t)ieee_exponent - EXPONENT_BIAS - MANTISSA_BITS;
+  if (e2 <= 0 && e2 >= -MANTISSA_BITS) {
+    const uint64_t m2 = (1ULL << MANTISSA_BITS) | ieee_mantissa;
+    const uint64_t fraction_mask = (1ULL << -e2) - 1;
+    if ((m2 & fraction_mask) == 0) {
+      return write_decimal(buffer, negative, m2 >> -e2, 0);
+    }
+  }
+
+  uint64_t digits;
+  int32_t exponent;
+  shortest_digits(ieee_mantissa, ieee_exponent, &digits, &exponent);
+  return write_decimal(buffer, negative, digits, exponent);
+}
+
+string_t *int64_to_string(int64_t value) {
+  uint8_t buffer[NUMBER_BUFFER_SIZE];
+  size_t len = format_int64(value, buffer);
+  string_t *string = new_string(len);
+  memcpy(string->data, buffer, len);
+  return string;
+}
+
+string_t *double_to_string(double value) {
+  uint8_t buffer[NUMBER_BUFFER_SIZE];
+  size_t len = format_double(value, buffer);
+  string_t *string = new_string(len);
+  memcpy(string->data, buffer, len);
+  return string;
+}
@@ -0,0 +1,96 @@
+#ifndef C_PROGRAMS_NUMBER_H
+#define C_PROGRAMS_NUMBER_H
+/**
+ * Conversions between numbers and string_t, without intermediate C strings.
+ *
+ * Parsing reads straight from the data and length of a string_t, so fields
+ * of a record (or views into a buffer) can be converted without copying
+ * them into a NUL-terminated buffer first. The whole string must be a
+ * number: leading or trailing whitespace and any other extra bytes are
+ * rejected (use trim_string first if needed).
+ *
+ * - Integers are read eight digits at a time (SWAR).
+ * - Decimal floating point numbers are converted with the algorithm of
+ *   Clinger when the result is exact in double precision, and otherwise with
+ *   the Eisel-Lemire algorithm ("Number Parsing at a Gigabyte per Second",
+ *   Lemire 2021). Inputs with more than 19 significant digits and the rare
+ *   ambiguous cases fall back to strtod. The result is always the correctly
+ *   rounded double, identical to strtod in the "C" locale.
+ * - Doubles are formatted with the Ryu algorithm (Adams 2018), which finds
+ *   the shortest decimal representation that parses back to exactly the
+ *   same double.
+ */
+#include "string.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * The size of a buffer that can hold any formatted int64_t or double.
+ */
+#define NUMBER_BUFFER_SIZE 32
+
+/**
+ * Parses a decimal integer with an optional leading '+' or '-'.
+ *
+ * @param string The string to parse.
+ * @param value  Receives the parsed value on success.
+ * @return true on success; false if the string is not an integer or does
+ *         not fit in an int64_t.
+ */
+bool string_to_int64(const string_t *string, int64_t *value);
+
+/**
+ * Parses a decimal floating point number such as "-12", "3.25", ".5",
+ * "6.02e23" or "1E-7". The special values "inf", "infinity" and "nan" are
+ * accepted in any case, optionally signed. Hexadecimal floats are not
+ * supported.
+ *
+ * @param string The string to parse.
+ * @param value  Receives the parsed value on success. Values too large for a
+ *               double become infinite, values too small become zero.
+ * @return true on success; false if the string is not a number.
+ */
+bool string_to_double(const string_t *string, double *value);
+
+/**
+ * Writes the decimal representation of the value to the buffer, which must
+ * hold at least NUMBER_BUFFER_SIZE bytes. No NUL terminator is written.
+ *
+ * @param value  The value to format.
+ * @param buffer The buffer to write to.
+ * @return The number of bytes written.
+ */
+size_t format_int64(int64_t value, uint8_t *buffer);
+
+/**
+ * Writes the shortest decimal representation that converts back to exactly
+ * the same double to the buffer, which must hold at least NUMBER_BUFFER_SIZE
+ * bytes. No NUL terminator is written.
+ *
+ * The layout follows the one of JavaScript: integers below 10^21 are written
+ * in full ("1500"), other values of a reasonable magnitude with a decimal
+ * point ("0.001", "3.25"), and the rest in scientific notation ("1e+21",
+ * "2.5e-7"). The special values are written as "nan", "inf" and "-inf".
+ *
+ * @param value  The value to format.
+ * @param buffer The buffer to write to.
+ * @return The number of bytes written.
+ */
+size_t format_double(double value, uint8_t *buffer);
+
+/**
+ * @param value The value to format.
+ * @return A newly allocated string with the decimal representation.
+ */
+string_t *int64_to_string(int64_t value);
+
+/**
+ * @param value The value to format.
+ * @return A newly allocated string with the shortest round-trip
+ *         representation of the value (see format_double).
+ */
+string_t *double_to_string(double value);
+
+#endif // C_PROGRAMS_NUMBER_H
@@ -0,0 +1,574 @@
+#include "radix.h"
+#include "../Arena/arena.h"
+#include "../Panic/panic.h"
+#include "simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+enum node_type { NODE4, NODE16, NODE48, NODE256 };
+
+static const size_t CAPACITY[] = {4, 16, 48, 256};
+
+/*
+ * Every node starts with this header. The shared prefix is not copied: it
+ * points into the key of an entry below the node, and entries never move.
+ * entry holds the key that ends at this node, if there is one.
+ *
+ * A child is either a node or an entry. Entries are tagged by setting the
+ * lowest bit of their pointer.
+ */
+typedef struct radix_node {
+  uint8_t type;
+  uint16_t count;
+  size_t prefix_len;
+  const uint8_t *prefix;
+  radix_entry_t *entry;
+} radix_node_t;
+
+// Node4 and Node16 keep their keys sorted.
+typedef struct node4 {
+  radix_node_t header;
+  uint8_t keys[4];
+  void *children[4];
+} node4_t;
+
+typedef struct node16 {
+  radix_node_t header;
+  uint8_t keys[16];
+  void *children[16];
+} node16_t;
+
+// index holds one plus the position of the child for each byte, or 0.
+typedef struct node48 {
+  radix_node_t header;
+  uint8_t index[256];
+  void *children[48];
+} node48_t;
+
+typedef struct node256 {
+  radix_node_t header;
+  void *children[256];
+} node256_t;
+
+// The prefix of nodes that have none.
+static const uint8_t NO_PREFIX[1] = {0};
+
+static const size_t NODE_SIZE[] = {sizeof(node4_t), sizeof(node16_t),
+                                   sizeof(node48_t), sizeof(node256_t)};
+
+static bool is_entry(const void *child) { return (uintptr_t)child & 1; }
+
+static radix_entry_t *as_entry(const void *child) {
+  return (radix_entry_t *)((uintptr_t)child & ~(uintptr_t)1);
+}
+
+static void *tag_entry(radix_entry_t *entry) {
+  return (void *)((uintptr_t)entry | 1);
+}
+
+static size_t common_len(const uint8_t *left, const uint8_t *right,
+                         size_t len) {
+  size_t index = 0;
+  for (; index + 8 <= len; index += 8) {
+    uint64_t diff = load_u64(left + index) ^ load_u64(right + index);
+    if (diff) {
+      return index + trailing_zeros(diff) / 8;
+    }
+  }
+  while (index < len && left[index] == right[index]) {
+    index++;
+  }
+  return index;
+}
+
+// SECTION: Nodes.
+
+static radix_node_t *new_node(radix_tree_t *tree, enum node_type type) {
+  radix_node_t *node = calloc(1, NODE_SIZE[type]);
+  if (!node) {
+    panic(stderr, "Could not allocate a radix tree node.");
+  }
+  node->type = (uint8_t)type;
+  node->prefix = NO_PREFIX;
+  tree->memory += NODE_SIZE[type];
+  tree->nodes[type]++;
+  return node;
+}
+
+static radix_entry_t *new_entry(radix_tree_t *tree, const string_t *key,
+                                void *value) {
+  size_t size = sizeof(radix_entry_t) + key->len;
+  radix_entry_t *entry = arena_alloc(tree->arena, size, 8);
+  entry->key.len = key->len;
+  entry->key.data = (uint8_t *)(entry + 1);
+  memcpy(entry->key.data, key->data, key->len);
+  entry->value = value;
+  tree->memory += size;
+  tree->count++;
+  return entry;
+}
+
+static void **find_child(radix_node_t *node, uint8_t byte) {
+  switch (node->type) {
+  case NODE4: {
+    node4_t *small = (node4_t *)node;
+    for (size_t i = 0; i < node->count; i++) {
+      if (small->keys[i] == byte) {
+        return &small->children[i];
+      }
+    }
+    return NULL;
+  }
+  case NODE16: {
+    node16_t *medium = (node16_t *)node;
+#if defined(STRING_HAS_SSE2)
+    __m128i keys = _mm_loadu_si128((const __m128i *)medium->keys);
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(keys, _mm_set1_epi8((char)byte)));
+    mask &= (1u << node->count) - 1;
+    return mask ? &medium->children[trailing_zeros(mask)] : NULL;
+#else
+    for (size_t i = 0; i < node->count; i++) {
+      if (medium->keys[i] == byte) {
+        return &medium->children[i];
+      }
+    }
+    return NULL;
+#endif
+  }
+  case NODE48: {
+    node48_t *large = (node48_t *)node;
+    uint8_t position = large->index[byte];
+    return position ? &large->children[position - 1] : NULL;
+  }
+  default: {
+    node256_t *full = (node256_t *)node;
+    return full->children[byte] ? &full->children[byte] : NULL;
+  }
+  }
+}
+
+static void insert_sorted(uint8_t *keys, void **children, size_t count,
+                          uint8_t byte, void *child) {
+  size_t index = count;
+  while (index > 0 && keys[index - 1] > byte) {
+    keys[index] = keys[index - 1];
+    children[index] = children[index - 1];
+    index--;
+  }
+  keys[index] = byte;
+  children[index] = child;
+}
+
+// Replaces a full node with one of the next size.
+static radix_node_t *grow_node(radix_tree_t *tree, radix_node_t *node) {
+  radix_node_t *bigger = new_node(tree, node->type + 1);
+  bigger->count = node->count;
+  bigger->prefix_len = node->prefix_len;
+  bigger->prefix = node->prefix;
+  bigger->entry = node->entry;
+  switch (node->type) {
+  case NODE4: {
+    node4_t *from = (node4_t *)node;
+    node16_t *to = (node16_t *)bigger;
+    memcpy(to->keys, from->keys, sizeof(from->keys));
+    memcpy(to->children, from->children, sizeof(from->children));
+    break;
+  }
+  case NODE16: {
+    node16_t *from = (node16_t *)node;
+    node48_t *to = (node48_t *)bigger;
+    for (size_t i = 0; i < node->count; i++) {
+      to->index[from->keys[i]] = (uint8_t)(i + 1);
+      to->children[i] = from->children[i];
+    }
+    break;
+  }
+  default: {
+    node48_t *from = (node48_t *)node;
+    node256_t *to = (node256_t *)bigger;
+    for (size_t byte = 0; byte < 256; byte++) {
+      if (from->index[byte]) {
+        to->children[byte] = from->children[from->index[byte] - 1];
+      }
+    }
+    break;
+  }
+  }
+  tree->memory -= NODE_SIZE[node->type];
+  tree->nodes[node->type]--;
+  free(node);
+  return bigger;
+}
+
+/*
+ * Adds a child for a byte the node does not branch on yet. A full node is
+ * replaced by a bigger one, which is stored in *ref.
+ */
+static void add_child(radix_tree_t *tree, void **ref, radix_node_t *node,
+                      uint8_t byte, void *child) {
+  if (node->count == CAPACITY[node->type]) {
+    node = grow_node(tree, node);
+    *ref = node;
+  }
+  switch (node->type) {
+  case NODE4: {
+    node4_t *small = (node4_t *)node;
+    insert_sorted(small->keys, small->children, node->count, byte, child);
+    break;
+  }
+  case NODE16: {
+    node16_t *medium = (node16_t *)node;
+    insert_sorted(medium->keys, medium->children, node->count, byte, child);
+    break;
+  }
+  case NODE48: {
+    node48_t *large = (node48_t *)node;
+    large->children[node->count] = child;
+    large->index[byte] = (uint8_t)(node->count + 1);
+    break;
+  }
+  default:
+    ((node256_t *)node)->children[byte] = child;
+    break;
+  }
+  node->count++;
+}
+
+// Hangs an entry from a node whose prefix ends at depth.
+static void place_entry(radix_tree_t *tree, radix_node_t *node,
+                        radix_entry_t *entry, size_t depth) {
+  if (entry->key.len == depth) {
+    node->entry = entry;
+  } else {
+    add_child(tree, NULL, node, entry->key.data[depth], tag_entry(entry));
+  }
+}
+
+// SECTION: Building.
+
+radix_tree_t *new_radix_tree(void) {
+  radix_tree_t *tree = malloc(sizeof(radix_tree_t));
+  if (!tree) {
+    panic(stderr, "Could not allocate the radix tree.");
+  }
+  tree->arena = new_arena(0);
+  tree->count = 0;
+  tree->memory = sizeof(radix_tree_t);
+  memset(tree->nodes, 0, sizeof(tree->nodes));
+  // The root branches on the first byte of every key, so it is never
+  // replaced by a bigger node or split.
+  tree->root = new_node(tree, NODE256);
+  return tree;
+}
+
+/*
+ * Two entries end up in the same slot: a new node takes their place, with
+ * the bytes they share after depth as its prefix.
+ */
+static radix_node_t *split_entry(radix_tree_t *tree, radix_entry_t *old,
+                                 radix_entry_t *entry, size_t depth) {
+  size_t shortest =
+      old->key.len < entry->key.len ? old->key.len : entry->key.len;
+  radix_node_t *node = new_node(tree, NODE4);
+  node->prefix = old->key.data + depth;
+  node->prefix_len =
+      common_len(old->key.data + depth, entry->key.data + depth,
+                 shortest - depth);
+  place_entry(tree, node, old, depth + node->prefix_len);
+  place_entry(tree, node, entry, depth + node->prefix_len);
+  return node;
+}
+
+/*
+ * The key leaves the prefix of a node after same bytes: a new node with the
+ * shared part of the prefix takes its place, and the old node keeps the
+ * rest of its prefix after the byte it is branched on.
+ */
+static radix_node_t *split_prefix(radix_tree_t *tree, radix_node_t *node,
+                                  size_t same, radix_entry_t *entry,
+                                  size_t depth) {
+  radix_node_t *parent = new_node(tree, NODE4);
+  parent->prefix = node->prefix;
+  parent->prefix_len = same;
+  uint8_t byte = node->prefix[same];
+  node->prefix += same + 1;
+  node->prefix_len -= same + 1;
+  add_child(tree, NULL, parent, byte, node);
+  place_entry(tree, parent, entry, depth + same);
+  return parent;
+}
+
+const radix_entry_t *radix_insert(radix_tree_t *tree, const string_t *key,
+                                  void *value) {
+  if (!tree || !key) {
+    panic(stderr, "Tree or key pointer is empty.");
+  }
+  radix_node_t *node = tree->root;
+  void **ref = NULL;
+  size_t depth = 0;
+  for (;;) {
+    size_t rest = key->len - depth;
+    size_t same = common_len(node->prefix, key->data + depth,
+                             rest < node->prefix_len ? rest : node->prefix_len);
+    if (same < node->prefix_len) {
+      radix_entry_t *entry = new_entry(tree, key, value);
+      *ref = split_prefix(tree, node, same, entry, depth);
+      return entry;
+    }
+    depth += node->prefix_len;
+    if (depth == key->len) {
+      if (node->entry) {
+        node->entry->value = value;
+      } else {
+        node->entry = new_entry(tree, key, value);
+      }
+      return node->entry;
+    }
+    void **slot = find_child(node, key->data[depth]);
+    if (!slot) {
+      radix_entry_t *entry = new_entry(tree, key, value);
+      add_child(tree, ref, node, key->data[depth], tag_entry(entry));
+      return entry;
+    }
+    if (is_entry(*slot)) {
+      radix_entry_t *old = as_entry(*slot);
+      if (string_equals(&old->key, key)) {
+        old->value = value;
+        return old;
+      }
+      radix_entry_t *entry = new_entry(tree, key, value);
+      *slot = split_entry(tree, old, entry, depth + 1);
+      return entry;
+    }
+    ref = slot;
+    node = *slot;
+    depth++;
+  }
+}
+
+// SECTION: Lookup.
+
+static void assert_tree(const radix_tree_t *tree, const string_t *string) {
+  if (!tree || !string) {
+    panic(stderr, "Tree or string pointer is empty.");
+  }
+}
+
+// Whether the prefix of the node follows depth bytes into the string.
+static bool prefix_matches(const radix_node_t *node, const string_t *string,
+                           size_t depth) {
+  return node->prefix_len <= string->len - depth &&
+         memcmp(node->prefix, string->data + depth, node->prefix_len) == 0;
+}
+
+// Whether the entry's key starts with the first len bytes of the string,
+// given that it is known to share the first depth of them.
+static bool entry_starts_with(const radix_entry_t *entry,
+                              const string_t *string, size_t depth,
+                              size_t len) {
+  return entry->key.len >= len &&
+         memcmp(entry->key.data + depth, string->data + depth, len - depth) ==
+             0;
+}
+
+const radix_entry_t *radix_find(const radix_tree_t *tree,
+                                const string_t *key) {
+  assert_tree(tree, key);
+  radix_node_t *node = tree->root;
+  size_t depth = 0;
+  for (;;) {
+    if (!prefix_matches(node, key, depth)) {
+      return NULL;
+    }
+    depth += node->prefix_len;
+    if (depth == key->len) {
+      return node->entry;
+    }
+    void **slot = find_child(node, key->data[depth]);
+    if (!slot) {
+      return NULL;
+    }
+    if (is_entry(*slot)) {
+      radix_entry_t *entry = as_entry(*slot);
+      return entry->key.len == key->len &&
+                     entry_starts_with(entry, key, depth + 1, key->len)
+                 ? entry
+                 : NULL;
+    }
+    node = *slot;
+    depth++;
+  }
+}
+
+const radix_entry_t *radix_longest_prefix(const radix_tree_t *tree,
+                                          const string_t *string) {
+  assert_tree(tree, string);
+  const radix_entry_t *best = NULL;
+  radix_node_t *node = tree->root;
+  size_t depth = 0;
+  for (;;) {
+    if (!prefix_matches(node, string, depth)) {
+      return best;
+    }
+    depth += node->prefix_len;
+    if (node->entry) {
+      best = node->entry;
+    }
+    if (depth == string->len) {
+      return best;
+    }
+    void **slot = find_child(node, string->data[depth]);
+    if (!slot) {
+      return best;
+    }
+    if (is_entry(*slot)) {
+      radix_entry_t *entry = as_entry(*slot);
+      return entry->key.len <= string->len &&
+                     entry_starts_with(entry, string, depth + 1,
+                                       entry->key.len)
+                 ? entry
+                 : best;
+    }
+    node = *slot;
+    depth++;
+  }
+}
+
+// SECTION: Iteration.
+
+typedef struct visitor {
+  radix_visit_t visit;
+  void *context;
+  size_t visited;
+} visitor_t;
+
+static bool visit_entry(visitor_t *visitor, const radix_entry_t *entry) {
+  visitor->visited++;
+  return visitor->visit(entry, visitor->context);
+}
+
+// Visits everything below a child in order; returns false once stopped.
+static bool visit_all(visitor_t *visitor, const void *child) {
+  if (is_entry(child)) {
+    return visit_entry(visitor, as_entry(child));
+  }
+  const radix_node_t *node = child;
+  if (node->entry && !visit_entry(visitor, node->entry)) {
+    return false;
+  }
+  switch (node->type) {
+  case NODE4:
+    for (size_t i = 0; i < node->count; i++) {
+      if (!visit_all(visitor, ((const node4_t *)node)->children[i])) {
+        return false;
+      }
+    }
+    return true;
+  case NODE16:
+    for (size_t i = 0; i < node->count; i++) {
+      if (!visit_all(visitor, ((const node16_t *)node)->children[i])) {
+        return false;
+      }
+    }
+    return true;
+  case NODE48: {
+    const node48_t *large = (const node48_t *)node;
+    for (size_t byte = 0; byte < 256; byte++) {
+      if (large->index[byte] &&
+          !visit_all(visitor, large->children[large->index[byte] - 1])) {
+        return false;
+      }
+    }
+    return true;
+  }
+  default: {
+    const node256_t *full = (const node256_t *)node;
+    for (size_t byte = 0; byte < 256; byte++) {
+      if (full->children[byte] && !visit_all(visitor, full->children[byte])) {
+        return false;
+      }
+    }
+    return true;
+  }
+  }
+}
+
+size_t radix_visit_prefix(const radix_tree_t *tree, const string_t *prefix,
+                          radix_visit_t visit, void *context) {
+  assert_tree(tree, prefix);
+  if (!visit) {
+    panic(stderr, "Visit function is empty.");
+  }
+  visitor_t visitor = {visit, context, 0};
+  radix_node_t *node = tree->root;
+  size_t depth = 0;
+  for (;;) {
+    size_t rest = prefix->len - depth;
+    if (rest <= node->prefix_len) {
+      // The prefix ends inside this node's prefix, or right after it.
+      if (memcmp(node->prefix, prefix->data + depth, rest) == 0) {
+        visit_all(&visitor, node);
+      }
+      return visitor.visited;
+    }
+    if (memcmp(node->prefix, prefix->data + depth, node->prefix_len) != 0) {
+      return 0;
+    }
+    depth += node->prefix_len;
+    void **slot = find_child(node, prefix->data[depth]);
+    if (!slot) {
+      return 0;
+    }
+    if (is_entry(*slot)) {
+      radix_entry_t *entry = as_entry(*slot);
+      if (entry_starts_with(entry, prefix, depth + 1, prefix->len)) {
+        visit_entry(&visitor, entry);
+      }
+      return visitor.visited;
+    }
+    node = *slot;
+    depth++;
+  }
+}
+
+// SECTION: Cleanup.
+
+static void free_node(radix_node_t *node) {
+  void **children;
+  size_t count;
+  switch (node->type) {
+  case NODE4:
+    children = ((node4_t *)node)->children;
+    count = node->count;
+    break;
+  case NODE16:
+    children = ((node16_t *)node)->children;
+    count = node->count;
+    break;
+  case NODE48:
+    children = ((node48_t *)node)->children;
+    count = node->count;
+    break;
+  default:
+    children = ((node256_t *)node)->children;
+    count = 256;
+    break;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (children[i] && !is_entry(children[i])) {
+      free_node(children[i]);
+    }
+  }
+  free(node);
+}
+
+void free_radix_tree(radix_tree_t *tree) {
+  if (!tree) {
+    return;
+  }
+  free_node(tree->root);
+  free_arena(tree->arena);
+  free(tree);
+}
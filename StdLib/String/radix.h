@@ -0,0 +1,114 @@
+#ifndef C_PROGRAMS_RADIX_H
+#define C_PROGRAMS_RADIX_H
+/**
+ * An adaptive radix tree (Leis, Kemper and Neumann, "The Adaptive Radix
+ * Tree: ARTful Indexing for Main-Memory Databases", 2013) that maps string_t
+ * keys to values.
+ *
+ * Each inner node branches on one byte of the key. Nodes come in four sizes
+ * (for up to 4, 16, 48 and 256 children) and grow as children are added, so
+ * sparse nodes stay small and dense ones are indexed directly. A run of
+ * bytes that all keys below a node share is stored once in the node instead
+ * of as a chain of nodes with one child each, and a key with no other key
+ * below it is stored as a leaf directly in its parent. A lookup therefore
+ * visits at most one node per distinguishing byte and compares every byte of
+ * the key once.
+ *
+ * Keys are copied into the tree; any key, including the empty one, can be
+ * stored, and keys may be prefixes of each other. The entries are kept in
+ * the order of string_cmp, which makes it cheap to find the longest key that
+ * is a prefix of a string, and to visit all keys that start with a prefix.
+ *
+ * Entries live in an arena owned by the tree. The tree does not support
+ * removal; entries stay valid until the tree is freed.
+ */
+#include "string.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct arena;
+struct radix_node;
+
+/**
+ * A key and its value. The key refers to the tree's own copy of the bytes.
+ */
+typedef struct radix_entry {
+  string_t key;
+  void *value;
+} radix_entry_t;
+
+/**
+ * count is the number of entries. memory is the number of bytes used by the
+ * nodes and the entries, and nodes[i] the number of nodes of each size (4,
+ * 16, 48 and 256 children, in that order).
+ */
+typedef struct radix_tree {
+  struct radix_node *root;
+  struct arena *arena;
+  size_t count;
+  size_t memory;
+  size_t nodes[4];
+} radix_tree_t;
+
+/**
+ * Called for each visited entry. Returning false stops the visit.
+ */
+typedef bool (*radix_visit_t)(const radix_entry_t *entry, void *context);
+
+/**
+ * @return A new, empty radix tree that must be freed with free_radix_tree.
+ */
+radix_tree_t *new_radix_tree(void);
+
+/**
+ * Inserts a key, or replaces its value if the tree already holds it.
+ *
+ * @param tree  The tree to insert into.
+ * @param key   The key; its bytes are copied.
+ * @param value The value to store.
+ * @return The entry of the key.
+ */
+const radix_entry_t *radix_insert(radix_tree_t *tree, const string_t *key,
+                                  void *value);
+
+/**
+ * @param tree The tree to search.
+ * @param key  The key to look for.
+ * @return The entry of the key, or NULL if the tree does not hold it.
+ */
+const radix_entry_t *radix_find(const radix_tree_t *tree, const string_t *key);
+
+/**
+ * Finds the longest key in the tree that is a prefix of the given string
+ * (or the string itself), as in routing tables and tokenizers.
+ *
+ * @param tree   The tree to search.
+ * @param string The string whose prefixes are looked up.
+ * @return The entry of the longest such key, or NULL if there is none.
+ */
+const radix_entry_t *radix_longest_prefix(const radix_tree_t *tree,
+                                          const string_t *string);
+
+/**
+ * Visits every entry whose key starts with the given prefix, in the order
+ * of string_cmp. An empty prefix visits the whole tree.
+ *
+ * @param tree    The tree to search.
+ * @param prefix  The prefix the keys must start with.
+ * @param visit   Called for each entry, until it returns false.
+ * @param context Passed on to the visit function.
+ * @return The number of entries visited.
+ */
+size_t radix_visit_prefix(const radix_tree_t *tree, const string_t *prefix,
+                          radix_visit_t visit, void *context);
+
+/**
+ * De-allocates the tree and all of its entries. The values are not freed.
+ *
+ * @param tree The tree to be deallocated.
+ */
+void free_radix_tree(radix_tree_t *tree);
+
+#endif // C_PROGRAMS_RADIX_H
@@ -0,0 +1,204 @@
+#include "replace.h"
+#include "../Panic/panic.h"
+#include "search.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static void assert_needle(const string_t *needle) {
+  if (!needle) {
+    panic(stderr, "Needle pointer is empty.");
+  }
+  if (needle->len == 0) {
+    panic(stderr, "Needle is empty.");
+  }
+}
+
+// SECTION: Finding.
+
+static void append_offset(size_t **offsets, size_t *count, size_t *capacity,
+                          size_t offset) {
+  if (*count == *capacity) {
+    *capacity = *capacity ? *capacity * 2 : 16;
+    *offsets = realloc(*offsets, *capacity * sizeof(size_t));
+    if (!*offsets) {
+      panic(stderr, "Could not grow the offsets array.");
+    }
+  }
+  (*offsets)[(*count)++] = offset;
+}
+
+size_t *string_find_all(const string_t *haystack, const string_t *needle,
+                        size_t *count) {
+  if (!haystack || !count) {
+    panic(stderr, "String or count pointer is empty.");
+  }
+  assert_needle(needle);
+  const size_t len = haystack->len;
+  size_t *offsets = NULL;
+  size_t used = 0;
+  size_t capacity = 0;
+  size_t index = 0;
+  while (index + needle->len <= len) {
+    index += search_bytes(haystack->data + index, len - index, needle->data,
+                          needle->len);
+    if (index == len) {
+      break;
+    }
+    append_offset(&offsets, &used, &capacity, index);
+    index += needle->len;
+  }
+  *count = used;
+  return offsets;
+}
+
+size_t string_count(const string_t *haystack, const string_t *needle) {
+  if (!haystack) {
+    panic(stderr, "String pointer is empty.");
+  }
+  assert_needle(needle);
+  const size_t len = haystack->len;
+  size_t count = 0;
+  size_t index = 0;
+  while (index + needle->len <= len) {
+    index += search_bytes(haystack->data + index, len - index, needle->data,
+                          needle->len);
+    if (index == len) {
+      break;
+    }
+    count++;
+    index += needle->len;
+  }
+  return count;
+}
+
+// SECTION: Replacing.
+
+string_t *string_replace_all(const string_t *source, const string_t *needle,
+                             const string_t *replacement) {
+  if (!source || !replacement) {
+    panic(stderr, "String pointer is empty.");
+  }
+  size_t count;
+  size_t *offsets = string_find_all(source, needle, &count);
+  string_t *result =
+      new_string(source->len - count * needle->len + count * replacement->len);
+  uint8_t *out = result->data;
+  size_t from = 0;
+  for (size_t i = 0; i < count; i++) {
+    memcpy(out, source->data + from, offsets[i] - from);
+    out += offsets[i] - from;
+    memcpy(out, replacement->data, replacement->len);
+    out += replacement->len;
+    from = offsets[i] + needle->len;
+  }
+  memcpy(out, source->data + from, source->len - from);
+  free(offsets);
+  return result;
+}
+
+// SECTION: Streaming.
+
+stream_replacer_t *new_stream_replacer(const string_t *needle,
+                                       const string_t *replacement) {
+  assert_needle(needle);
+  if (!replacement) {
+    panic(stderr, "String pointer is empty.");
+  }
+  stream_replacer_t *replacer = malloc(sizeof(stream_replacer_t));
+  // The carry is joined with up to needle->len - 1 bytes of the next chunk.
+  uint8_t *carry = malloc(2 * needle->len);
+  if (!replacer || !carry) {
+    panic(stderr, "Could not allocate the stream replacer.");
+  }
+  replacer->needle = copy_string(needle);
+  replacer->replacement = copy_string(replacement);
+  replacer->carry = carry;
+  replacer->carry_len = 0;
+  replacer->matches = 0;
+  return replacer;
+}
+
+static void assert_replacer(const stream_replacer_t *replacer,
+                            const string_writer_t *output) {
+  if (!replacer || !output) {
+    panic(stderr, "Replacer or output pointer is empty.");
+  }
+}
+
+/*
+ * Replaces the occurrences in data and writes out the result up to the last
+ * needle->len - 1 bytes, which could begin an occurrence that is cut off by
+ * the end of the data. Returns the number of bytes of data dealt with.
+ */
+static size_t replace_block(stream_replacer_t *replacer, const uint8_t *data,
+                            size_t len, string_writer_t *output) {
+  const string_t *needle = replacer->needle;
+  size_t from = 0;
+  while (from + needle->len <= len) {
+    size_t found = from + search_bytes(data + from, len - from, needle->data,
+                                       needle->len);
+    if (found == len) {
+      break;
+    }
+    writer_write_bytes(output, data + from, found - from);
+    writer_write(output, replacer->replacement);
+    replacer->matches++;
+    from = found + needle->len;
+  }
+  size_t keep = len - from < needle->len ? from : len - needle->len + 1;
+  writer_write_bytes(output, data + from, keep - from);
+  return keep;
+}
+
+static void set_carry(stream_replacer_t *replacer, const uint8_t *data,
+                      size_t len) {
+  memmove(replacer->carry, data, len);
+  replacer->carry_len = len;
+}
+
+void stream_replace(stream_replacer_t *replacer, const string_t *chunk,
+                    string_writer_t *output) {
+  assert_replacer(replacer, output);
+  if (!chunk) {
+    panic(stderr, "Chunk pointer is empty.");
+  }
+  const size_t reach = replacer->needle->len - 1;
+  size_t start = 0;
+  if (replacer->carry_len > 0) {
+    // An occurrence that begins in the carry ends within the next reach
+    // bytes, so the carry and that much of the chunk are searched together.
+    const size_t held = replacer->carry_len;
+    const size_t joined = chunk->len < reach ? chunk->len : reach;
+    memcpy(replacer->carry + held, chunk->data, joined);
+    size_t done = replace_block(replacer, replacer->carry, held + joined,
+                                output);
+    if (joined == chunk->len) {
+      set_carry(replacer, replacer->carry + done, held + joined - done);
+      return;
+    }
+    // With a full window, done is never less than held.
+    start = done - held;
+  }
+  size_t done = replace_block(replacer, chunk->data + start,
+                              chunk->len - start, output);
+  set_carry(replacer, chunk->data + start + done, chunk->len - start - done);
+}
+
+void stream_replace_finish(stream_replacer_t *replacer,
+                           string_writer_t *output) {
+  assert_replacer(replacer, output);
+  // The carry is shorter than the needle, so it holds no occurrence.
+  writer_write_bytes(output, replacer->carry, replacer->carry_len);
+  replacer->carry_len = 0;
+}
+
+void free_stream_replacer(stream_replacer_t *replacer) {
+  if (!replacer) {
+    return;
+  }
+  free_string(replacer->needle);
+  free_string(replacer->replacement);
+  free(replacer->carry);
+  free(replacer);
+}
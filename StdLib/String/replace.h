@@ -0,0 +1,108 @@
+#ifndef C_PROGRAMS_REPLACE_H
+#define C_PROGRAMS_REPLACE_H
+/**
+ * Finding and replacing every occurrence of a string.
+ *
+ * A loop of index_of_string, substring and concat_string copies everything
+ * after a match again for each match, so replacing all occurrences that way
+ * takes quadratic time and one allocation per match. These functions search
+ * with search_bytes in a single left to right pass. string_replace_all
+ * computes the length of its result first and fills it in one go.
+ *
+ * Occurrences do not overlap: after a match, the search resumes at its end,
+ * so "aa" occurs twice in "aaaaa", at 0 and 2. The needle must not be empty.
+ *
+ * A stream replacer does the same for input that arrives in chunks, such as
+ * blocks read from a file, and writes the result to a string_writer_t. Its
+ * output is the same as that of string_replace_all on the whole input, no
+ * matter where the chunks begin and end.
+ */
+#include "string.h"
+#include "writer.h"
+
+#include <stddef.h>
+
+/**
+ * Finds all occurrences of a needle in a haystack.
+ *
+ * @param haystack The string to search in.
+ * @param needle   The string to search for; it must not be empty.
+ * @param count    Receives the number of occurrences.
+ * @return An array of the offsets of the occurrences in increasing order,
+ *         which the caller must free, or NULL if there are none.
+ */
+size_t *string_find_all(const string_t *haystack, const string_t *needle,
+                        size_t *count);
+
+/**
+ * Counts the occurrences of a needle without storing their offsets.
+ *
+ * @param haystack The string to search in.
+ * @param needle   The string to search for; it must not be empty.
+ * @return The number of occurrences.
+ */
+size_t string_count(const string_t *haystack, const string_t *needle);
+
+/**
+ * Replaces every occurrence of a needle.
+ *
+ * @param source      The string to search in.
+ * @param needle      The string to replace; it must not be empty.
+ * @param replacement The string to put in its place; it may be empty.
+ * @return A new string with the occurrences replaced.
+ */
+string_t *string_replace_all(const string_t *source, const string_t *needle,
+                             const string_t *replacement);
+
+/**
+ * Holds copies of the needle and the replacement, and the carry: the last
+ * few bytes of the input seen so far, which could be the start of an
+ * occurrence that continues in the next chunk. The carry is always shorter
+ * than the needle. matches counts the occurrences replaced so far.
+ */
+typedef struct stream_replacer {
+  string_t *needle;
+  string_t *replacement;
+  uint8_t *carry;
+  size_t carry_len;
+  size_t matches;
+} stream_replacer_t;
+
+/**
+ * Creates a replacer for input that arrives in chunks.
+ *
+ * @param needle      The string to replace; it must not be empty.
+ * @param replacement The string to put in its place; it may be empty.
+ * @return A new stream replacer.
+ */
+stream_replacer_t *new_stream_replacer(const string_t *needle,
+                                       const string_t *replacement);
+
+/**
+ * Feeds the next chunk of input to the replacer and writes out everything
+ * that can no longer be part of an occurrence. Up to needle->len - 1 bytes
+ * are held back until the next chunk or stream_replace_finish.
+ *
+ * @param replacer The stream replacer.
+ * @param chunk    The next chunk of input; it may be empty.
+ * @param output   Receives the output.
+ */
+void stream_replace(stream_replacer_t *replacer, const string_t *chunk,
+                    string_writer_t *output);
+
+/**
+ * Ends the input: writes out the bytes that were held back and makes the
+ * replacer ready for a new input.
+ *
+ * @param replacer The stream replacer.
+ * @param output   Receives the output.
+ */
+void stream_replace_finish(stream_replacer_t *replacer,
+                           string_writer_t *output);
+
+/**
+ * @param replacer The stream replacer to be deallocated.
+ */
+void free_stream_replacer(stream_replacer_t *replacer);
+
+#endif // C_PROGRAMS_REPLACE_H
@@ -0,0 +1,394 @@
+#include "rope.h"
+#include "../Panic/panic.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Adjacent leaves that are both smaller than this are merged into one when
+// they are concatenated, so that many tiny edits do not leave behind a tree
+// of tiny leaves.
+static const size_t SMALL_LEAF = 128;
+
+// SECTION: Reference counting.
+//
+// Internal functions follow one ownership rule: every node pointer passed
+// to them or returned by them carries one reference, which the receiver is
+// responsible for releasing (or passing on).
+
+static rope_node_t *acquire(rope_node_t *node) {
+  if (node) {
+    node->refs++;
+  }
+  return node;
+}
+
+static void release_buffer(rope_buffer_t *buffer) {
+  if (--buffer->refs == 0) {
+    free_string(buffer->string);
+    free(buffer);
+  }
+}
+
+static void release(rope_node_t *node) {
+  if (!node || --node->refs > 0) {
+    return;
+  }
+  if (node->buffer) {
+    release_buffer(node->buffer);
+  } else {
+    release(node->left);
+    release(node->right);
+  }
+  free(node);
+}
+
+static rope_node_t *allocate_node(void) {
+  rope_node_t *node = malloc(sizeof(rope_node_t));
+  if (!node) {
+    panic(stderr, "Could not allocate a rope node.");
+  }
+  node->refs = 1;
+  node->left = NULL;
+  node->right = NULL;
+  node->buffer = NULL;
+  node->offset = 0;
+  return node;
+}
+
+static rope_node_t *make_leaf(rope_buffer_t *buffer, size_t offset,
+                              size_t len) {
+  rope_node_t *leaf = allocate_node();
+  buffer->refs++;
+  leaf->buffer = buffer;
+  leaf->offset = offset;
+  leaf->len = len;
+  leaf->height = 0;
+  return leaf;
+}
+
+// Creates a leaf that owns the given string; returns NULL for empty strings
+// because the empty rope is represented by a NULL root.
+static rope_node_t *leaf_owning(string_t *string) {
+  if (string->len == 0) {
+    free_string(string);
+    return NULL;
+  }
+  rope_buffer_t *buffer = malloc(sizeof(rope_buffer_t));
+  if (!buffer) {
+    panic(stderr, "Could not allocate a rope buffer.");
+  }
+  buffer->refs = 0;
+  buffer->string = string;
+  return make_leaf(buffer, 0, string->len);
+}
+
+static int height(const rope_node_t *node) { return node ? node->height : -1; }
+
+static size_t length(const rope_node_t *node) { return node ? node->len : 0; }
+
+static rope_node_t *make_node(rope_node_t *left, rope_node_t *right) {
+  rope_node_t *node = allocate_node();
+  node->left = left;
+  node->right = right;
+  node->len = left->len + right->len;
+  node->height = 1 + (left->height > right->height ? left->height
+                                                   : right->height);
+  return node;
+}
+
+// Takes apart an internal node, handing its children (with a reference each)
+// to the caller. Nodes nobody else refers to are recycled in place of
+// touching the reference counts of their children.
+static void unpack(rope_node_t *node, rope_node_t **left,
+                   rope_node_t **right) {
+  if (node->refs == 1) {
+    *left = node->left;
+    *right = node->right;
+    free(node);
+  } else {
+    *left = acquire(node->left);
+    *right = acquire(node->right);
+    node->refs--;
+  }
+}
+
+// SECTION: Balancing.
+
+static rope_node_t *rotate_left(rope_node_t *node) {
+  rope_node_t *a, *b, *c, *d;
+  unpack(node, &a, &b);
+  unpack(b, &c, &d);
+  return make_node(make_node(a, c), d);
+}
+
+static rope_node_t *rotate_right(rope_node_t *node) {
+  rope_node_t *a, *b, *c, *d;
+  unpack(node, &a, &b);
+  unpack(a, &c, &d);
+  return make_node(c, make_node(d, b));
+}
+
+// Joins two trees where the left one is more than one level taller, by
+// walking down its right spine until the heights match.
+static rope_node_t *join_right(rope_node_t *left, rope_node_t *right) {
+  rope_node_t *outer, *inner;
+  unpack(left, &outer, &inner);
+  if (height(inner) <= height(right) + 1) {
+    rope_node_t *joined = make_node(inner, right);
+    if (joined->height <= height(outer) + 1) {
+      return make_node(outer, joined);
+    }
+    return rotate_left(make_node(outer, rotate_right(joined)));
+  }
+  rope_node_t *joined = join_right(inner, right);
+  int joined_height = joined->height;
+  rope_node_t *node = make_node(outer, joined);
+  return joined_height <= height(outer) + 1 ? node : rotate_left(node);
+}
+
+static rope_node_t *join_left(rope_node_t *left, rope_node_t *right) {
+  rope_node_t *inner, *outer;
+  unpack(right, &inner, &outer);
+  if (height(inner) <= height(left) + 1) {
+    rope_node_t *joined = make_node(left, inner);
+    if (joined->height <= height(outer) + 1) {
+      return make_node(joined, outer);
+    }
+    return rotate_right(make_node(rotate_left(joined), outer));
+  }
+  rope_node_t *joined = join_left(left, inner);
+  int joined_height = joined->height;
+  rope_node_t *node = make_node(joined, outer);
+  return joined_height <= height(outer) + 1 ? node : rotate_right(node);
+}
+
+static rope_node_t *join(rope_node_t *left, rope_node_t *right) {
+  if (!left) {
+    return right;
+  }
+  if (!right) {
+    return left;
+  }
+  if (left->buffer && right->buffer && left->len + right->len <= SMALL_LEAF) {
+    string_t *merged = new_string(left->len + right->len);
+    memcpy(merged->data, left->buffer->string->data + left->offset, left->len);
+    memcpy(merged->data + left->len,
+           right->buffer->string->data + right->offset, right->len);
+    release(left);
+    release(right);
+    return leaf_owning(merged);
+  }
+  if (left->height > right->height + 1) {
+    return join_right(left, right);
+  }
+  if (right->height > left->height + 1) {
+    return join_left(left, right);
+  }
+  return make_node(left, right);
+}
+
+static void split(rope_node_t *node, size_t index, rope_node_t **left,
+                  rope_node_t **right) {
+  if (!node) {
+    *left = *right = NULL;
+    return;
+  }
+  if (index == 0) {
+    *left = NULL;
+    *right = node;
+    return;
+  }
+  if (index >= node->len) {
+    *left = node;
+    *right = NULL;
+    return;
+  }
+  if (node->buffer) {
+    // Both halves keep slicing the same buffer; no bytes are copied.
+    *left = make_leaf(node->buffer, node->offset, index);
+    *right = make_leaf(node->buffer, node->offset + index, node->len - index);
+    release(node);
+    return;
+  }
+  rope_node_t *a, *b, *l, *r;
+  unpack(node, &a, &b);
+  if (index <= a->len) {
+    split(a, index, &l, &r);
+    *left = l;
+    *right = join(r, b);
+  } else {
+    split(b, index - a->len, &l, &r);
+    *left = join(a, l);
+    *right = r;
+  }
+}
+
+// SECTION: Public interface.
+
+static rope_t *wrap(rope_node_t *root) {
+  rope_t *rope = malloc(sizeof(rope_t));
+  if (!rope) {
+    panic(stderr, "Could not allocate the rope.");
+  }
+  rope->root = root;
+  return rope;
+}
+
+static void assert_rope(const rope_t *rope) {
+  if (!rope) {
+    panic(stderr, "Rope pointer is null.");
+  }
+}
+
+rope_t *new_rope(const string_t *string) {
+  if (!string) {
+    panic(stderr, "String pointer is empty.");
+  }
+  return wrap(leaf_owning(copy_string(string)));
+}
+
+rope_t *new_rope_owning(string_t *string) {
+  if (!string) {
+    panic(stderr, "String pointer is empty.");
+  }
+  return wrap(leaf_owning(string));
+}
+
+size_t rope_length(const rope_t *rope) {
+  assert_rope(rope);
+  return length(rope->root);
+}
+
+uint8_t rope_byte_at(const rope_t *rope, size_t index) {
+  assert_rope(rope);
+  if (index >= length(rope->root)) {
+    panic(stderr, "Index exceeds the length of the rope.");
+  }
+  const rope_node_t *node = rope->root;
+  while (!node->buffer) {
+    if (index < node->left->len) {
+      node = node->left;
+    } else {
+      index -= node->left->len;
+      node = node->right;
+    }
+  }
+  return node->buffer->string->data[node->offset + index];
+}
+
+rope_t *concat_rope(const rope_t *left, const rope_t *right) {
+  assert_rope(left);
+  assert_rope(right);
+  return wrap(join(acquire(left->root), acquire(right->root)));
+}
+
+void split_rope(const rope_t *rope, size_t index, rope_t **left,
+                rope_t **right) {
+  assert_rope(rope);
+  if (!left || !right) {
+    panic(stderr, "Output pointers for the split are null.");
+  }
+  if (index > length(rope->root)) {
+    panic(stderr, "Split index exceeds the length of the rope.");
+  }
+  rope_node_t *l, *r;
+  split(acquire(rope->root), index, &l, &r);
+  *left = wrap(l);
+  *right = wrap(r);
+}
+
+rope_t *subrope(const rope_t *rope, size_t start, size_t end) {
+  assert_rope(rope);
+  if (end > length(rope->root) || start > end) {
+    panic(stderr, "Invalid constraints to extract a subrope from.");
+  }
+  rope_node_t *before, *rest, *middle, *after;
+  split(acquire(rope->root), start, &before, &rest);
+  split(rest, end - start, &middle, &after);
+  release(before);
+  release(after);
+  return wrap(middle);
+}
+
+rope_t *insert_rope(const rope_t *rope, size_t index, const string_t *string) {
+  assert_rope(rope);
+  if (!string) {
+    panic(stderr, "String pointer is empty.");
+  }
+  if (index > length(rope->root)) {
+    panic(stderr, "Insertion index exceeds the length of the rope.");
+  }
+  rope_node_t *before, *after;
+  split(acquire(rope->root), index, &before, &after);
+  rope_node_t *inserted = leaf_owning(copy_string(string));
+  return wrap(join(join(before, inserted), after));
+}
+
+rope_t *delete_rope(const rope_t *rope, size_t start, size_t end) {
+  assert_rope(rope);
+  if (end > length(rope->root) || start > end) {
+    panic(stderr, "Invalid constraints to delete from the rope.");
+  }
+  rope_node_t *before, *rest, *middle, *after;
+  split(acquire(rope->root), start, &before, &rest);
+  split(rest, end - start, &middle, &after);
+  release(middle);
+  return wrap(join(before, after));
+}
+
+rope_iterator_t rope_iterator(const rope_t *rope) {
+  assert_rope(rope);
+  rope_iterator_t iterator;
+  iterator.depth = 0;
+  if (rope->root) {
+    iterator.stack[iterator.depth++] = rope->root;
+  }
+  return iterator;
+}
+
+bool next_rope_leaf(rope_iterator_t *iterator, string_t *leaf) {
+  if (!iterator || !leaf) {
+    panic(stderr, "Iterator or leaf pointer is null.");
+  }
+  if (iterator->depth == 0) {
+    return false;
+  }
+  const rope_node_t *node = iterator->stack[--iterator->depth];
+  while (!node->buffer) {
+    iterator->stack[iterator->depth++] = node->right;
+    node = node->left;
+  }
+  leaf->len = node->len;
+  leaf->data = node->buffer->string->data + node->offset;
+  return true;
+}
+
+string_t *flatten_rope(const rope_t *rope) {
+  assert_rope(rope);
+  string_t *string = new_string(length(rope->root));
+  rope_iterator_t iterator = rope_iterator(rope);
+  string_t leaf;
+  size_t written = 0;
+  while (next_rope_leaf(&iterator, &leaf)) {
+    memcpy(string->data + written, leaf.data, leaf.len);
+    written += leaf.len;
+  }
+  return string;
+}
+
+void fprint_rope(const rope_t *rope, FILE *output) {
+  assert_rope(rope);
+  rope_iterator_t iterator = rope_iterator(rope);
+  string_t leaf;
+  while (next_rope_leaf(&iterator, &leaf)) {
+    fprint_string(&leaf, output);
+  }
+}
+
+void free_rope(rope_t *rope) {
+  if (!rope) {
+    return;
+  }
+  release(rope->root);
+  free(rope);
+}
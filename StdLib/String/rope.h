@@ -0,0 +1,192 @@
+#ifndef C_PROGRAMS_ROPE_H
+#define C_PROGRAMS_ROPE_H
+/**
+ * A rope: a string stored as a balanced binary tree whose leaves are slices
+ * of string_t buffers.
+ *
+ * Ropes make edits of very large texts cheap. Concatenation, splitting,
+ * insertion and deletion take O(log n) time and never copy the text itself;
+ * they only create O(log n) new tree nodes. The tree is kept balanced with
+ * the AVL rule (the heights of two siblings differ by at most one) using the
+ * join-based algorithms of Blelloch, Ferizovic and Sun ("Just Join for
+ * Parallel Ordered Sets", 2016).
+ *
+ * Ropes are persistent: every operation returns a new rope and leaves its
+ * inputs untouched, in the same way that concat_string and substring do.
+ * The versions share their nodes and buffers through reference counting,
+ * so keeping old versions around is cheap. Every rope returned by these
+ * functions must be freed with free_rope. The reference counts are not
+ * atomic, so a family of ropes must only be used by one thread at a time.
+ */
+#include "string.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+/**
+ * A reference counted string_t that is shared by all the leaves slicing it.
+ */
+typedef struct rope_buffer {
+  size_t refs;
+  string_t *string;
+} rope_buffer_t;
+
+/**
+ * Leaves have no children and refer to the bytes [offset, offset + len) of
+ * their buffer. Internal nodes have exactly two children and cache the total
+ * length and height of their subtree.
+ */
+typedef struct rope_node {
+  size_t refs;
+  size_t len;
+  int height;
+  struct rope_node *left;
+  struct rope_node *right;
+  rope_buffer_t *buffer;
+  size_t offset;
+} rope_node_t;
+
+typedef struct rope {
+  rope_node_t *root;
+} rope_t;
+
+/**
+ * The deepest AVL tree with 2^64 leaves is shorter than this, so a fixed
+ * stack always suffices to walk a rope.
+ */
+#define ROPE_MAX_DEPTH 96
+
+/**
+ * Iterates over the leaves of a rope from left to right. Initialize it with
+ * rope_iterator and advance it with next_rope_leaf.
+ */
+typedef struct rope_iterator {
+  size_t depth;
+  const rope_node_t *stack[ROPE_MAX_DEPTH];
+} rope_iterator_t;
+
+/**
+ * Creates a rope holding a copy of the given string.
+ *
+ * @param string The initial contents.
+ * @return A new rope.
+ */
+rope_t *new_rope(const string_t *string);
+
+/**
+ * Creates a rope that takes ownership of the given string instead of copying
+ * it. The string must not be used or freed by the caller afterwards; it is
+ * freed when the last rope referring to it is freed.
+ *
+ * @param string The initial contents.
+ * @return A new rope.
+ */
+rope_t *new_rope_owning(string_t *string);
+
+/**
+ * @param rope The rope to measure.
+ * @return The number of bytes in the rope.
+ */
+size_t rope_length(const rope_t *rope);
+
+/**
+ * @param rope  The rope to read.
+ * @param index The position of the desired byte (must be within the rope).
+ * @return The byte at the given position.
+ */
+uint8_t rope_byte_at(const rope_t *rope, size_t index);
+
+/**
+ * Concatenates two ropes in O(log n) time.
+ *
+ * @param left  The first rope.
+ * @param right The second rope.
+ * @return A new rope with the contents of left followed by those of right.
+ */
+rope_t *concat_rope(const rope_t *left, const rope_t *right);
+
+/**
+ * Splits a rope in two at the given position in O(log n) time.
+ *
+ * @param rope  The rope to split.
+ * @param index The split position; at most the length of the rope.
+ * @param left  Receives a new rope with the bytes before the position.
+ * @param right Receives a new rope with the bytes from the position onwards.
+ */
+void split_rope(const rope_t *rope, size_t index, rope_t **left,
+                rope_t **right);
+
+/**
+ * Extracts the bytes from start (inclusive) to end (exclusive) as a rope.
+ *
+ * @param rope  The source rope.
+ * @param start The starting index (inclusive).
+ * @param end   The ending index (exclusive).
+ * @return A new rope with the selected range.
+ */
+rope_t *subrope(const rope_t *rope, size_t start, size_t end);
+
+/**
+ * Inserts a copy of the string at the given position.
+ *
+ * @param rope   The rope to insert into.
+ * @param index  The position of the insertion; at most the rope's length.
+ * @param string The string to insert.
+ * @return A new rope with the string inserted.
+ */
+rope_t *insert_rope(const rope_t *rope, size_t index, const string_t *string);
+
+/**
+ * Removes the bytes from start (inclusive) to end (exclusive).
+ *
+ * @param rope  The rope to delete from.
+ * @param start The starting index (inclusive).
+ * @param end   The ending index (exclusive).
+ * @return A new rope without the given range.
+ */
+rope_t *delete_rope(const rope_t *rope, size_t start, size_t end);
+
+/**
+ * Copies the contents of the rope into a single, newly allocated string_t.
+ *
+ * @param rope The rope to flatten.
+ * @return A new string with the contents of the rope.
+ */
+string_t *flatten_rope(const rope_t *rope);
+
+/**
+ * @param rope The rope whose leaves are to be visited.
+ * @return An iterator positioned before the first leaf.
+ */
+rope_iterator_t rope_iterator(const rope_t *rope);
+
+/**
+ * Advances to the next leaf of the rope. The leaf is returned as a view: a
+ * string_t held by value that points into the rope's buffers. It must not be
+ * passed to free_string and is valid for as long as the rope is.
+ *
+ * @param iterator The iterator to advance.
+ * @param leaf     Receives a view of the next leaf.
+ * @return true if a leaf was produced, false once all leaves were visited.
+ */
+bool next_rope_leaf(rope_iterator_t *iterator, string_t *leaf);
+
+/**
+ * Writes the contents of the rope to the given stream, one leaf at a time,
+ * without flattening it first.
+ *
+ * @param rope   The rope to be printed.
+ * @param output The file pointer to output the rope to.
+ */
+void fprint_rope(const rope_t *rope, FILE *output);
+
+/**
+ * Releases the rope. Nodes and buffers shared with other ropes stay alive
+ * until the last rope using them is freed.
+ *
+ * @param rope The rope to be deallocated.
+ */
+void free_rope(rope_t *rope);
+
+#endif // C_PROGRAMS_ROPE_H
@@ -0,0 +1,213 @@
+#include "search.h"
+#include "simd.h"
+
+#include <string.h>
+
+byte_set_t new_byte_set(const uint8_t *bytes, size_t count) {
+  byte_set_t set;
+  memset(&set, 0, sizeof(set));
+  for (size_t i = 0; i < count; i++) {
+    uint8_t byte = bytes[i];
+    if (byte_set_contains(&set, byte)) {
+      continue;
+    }
+    set.bits[byte >> 6] |= 1ULL << (byte & 63);
+    set.low_nibbles[byte >> 7][byte & 15] |= (uint8_t)(1 << ((byte >> 4) & 7));
+    if (set.count < sizeof(set.members)) {
+      set.members[set.count] = byte;
+    }
+    set.count++;
+  }
+  return set;
+}
+
+size_t search_byte(const uint8_t *data, size_t len, uint8_t byte) {
+  size_t index = 0;
+#if defined(STRING_HAS_AVX2)
+  const __m256i wanted = _mm256_set1_epi8((char)byte);
+  for (; index + 32 <= len; index += 32) {
+    __m256i block = _mm256_loadu_si256((const __m256i *)(data + index));
+    uint32_t mask =
+        (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, wanted));
+    if (mask) {
+      return index + trailing_zeros(mask);
+    }
+  }
+#endif
+#if defined(STRING_HAS_SSE2)
+  const __m128i wanted16 = _mm_set1_epi8((char)byte);
+  for (; index + 16 <= len; index += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i *)(data + index));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, wanted16));
+    if (mask) {
+      return index + trailing_zeros(mask);
+    }
+  }
+#endif
+  for (; index + 8 <= len; index += 8) {
+    uint64_t mask = swar_equal_bytes(load_u64(data + index), byte);
+    if (mask) {
+      return index + swar_first_byte(mask);
+    }
+  }
+  for (; index < len; index++) {
+    if (data[index] == byte) {
+      return index;
+    }
+  }
+  return len;
+}
+
+#if defined(STRING_HAS_AVX2)
+// Classifies 32 bytes at once with two table lookups on the nibbles of each
+// byte (Mula's algorithm). Returns a bitmask of the bytes that are members.
+static inline uint32_t members_avx2(__m256i block, __m256i low_table,
+                                    __m256i high_table) {
+  static const uint8_t BITS[16] = {1, 2, 4, 8, 16, 32, 64, 128,
+                                   1, 2, 4, 8, 16, 32, 64, 128};
+  const __m256i bit_table =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)BITS));
+  // pshufb yields zero for indices with the top bit set, so each table only
+  // answers for its own half of the byte range.
+  __m256i rows = _mm256_or_si256(
+      _mm256_shuffle_epi8(low_table, block),
+      _mm256_shuffle_epi8(high_table,
+                          _mm256_xor_si256(block, _mm256_set1_epi8((char)0x80))));
+  __m256i high_nibbles = _mm256_and_si256(_mm256_srli_epi16(block, 4),
+                                          _mm256_set1_epi8(0x0f));
+  __m256i columns = _mm256_shuffle_epi8(bit_table, high_nibbles);
+  __m256i misses = _mm256_cmpeq_epi8(_mm256_and_si256(rows, columns),
+                                     _mm256_setzero_si256());
+  return ~(uint32_t)_mm256_movemask_epi8(misses);
+}
+#endif
+
+static size_t scan_set(const uint8_t *data, size_t len, const byte_set_t *set,
+                       bool want_member) {
+  size_t index = 0;
+#if defined(STRING_HAS_AVX2)
+  const __m256i low_table = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *)set->low_nibbles[0]));
+  const __m256i high_table = _mm256_broadcastsi128_si256(
+      _mm_loadu_si128((const __m128i *)set->low_nibbles[1]));
+  for (; index + 32 <= len; index += 32) {
+    __m256i block = _mm256_loadu_si256((const __m256i *)(data + index));
+    uint32_t mask = members_avx2(block, low_table, high_table);
+    if (!want_member) {
+      mask = ~mask;
+    }
+    if (mask) {
+      return index + trailing_zeros(mask);
+    }
+  }
+#elif defined(STRING_HAS_SSE2)
+  // Without a byte shuffle instruction, small sets are matched with one
+  // comparison per member; larger sets take the scalar loop below.
+  if (set->count <= 4) {
+    __m128i members[4];
+    for (size_t m = 0; m < set->count; m++) {
+      members[m] = _mm_set1_epi8((char)set->members[m]);
+    }
+    for (; index + 16 <= len; index += 16) {
+      __m128i block = _mm_loadu_si128((const __m128i *)(data + index));
+      __m128i hits = _mm_setzero_si128();
+      for (size_t m = 0; m < set->count; m++) {
+        hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, members[m]));
+      }
+      uint32_t mask = (uint32_t)_mm_movemask_epi8(hits);
+      if (!want_member) {
+        mask = ~mask & 0xffffu;
+      }
+      if (mask) {
+        return index + trailing_zeros(mask);
+      }
+    }
+  }
+#endif
+  for (; index < len; index++) {
+    if (byte_set_contains(set, data[index]) == want_member) {
+      return index;
+    }
+  }
+  return len;
+}
+
+size_t search_byte_set(const uint8_t *data, size_t len, const byte_set_t *set) {
+  if (set->count == 1) {
+    return search_byte(data, len, set->members[0]);
+  }
+  return scan_set(data, len, set, true);
+}
+
+size_t search_not_byte_set(const uint8_t *data, size_t len,
+                           const byte_set_t *set) {
+  return scan_set(data, len, set, false);
+}
+
+size_t search_bytes(const uint8_t *haystack, size_t len, const uint8_t *needle,
+                    size_t needle_len) {
+  if (needle_len == 0) {
+    return 0;
+  }
+  if (needle_len > len) {
+    return len;
+  }
+  if (needle_len == 1) {
+    return search_byte(haystack, len, needle[0]);
+  }
+  const size_t last = needle_len - 1;
+  const size_t end = len - last; // One past the last possible start.
+  size_t index = 0;
+#if defined(STRING_HAS_AVX2)
+  const __m256i first_byte = _mm256_set1_epi8((char)needle[0]);
+  const __m256i last_byte = _mm256_set1_epi8((char)needle[last]);
+  for (; index + 32 <= end; index += 32) {
+    __m256i block_first =
+        _mm256_loadu_si256((const __m256i *)(haystack + index));
+    __m256i block_last =
+        _mm256_loadu_si256((const __m256i *)(haystack + index + last));
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first_byte),
+                         _mm256_cmpeq_epi8(block_last, last_byte)));
+    while (mask) {
+      size_t candidate = index + trailing_zeros(mask);
+      if (memcmp(haystack + candidate + 1, needle + 1, last - 1) == 0) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+#endif
+#if defined(STRING_HAS_SSE2)
+  const __m128i first16 = _mm_set1_epi8((char)needle[0]);
+  const __m128i last16 = _mm_set1_epi8((char)needle[last]);
+  for (; index + 16 <= end; index += 16) {
+    __m128i block_first = _mm_loadu_si128((const __m128i *)(haystack + index));
+    __m128i block_last =
+        _mm_loadu_si128((const __m128i *)(haystack + index + last));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(
+        _mm_and_si128(_mm_cmpeq_epi8(block_first, first16),
+                      _mm_cmpeq_epi8(block_last, last16)));
+    while (mask) {
+      size_t candidate = index + trailing_zeros(mask);
+      if (memcmp(haystack + candidate + 1, needle + 1, last - 1) == 0) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+#endif
+  // Skip ahead to occurrences of the first byte, then verify.
+  while (index < end) {
+    index += search_byte(haystack + index, end - index, needle[0]);
+    if (index >= end) {
+      break;
+    }
+    if (haystack[index + last] == needle[last] &&
+        memcmp(haystack + index + 1, needle + 1, last - 1) == 0) {
+      return index;
+    }
+    index++;
+  }
+  return len;
+}
@@ -0,0 +1,99 @@
+#ifndef C_PROGRAMS_SEARCH_H
+#define C_PROGRAMS_SEARCH_H
+/**
+ * Vectorized search kernels over raw byte ranges.
+ *
+ * These are the building blocks of the higher level string functions
+ * (index_of_string, the tokenizers, ...). They work on plain pointers and
+ * lengths so that they can be pointed at any part of a string_t without
+ * creating substrings first.
+ *
+ * Every search returns the index of the first match, or len (the length of
+ * the range that was searched) if there is none.
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A set of bytes, e.g. the delimiters " \t,;". Build it once with
+ * new_byte_set and reuse it for any number of searches.
+ *
+ * bits is a 256 bit membership bitmap. The nibble tables encode the same set
+ * for the vector lookup: bit (b >> 4) & 7 of low_nibbles[b >> 7][b & 15] is
+ * set when b is a member.
+ */
+typedef struct byte_set {
+  uint64_t bits[4];
+  uint8_t low_nibbles[2][16];
+  size_t count;
+  uint8_t members[8];
+} byte_set_t;
+
+/**
+ * Builds a byte set from the given bytes. Duplicates are ignored.
+ *
+ * @param bytes The members of the set.
+ * @param count The number of bytes given.
+ * @return The byte set.
+ */
+byte_set_t new_byte_set(const uint8_t *bytes, size_t count);
+
+/**
+ * @param set  The set to check.
+ * @param byte The byte to look for.
+ * @return true if the byte is a member of the set.
+ */
+static inline bool byte_set_contains(const byte_set_t *set, uint8_t byte) {
+  return (set->bits[byte >> 6] >> (byte & 63)) & 1;
+}
+
+/**
+ * Finds the first occurrence of a byte (the equivalent of memchr).
+ *
+ * @param data The bytes to search.
+ * @param len  The number of bytes.
+ * @param byte The byte to look for.
+ * @return The index of the first occurrence, or len if there is none.
+ */
+size_t search_byte(const uint8_t *data, size_t len, uint8_t byte);
+
+/**
+ * Finds the first byte that is a member of the set.
+ *
+ * @param data The bytes to search.
+ * @param len  The number of bytes.
+ * @param set  The set of bytes to look for.
+ * @return The index of the first member, or len if there is none.
+ */
+size_t search_byte_set(const uint8_t *data, size_t len, const byte_set_t *set);
+
+/**
+ * Finds the first byte that is NOT a member of the set, e.g. to skip leading
+ * whitespace.
+ *
+ * @param data The bytes to search.
+ * @param len  The number of bytes.
+ * @param set  The set of bytes to skip over.
+ * @return The index of the first non-member, or len if there is none.
+ */
+size_t search_not_byte_set(const uint8_t *data, size_t len,
+                           const byte_set_t *set);
+
+/**
+ * Finds the first occurrence of the needle in the haystack. Candidate
+ * positions are found by comparing the first and last byte of the needle
+ * against a whole register of haystack positions at once; only candidates
+ * are then verified byte by byte.
+ *
+ * @param haystack   The bytes to search.
+ * @param len        The number of bytes in the haystack.
+ * @param needle     The bytes to look for.
+ * @param needle_len The number of bytes in the needle.
+ * @return The index of the first occurrence, or len if there is none. An
+ *         empty needle is found at index 0.
+ */
+size_t search_bytes(const uint8_t *haystack, size_t len, const uint8_t *needle,
+                    size_t needle_len);
+
+#endif // C_PROGRAMS_SEARCH_H
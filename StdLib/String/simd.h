@@ -0,0 +1,130 @@
+#ifndef C_PROGRAMS_STRING_SIMD_H
+#define C_PROGRAMS_STRING_SIMD_H
+/**
+ * Internal helpers shared by the string kernels. This header is not part of
+ * the public interface of the String library.
+ *
+ * The vector code paths are chosen at compile time: AVX2 when the compiler
+ * targets it (e.g. -mavx2 or -march=native), otherwise SSE2, which every
+ * x86-64 processor supports. Other targets use the portable word-at-a-time
+ * (SWAR) fallbacks, which work on eight bytes per step. Carry-less
+ * multiplication is used when the compiler targets PCLMUL.
+ */
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__PCLMUL__)
+#include <wmmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define STRING_HAS_AVX2 1
+#define STRING_HAS_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define STRING_HAS_SSE2 1
+#endif
+
+/**
+ * Words are always loaded in little-endian order, so that the first byte in
+ * memory is the least significant byte of the word on every platform.
+ */
+static inline uint64_t load_u64(const uint8_t *data) {
+  uint64_t word;
+  memcpy(&word, data, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  return word;
+}
+
+static inline void store_u64(uint8_t *data, uint64_t word) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap64(word);
+#endif
+  memcpy(data, &word, sizeof(word));
+}
+
+static inline unsigned trailing_zeros(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_ctzll(value);
+#else
+  unsigned count = 0;
+  while (!(value & 1)) {
+    value >>= 1;
+    count++;
+  }
+  return count;
+#endif
+}
+
+static inline unsigned population_count(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (unsigned)__builtin_popcountll(value);
+#else
+  value = value - ((value >> 1) & 0x5555555555555555ULL);
+  value = (value & 0x3333333333333333ULL) + ((value >> 2) & 0x3333333333333333ULL);
+  value = (value + (value >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return (unsigned)((value * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+/**
+ * SWAR helpers: the result has the high bit of a byte set where the
+ * corresponding input byte is zero (resp. equal to the given byte). Only the
+ * lowest flagged byte is guaranteed to be exact; a borrow can flag bytes
+ * above it, so callers must only ever act on the first match.
+ */
+static inline uint64_t swar_zero_bytes(uint64_t word) {
+  return (word - 0x0101010101010101ULL) & ~word & 0x8080808080808080ULL;
+}
+
+static inline uint64_t swar_equal_bytes(uint64_t word, uint8_t byte) {
+  return swar_zero_bytes(word ^ (0x0101010101010101ULL * byte));
+}
+
+/**
+ * @return The index of the first byte flagged by a SWAR mask.
+ */
+static inline unsigned swar_first_byte(uint64_t mask) {
+  return trailing_zeros(mask) >> 3;
+}
+
+/**
+ * @return A mask with one bit per byte of the word (bit i for byte i) that
+ *         is set where the byte equals the given byte. Unlike the SWAR
+ *         helpers above, every flag is exact.
+ */
+static inline uint64_t swar_byte_mask(uint64_t word, uint8_t byte) {
+  uint64_t diff = word ^ (0x0101010101010101ULL * byte);
+  uint64_t nonzero = ((diff & 0x7f7f7f7f7f7f7f7fULL) + 0x7f7f7f7f7f7f7f7fULL) |
+                     diff;
+  uint64_t equal = ~nonzero & 0x8080808080808080ULL;
+  // Gathers the high bit of every byte into the top byte of the product.
+  return ((equal >> 7) * 0x0102040810204080ULL) >> 56;
+}
+
+/**
+ * @return The prefix XOR of the bits: bit i of the result is the XOR of
+ *         bits 0 to i of the input. With quote positions as input, the
+ *         result marks the bytes between an opening and a closing quote.
+ */
+static inline uint64_t prefix_xor(uint64_t bits) {
+#if defined(__PCLMUL__)
+  // A carry-less multiplication by all ones computes exactly this.
+  __m128i product = _mm_clmulepi64_si128(
+      _mm_set_epi64x(0, (long long)bits), _mm_set1_epi8((char)0xff), 0);
+  return (uint64_t)_mm_cvtsi128_si64(product);
+#else
+  bits ^= bits << 1;
+  bits ^= bits << 2;
+  bits ^= bits << 4;
+  bits ^= bits << 8;
+  bits ^= bits << 16;
+  bits ^= bits << 32;
+  return bits;
+#endif
+}
+
+#endif // C_PROGRAMS_STRING_SIMD_H
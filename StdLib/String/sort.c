@@ -0,0 +1,369 @@
+#include "sort.h"
+#include "../Panic/panic.h"
+#include "../Parallel/parallel.h"
+#include "simd.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Groups smaller than this are sorted with multikey quicksort, and parts of
+// multikey quicksort smaller than INSERTION_THRESHOLD with insertion sort.
+static const size_t RADIX_THRESHOLD = 64;
+static const size_t INSERTION_THRESHOLD = 12;
+
+// An entry caches everything about its string that sorting needs. prefix
+// holds the eight bytes starting at a multiple of eight (the depth of the
+// entry's group rounded down), most significant first and padded with zeros
+// past the end of the string.
+typedef struct sort_entry {
+  uint64_t prefix;
+  size_t len;
+  const uint8_t *data;
+  void *item;
+} sort_entry_t;
+
+static inline uint64_t big_endian(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_bswap64(word);
+#else
+  uint64_t result = 0;
+  for (int i = 0; i < 8; i++) {
+    result = result << 8 | ((word >> (8 * i)) & 0xff);
+  }
+  return result;
+#endif
+}
+
+static inline uint64_t load_prefix(const uint8_t *data, size_t len,
+                                   size_t depth) {
+  if (depth >= len) {
+    return 0;
+  }
+  if (len - depth >= 8) {
+    return big_endian(load_u64(data + depth));
+  }
+  uint8_t padded[8] = {0};
+  memcpy(padded, data + depth, len - depth);
+  return big_endian(load_u64(padded));
+}
+
+static void refresh(sort_entry_t *entries, size_t count, size_t depth) {
+  for (size_t i = 0; i < count; i++) {
+    entries[i].prefix = load_prefix(entries[i].data, entries[i].len, depth);
+  }
+}
+
+// The number of bytes of the prefix that are part of the string. Comparing
+// it after the prefix puts a string before any longer string that it starts.
+static inline size_t cached_len(const sort_entry_t *entry, size_t depth) {
+  if (entry->len <= depth) {
+    return 0;
+  }
+  return entry->len - depth < 8 ? entry->len - depth : 8;
+}
+
+// SECTION: Multikey quicksort.
+
+static int compare_entries(const sort_entry_t *left, const sort_entry_t *right,
+                           size_t depth) {
+  if (left->prefix != right->prefix) {
+    return left->prefix < right->prefix ? -1 : +1;
+  }
+  size_t left_len = cached_len(left, depth);
+  size_t right_len = cached_len(right, depth);
+  if (left_len != right_len || left_len < 8) {
+    return left_len < right_len ? -1 : left_len > right_len;
+  }
+  depth += 8;
+  size_t common = (left->len < right->len ? left->len : right->len) - depth;
+  int order = memcmp(left->data + depth, right->data + depth, common);
+  if (order != 0) {
+    return order;
+  }
+  return left->len < right->len ? -1 : left->len > right->len;
+}
+
+static void insertion_sort(sort_entry_t *entries, size_t count, size_t depth) {
+  for (size_t i = 1; i < count; i++) {
+    sort_entry_t entry = entries[i];
+    size_t j = i;
+    while (j > 0 && compare_entries(&entries[j - 1], &entry, depth) > 0) {
+      entries[j] = entries[j - 1];
+      j--;
+    }
+    entries[j] = entry;
+  }
+}
+
+static inline int compare_key(const sort_entry_t *entry, uint64_t prefix,
+                              size_t len, size_t depth) {
+  if (entry->prefix != prefix) {
+    return entry->prefix < prefix ? -1 : +1;
+  }
+  size_t entry_len = cached_len(entry, depth);
+  return entry_len < len ? -1 : entry_len > len;
+}
+
+static inline void swap_entries(sort_entry_t *left, sort_entry_t *right) {
+  sort_entry_t swap = *left;
+  *left = *right;
+  *right = swap;
+}
+
+// Sorts entries that share their first depth bytes, depth being a multiple
+// of eight, eight bytes at a time. Every part is split three ways around a
+// pivot prefix; only the middle part moves on to the next eight bytes.
+static void multikey_quicksort(sort_entry_t *entries, size_t count,
+                               size_t depth) {
+  while (count > INSERTION_THRESHOLD) {
+    const sort_entry_t *a = &entries[0], *b = &entries[count / 2],
+                       *c = &entries[count - 1];
+    const sort_entry_t *pivot;
+    if (compare_key(a, b->prefix, cached_len(b, depth), depth) < 0) {
+      pivot = compare_key(b, c->prefix, cached_len(c, depth), depth) < 0 ? b
+              : compare_key(a, c->prefix, cached_len(c, depth), depth) < 0
+                  ? c
+                  : a;
+    } else {
+      pivot = compare_key(a, c->prefix, cached_len(c, depth), depth) < 0 ? a
+              : compare_key(b, c->prefix, cached_len(c, depth), depth) < 0
+                  ? c
+                  : b;
+    }
+    const uint64_t prefix = pivot->prefix;
+    const size_t len = cached_len(pivot, depth);
+
+    size_t less = 0, index = 0, greater = count;
+    while (index < greater) {
+      int order = compare_key(&entries[index], prefix, len, depth);
+      if (order < 0) {
+        swap_entries(&entries[less++], &entries[index++]);
+      } else if (order > 0) {
+        swap_entries(&entries[index], &entries[--greater]);
+      } else {
+        index++;
+      }
+    }
+    multikey_quicksort(entries, less, depth);
+    multikey_quicksort(entries + greater, count - greater, depth);
+    if (len < 8) {
+      // The middle part holds equal strings.
+      return;
+    }
+    entries += less;
+    count = greater - less;
+    depth += 8;
+    refresh(entries, count, depth);
+  }
+  insertion_sort(entries, count, depth);
+}
+
+// SECTION: Radix sort.
+
+static inline size_t bucket_of(const sort_entry_t *entry, size_t depth) {
+  if (entry->len <= depth) {
+    return 0;
+  }
+  return ((entry->prefix >> (56 - 8 * (depth & 7))) & 0xff) + 1;
+}
+
+// Distributes the entries by their byte at the given depth into 257 buckets,
+// the first one for the strings that end before it. starts receives the
+// first index of every bucket, and one past the last.
+static void distribute(sort_entry_t *entries, sort_entry_t *buffer,
+                       size_t count, size_t depth, size_t starts[258]) {
+  size_t counts[257] = {0};
+  for (size_t i = 0; i < count; i++) {
+    counts[bucket_of(&entries[i], depth)]++;
+  }
+  size_t next[257];
+  bool scattered = true;
+  starts[0] = 0;
+  for (size_t b = 0; b < 257; b++) {
+    next[b] = starts[b];
+    starts[b + 1] = starts[b] + counts[b];
+    scattered &= counts[b] < count;
+  }
+  if (!scattered) {
+    // A shared byte, such as the common prefix of a column of values.
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    buffer[next[bucket_of(&entries[i], depth)]++] = entries[i];
+  }
+  memcpy(entries, buffer, count * sizeof(sort_entry_t));
+}
+
+// Sorts entries that share their first depth bytes. buffer has room for as
+// many entries. The largest bucket is sorted by the loop rather than by a
+// recursive call, which keeps the recursion depth logarithmic.
+static void radix_sort(sort_entry_t *entries, sort_entry_t *buffer,
+                       size_t count, size_t depth) {
+  while (count >= RADIX_THRESHOLD) {
+    size_t starts[258];
+    distribute(entries, buffer, count, depth, starts);
+    size_t largest = 0;
+    for (size_t b = 1; b < 257; b++) {
+      if (starts[b + 1] - starts[b] > starts[largest + 1] - starts[largest]) {
+        largest = b;
+      }
+    }
+    const bool next_word = ((depth + 1) & 7) == 0;
+    for (size_t b = 1; b < 257; b++) {
+      size_t size = starts[b + 1] - starts[b];
+      if (b == largest || size < 2) {
+        continue;
+      }
+      if (next_word) {
+        refresh(entries + starts[b], size, depth + 1);
+      }
+      radix_sort(entries + starts[b], buffer + starts[b], size, depth + 1);
+    }
+    if (largest == 0) {
+      return;
+    }
+    entries += starts[largest];
+    buffer += starts[largest];
+    count = starts[largest + 1] - starts[largest];
+    depth++;
+    if (next_word) {
+      refresh(entries, count, depth);
+    }
+  }
+  multikey_quicksort(entries, count, depth & ~(size_t)7);
+}
+
+// SECTION: Threads.
+//
+// The entries are filled in by slices, then distributed by their first byte
+// on the calling thread, and the buckets are handed out to the threads
+// largest first.
+
+typedef struct sort_job {
+  sort_entry_t *entries;
+  sort_entry_t *buffer;
+  void **items;
+  size_t count;
+  sort_key_t key;
+  const void *context;
+  size_t threads;
+  size_t starts[258];
+  size_t order[256];
+  size_t next;
+  pthread_mutex_t lock;
+} sort_job_t;
+
+static void fill_entries(const sort_job_t *job, size_t start, size_t end) {
+  for (size_t i = start; i < end; i++) {
+    const string_t *key = job->key(job->items[i], job->context);
+    if (!key) {
+      panic(stderr, "String pointer is empty.");
+    }
+    sort_entry_t *entry = &job->entries[i];
+    entry->len = key->len;
+    entry->data = key->data;
+    entry->item = job->items[i];
+    entry->prefix = load_prefix(key->data, key->len, 0);
+  }
+}
+
+static void fill_slice(void *context, size_t index) {
+  const sort_job_t *job = context;
+  size_t slice = (job->count + job->threads - 1) / job->threads;
+  size_t start = index * slice;
+  size_t end = start + slice < job->count ? start + slice : job->count;
+  if (start < end) {
+    fill_entries(job, start, end);
+  }
+}
+
+static void sort_buckets(void *context, size_t index) {
+  (void)index;
+  sort_job_t *job = context;
+  for (;;) {
+    pthread_mutex_lock(&job->lock);
+    size_t taken = job->next < 256 ? job->order[job->next++] : 256;
+    pthread_mutex_unlock(&job->lock);
+    if (taken == 256) {
+      return;
+    }
+    size_t start = job->starts[taken + 1];
+    size_t size = job->starts[taken + 2] - start;
+    if (size > 1) {
+      radix_sort(job->entries + start, job->buffer + start, size, 1);
+    }
+  }
+}
+
+static void parallel_sort(sort_job_t *job) {
+  run_workers(job->threads, fill_slice, job);
+  distribute(job->entries, job->buffer, job->count, 0, job->starts);
+  // Insertion sort of the buckets by decreasing size.
+  for (size_t b = 0; b < 256; b++) {
+    size_t size = job->starts[b + 2] - job->starts[b + 1];
+    size_t i = b;
+    while (i > 0 && job->starts[job->order[i - 1] + 2] -
+                            job->starts[job->order[i - 1] + 1] <
+                        size) {
+      job->order[i] = job->order[i - 1];
+      i--;
+    }
+    job->order[i] = b;
+  }
+  job->next = 0;
+  pthread_mutex_init(&job->lock, NULL);
+  run_workers(job->threads, sort_buckets, job);
+  pthread_mutex_destroy(&job->lock);
+}
+
+// SECTION: Public interface.
+
+static const string_t *string_itself(const void *item, const void *context) {
+  (void)context;
+  return item;
+}
+
+void sort_by_string_key(void **items, size_t count, sort_key_t key,
+                        const void *context, size_t threads) {
+  if (!items || !key) {
+    panic(stderr, "Item array or key function pointer is empty.");
+  }
+  if (count < 2) {
+    return;
+  }
+  threads = resolve_threads(threads);
+  if (count < SORT_PARALLEL_THRESHOLD) {
+    threads = 1;
+  }
+  sort_job_t job;
+  job.entries = malloc(2 * count * sizeof(sort_entry_t));
+  if (!job.entries) {
+    panic(stderr, "Could not allocate memory for sorting.");
+  }
+  job.buffer = job.entries + count;
+  job.items = items;
+  job.count = count;
+  job.key = key;
+  job.context = context;
+  job.threads = threads;
+
+  if (threads == 1) {
+    fill_entries(&job, 0, count);
+    radix_sort(job.entries, job.buffer, count, 0);
+  } else {
+    parallel_sort(&job);
+  }
+  for (size_t i = 0; i < count; i++) {
+    items[i] = job.entries[i].item;
+  }
+  free(job.entries);
+}
+
+void sort_strings(string_t **strings, size_t count, size_t threads) {
+  if (!strings) {
+    panic(stderr, "String array pointer is empty.");
+  }
+  sort_by_string_key((void **)strings, count, string_itself, NULL, threads);
+}
@@ -0,0 +1,61 @@
+#ifndef C_PROGRAMS_SORT_H
+#define C_PROGRAMS_SORT_H
+/**
+ * Sorting of strings in string_cmp order.
+ *
+ * Sorting pointers with qsort and string_cmp follows two pointers for every
+ * comparison and compares the common prefixes of similar strings over and
+ * over. This sort copies the pointers into an array of entries that also
+ * hold the length, the data pointer and the next eight bytes of each string,
+ * and then sorts that array with a most significant digit radix sort: the
+ * entries are distributed by one byte at a time, and bytes that were already
+ * used are never looked at again. The cached bytes are refreshed once every
+ * eight levels, so the strings themselves are read only rarely. Small groups
+ * are finished with multikey quicksort (Bentley and Sedgewick, "Fast
+ * Algorithms for Sorting and Searching Strings", 1997), which compares all
+ * eight cached bytes at once.
+ *
+ * With several threads, the entries are distributed by their first byte and
+ * the resulting groups are sorted in parallel.
+ *
+ * The sort is not stable. It needs 64 bytes of temporary memory per string.
+ */
+#include "string.h"
+
+#include <stddef.h>
+
+/**
+ * Arrays with fewer strings than this are always sorted by one thread.
+ */
+#define SORT_PARALLEL_THRESHOLD 100000
+
+/**
+ * Returns the string to sort an item by.
+ */
+typedef const string_t *(*sort_key_t)(const void *item, const void *context);
+
+/**
+ * Sorts an array of strings in place, in the order of string_cmp.
+ *
+ * @param strings The strings to sort.
+ * @param count   The number of strings.
+ * @param threads The number of threads to use, 0 for one per processor.
+ */
+void sort_strings(string_t **strings, size_t count, size_t threads);
+
+/**
+ * Sorts an array of items in place by a string that belongs to each of
+ * them, for example one of the values of a record. The key function is
+ * called once per item, before sorting; the keys must not change until the
+ * sort returns.
+ *
+ * @param items   The items to sort.
+ * @param count   The number of items.
+ * @param key     Returns the key of an item.
+ * @param context Passed on to the key function.
+ * @param threads The number of threads to use, 0 for one per processor.
+ */
+void sort_by_string_key(void **items, size_t count, sort_key_t key,
+                        const void *context, size_t threads);
+
+#endif // C_PROGRAMS_SORT_H
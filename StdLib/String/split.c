@@ -0,0 +1,144 @@
+#include "split.h"
+#include "../Panic/panic.h"
+#include "simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static tokenizer_t new_tokenizer(const string_t *source, split_mode_t mode) {
+  if (!source) {
+    panic(stderr, "String pointer is empty.");
+  }
+  tokenizer_t tokenizer;
+  memset(&tokenizer, 0, sizeof(tokenizer));
+  tokenizer.source = source;
+  tokenizer.mode = mode;
+  return tokenizer;
+}
+
+tokenizer_t byte_tokenizer(const string_t *source, uint8_t delimiter) {
+  tokenizer_t tokenizer = new_tokenizer(source, SPLIT_ON_BYTE);
+  tokenizer.delimiter = delimiter;
+  return tokenizer;
+}
+
+tokenizer_t set_tokenizer(const string_t *source, const char *delimiters) {
+  if (!delimiters) {
+    panic(stderr, "Delimiter pointer is empty.");
+  }
+  tokenizer_t tokenizer = new_tokenizer(source, SPLIT_ON_ANY_BYTE);
+  tokenizer.delimiters =
+      new_byte_set((const uint8_t *)delimiters, strlen(delimiters));
+  return tokenizer;
+}
+
+tokenizer_t string_tokenizer(const string_t *source,
+                             const string_t *separator) {
+  if (!separator || separator->len == 0) {
+    panic(stderr, "Separator must be a non-empty string.");
+  }
+  tokenizer_t tokenizer = new_tokenizer(source, SPLIT_ON_STRING);
+  tokenizer.separator = separator;
+  return tokenizer;
+}
+
+bool next_token(tokenizer_t *tokenizer, string_t *token) {
+  if (!tokenizer || !token) {
+    panic(stderr, "Tokenizer or token pointer is empty.");
+  }
+  if (tokenizer->finished) {
+    return false;
+  }
+  const uint8_t *start = tokenizer->source->data + tokenizer->position;
+  size_t remaining = tokenizer->source->len - tokenizer->position;
+  size_t found;
+  size_t skip;
+  switch (tokenizer->mode) {
+  case SPLIT_ON_BYTE:
+    found = search_byte(start, remaining, tokenizer->delimiter);
+    skip = 1;
+    break;
+  case SPLIT_ON_ANY_BYTE:
+    found = search_byte_set(start, remaining, &tokenizer->delimiters);
+    skip = 1;
+    break;
+  default:
+    found = search_bytes(start, remaining, tokenizer->separator->data,
+                         tokenizer->separator->len);
+    skip = tokenizer->separator->len;
+    break;
+  }
+  token->data = (uint8_t *)start;
+  token->len = found;
+  if (found == remaining) {
+    tokenizer->finished = true;
+    tokenizer->position = tokenizer->source->len;
+  } else {
+    tokenizer->position += found + skip;
+  }
+  return true;
+}
+
+static void append_offset(size_t **starts, size_t *count, size_t *capacity,
+                          size_t offset) {
+  if (*count == *capacity) {
+    *capacity *= 2;
+    *starts = realloc(*starts, *capacity * sizeof(size_t));
+    if (!*starts) {
+      panic(stderr, "Could not grow the offsets array.");
+    }
+  }
+  (*starts)[(*count)++] = offset;
+}
+
+size_t *split_offsets(const string_t *source, uint8_t delimiter,
+                      size_t *count) {
+  if (!source || !count) {
+    panic(stderr, "String or count pointer is empty.");
+  }
+  const uint8_t *data = source->data;
+  const size_t len = source->len;
+  size_t capacity = 16;
+  size_t used = 0;
+  size_t *starts = malloc(capacity * sizeof(size_t));
+  if (!starts) {
+    panic(stderr, "Could not allocate the offsets array.");
+  }
+  append_offset(&starts, &used, &capacity, 0);
+
+  size_t index = 0;
+  // Each block yields a bitmask of delimiter positions; walking its set bits
+  // emits the offsets without a branch per byte.
+#if defined(STRING_HAS_AVX2)
+  const __m256i wanted = _mm256_set1_epi8((char)delimiter);
+  for (; index + 32 <= len; index += 32) {
+    __m256i block = _mm256_loadu_si256((const __m256i *)(data + index));
+    uint32_t mask =
+        (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, wanted));
+    while (mask) {
+      append_offset(&starts, &used, &capacity,
+                    index + trailing_zeros(mask) + 1);
+      mask &= mask - 1;
+    }
+  }
+#elif defined(STRING_HAS_SSE2)
+  const __m128i wanted = _mm_set1_epi8((char)delimiter);
+  for (; index + 16 <= len; index += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i *)(data + index));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(block, wanted));
+    while (mask) {
+      append_offset(&starts, &used, &capacity,
+                    index + trailing_zeros(mask) + 1);
+      mask &= mask - 1;
+    }
+  }
+#endif
+  for (; index < len; index++) {
+    if (data[index] == delimiter) {
+      append_offset(&starts, &used, &capacity, index + 1);
+    }
+  }
+  append_offset(&starts, &used, &capacity, len + 1);
+  *count = used - 1;
+  return starts;
+}
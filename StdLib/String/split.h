@@ -0,0 +1,101 @@
+#ifndef C_PROGRAMS_SPLIT_H
+#define C_PROGRAMS_SPLIT_H
+/**
+ * Zero-copy tokenizers for string_t.
+ *
+ * A tokenizer walks over a source string and yields its tokens as views: a
+ * view is a string_t (held by value, not by pointer) whose data points into
+ * the source string. Views allocate nothing, must NOT be passed to
+ * free_string, and are only valid as long as the source string is. Use
+ * copy_string on a view to keep a token around.
+ *
+ * Splitting behaves like the split function of most scripting languages:
+ * n delimiters produce n + 1 tokens, so adjacent delimiters yield empty
+ * tokens and an empty source yields a single empty token.
+ *
+ * Example:
+ *
+ *   tokenizer_t tokens = byte_tokenizer(line, ',');
+ *   string_t field;
+ *   while (next_token(&tokens, &field)) {
+ *     print_string(&field);
+ *   }
+ */
+#include "search.h"
+#include "string.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum split_mode {
+  SPLIT_ON_BYTE,
+  SPLIT_ON_ANY_BYTE,
+  SPLIT_ON_STRING
+} split_mode_t;
+
+typedef struct tokenizer {
+  const string_t *source;
+  size_t position;
+  bool finished;
+  split_mode_t mode;
+  uint8_t delimiter;
+  byte_set_t delimiters;
+  const string_t *separator;
+} tokenizer_t;
+
+/**
+ * Creates a tokenizer that splits the source on a single byte.
+ *
+ * @param source    The string to split.
+ * @param delimiter The byte that separates tokens.
+ * @return The tokenizer, positioned before the first token.
+ */
+tokenizer_t byte_tokenizer(const string_t *source, uint8_t delimiter);
+
+/**
+ * Creates a tokenizer that splits the source on any one of several bytes,
+ * e.g. " \t" to split on both spaces and tabs.
+ *
+ * @param source     The string to split.
+ * @param delimiters The bytes that separate tokens (as a C string).
+ * @return The tokenizer, positioned before the first token.
+ */
+tokenizer_t set_tokenizer(const string_t *source, const char *delimiters);
+
+/**
+ * Creates a tokenizer that splits the source on a multi-byte separator,
+ * e.g. "\r\n" or "::". The separator must be non-empty and must outlive the
+ * tokenizer.
+ *
+ * @param source    The string to split.
+ * @param separator The string that separates tokens.
+ * @return The tokenizer, positioned before the first token.
+ */
+tokenizer_t string_tokenizer(const string_t *source, const string_t *separator);
+
+/**
+ * Advances the tokenizer to the next token.
+ *
+ * @param tokenizer The tokenizer to advance.
+ * @param token     Receives a view of the next token.
+ * @return true if a token was produced, false once the source is exhausted.
+ */
+bool next_token(tokenizer_t *tokenizer, string_t *token);
+
+/**
+ * Splits the whole source on a single byte in one pass and returns the
+ * starting offset of every token, for bulk (columnar) processing.
+ *
+ * The returned array holds count + 1 entries: token i spans the bytes from
+ * starts[i] up to (but excluding) starts[i + 1] - 1, and the final entry is
+ * always source->len + 1. The array must be released with free().
+ *
+ * @param source    The string to split.
+ * @param delimiter The byte that separates tokens.
+ * @param count     Receives the number of tokens.
+ * @return The newly allocated array of token starts.
+ */
+size_t *split_offsets(const string_t *source, uint8_t delimiter, size_t *count);
+
+#endif // C_PROGRAMS_SPLIT_H
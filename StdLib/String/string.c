@@ -1,5 +1,7 @@
 #include "string.h"
 #include "../Panic/panic.h"
+#include "search.h"
+#include "simd.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -27,8 +29,8 @@ string_t *convert_string(const char *cstr) {
 }
 
 string_t *copy_string(const string_t *string) {
-  string_t *copy = malloc(sizeof(string_t));
-  assert_not_null(copy);
+  assert_not_null(string);
+  string_t *copy = new_string(string->len);
   memcpy(copy->data, string->data, string->len);
   return copy;
 }
@@ -135,19 +137,162 @@ string_t *right_string(const string_t *src, size_t len) {
   return rightstr;
 }
 
+// Returns the index of the first byte where the two buffers differ, or len
+// if they are identical. The vector loops compare a whole register per step
+// and locate the mismatch from the equality bitmask.
+static size_t mismatch(const uint8_t *left, const uint8_t *right, size_t len) {
+  size_t index = 0;
+#if defined(STRING_HAS_AVX2)
+  for (; index + 32 <= len; index += 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(left + index));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(right + index));
+    uint32_t equal = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+    if (equal != 0xffffffffu) {
+      return index + trailing_zeros(~equal);
+    }
+  }
+#endif
+#if defined(STRING_HAS_SSE2)
+  for (; index + 16 <= len; index += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(left + index));
+    __m128i b = _mm_loadu_si128((const __m128i *)(right + index));
+    uint32_t equal = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+    if (equal != 0xffffu) {
+      return index + trailing_zeros(~equal & 0xffffu);
+    }
+  }
+#endif
+  for (; index + 8 <= len; index += 8) {
+    uint64_t diff = load_u64(left + index) ^ load_u64(right + index);
+    if (diff) {
+      return index + (trailing_zeros(diff) >> 3);
+    }
+  }
+  for (; index < len; index++) {
+    if (left[index] != right[index]) {
+      break;
+    }
+  }
+  return index;
+}
+
 int string_cmp(const string_t *left, const string_t *right) {
   assert_not_null(left);
   assert_not_null(right);
+  size_t common = left->len < right->len ? left->len : right->len;
+  size_t index =
+      left == right ? common : mismatch(left->data, right->data, common);
+  if (index < common) {
+    return left->data[index] - right->data[index];
+  }
   if (left->len != right->len) {
     return left->len > right->len ? +1 : -1;
   }
-  for (size_t index = 0; index < left->len; index++) {
-    int diff = left->data[index] - right->data[index];
-    if (diff) {
-      return diff;
+  return 0;
+}
+
+bool string_equals(const string_t *left, const string_t *right) {
+  assert_not_null(left);
+  assert_not_null(right);
+  if (left->len != right->len) {
+    return false;
+  }
+  if (left == right || left->data == right->data) {
+    return true;
+  }
+  return mismatch(left->data, right->data, left->len) == left->len;
+}
+
+bool string_equals_hashed(const string_t *left, uint64_t left_hash,
+                          const string_t *right, uint64_t right_hash) {
+  return left_hash == right_hash && string_equals(left, right);
+}
+
+// The hash is a port of wyhash (final version 4) by Wang Yi, which is in the
+// public domain. It reads the input in 48-byte strides with three independent
+// 64x64->128 bit multiply-mix lanes.
+static const uint64_t WY_SECRET[4] = {
+    0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL,
+    0x589965cc75374cc3ULL};
+
+static void wy_multiply(uint64_t *a, uint64_t *b) {
+#if defined(__SIZEOF_INT128__)
+  __uint128_t product = (__uint128_t)*a * *b;
+  *a = (uint64_t)product;
+  *b = (uint64_t)(product >> 64);
+#else
+  uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+  uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+  uint64_t t = rl + (rm0 << 32), carry = t < rl;
+  uint64_t lo = t + (rm1 << 32);
+  carry += lo < t;
+  uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+  *a = lo;
+  *b = hi;
+#endif
+}
+
+static uint64_t wy_mix(uint64_t a, uint64_t b) {
+  wy_multiply(&a, &b);
+  return a ^ b;
+}
+
+static uint64_t wy_read4(const uint8_t *data) {
+  uint32_t word;
+  memcpy(&word, data, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  word = __builtin_bswap32(word);
+#endif
+  return word;
+}
+
+uint64_t string_hash_bytes(const uint8_t *data, size_t len, uint64_t seed) {
+  const uint8_t *p = data;
+  uint64_t a, b;
+  seed ^= wy_mix(seed ^ WY_SECRET[0], WY_SECRET[1]);
+  if (len <= 16) {
+    if (len >= 4) {
+      size_t shift = (len >> 3) << 2;
+      a = (wy_read4(p) << 32) | wy_read4(p + shift);
+      b = (wy_read4(p + len - 4) << 32) | wy_read4(p + len - 4 - shift);
+    } else if (len > 0) {
+      a = ((uint64_t)p[0] << 16) | ((uint64_t)p[len >> 1] << 8) | p[len - 1];
+      b = 0;
+    } else {
+      a = b = 0;
+    }
+  } else {
+    size_t remaining = len;
+    if (remaining > 48) {
+      uint64_t lane1 = seed, lane2 = seed;
+      do {
+        seed = wy_mix(load_u64(p) ^ WY_SECRET[1], load_u64(p + 8) ^ seed);
+        lane1 = wy_mix(load_u64(p + 16) ^ WY_SECRET[2],
+                       load_u64(p + 24) ^ lane1);
+        lane2 = wy_mix(load_u64(p + 32) ^ WY_SECRET[3],
+                       load_u64(p + 40) ^ lane2);
+        p += 48;
+        remaining -= 48;
+      } while (remaining > 48);
+      seed ^= lane1 ^ lane2;
+    }
+    while (remaining > 16) {
+      seed = wy_mix(load_u64(p) ^ WY_SECRET[1], load_u64(p + 8) ^ seed);
+      p += 16;
+      remaining -= 16;
     }
+    a = load_u64(p + remaining - 16);
+    b = load_u64(p + remaining - 8);
   }
-  return 0;
+  a ^= WY_SECRET[1];
+  b ^= seed;
+  wy_multiply(&a, &b);
+  return wy_mix(a ^ WY_SECRET[0] ^ len, b ^ WY_SECRET[1]);
+}
+
+uint64_t string_hash(const string_t *string, uint64_t seed) {
+  assert_not_null(string);
+  return string_hash_bytes(string->data, string->len, seed);
 }
 
 size_t index_of_string(const string_t *bigger, const string_t *smaller) {
@@ -157,21 +302,262 @@ size_t index_of_string(const string_t *bigger, const string_t *smaller) {
   if (smaller->len > bigger->len) {
     return fail_value;
   }
-  if (smaller->len == bigger->len) {
-    return string_cmp(smaller, bigger) ? fail_value : 0;
+  size_t index =
+      search_bytes(bigger->data, bigger->len, smaller->data, smaller->len);
+  if (index == bigger->len && smaller->len > 0) {
+    return fail_value;
   }
+  return index;
+}
+
+// SECTION: ASCII case folding and trimming. Only the ASCII letters A-Z and
+// a-z are affected; every other byte (including UTF-8 sequences) is left as
+// it is.
 
-  for (size_t i = 0; i <= bigger->len - smaller->len; i++) {
-    bool mismatched = false;
-    for (size_t j = 0; j < smaller->len; j++) {
-      if (smaller->data[j] != bigger->data[i + j]) {
-        mismatched = true;
-        break;
+static inline uint8_t fold_byte(uint8_t byte) {
+  return (uint8_t)(byte >= 'A' && byte <= 'Z' ? byte + ('a' - 'A') : byte);
+}
+
+// Returns 0x20 in every byte of the word that lies within [first, last],
+// which must both be ASCII. Masking to seven bits first means that none of
+// the additions can carry into the neighbouring byte.
+static inline uint64_t swar_range_case_bits(uint64_t word, uint8_t first,
+                                            uint8_t last) {
+  const uint64_t ones = 0x0101010101010101ULL;
+  uint64_t heptets = word & (0x7f * ones);
+  uint64_t at_least_first = heptets + (0x80 - first) * ones;
+  uint64_t above_last = heptets + (0x7f - last) * ones;
+  return (~word & (at_least_first ^ above_last) & (0x80 * ones)) >> 2;
+}
+
+#if defined(STRING_HAS_AVX2)
+static inline __m256i range_case_bits_avx2(__m256i block, char first,
+                                           char last) {
+  // Bytes of 0x80 and above are negative, so they never fall in the range.
+  __m256i in_range =
+      _mm256_and_si256(_mm256_cmpgt_epi8(block, _mm256_set1_epi8(first - 1)),
+                       _mm256_cmpgt_epi8(_mm256_set1_epi8(last + 1), block));
+  return _mm256_and_si256(in_range, _mm256_set1_epi8(0x20));
+}
+#endif
+#if defined(STRING_HAS_SSE2)
+static inline __m128i range_case_bits_sse2(__m128i block, char first,
+                                           char last) {
+  __m128i in_range =
+      _mm_and_si128(_mm_cmpgt_epi8(block, _mm_set1_epi8(first - 1)),
+                    _mm_cmpgt_epi8(_mm_set1_epi8(last + 1), block));
+  return _mm_and_si128(in_range, _mm_set1_epi8(0x20));
+}
+#endif
+
+// Flips the case bit of every byte within [first, last].
+static void flip_case(uint8_t *data, size_t len, char first, char last) {
+  size_t index = 0;
+#if defined(STRING_HAS_AVX2)
+  for (; index + 32 <= len; index += 32) {
+    __m256i *address = (__m256i *)(data + index);
+    __m256i block = _mm256_loadu_si256(address);
+    _mm256_storeu_si256(
+        address,
+        _mm256_xor_si256(block, range_case_bits_avx2(block, first, last)));
+  }
+#endif
+#if defined(STRING_HAS_SSE2)
+  for (; index + 16 <= len; index += 16) {
+    __m128i *address = (__m128i *)(data + index);
+    __m128i block = _mm_loadu_si128(address);
+    _mm_storeu_si128(
+        address, _mm_xor_si128(block, range_case_bits_sse2(block, first, last)));
+  }
+#endif
+  for (; index + 8 <= len; index += 8) {
+    uint64_t word = load_u64(data + index);
+    store_u64(data + index,
+              word ^ swar_range_case_bits(word, (uint8_t)first, (uint8_t)last));
+  }
+  for (; index < len; index++) {
+    if (data[index] >= first && data[index] <= last) {
+      data[index] ^= 0x20;
+    }
+  }
+}
+
+void string_to_lower(string_t *string) {
+  assert_not_null(string);
+  flip_case(string->data, string->len, 'A', 'Z');
+}
+
+void string_to_upper(string_t *string) {
+  assert_not_null(string);
+  flip_case(string->data, string->len, 'a', 'z');
+}
+
+// Same as mismatch, but both sides are folded to lower case before they are
+// compared.
+static size_t mismatch_ignore_case(const uint8_t *left, const uint8_t *right,
+                                   size_t len) {
+  size_t index = 0;
+#if defined(STRING_HAS_AVX2)
+  for (; index + 32 <= len; index += 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(left + index));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(right + index));
+    a = _mm256_or_si256(a, range_case_bits_avx2(a, 'A', 'Z'));
+    b = _mm256_or_si256(b, range_case_bits_avx2(b, 'A', 'Z'));
+    uint32_t equal = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b));
+    if (equal != 0xffffffffu) {
+      return index + trailing_zeros(~equal);
+    }
+  }
+#endif
+#if defined(STRING_HAS_SSE2)
+  for (; index + 16 <= len; index += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(left + index));
+    __m128i b = _mm_loadu_si128((const __m128i *)(right + index));
+    a = _mm_or_si128(a, range_case_bits_sse2(a, 'A', 'Z'));
+    b = _mm_or_si128(b, range_case_bits_sse2(b, 'A', 'Z'));
+    uint32_t equal = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(a, b));
+    if (equal != 0xffffu) {
+      return index + trailing_zeros(~equal & 0xffffu);
+    }
+  }
+#endif
+  for (; index + 8 <= len; index += 8) {
+    uint64_t a = load_u64(left + index);
+    uint64_t b = load_u64(right + index);
+    uint64_t diff = (a | swar_range_case_bits(a, 'A', 'Z')) ^
+                    (b | swar_range_case_bits(b, 'A', 'Z'));
+    if (diff) {
+      return index + (trailing_zeros(diff) >> 3);
+    }
+  }
+  for (; index < len; index++) {
+    if (fold_byte(left[index]) != fold_byte(right[index])) {
+      break;
+    }
+  }
+  return index;
+}
+
+int string_case_cmp(const string_t *left, const string_t *right) {
+  assert_not_null(left);
+  assert_not_null(right);
+  size_t common = left->len < right->len ? left->len : right->len;
+  size_t index = mismatch_ignore_case(left->data, right->data, common);
+  if (index < common) {
+    return fold_byte(left->data[index]) - fold_byte(right->data[index]);
+  }
+  if (left->len != right->len) {
+    return left->len > right->len ? +1 : -1;
+  }
+  return 0;
+}
+
+size_t index_of_string_ignore_case(const string_t *bigger,
+                                   const string_t *smaller) {
+  assert_not_null(bigger);
+  assert_not_null(smaller);
+  const size_t fail_value = bigger->len + 1;
+  if (smaller->len > bigger->len) {
+    return fail_value;
+  }
+  if (smaller->len == 0) {
+    return 0;
+  }
+  const uint8_t *haystack = bigger->data;
+  const size_t last = smaller->len - 1;
+  const size_t end = bigger->len - last;
+  const uint8_t first_byte = fold_byte(smaller->data[0]);
+  const uint8_t last_byte = fold_byte(smaller->data[last]);
+  size_t index = 0;
+  // Candidates are the positions where both the first and the last byte of
+  // the needle match (after folding); only those are compared in full.
+#if defined(STRING_HAS_AVX2)
+  const __m256i first_wanted = _mm256_set1_epi8((char)first_byte);
+  const __m256i last_wanted = _mm256_set1_epi8((char)last_byte);
+  for (; index + 32 <= end; index += 32) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(haystack + index));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(haystack + index + last));
+    a = _mm256_or_si256(a, range_case_bits_avx2(a, 'A', 'Z'));
+    b = _mm256_or_si256(b, range_case_bits_avx2(b, 'A', 'Z'));
+    uint32_t mask = (uint32_t)_mm256_movemask_epi8(
+        _mm256_and_si256(_mm256_cmpeq_epi8(a, first_wanted),
+                         _mm256_cmpeq_epi8(b, last_wanted)));
+    while (mask) {
+      size_t candidate = index + trailing_zeros(mask);
+      if (mismatch_ignore_case(haystack + candidate, smaller->data,
+                               smaller->len) == smaller->len) {
+        return candidate;
       }
+      mask &= mask - 1;
     }
-    if (!mismatched) {
-      return i;
+  }
+#endif
+#if defined(STRING_HAS_SSE2)
+  const __m128i first16 = _mm_set1_epi8((char)first_byte);
+  const __m128i last16 = _mm_set1_epi8((char)last_byte);
+  for (; index + 16 <= end; index += 16) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(haystack + index));
+    __m128i b = _mm_loadu_si128((const __m128i *)(haystack + index + last));
+    a = _mm_or_si128(a, range_case_bits_sse2(a, 'A', 'Z'));
+    b = _mm_or_si128(b, range_case_bits_sse2(b, 'A', 'Z'));
+    uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpeq_epi8(a, first16), _mm_cmpeq_epi8(b, last16)));
+    while (mask) {
+      size_t candidate = index + trailing_zeros(mask);
+      if (mismatch_ignore_case(haystack + candidate, smaller->data,
+                               smaller->len) == smaller->len) {
+        return candidate;
+      }
+      mask &= mask - 1;
+    }
+  }
+#endif
+  for (; index < end; index++) {
+    if (fold_byte(haystack[index]) == first_byte &&
+        fold_byte(haystack[index + last]) == last_byte &&
+        mismatch_ignore_case(haystack + index, smaller->data, smaller->len) ==
+            smaller->len) {
+      return index;
     }
   }
   return fail_value;
 }
+
+size_t index_of_first_not_in(const string_t *string, const char *set) {
+  assert_not_null(string);
+  if (!set) {
+    panic(stderr, "Set pointer is empty.");
+  }
+  byte_set_t members = new_byte_set((const uint8_t *)set, strlen(set));
+  return search_not_byte_set(string->data, string->len, &members);
+}
+
+static const char *WHITESPACE = " \t\n\v\f\r";
+
+static inline bool is_whitespace(uint8_t byte) {
+  return byte == ' ' || (byte >= '\t' && byte <= '\r');
+}
+
+string_t trim_left_string(const string_t *string) {
+  assert_not_null(string);
+  size_t start = index_of_first_not_in(string, WHITESPACE);
+  string_t view = {string->len - start, string->data + start};
+  return view;
+}
+
+string_t trim_right_string(const string_t *string) {
+  assert_not_null(string);
+  // Trailing whitespace is short in practice, so a backwards byte loop
+  // beats setting up a vector scan.
+  size_t end = string->len;
+  while (end > 0 && is_whitespace(string->data[end - 1])) {
+    end--;
+  }
+  string_t view = {end, string->data};
+  return view;
+}
+
+string_t trim_string(const string_t *string) {
+  string_t left = trim_left_string(string);
+  return trim_right_string(&left);
+}
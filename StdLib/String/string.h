@@ -134,12 +134,62 @@ string_t *right_string(const string_t *src, size_t len);
  * - a positive number if the left string appears after the right one.
  * - zero if they are equal.
  *
+ * A string that is a proper prefix of another comes first. The bytes are
+ * compared as unsigned values, one vector register (or machine word) at a
+ * time.
+ *
  * @param left  The left string to compare.
  * @param right The right string to compare.
  * @return An integer based on the comparison of the two strings given.
  */
 int string_cmp(const string_t *left, const string_t *right);
 
+/**
+ * Checks whether the two strings have the same contents. This is cheaper
+ * than string_cmp because strings of different lengths are rejected
+ * without reading any of their bytes.
+ *
+ * @param left  The left string to compare.
+ * @param right The right string to compare.
+ * @return true if both strings contain exactly the same bytes.
+ */
+bool string_equals(const string_t *left, const string_t *right);
+
+/**
+ * Same as string_equals, but takes the (previously computed) hashes of both
+ * strings, as stored by hash tables. Different hashes reject the pair
+ * without touching the string data at all.
+ *
+ * @param left       The left string to compare.
+ * @param left_hash  string_hash of the left string.
+ * @param right      The right string to compare.
+ * @param right_hash string_hash of the right string (with the same seed).
+ * @return true if both strings contain exactly the same bytes.
+ */
+bool string_equals_hashed(const string_t *left, uint64_t left_hash,
+                          const string_t *right, uint64_t right_hash);
+
+/**
+ * Computes a fast, well-distributed 64-bit hash of the contents of the
+ * string (wyhash). Equal strings always have equal hashes for the same seed.
+ * This is not a cryptographic hash.
+ *
+ * @param string The string to hash.
+ * @param seed   An arbitrary seed; different seeds give unrelated hashes.
+ * @return The 64-bit hash value.
+ */
+uint64_t string_hash(const string_t *string, uint64_t seed);
+
+/**
+ * Same as string_hash, but over a raw byte range.
+ *
+ * @param data The bytes to hash.
+ * @param len  The number of bytes.
+ * @param seed An arbitrary seed.
+ * @return The 64-bit hash value.
+ */
+uint64_t string_hash_bytes(const uint8_t *data, size_t len, uint64_t seed);
+
 /**
  * Checks if the smaller string is entirely contained in the bigger one.
  * If it is, it returns the first index where the two string start to match.
@@ -152,4 +202,66 @@ int string_cmp(const string_t *left, const string_t *right);
  */
 size_t index_of_string(const string_t *bigger, const string_t *smaller);
 
+/**
+ * Converts the ASCII letters of the string to lower case, in place. Bytes
+ * outside A-Z (including multi-byte UTF-8 sequences) are left unchanged.
+ *
+ * @param string The string to convert.
+ */
+void string_to_lower(string_t *string);
+
+/**
+ * Converts the ASCII letters of the string to upper case, in place. Bytes
+ * outside a-z (including multi-byte UTF-8 sequences) are left unchanged.
+ *
+ * @param string The string to convert.
+ */
+void string_to_upper(string_t *string);
+
+/**
+ * Same as string_cmp, but ASCII letters are compared without regard to
+ * case (both sides are folded to lower case).
+ *
+ * @param left  The left string to compare.
+ * @param right The right string to compare.
+ * @return An integer based on the comparison of the two strings given.
+ */
+int string_case_cmp(const string_t *left, const string_t *right);
+
+/**
+ * Same as index_of_string, but ASCII letters match regardless of case.
+ *
+ * @param bigger  The string to be searched in.
+ * @param smaller The string to be searched for.
+ * @return The location of the first match, or a value greater than the
+ *         length of bigger if there is none.
+ */
+size_t index_of_string_ignore_case(const string_t *bigger,
+                                   const string_t *smaller);
+
+/**
+ * Finds the first byte of the string that does not occur in the given set
+ * of bytes (like strspn from the C library).
+ *
+ * @param string The string to scan.
+ * @param set    The bytes to skip over, as a C string.
+ * @return The index of the first byte not in the set, or the length of the
+ *         string if every byte is in the set.
+ */
+size_t index_of_first_not_in(const string_t *string, const char *set);
+
+/**
+ * The trim functions remove ASCII whitespace (space, \t, \n, \v, \f and \r)
+ * from the beginning, the end or both ends of a string. They do not
+ * allocate: the result is a view, a string_t held by value that points into
+ * the original string. Views must not be passed to free_string; use
+ * copy_string to obtain an independent copy.
+ *
+ * @param string The string to trim.
+ * @return A view of the trimmed part of the string.
+ */
+string_t trim_string(const string_t *string);
+string_t trim_left_string(const string_t *string);
+string_t trim_right_string(const string_t *string);
+
 #endif // C_PROGRAMS_STRING_H
\ No newline at end of file
@@ -0,0 +1,299 @@
+#include "suffix.h"
+#include "../Panic/panic.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t EMPTY = SIZE_MAX;
+
+static void *allocate(size_t size) {
+  void *memory = malloc(size ? size : 1);
+  if (!memory) {
+    panic(stderr, "Could not allocate memory for the suffix array.");
+  }
+  return memory;
+}
+
+// SECTION: SA-IS.
+//
+// The text is either the input bytes or, in the recursive calls, a reduced
+// string of size_t names. Both are terminated by a virtual sentinel that is
+// smaller than every symbol; it is never stored.
+
+typedef struct sais_text {
+  const void *symbols;
+  bool wide;
+  size_t len;
+  size_t alphabet;
+  uint8_t *types; // Bit i is set when suffix i is S-type.
+} sais_text_t;
+
+static inline size_t symbol(const sais_text_t *text, size_t index) {
+  return text->wide ? ((const size_t *)text->symbols)[index]
+                    : ((const uint8_t *)text->symbols)[index];
+}
+
+static inline bool is_s_type(const sais_text_t *text, size_t index) {
+  return (text->types[index >> 3] >> (index & 7)) & 1;
+}
+
+static inline bool is_lms(const sais_text_t *text, size_t index) {
+  return index > 0 && is_s_type(text, index) && !is_s_type(text, index - 1);
+}
+
+static void bucket_bounds(const size_t *counts, size_t alphabet,
+                          size_t *buckets, bool ends) {
+  size_t sum = 0;
+  for (size_t c = 0; c < alphabet; c++) {
+    sum += counts[c];
+    buckets[c] = ends ? sum : sum - counts[c];
+  }
+}
+
+// Sorts all suffixes from the sorted LMS suffixes placed at the ends of their
+// buckets: the L-type suffixes are induced left to right, then the S-type
+// suffixes right to left.
+static void induce(const sais_text_t *text, size_t *sa, const size_t *counts,
+                   size_t *buckets) {
+  const size_t n = text->len;
+  bucket_bounds(counts, text->alphabet, buckets, false);
+  // The suffix before the sentinel is L-type and comes first in its bucket.
+  sa[buckets[symbol(text, n - 1)]++] = n - 1;
+  for (size_t i = 0; i < n; i++) {
+    size_t j = sa[i];
+    if (j != EMPTY && j > 0 && !is_s_type(text, j - 1)) {
+      sa[buckets[symbol(text, j - 1)]++] = j - 1;
+    }
+  }
+  bucket_bounds(counts, text->alphabet, buckets, true);
+  for (size_t i = n; i-- > 0;) {
+    size_t j = sa[i];
+    if (j != EMPTY && j > 0 && is_s_type(text, j - 1)) {
+      sa[--buckets[symbol(text, j - 1)]] = j - 1;
+    }
+  }
+}
+
+static bool lms_substrings_equal(const sais_text_t *text, size_t a, size_t b) {
+  for (size_t d = 0;; d++) {
+    // Only the last LMS substring reaches the sentinel, so it is unique.
+    if (a + d == text->len || b + d == text->len) {
+      return false;
+    }
+    if (symbol(text, a + d) != symbol(text, b + d) ||
+        is_s_type(text, a + d) != is_s_type(text, b + d)) {
+      return false;
+    }
+    if (d > 0 && (is_lms(text, a + d) || is_lms(text, b + d))) {
+      return is_lms(text, a + d) && is_lms(text, b + d);
+    }
+  }
+}
+
+static void sais(const void *symbols, bool wide, size_t *sa, size_t n,
+                 size_t alphabet) {
+  if (n == 0) {
+    return;
+  }
+  if (n == 1) {
+    sa[0] = 0;
+    return;
+  }
+  sais_text_t text = {symbols, wide, n, alphabet, NULL};
+  text.types = calloc((n + 7) / 8, 1);
+  size_t *counts = calloc(alphabet, sizeof(size_t));
+  size_t *buckets = allocate(alphabet * sizeof(size_t));
+  if (!text.types || !counts) {
+    panic(stderr, "Could not allocate memory for the suffix array.");
+  }
+
+  // Suffix n - 1 is L-type because the sentinel is smaller than anything.
+  for (size_t i = n - 1; i-- > 0;) {
+    size_t current = symbol(&text, i), next = symbol(&text, i + 1);
+    if (current < next || (current == next && is_s_type(&text, i + 1))) {
+      text.types[i >> 3] |= (uint8_t)(1 << (i & 7));
+    }
+  }
+  for (size_t i = 0; i < n; i++) {
+    counts[symbol(&text, i)]++;
+  }
+
+  // Step 1: sort the LMS substrings by inducing from their unsorted starts.
+  for (size_t i = 0; i < n; i++) {
+    sa[i] = EMPTY;
+  }
+  bucket_bounds(counts, alphabet, buckets, true);
+  for (size_t i = 1; i < n; i++) {
+    if (is_lms(&text, i)) {
+      sa[--buckets[symbol(&text, i)]] = i;
+    }
+  }
+  induce(&text, sa, counts, buckets);
+
+  // Step 2: name the sorted LMS substrings. LMS positions are at least two
+  // apart, so the name of position p can be stored at n1 + p / 2.
+  size_t n1 = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (is_lms(&text, sa[i])) {
+      sa[n1++] = sa[i];
+    }
+  }
+  for (size_t i = n1; i < n; i++) {
+    sa[i] = EMPTY;
+  }
+  size_t names = 0;
+  size_t previous = EMPTY;
+  for (size_t i = 0; i < n1; i++) {
+    size_t position = sa[i];
+    if (previous == EMPTY || !lms_substrings_equal(&text, previous, position)) {
+      names++;
+      previous = position;
+    }
+    sa[n1 + position / 2] = names - 1;
+  }
+  for (size_t i = n, j = n; i-- > n1;) {
+    if (sa[i] != EMPTY) {
+      sa[--j] = sa[i];
+    }
+  }
+
+  // Sort the reduced string, recursively if its names are not yet unique.
+  size_t *reduced = sa + n - n1;
+  if (names < n1) {
+    sais(reduced, true, sa, n1, names);
+  } else {
+    for (size_t i = 0; i < n1; i++) {
+      sa[reduced[i]] = i;
+    }
+  }
+
+  // Step 3: place the sorted LMS suffixes and induce all the others.
+  for (size_t i = 1, j = 0; i < n; i++) {
+    if (is_lms(&text, i)) {
+      reduced[j++] = i;
+    }
+  }
+  for (size_t i = 0; i < n1; i++) {
+    sa[i] = reduced[sa[i]];
+  }
+  for (size_t i = n1; i < n; i++) {
+    sa[i] = EMPTY;
+  }
+  bucket_bounds(counts, alphabet, buckets, true);
+  for (size_t i = n1; i-- > 0;) {
+    size_t position = sa[i];
+    sa[i] = EMPTY;
+    sa[--buckets[symbol(&text, position)]] = position;
+  }
+  induce(&text, sa, counts, buckets);
+
+  free(text.types);
+  free(counts);
+  free(buckets);
+}
+
+// SECTION: Public interface.
+
+size_t *build_suffix_array(const string_t *text) {
+  if (!text) {
+    panic(stderr, "String pointer is empty.");
+  }
+  size_t *suffixes = allocate(text->len * sizeof(size_t));
+  sais(text->data, false, suffixes, text->len, 256);
+  return suffixes;
+}
+
+size_t *build_lcp_array(const string_t *text, const size_t *suffixes) {
+  if (!text || !suffixes) {
+    panic(stderr, "String or suffix array pointer is empty.");
+  }
+  const size_t n = text->len;
+  size_t *lcp = allocate(n * sizeof(size_t));
+  size_t *rank = allocate(n * sizeof(size_t));
+  for (size_t i = 0; i < n; i++) {
+    rank[suffixes[i]] = i;
+  }
+  // Moving from suffix i to suffix i + 1 shortens the common prefix with the
+  // preceding row by at most one, so the total work is linear.
+  size_t common = 0;
+  for (size_t i = 0; i < n; i++) {
+    if (rank[i] == 0) {
+      lcp[0] = 0;
+      common = 0;
+      continue;
+    }
+    size_t j = suffixes[rank[i] - 1];
+    while (i + common < n && j + common < n &&
+           text->data[i + common] == text->data[j + common]) {
+      common++;
+    }
+    lcp[rank[i]] = common;
+    if (common > 0) {
+      common--;
+    }
+  }
+  free(rank);
+  return lcp;
+}
+
+// Compares the pattern with the suffix at the given position, knowing that
+// their first *matched bytes are equal. A suffix that begins with the
+// pattern compares as equal.
+static int compare_suffix(const string_t *text, size_t position,
+                          const string_t *pattern, size_t *matched) {
+  const size_t available = text->len - position;
+  const uint8_t *suffix = text->data + position;
+  size_t m = *matched;
+  while (m < pattern->len && m < available && suffix[m] == pattern->data[m]) {
+    m++;
+  }
+  *matched = m;
+  if (m == pattern->len) {
+    return 0;
+  }
+  if (m == available) {
+    return 1;
+  }
+  return pattern->data[m] < suffix[m] ? -1 : 1;
+}
+
+// Returns the first row whose suffix is not smaller than the pattern (or,
+// with past_matches, the first row whose suffix is greater and does not
+// begin with it). Every suffix strictly between the bounds of the search
+// shares at least min(left, right) bytes with the pattern, which are skipped.
+static size_t search_rows(const string_t *text, const size_t *suffixes,
+                          const string_t *pattern, bool past_matches) {
+  size_t low = 0, high = text->len;
+  size_t left = 0, right = 0;
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    size_t matched = left < right ? left : right;
+    int order = compare_suffix(text, suffixes[middle], pattern, &matched);
+    if (order > 0 || (order == 0 && past_matches)) {
+      low = middle + 1;
+      left = matched;
+    } else {
+      high = middle;
+      right = matched;
+    }
+  }
+  return low;
+}
+
+suffix_range_t find_suffix_range(const string_t *text, const size_t *suffixes,
+                                 const string_t *pattern) {
+  if (!text || !suffixes || !pattern) {
+    panic(stderr, "String, suffix array or pattern pointer is empty.");
+  }
+  suffix_range_t range;
+  range.start = search_rows(text, suffixes, pattern, false);
+  range.end = search_rows(text, suffixes, pattern, true);
+  return range;
+}
+
+size_t count_occurrences(const string_t *text, const size_t *suffixes,
+                         const string_t *pattern) {
+  suffix_range_t range = find_suffix_range(text, suffixes, pattern);
+  return range.end - range.start;
+}
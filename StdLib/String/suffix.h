@@ -0,0 +1,74 @@
+#ifndef C_PROGRAMS_SUFFIX_H
+#define C_PROGRAMS_SUFFIX_H
+/**
+ * Suffix arrays for answering many substring queries over one large text.
+ *
+ * The suffix array of a text lists the starting positions of all its
+ * suffixes in lexicographic order. Every occurrence of a pattern is the
+ * start of a suffix that begins with the pattern, and those suffixes are
+ * adjacent in the array, so all occurrences can be found with a binary
+ * search instead of a scan of the whole text.
+ *
+ * The array is built in linear time with SA-IS (Nong, Zhang and Chan, "Two
+ * Efficient Algorithms for Linear Time Suffix Array Construction", 2011) and
+ * takes sizeof(size_t) bytes per byte of text. For a compressed index that
+ * does not need the text at query time, see fm_index.h.
+ */
+#include "string.h"
+
+#include <stddef.h>
+
+/**
+ * A range [start, end) of rows of a suffix array.
+ */
+typedef struct suffix_range {
+  size_t start;
+  size_t end;
+} suffix_range_t;
+
+/**
+ * Builds the suffix array of the text.
+ *
+ * @param text The text to index.
+ * @return A newly allocated array of text->len positions, sorted by the
+ *         suffixes that start at them. Release it with free.
+ */
+size_t *build_suffix_array(const string_t *text);
+
+/**
+ * Builds the longest common prefix array with the algorithm of Kasai et al.
+ * Entry i is the length of the longest common prefix of the suffixes in rows
+ * i - 1 and i of the suffix array; entry 0 is 0.
+ *
+ * @param text     The indexed text.
+ * @param suffixes The suffix array of the text.
+ * @return A newly allocated array of text->len entries. Release it with free.
+ */
+size_t *build_lcp_array(const string_t *text, const size_t *suffixes);
+
+/**
+ * Finds the rows of the suffix array whose suffixes begin with the pattern.
+ * The occurrences of the pattern are suffixes[start] to suffixes[end - 1],
+ * in no particular order of position. The search takes O(m log n) time in
+ * the worst case for a pattern of length m, but skips the bytes that are
+ * already known to match, so it is usually close to O(m + log n).
+ *
+ * @param text     The indexed text.
+ * @param suffixes The suffix array of the text.
+ * @param pattern  The pattern to look for. The empty pattern matches every
+ *                 row.
+ * @return The range of matching rows; empty (start == end) if there are none.
+ */
+suffix_range_t find_suffix_range(const string_t *text, const size_t *suffixes,
+                                 const string_t *pattern);
+
+/**
+ * @param text     The indexed text.
+ * @param suffixes The suffix array of the text.
+ * @param pattern  The pattern to count.
+ * @return The number of (possibly overlapping) occurrences of the pattern.
+ */
+size_t count_occurrences(const string_t *text, const size_t *suffixes,
+                         const string_t *pattern);
+
+#endif // C_PROGRAMS_SUFFIX_H
@@ -0,0 +1,310 @@
+#include "utf8.h"
+#include "../Panic/panic.h"
+#include "simd.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const uint64_t HIGH_BITS = 0x8080808080808080ULL;
+
+// Checks one code point at a time against the table of well-formed byte
+// sequences in the Unicode standard (Table 3-7). Runs of ASCII are skipped
+// eight bytes at a time.
+static bool validate_scalar(const uint8_t *data, size_t len) {
+  size_t index = 0;
+  while (index < len) {
+    if (index + 8 <= len && !(load_u64(data + index) & HIGH_BITS)) {
+      index += 8;
+      continue;
+    }
+    uint8_t byte = data[index];
+    if (byte < 0x80) {
+      index++;
+      continue;
+    }
+    size_t needed;
+    uint8_t low = 0x80, high = 0xbf;
+    if (byte >= 0xc2 && byte <= 0xdf) {
+      needed = 1;
+    } else if (byte >= 0xe0 && byte <= 0xef) {
+      needed = 2;
+      if (byte == 0xe0) {
+        low = 0xa0; // Overlong
+      } else if (byte == 0xed) {
+        high = 0x9f; // Surrogates
+      }
+    } else if (byte >= 0xf0 && byte <= 0xf4) {
+      needed = 3;
+      if (byte == 0xf0) {
+        low = 0x90; // Overlong
+      } else if (byte == 0xf4) {
+        high = 0x8f; // Above U+10FFFF
+      }
+    } else {
+      return false;
+    }
+    if (len - index <= needed) {
+      return false;
+    }
+    if (data[index + 1] < low || data[index + 1] > high) {
+      return false;
+    }
+    for (size_t k = 2; k <= needed; k++) {
+      if ((data[index + k] & 0xc0) != 0x80) {
+        return false;
+      }
+    }
+    index += needed + 1;
+  }
+  return true;
+}
+
+#if defined(STRING_HAS_AVX2)
+// Error classes of the lookup algorithm. Every pair of adjacent bytes is
+// classified three times (high nibble of the first byte, low nibble of the
+// first byte, high nibble of the second byte); a bit that survives all three
+// lookups identifies an invalid pair.
+enum {
+  TOO_SHORT = 1 << 0,
+  TOO_LONG = 1 << 1,
+  OVERLONG_3 = 1 << 2,
+  TOO_LARGE = 1 << 3,
+  SURROGATE = 1 << 4,
+  OVERLONG_2 = 1 << 5,
+  TOO_LARGE_1000 = 1 << 6,
+  OVERLONG_4 = 1 << 6,
+  TWO_CONTS = 1 << 7,
+  CARRY = TOO_SHORT | TOO_LONG | TWO_CONTS
+};
+
+static const uint8_t BYTE_1_HIGH[16] = {
+    TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+    TOO_LONG, TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+    TOO_SHORT | OVERLONG_2, TOO_SHORT, TOO_SHORT | OVERLONG_3 | SURROGATE,
+    TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4};
+
+static const uint8_t BYTE_1_LOW[16] = {
+    CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4,
+    CARRY | OVERLONG_2,
+    CARRY,
+    CARRY,
+    CARRY | TOO_LARGE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE,
+    CARRY | TOO_LARGE | TOO_LARGE_1000,
+    CARRY | TOO_LARGE | TOO_LARGE_1000};
+
+static const uint8_t BYTE_2_HIGH[16] = {
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    TOO_SHORT, TOO_SHORT,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 |
+        OVERLONG_4,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+    TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT};
+
+// The input shifted right by n bytes, with the last n bytes of the previous
+// block shifted in.
+#define PREVIOUS_BYTES(input, previous, n)                                     \
+  _mm256_alignr_epi8(input, _mm256_permute2x128_si256(previous, input, 0x21), \
+                     16 - (n))
+
+static inline __m256i lookup(const uint8_t table[16], __m256i nibbles) {
+  __m256i repeated =
+      _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)table));
+  return _mm256_shuffle_epi8(repeated, nibbles);
+}
+
+static inline __m256i high_nibbles(__m256i bytes) {
+  return _mm256_and_si256(_mm256_srli_epi16(bytes, 4), _mm256_set1_epi8(0x0f));
+}
+
+static __m256i check_block(__m256i input, __m256i previous) {
+  __m256i prev1 = PREVIOUS_BYTES(input, previous, 1);
+  __m256i special = _mm256_and_si256(
+      _mm256_and_si256(
+          lookup(BYTE_1_HIGH, high_nibbles(prev1)),
+          lookup(BYTE_1_LOW, _mm256_and_si256(prev1, _mm256_set1_epi8(0x0f)))),
+      lookup(BYTE_2_HIGH, high_nibbles(input)));
+
+  // Third and fourth bytes of a sequence must be continuations; the table
+  // lookups only see pairs, so these are checked against the lead bytes two
+  // and three positions back.
+  __m256i prev2 = PREVIOUS_BYTES(input, previous, 2);
+  __m256i prev3 = PREVIOUS_BYTES(input, previous, 3);
+  __m256i third = _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xe0 - 0x80));
+  __m256i fourth = _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xf0 - 0x80));
+  __m256i must_continue = _mm256_and_si256(_mm256_or_si256(third, fourth),
+                                           _mm256_set1_epi8((char)0x80));
+  return _mm256_xor_si256(must_continue, special);
+}
+#endif
+
+bool utf8_is_valid_bytes(const uint8_t *data, size_t len) {
+  size_t index = 0;
+#if defined(STRING_HAS_AVX2)
+  if (len >= 32) {
+    const __m256i incomplete_limit = _mm256_setr_epi8(
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+        -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, (char)(0xf0 - 1),
+        (char)(0xe0 - 1), (char)(0xc0 - 1));
+    __m256i error = _mm256_setzero_si256();
+    __m256i previous = _mm256_setzero_si256();
+    __m256i incomplete = _mm256_setzero_si256();
+    for (; index + 32 <= len; index += 32) {
+      __m256i input = _mm256_loadu_si256((const __m256i *)(data + index));
+      if (!_mm256_movemask_epi8(input)) {
+        // An ASCII block is only wrong if the previous block ended in the
+        // middle of a multi-byte sequence.
+        error = _mm256_or_si256(error, incomplete);
+      } else {
+        error = _mm256_or_si256(error, check_block(input, previous));
+        incomplete = _mm256_subs_epu8(input, incomplete_limit);
+      }
+      previous = input;
+    }
+    if (!_mm256_testz_si256(error, error)) {
+      return false;
+    }
+    // Everything so far is valid, so stepping back over at most three
+    // continuation bytes (and their lead byte) lands on a code point boundary
+    // from where the scalar validator can finish the tail.
+    size_t back = 0;
+    while (back < 3 && (data[index - 1 - back] & 0xc0) == 0x80) {
+      back++;
+    }
+    if (data[index - 1 - back] >= 0xc0) {
+      back++;
+    }
+    index -= back;
+  }
+#endif
+  return validate_scalar(data + index, len - index);
+}
+
+bool utf8_is_valid(const string_t *string) {
+  if (!string) {
+    panic(stderr, "String pointer is empty.");
+  }
+  return utf8_is_valid_bytes(string->data, string->len);
+}
+
+size_t utf8_count_code_points(const string_t *string) {
+  if (!string) {
+    panic(stderr, "String pointer is empty.");
+  }
+  const uint8_t *data = string->data;
+  size_t len = string->len;
+  size_t index = 0;
+  size_t count = 0;
+  // Continuation bytes are 10xxxxxx, which are the only bytes below -64
+  // when read as signed integers.
+#if defined(STRING_HAS_AVX2)
+  for (; index + 32 <= len; index += 32) {
+    __m256i input = _mm256_loadu_si256((const __m256i *)(data + index));
+    uint32_t leads = (uint32_t)_mm256_movemask_epi8(
+        _mm256_cmpgt_epi8(input, _mm256_set1_epi8(-65)));
+    count += population_count(leads);
+  }
+#endif
+#if defined(STRING_HAS_SSE2)
+  for (; index + 16 <= len; index += 16) {
+    __m128i input = _mm_loadu_si128((const __m128i *)(data + index));
+    uint32_t leads = (uint32_t)_mm_movemask_epi8(
+        _mm_cmpgt_epi8(input, _mm_set1_epi8(-65)));
+    count += population_count(leads);
+  }
+#endif
+  for (; index + 8 <= len; index += 8) {
+    uint64_t word = load_u64(data + index);
+    uint64_t continuations = word & ~(word << 1) & HIGH_BITS;
+    count += 8 - population_count(continuations);
+  }
+  for (; index < len; index++) {
+    count += (data[index] & 0xc0) != 0x80;
+  }
+  return count;
+}
+
+size_t utf8_to_utf32(const string_t *string, uint32_t *output) {
+  if (!string || !output) {
+    panic(stderr, "String or output pointer is empty.");
+  }
+  const uint8_t *data = string->data;
+  size_t len = string->len;
+  size_t index = 0;
+  size_t count = 0;
+  while (index < len) {
+#if defined(STRING_HAS_SSE2)
+    if (index + 16 <= len) {
+      __m128i input = _mm_loadu_si128((const __m128i *)(data + index));
+      if (!_mm_movemask_epi8(input)) {
+        // Sixteen ASCII bytes: zero-extend them straight to 32 bits.
+        __m128i zero = _mm_setzero_si128();
+        __m128i low = _mm_unpacklo_epi8(input, zero);
+        __m128i high = _mm_unpackhi_epi8(input, zero);
+        __m128i *out = (__m128i *)(output + count);
+        _mm_storeu_si128(out, _mm_unpacklo_epi16(low, zero));
+        _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(low, zero));
+        _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(high, zero));
+        _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(high, zero));
+        index += 16;
+        count += 16;
+        continue;
+      }
+    }
+#else
+    if (index + 8 <= len && !(load_u64(data + index) & HIGH_BITS)) {
+      for (size_t k = 0; k < 8; k++) {
+        output[count++] = data[index++];
+      }
+      continue;
+    }
+#endif
+    uint32_t byte = data[index];
+    if (byte < 0x80) {
+      output[count++] = byte;
+      index += 1;
+    } else if (byte < 0xe0) {
+      output[count++] = ((byte & 0x1f) << 6) | (data[index + 1] & 0x3f);
+      index += 2;
+    } else if (byte < 0xf0) {
+      output[count++] = ((byte & 0x0f) << 12) |
+                        ((uint32_t)(data[index + 1] & 0x3f) << 6) |
+                        (data[index + 2] & 0x3f);
+      index += 3;
+    } else {
+      output[count++] = ((byte & 0x07) << 18) |
+                        ((uint32_t)(data[index + 1] & 0x3f) << 12) |
+                        ((uint32_t)(data[index + 2] & 0x3f) << 6) |
+                        (data[index + 3] & 0x3f);
+      index += 4;
+    }
+  }
+  return count;
+}
+
+uint32_t *convert_utf8_to_utf32(const string_t *string, size_t *count) {
+  if (!string || !count) {
+    panic(stderr, "String or count pointer is empty.");
+  }
+  if (!utf8_is_valid(string)) {
+    *count = 0;
+    return NULL;
+  }
+  size_t code_points = utf8_count_code_points(string);
+  uint32_t *output = malloc((code_points ? code_points : 1) * sizeof(uint32_t));
+  if (!output) {
+    panic(stderr, "Could not allocate the UTF-32 buffer.");
+  }
+  *count = utf8_to_utf32(string, output);
+  return output;
+}
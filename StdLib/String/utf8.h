@@ -0,0 +1,68 @@
+#ifndef C_PROGRAMS_UTF8_H
+#define C_PROGRAMS_UTF8_H
+/**
+ * UTF-8 utilities for string_t.
+ *
+ * A string_t is just a sequence of bytes; these functions interpret the
+ * bytes as UTF-8. Validation follows RFC 3629: overlong encodings, UTF-16
+ * surrogates (U+D800 to U+DFFF) and code points above U+10FFFF are all
+ * rejected.
+ *
+ * When compiled for AVX2 the validator checks 32 bytes per step using the
+ * lookup table algorithm of Keiser and Lemire ("Validating UTF-8 In Less Than
+ * One Instruction Per Byte", 2021). Otherwise a scalar validator with an
+ * eight-byte ASCII fast path is used. Both give identical answers.
+ */
+#include "string.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @param string The string to check.
+ * @return true if the string is well-formed UTF-8.
+ */
+bool utf8_is_valid(const string_t *string);
+
+/**
+ * Same as utf8_is_valid, but over a raw byte range.
+ *
+ * @param data The bytes to check.
+ * @param len  The number of bytes.
+ * @return true if the bytes are well-formed UTF-8.
+ */
+bool utf8_is_valid_bytes(const uint8_t *data, size_t len);
+
+/**
+ * Counts the code points (characters) in a string by counting every byte
+ * that is not a continuation byte. The string must be valid UTF-8 for the
+ * result to be meaningful.
+ *
+ * @param string The string to count.
+ * @return The number of code points in the string.
+ */
+size_t utf8_count_code_points(const string_t *string);
+
+/**
+ * Decodes a valid UTF-8 string into UTF-32. The output array must have room
+ * for utf8_count_code_points(string) code points. The input is not
+ * validated; use utf8_is_valid first if it comes from an untrusted source.
+ *
+ * @param string The (valid) UTF-8 string to decode.
+ * @param output The array that receives the code points.
+ * @return The number of code points written.
+ */
+size_t utf8_to_utf32(const string_t *string, uint32_t *output);
+
+/**
+ * Validates and decodes the given string into a newly allocated array of
+ * UTF-32 code points, which must be released with free().
+ *
+ * @param string The UTF-8 string to decode.
+ * @param count  Receives the number of code points decoded.
+ * @return The decoded code points, or NULL if the string is not valid UTF-8.
+ */
+uint32_t *convert_utf8_to_utf32(const string_t *string, size_t *count);
+
+#endif // C_PROGRAMS_UTF8_H
@@ -0,0 +1,187 @@
+// fwrite_unlocked is a glibc extension.
+#define _DEFAULT_SOURCE
+#include "writer.h"
+#include "../Panic/panic.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+
+static string_writer_t *new_writer(int fd, FILE *stream, size_t capacity) {
+  if (capacity == 0) {
+    capacity = WRITER_CAPACITY;
+  }
+  string_writer_t *writer = malloc(sizeof(string_writer_t));
+  uint8_t *buffer = malloc(capacity);
+  if (!writer || !buffer) {
+    panic(stderr, "Could not allocate the writer.");
+  }
+  writer->fd = fd;
+  writer->stream = stream;
+  writer->buffer = buffer;
+  writer->len = 0;
+  writer->capacity = capacity;
+  writer->bytes_written = 0;
+  writer->flushes = 0;
+  writer->failed = false;
+  return writer;
+}
+
+string_writer_t *new_fd_writer(int fd, size_t capacity) {
+  if (fd < 0) {
+    panic(stderr, "File descriptor is not valid.");
+  }
+  return new_writer(fd, NULL, capacity);
+}
+
+string_writer_t *new_stream_writer(FILE *stream, size_t capacity) {
+  if (!stream) {
+    panic(stderr, "Output pointer is null.");
+  }
+  return new_writer(-1, stream, capacity);
+}
+
+static void assert_writer(const string_writer_t *writer) {
+  if (!writer) {
+    panic(stderr, "Writer pointer is empty.");
+  }
+}
+
+// SECTION: Output.
+
+static void write_fd(string_writer_t *writer, struct iovec *parts,
+                     int count) {
+  while (count > 0) {
+    ssize_t written = writev(writer->fd, parts, count);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      writer->failed = true;
+      return;
+    }
+    writer->flushes++;
+    writer->bytes_written += (size_t)written;
+    // Skip what was written; a short write can end inside a part.
+    size_t left = (size_t)written;
+    while (count > 0 && left >= parts->iov_len) {
+      left -= parts->iov_len;
+      parts++;
+      count--;
+    }
+    if (count > 0) {
+      parts->iov_base = (uint8_t *)parts->iov_base + left;
+      parts->iov_len -= left;
+    }
+  }
+}
+
+static void write_stream(string_writer_t *writer, const struct iovec *parts,
+                         int count) {
+  flockfile(writer->stream);
+  for (int i = 0; i < count && !writer->failed; i++) {
+#if defined(__GLIBC__)
+    size_t written = fwrite_unlocked(parts[i].iov_base, 1, parts[i].iov_len,
+                                     writer->stream);
+#else
+    size_t written =
+        fwrite(parts[i].iov_base, 1, parts[i].iov_len, writer->stream);
+#endif
+    writer->bytes_written += written;
+    writer->failed = written < parts[i].iov_len;
+  }
+  funlockfile(writer->stream);
+  writer->flushes++;
+}
+
+// Writes out the buffer followed by len bytes of data (which may be 0).
+static void hand_over(string_writer_t *writer, const uint8_t *data,
+                      size_t len) {
+  struct iovec parts[2];
+  int count = 0;
+  if (writer->len > 0) {
+    parts[count].iov_base = writer->buffer;
+    parts[count++].iov_len = writer->len;
+  }
+  if (len > 0) {
+    parts[count].iov_base = (void *)data;
+    parts[count++].iov_len = len;
+  }
+  writer->len = 0;
+  if (count == 0 || writer->failed) {
+    return;
+  }
+  if (writer->fd >= 0) {
+    write_fd(writer, parts, count);
+  } else {
+    write_stream(writer, parts, count);
+  }
+}
+
+// SECTION: Writing.
+
+void writer_write_bytes(string_writer_t *writer, const uint8_t *data,
+                        size_t len) {
+  assert_writer(writer);
+  if (!data && len > 0) {
+    panic(stderr, "Data pointer is empty.");
+  }
+  if (len <= writer->capacity - writer->len) {
+    memcpy(writer->buffer + writer->len, data, len);
+    writer->len += len;
+  } else if (len < writer->capacity / 2) {
+    // Cheaper to copy than to make another call for it.
+    hand_over(writer, NULL, 0);
+    memcpy(writer->buffer, data, len);
+    writer->len = len;
+  } else {
+    hand_over(writer, data, len);
+  }
+}
+
+void writer_write(string_writer_t *writer, const string_t *string) {
+  if (!string) {
+    panic(stderr, "String pointer is empty.");
+  }
+  writer_write_bytes(writer, string->data, string->len);
+}
+
+void writer_write_byte(string_writer_t *writer, uint8_t byte) {
+  assert_writer(writer);
+  if (writer->len == writer->capacity) {
+    hand_over(writer, NULL, 0);
+  }
+  writer->buffer[writer->len++] = byte;
+}
+
+void writer_newline(string_writer_t *writer) { writer_write_byte(writer, '\n'); }
+
+void writer_write_line(string_writer_t *writer, string_t *const strings[],
+                       size_t count, uint8_t separator) {
+  if (!strings && count > 0) {
+    panic(stderr, "String array pointer is empty.");
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (i > 0) {
+      writer_write_byte(writer, separator);
+    }
+    writer_write(writer, strings[i]);
+  }
+  writer_newline(writer);
+}
+
+bool writer_flush(string_writer_t *writer) {
+  assert_writer(writer);
+  hand_over(writer, NULL, 0);
+  return !writer->failed;
+}
+
+void free_writer(string_writer_t *writer) {
+  if (!writer) {
+    return;
+  }
+  hand_over(writer, NULL, 0);
+  free(writer->buffer);
+  free(writer);
+}
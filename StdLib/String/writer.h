@@ -0,0 +1,127 @@
+#ifndef C_PROGRAMS_WRITER_H
+#define C_PROGRAMS_WRITER_H
+/**
+ * Buffered output of many strings.
+ *
+ * fprint_string makes one fwrite call per string, and every call takes the
+ * lock of the stream. A writer collects the strings in its own buffer
+ * instead and hands them over in large blocks: with writev on a file
+ * descriptor, or with a single locked run of fwrite_unlocked calls on a
+ * stream. Strings that are large compared to the buffer are not copied;
+ * they are written together with the buffered bytes in one writev call.
+ *
+ * Write errors are sticky: after a failed write, the writer discards all
+ * output and writer_flush returns false.
+ */
+#include "string.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * The default size of the buffer of a writer.
+ */
+#define WRITER_CAPACITY (64 * 1024)
+
+/**
+ * A writer sends its output either to fd or, when fd is -1, to stream.
+ * bytes_written counts the bytes handed over so far and flushes the number
+ * of writev or (locked) fwrite calls that did so.
+ */
+typedef struct string_writer {
+  int fd;
+  FILE *stream;
+  uint8_t *buffer;
+  size_t len;
+  size_t capacity;
+  size_t bytes_written;
+  size_t flushes;
+  bool failed;
+} string_writer_t;
+
+/**
+ * Creates a writer for a file descriptor, such as STDOUT_FILENO or a file
+ * opened with open. The descriptor is not closed by the writer.
+ *
+ * @param fd       The file descriptor to write to.
+ * @param capacity The size of the buffer, or 0 for WRITER_CAPACITY.
+ * @return A new writer.
+ */
+string_writer_t *new_fd_writer(int fd, size_t capacity);
+
+/**
+ * Creates a writer for a stdio stream. Use this when other code writes to
+ * the same stream; the writer flushes into the stream's own buffer, which
+ * keeps the output in order. The stream is not closed by the writer.
+ *
+ * @param stream   The stream to write to.
+ * @param capacity The size of the buffer, or 0 for WRITER_CAPACITY.
+ * @return A new writer.
+ */
+string_writer_t *new_stream_writer(FILE *stream, size_t capacity);
+
+/**
+ * Appends bytes to the output.
+ *
+ * @param writer The writer.
+ * @param data   The bytes to write.
+ * @param len    The number of bytes.
+ */
+void writer_write_bytes(string_writer_t *writer, const uint8_t *data,
+                        size_t len);
+
+/**
+ * Appends a string to the output.
+ *
+ * @param writer The writer.
+ * @param string The string to write.
+ */
+void writer_write(string_writer_t *writer, const string_t *string);
+
+/**
+ * Appends a single byte to the output, for example a separator.
+ *
+ * @param writer The writer.
+ * @param byte   The byte to write.
+ */
+void writer_write_byte(string_writer_t *writer, uint8_t byte);
+
+/**
+ * Appends a line break ('\n') to the output.
+ *
+ * @param writer The writer.
+ */
+void writer_newline(string_writer_t *writer);
+
+/**
+ * Appends the strings with a separator between every two of them and a line
+ * break at the end, for example the fields of a record.
+ *
+ * @param writer    The writer.
+ * @param strings   The strings to write.
+ * @param count     The number of strings.
+ * @param separator The byte to write between the strings.
+ */
+void writer_write_line(string_writer_t *writer, string_t *const strings[],
+                       size_t count, uint8_t separator);
+
+/**
+ * Hands all buffered bytes over to the file descriptor or the stream (but
+ * does not fflush the stream).
+ *
+ * @param writer The writer.
+ * @return true if everything written so far has been written successfully.
+ */
+bool writer_flush(string_writer_t *writer);
+
+/**
+ * Flushes the writer and releases it. Call writer_flush first to find out
+ * whether the output was written successfully.
+ *
+ * @param writer The writer to be deallocated.
+ */
+void free_writer(string_writer_t *writer);
+
+#endif // C_PROGRAMS_WRITER_H
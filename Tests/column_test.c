@@ -0,0 +1,331 @@
+#include "column_test.h"
+#include "../StdLib/Data/column.h"
+#include "../StdLib/Data/csv.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool date_is(const char *text, bool valid, int32_t expected) {
+  string_t string = {strlen(text), (uint8_t *)text};
+  int32_t days = -1;
+  bool parsed = string_to_date(&string, &days);
+  return parsed == valid && (!valid || days == expected);
+}
+
+static char *dates_round_trip() {
+  mu_assert("Epoch is not day 0.", date_is("1970-01-01", true, 0));
+  mu_assert("Day before the epoch is wrong.", date_is("1969-12-31", true, -1));
+  mu_assert("Leap day is wrong.", date_is("2000-02-29", true, 11016));
+  mu_assert("Invalid leap day was accepted.", date_is("1900-02-29", false, 0));
+  mu_assert("Invalid month was accepted.", date_is("2023-13-01", false, 0));
+  mu_assert("Day 31 of April was accepted.", date_is("2023-04-31", false, 0));
+  mu_assert("Short date was accepted.", date_is("2023-1-01", false, 0));
+  mu_assert("Date with a time was accepted.",
+            date_is("2023-01-01T00", false, 0));
+
+  // Every day of every four digit year, in order.
+  const int32_t first = -719528;
+  uint8_t buffer[10];
+  mu_assert("First day is wrong.", date_is("0000-01-01", true, first));
+  for (int32_t days = first; days < first + 3652425; days++) {
+    string_t string = {format_date(days, buffer), buffer};
+    int32_t parsed;
+    if (!string_to_date(&string, &parsed) || parsed != days) {
+      mu_assert("Date does not round trip.", false);
+    }
+  }
+  mu_assert("Last day is wrong.", memcmp(buffer, "9999-12-31", 10) == 0);
+  return NULL;
+}
+
+static const char *TEXT = "id,price,flag,day,name,late,later\n"
+                          "1,1.5,true,2024-01-31,alice,1,1\n"
+                          "2,,FALSE,,bob,2,2\n"
+                          "-3,2,true,1999-12-31,,3,3\n"
+                          "4,1e3,false,2000-02-29,dave,x,2.5\n";
+
+static dataset_t *parse_text(void) {
+  string_cache_t *cache = parse_csv((const uint8_t *)TEXT, strlen(TEXT), NULL);
+  dataset_t *dataset = new_dataset(cache);
+  free_cache(cache);
+  return dataset;
+}
+
+static char *types_are_inferred() {
+  dataset_t *dataset = parse_text();
+  const column_type_t expected[] = {COLUMN_INT64, COLUMN_DOUBLE,
+                                    COLUMN_BOOL,  COLUMN_DATE,
+                                    COLUMN_STRING, COLUMN_STRING,
+                                    COLUMN_DOUBLE};
+  for (size_t col = 0; col < 7; col++) {
+    mu_assert("Type was inferred incorrectly.",
+              infer_column_type(dataset, col, 0) == expected[col]);
+  }
+  mu_assert("Sample was not limited.",
+            infer_column_type(dataset, 5, 3) == COLUMN_INT64 &&
+                infer_column_type(dataset, 6, 3) == COLUMN_INT64);
+
+  // With a sample of three rows, the last two columns widen.
+  column_table_t *table = new_column_table(dataset, 3);
+  mu_assert("Table has the wrong shape.", table->rows == 4 && table->cols == 7);
+  for (size_t col = 0; col < 7; col++) {
+    mu_assert("Column has the wrong type.",
+              table->columns[col].type == expected[col]);
+  }
+  const column_t *columns = table->columns;
+  mu_assert("Integers are wrong.",
+            columns[0].int64s[2] == -3 && columns[0].nulls == 0 &&
+                string_equals(columns[0].name, dataset_column_name(dataset, 0)));
+  mu_assert("Doubles are wrong.",
+            columns[1].doubles[0] == 1.5 && columns[1].doubles[3] == 1000.0 &&
+                !column_is_valid(&columns[1], 1) &&
+                column_is_valid(&columns[1], 2) && columns[1].nulls == 1);
+  mu_assert("Booleans are wrong.",
+            column_bool(&columns[2], 0) && !column_bool(&columns[2], 1) &&
+                column_bool(&columns[2], 2) && !column_bool(&columns[2], 3) &&
+                column_is_valid(&columns[2], 1));
+  mu_assert("Dates are wrong.",
+            columns[3].dates[3] == 11016 && !column_is_valid(&columns[3], 1));
+  string_t name = column_string(&columns[4], 3);
+  mu_assert("Strings are wrong.",
+            name.len == 4 && memcmp(name.data, "dave", 4) == 0 &&
+                column_string(&columns[4], 2).len == 0 &&
+                !column_is_valid(&columns[4], 2) && columns[4].nulls == 1);
+  mu_assert("Widened double is wrong.", columns[6].doubles[3] == 2.5);
+  free_column_table(table);
+  free_dataset(dataset);
+  return NULL;
+}
+
+static char *tables_convert_back() {
+  dataset_t *dataset = parse_text();
+  const size_t rows[] = {3, 0};
+  const size_t cols[] = {4, 0, 3, 2, 1};
+  dataset_t *picked = take_rows(dataset, rows, 2);
+  dataset_t *view = select_columns(picked, cols, 5);
+  column_table_t *table = new_column_table(view, 0);
+  dataset_t *back = column_table_to_dataset(table);
+  const char *expected[2][5] = {{"dave", "4", "2000-02-29", "false", "1000"},
+                                {"alice", "1", "2024-01-31", "true", "1.5"}};
+  mu_assert("Converted dataset has the wrong shape.",
+            back->rows == 2 && back->cols == 5 &&
+                back->cache->references == 1);
+  for (size_t row = 0; row < 2; row++) {
+    for (size_t col = 0; col < 5; col++) {
+      const string_t *value = dataset_value(back, row, col);
+      mu_assert("Converted value is wrong.",
+                value->len == strlen(expected[row][col]) &&
+                    memcmp(value->data, expected[row][col], value->len) == 0);
+    }
+  }
+  mu_assert("Column names were not kept.",
+            string_equals(dataset_column_name(back, 0),
+                          dataset_column_name(view, 0)));
+
+  // A second conversion finds the same types and values.
+  column_table_t *again = new_column_table(back, 0);
+  for (size_t col = 0; col < 5; col++) {
+    mu_assert("Types changed in a round trip.",
+              again->columns[col].type == table->columns[col].type);
+  }
+  mu_assert("Values changed in a round trip.",
+            again->columns[4].doubles[0] == 1000.0 &&
+                again->columns[2].dates[1] == table->columns[2].dates[1]);
+  free_column_table(again);
+  free_dataset(back);
+  free_column_table(table);
+  free_dataset(view);
+  free_dataset(picked);
+  free_dataset(dataset);
+  return NULL;
+}
+
+static char *large_integers_keep_digits() {
+  // The first column is int64 in the sample and widens at 1.5; the second
+  // only fits a double as far as string_to_double can tell.
+  const char *text = "big,huge\n"
+                     "9007199254740993,12345678901234567890123\n"
+                     "1.5,-12345678901234567890123\n"
+                     "9007199254740992,3\n";
+  string_cache_t *cache = parse_csv((const uint8_t *)text, strlen(text), NULL);
+  dataset_t *dataset = new_dataset(cache);
+  free_cache(cache);
+  mu_assert("Integer beyond int64 was inferred as a double.",
+            infer_column_type(dataset, 1, 0) == COLUMN_STRING);
+  column_table_t *table = new_column_table(dataset, 1);
+  mu_assert("Integer beyond 2^53 was widened to a double.",
+            table->columns[0].type >= COLUMN_STRING &&
+                table->columns[1].type >= COLUMN_STRING);
+  dataset_t *back = column_table_to_dataset(table);
+  for (size_t row = 0; row < 3; row++) {
+    for (size_t col = 0; col < 2; col++) {
+      mu_assert("Value changed in a round trip.",
+                string_equals(dataset_value(back, row, col),
+                              dataset_value(dataset, row, col)));
+    }
+  }
+  free_dataset(back);
+  free_column_table(table);
+  free_dataset(dataset);
+
+  // Numbers out of the range of doubles, or with too many digits.
+  const char *lossy = "over,digits,under,fine\n"
+                      "1e400,0.12345678901234567890123,1e-400,1.50\n"
+                      "-1e400,1,-2.5e-400,-0.00025\n";
+  cache = parse_csv((const uint8_t *)lossy, strlen(lossy), NULL);
+  dataset = new_dataset(cache);
+  free_cache(cache);
+  table = new_column_table(dataset, 0);
+  mu_assert("Number that a double cannot keep was inferred as a double.",
+            table->columns[0].type >= COLUMN_STRING &&
+                table->columns[1].type >= COLUMN_STRING &&
+                table->columns[2].type >= COLUMN_STRING &&
+                table->columns[3].type == COLUMN_DOUBLE);
+  back = column_table_to_dataset(table);
+  for (size_t row = 0; row < 2; row++) {
+    for (size_t col = 0; col < 3; col++) {
+      mu_assert("Lossy number changed in a round trip.",
+                string_equals(dataset_value(back, row, col),
+                              dataset_value(dataset, row, col)));
+    }
+  }
+  free_dataset(back);
+  free_column_table(table);
+
+  // Integers that doubles hold exactly still widen to double.
+  const char *exact = "n\n9007199254740992\n1.5\n-9007199254740992\n";
+  cache = parse_csv((const uint8_t *)exact, strlen(exact), NULL);
+  dataset_t *small = new_dataset(cache);
+  free_cache(cache);
+  table = new_column_table(small, 1);
+  mu_assert("Exact integers did not widen to double.",
+            table->columns[0].type == COLUMN_DOUBLE &&
+                table->columns[0].doubles[2] == -9007199254740992.0);
+  free_column_table(table);
+  free_dataset(small);
+  free_dataset(dataset);
+  return NULL;
+}
+
+// A table of a status with a few values, a city with 300 and a unique id.
+static dataset_t *generate_dataset(size_t rows) {
+  const char *statuses[] = {"open", "closed", "pending", ""};
+  char *text = malloc(rows * 48 + 32);
+  size_t len = (size_t)sprintf(text, "status,city,id\n");
+  for (size_t i = 0; i < rows; i++) {
+    len += (size_t)sprintf(text + len, "%s,city%zu,id-%zu\n",
+                           statuses[i * 7 % 4], i * 31 % 300, i);
+  }
+  string_cache_t *cache = parse_csv((const uint8_t *)text, len, NULL);
+  dataset_t *dataset = new_dataset(cache);
+  free_cache(cache);
+  free(text);
+  return dataset;
+}
+
+static bool equals_cstr(string_t value, const char *expected) {
+  return value.len == strlen(expected) &&
+         memcmp(value.data, expected, value.len) == 0;
+}
+
+static char *dictionaries_encode_values() {
+  dataset_t *dataset = generate_dataset(1000);
+  column_table_t *table = new_column_table(dataset, 0);
+  column_t *status = &table->columns[0];
+  column_t *city = &table->columns[1];
+  column_t *id = &table->columns[2];
+  mu_assert("Columns were encoded incorrectly.",
+            status->type == COLUMN_DICTIONARY && status->cardinality == 4 &&
+                status->code_width == 1 && city->type == COLUMN_DICTIONARY &&
+                city->cardinality == 300 && city->code_width == 2 &&
+                id->type == COLUMN_STRING);
+  mu_assert("Dictionary is not sorted.",
+            equals_cstr(column_string(status, 1), "") &&
+                column_code(status, 1) == 0 && column_code(status, 3) == 1 &&
+                column_code(status, 0) == 2 && column_code(status, 2) == 3 &&
+                status->nulls == 250);
+  for (size_t row = 0; row < dataset->rows; row++) {
+    string_t value = column_string(city, row);
+    mu_assert("Encoded value differs.",
+              string_equals(&value, dataset_value(dataset, row, 1)));
+  }
+  mu_assert("Dictionary does not save memory.",
+            column_memory(city) * 2 < column_memory(id));
+
+  string_t open = {4, (uint8_t *)"open"};
+  string_t city7 = {5, (uint8_t *)"city7"};
+  string_t missing = {4, (uint8_t *)"shut"};
+  size_t count;
+  size_t *rows = column_rows_equal(status, &open, &count);
+  mu_assert("Equality filter on codes is wrong.",
+            count == 250 && rows[0] == 0 && rows[1] == 4);
+  free(rows);
+  mu_assert("Missing value has rows.",
+            !column_rows_equal(status, &missing, &count) && count == 0);
+  rows = column_rows_equal(city, &city7, &count);
+  dataset_t *filtered = take_rows(dataset, rows, count);
+  for (size_t row = 0; row < filtered->rows; row++) {
+    mu_assert("Filtered dataset is wrong.",
+              string_equals(dataset_value(filtered, row, 1), &city7));
+  }
+  mu_assert("Filter missed rows.", count == 4);
+  free(rows);
+  free_dataset(filtered);
+
+  size_t *counts = column_code_counts(status);
+  mu_assert("Code counts are wrong.",
+            counts[0] == 250 && counts[1] == 250 && counts[3] == 250);
+  free(counts);
+
+  rows = column_sorted_rows(city);
+  dataset_t *sorted = take_rows(dataset, rows, dataset->rows);
+  for (size_t row = 1; row < sorted->rows; row++) {
+    int order = string_cmp(dataset_value(sorted, row - 1, 1),
+                           dataset_value(sorted, row, 1));
+    mu_assert("Rows are not sorted.",
+              order < 0 || (order == 0 && rows[row - 1] < rows[row]));
+  }
+  free(rows);
+  free_dataset(sorted);
+
+  encode_column(id);
+  mu_assert("Forced encoding failed.",
+            id->type == COLUMN_DICTIONARY && id->cardinality == 1000 &&
+                id->code_width == 2);
+  dataset_t *back = column_table_to_dataset(table);
+  for (size_t row = 0; row < dataset->rows; row++) {
+    for (size_t col = 0; col < 3; col++) {
+      mu_assert("Encoded table does not convert back.",
+                string_equals(dataset_value(back, row, col),
+                              dataset_value(dataset, row, col)));
+    }
+  }
+  free_dataset(back);
+  free_column_table(table);
+  free_dataset(dataset);
+
+  dataset = generate_dataset(70000);
+  const size_t only_id = 2;
+  dataset_t *ids = select_columns(dataset, &only_id, 1);
+  table = new_column_table(ids, 0);
+  encode_column(&table->columns[0]);
+  mu_assert("Wide codes were not used.",
+            table->columns[0].code_width == 4 &&
+                equals_cstr(column_string(&table->columns[0], 69999),
+                            "id-69999"));
+  free_column_table(table);
+  free_dataset(ids);
+  free_dataset(dataset);
+  return NULL;
+}
+
+char *test_column() {
+  mu_run_test(dates_round_trip);
+  mu_run_test(types_are_inferred);
+  mu_run_test(tables_convert_back);
+  mu_run_test(large_integers_keep_digits);
+  mu_run_test(dictionaries_encode_values);
+  return NULL;
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_COLUMN_TEST_H
+#define C_PROGRAMS_COLUMN_TEST_H
+
+char *test_column();
+
+#endif // C_PROGRAMS_COLUMN_TEST_H
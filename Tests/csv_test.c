@@ -0,0 +1,353 @@
+#include "csv_test.h"
+#include "../StdLib/Data/csv.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const char *FILENAME = "reader.csv";
+
+static void write_file(const char *contents) {
+  FILE *output = fopen(FILENAME, "wb");
+  fputs(contents, output);
+  fclose(output);
+}
+
+/**
+ * Checks that a record holds the given fields, written as one string with
+ * '|' between them.
+ */
+static bool holds_fields(const record_t *record, const char *fields) {
+  if (!record) {
+    return false;
+  }
+  size_t index = 0;
+  for (const char *field = fields;; index++) {
+    const char *bar = strchr(field, '|');
+    size_t len = bar ? (size_t)(bar - field) : strlen(field);
+    if (index >= record->count || record->values[index]->len != len ||
+        memcmp(record->values[index]->data, field, len) != 0) {
+      return false;
+    }
+    if (!bar) {
+      break;
+    }
+    field = bar + 1;
+  }
+  return index + 1 == record->count;
+}
+
+static bool reads_records(size_t capacity, const csv_format_t *format,
+                          const char *contents, const char *expected[],
+                          size_t count) {
+  write_file(contents);
+  FILE *input = fopen(FILENAME, "rb");
+  csv_reader_t *reader = new_csv_reader(input, capacity, format);
+  bool same = true;
+  for (size_t i = 0; i < count; i++) {
+    record_t *record = csv_read_record(reader);
+    same = same && holds_fields(record, expected[i]);
+    free_record(record);
+  }
+  same = same && !csv_read_record(reader) && reader->records == count;
+  free_csv_reader(reader);
+  fclose(input);
+  remove(FILENAME);
+  return same;
+}
+
+static char *reader_splits_lines_and_fields() {
+  const char *expected[] = {"name|age|city", "alice|30|", "", "|||",
+                            "bob|25|paris"};
+  const char *contents = "name,age,city\nalice,30,\r\n\n,,,\nbob,25,paris";
+  mu_assert("Records were read incorrectly.",
+            reads_records(0, NULL, contents, expected, 5));
+  mu_assert("Records were read incorrectly with a tiny buffer.",
+            reads_records(4, NULL, contents, expected, 5));
+  mu_assert("Trailing newline made an extra record.",
+            reads_records(3, NULL, "a,b\nc,d\n", (const char *[]){"a|b", "c|d"},
+                          2));
+  mu_assert("Empty input has records.", reads_records(0, NULL, "", NULL, 0));
+  return NULL;
+}
+
+static char *reader_unescapes_quoted_fields() {
+  const char *expected[] = {"a,b|say \"hi\"|two\r\nlines", "plain|x",
+                            "|\"", "ab,c|\r", "unterminated\n"};
+  const char *contents = "\"a,b\",\"say \"\"hi\"\"\",\"two\r\nlines\"\r\n"
+                         "plain,x\n"
+                         "\"\",\"\"\"\"\n"
+                         "a\"b,\"c,\"\r\"\n"
+                         "\"unterminated\n";
+  for (size_t capacity = 1; capacity < 20; capacity++) {
+    mu_assert("Quoted records were read incorrectly.",
+              reads_records(capacity, NULL, contents, expected, 5));
+  }
+  mu_assert("Quoted records were read incorrectly with a large buffer.",
+            reads_records(0, NULL, contents, expected, 5));
+
+  const csv_format_t format = {';', '\''};
+  mu_assert("Records with another format were read incorrectly.",
+            reads_records(2, &format, "a;'b;c';'it''s'\n\"x\",y\n",
+                          (const char *[]){"a|b;c|it's", "\"x\",y"}, 2));
+  return NULL;
+}
+
+static char *reader_handles_long_records() {
+  char *contents = malloc(100 * 1001 + 1);
+  char *line = malloc(1001);
+  size_t len = 0;
+  for (size_t i = 0; i < 100; i++) {
+    for (size_t j = 0; j < 1000; j++) {
+      contents[len++] = j % 10 == 9 ? ',' : (char)('a' + (i + j) % 26);
+    }
+    contents[len++] = '\n';
+  }
+  contents[len] = '\0';
+  write_file(contents);
+  FILE *input = fopen(FILENAME, "rb");
+  csv_reader_t *reader = new_csv_reader(input, 64, NULL);
+  record_t *record;
+  size_t records = 0;
+  while ((record = csv_read_record(reader))) {
+    memcpy(line, contents + records * 1001, 1000);
+    bool same = record->count == 101 && record->packed;
+    for (size_t f = 0; same && f < 100; f++) {
+      same = record->values[f]->len == 9 &&
+             memcmp(record->values[f]->data, line + f * 10, 9) == 0;
+    }
+    same = same && record->values[100]->len == 0;
+    free_record(record);
+    mu_assert("Long record was read incorrectly.", same);
+    records++;
+  }
+  mu_assert("Wrong number of long records.", records == 100);
+  free_csv_reader(reader);
+  fclose(input);
+  remove(FILENAME);
+  free(line);
+  free(contents);
+  return NULL;
+}
+
+static char *mapped_records_match_reader() {
+  const char *contents = "id,name\r\n1,alice\n\n2,bob,extra\n3,";
+  write_file(contents);
+  FILE *input = fopen(FILENAME, "rb");
+  csv_reader_t *reader = new_csv_reader(input, 0, NULL);
+  csv_map_t *map = map_csv_file(FILENAME, NULL);
+  mu_assert("File could not be mapped.", map);
+  record_t *kept[5];
+  for (size_t i = 0; i < 5; i++) {
+    record_t *expected = csv_read_record(reader);
+    const record_t *mapped = next_mapped_record(map);
+    mu_assert("Mapped record differs.", record_cmp(expected, mapped) == 0);
+    free_record(expected);
+  }
+  mu_assert("Mapped file has extra records.",
+            !next_mapped_record(map) && map->records == 5);
+  free_csv_reader(reader);
+  fclose(input);
+  free_csv_map(map);
+
+  map = map_csv_file(FILENAME, NULL);
+  for (size_t i = 0; i < 5; i++) {
+    kept[i] = read_mapped_record(map);
+  }
+  mu_assert("Mapped file has extra packed records.", !read_mapped_record(map));
+  mu_assert("Values are not views of the file.",
+            kept[1]->values[1]->data - map->data == 11 &&
+                kept[3]->values[2]->len == 5);
+  sort_records_by_column(kept, 5, 0, 1);
+  mu_assert("Kept records were not sorted.",
+            kept[0]->values[0]->len == 0 && kept[1]->values[0]->data[0] == '1' &&
+                kept[4]->values[0]->data[0] == 'i');
+  for (size_t i = 0; i < 5; i++) {
+    free_record(kept[i]);
+  }
+  free_csv_map(map);
+
+  write_file("1,\"a,\"\"b\"\"\"\n2,c\n");
+  map = map_csv_file(FILENAME, NULL);
+  record_t *quoted = read_mapped_record(map);
+  record_t *plain = read_mapped_record(map);
+  mu_assert("Quoted mapped record was not unescaped.",
+            holds_fields(quoted, "1|a,\"b\"") && holds_fields(plain, "2|c") &&
+                plain->values[1]->data - map->data == 14);
+  free_record(quoted);
+  free_record(plain);
+  free_csv_map(map);
+
+  write_file("");
+  map = map_csv_file(FILENAME, NULL);
+  mu_assert("Empty file has records.", map && !next_mapped_record(map));
+  free_csv_map(map);
+  remove(FILENAME);
+  mu_assert("Missing file was mapped.", !map_csv_file(FILENAME, NULL));
+  return NULL;
+}
+
+static char *index_skips_quoted_bytes() {
+  static uint8_t text[1000];
+  srand(5);
+  csv_index_t *index = new_csv_index();
+  const csv_format_t formats[2] = {{',', '"'}, {'\t', '\''}};
+  for (size_t round = 0; round < 20; round++) {
+    const csv_format_t *format = &formats[round / 10];
+    const char bytes[6] = {'a', 'b', (char)format->delimiter, '\n',
+                           (char)format->quote, '\r'};
+    for (size_t i = 0; i < sizeof(text); i++) {
+      text[i] = (uint8_t)bytes[rand() % (round % 2 ? 6 : 5)];
+    }
+    for (size_t len = 0; len < sizeof(text); len += 1 + len / 3) {
+      for (int start = 0; start < 2; start++) {
+        bool quoted = start;
+        size_t count = 0;
+        bool same = true;
+        bool ends_quoted = index_csv(index, text, len, quoted, format);
+        bool has_quote = false;
+        for (size_t i = 0; i < len; i++) {
+          if (text[i] == format->quote) {
+            quoted = !quoted;
+            has_quote = true;
+          } else if (!quoted &&
+                     (text[i] == format->delimiter || text[i] == '\n')) {
+            same = same && count < index->count && index->offsets[count] == i;
+            count++;
+          }
+        }
+        mu_assert("Structural offsets are wrong.",
+                  same && count == index->count);
+        mu_assert("Final quote state is wrong.", ends_quoted == quoted);
+        mu_assert("Quotes were not noticed.", index->quotes == has_quote);
+      }
+    }
+  }
+  free_csv_index(index);
+  return NULL;
+}
+
+/**
+ * Checks that the reader, the map and parse_csv all read the same records
+ * from a text.
+ */
+static bool parsers_agree(const uint8_t *text, size_t len,
+                          const csv_format_t *format) {
+  FILE *output = fopen(FILENAME, "wb");
+  fwrite(text, 1, len, output);
+  fclose(output);
+  FILE *input = fopen(FILENAME, "rb");
+  csv_reader_t *reader = new_csv_reader(input, 0, format);
+  csv_map_t *map = map_csv_file(FILENAME, format);
+  string_cache_t *cache = parse_csv(text, len, format);
+  bool same = true;
+  for (size_t i = 0; same && i <= cache->rows; i++) {
+    const record_t *parsed = i == 0 ? cache->header : cache->records[i - 1];
+    record_t *record = csv_read_record(reader);
+    same = record_cmp(record, parsed) == 0 &&
+           record_cmp(next_mapped_record(map), parsed) == 0;
+    free_record(record);
+  }
+  same = same && !csv_read_record(reader) && !next_mapped_record(map);
+  free_cache(cache);
+  free_csv_map(map);
+  free_csv_reader(reader);
+  fclose(input);
+  remove(FILENAME);
+  return same;
+}
+
+static char *parse_matches_reader() {
+  // Over several index blocks, with quotes only in some of them.
+  const size_t len = 200000;
+  uint8_t *text = malloc(len);
+  const csv_format_t format = {';', '\''};
+  srand(9);
+  for (size_t round = 0; round < 4; round++) {
+    const char *bytes = round == 0 ? "abc,,\n\r" : "abc,,\n\r\"";
+    for (size_t i = 0; i < len; i++) {
+      text[i] = (uint8_t)bytes[rand() % (round == 0 ? 7 : 8)];
+      if (round == 2 && text[i] == '"' && (i < 60000 || i > 70000)) {
+        text[i] = 'q';
+      }
+      if (round == 3 && text[i] == ',') {
+        text[i] = rand() % 2 ? ';' : '\'';
+      }
+    }
+    mu_assert("Parsers disagree.",
+              parsers_agree(text, len, round == 3 ? &format : NULL));
+  }
+  free(text);
+
+  const char *quoted = "a,\"b,\nc\",d\n\"\"\"\",\"e\"\"\"\r\n";
+  string_cache_t *cache = parse_csv((const uint8_t *)quoted, strlen(quoted),
+                                    NULL);
+  mu_assert("Quoted fields were split.",
+            cache->cols == 3 && cache->rows == 1 &&
+                holds_fields(cache->header, "a|b,\nc|d") &&
+                holds_fields(cache->records[0], "\"|e\""));
+  free_cache(cache);
+  cache = parse_csv(NULL, 0, NULL);
+  mu_assert("Empty text has records.", !cache->header && cache->rows == 0);
+  free_cache(cache);
+  return NULL;
+}
+
+static bool caches_equal(const string_cache_t *left,
+                         const string_cache_t *right) {
+  if (left->rows != right->rows || left->cols != right->cols ||
+      record_cmp(left->header, right->header) != 0) {
+    return false;
+  }
+  for (size_t i = 0; i < left->rows; i++) {
+    if (record_cmp(left->records[i], right->records[i]) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static char *parallel_parse_matches_parse() {
+  const size_t len = 3 * CSV_PARALLEL_CHUNK + 1234;
+  uint8_t *text = malloc(len);
+  srand(13);
+  // Quoted fields with line breaks inside, and one record that spans more
+  // than a whole chunk.
+  for (size_t i = 0; i < len; i++) {
+    text[i] = (uint8_t)("abc,,\n\""[rand() % 7]);
+  }
+  memset(text + CSV_PARALLEL_CHUNK - 100, 'x', CSV_PARALLEL_CHUNK + 200);
+  for (size_t i = CSV_PARALLEL_CHUNK; i < 2 * CSV_PARALLEL_CHUNK; i += 999) {
+    text[i] = '\n';
+  }
+  text[CSV_PARALLEL_CHUNK - 101] = '"';
+  text[2 * CSV_PARALLEL_CHUNK + 101] = '"';
+
+  string_cache_t *expected = parse_csv(text, len, NULL);
+  for (size_t threads = 2; threads <= 4; threads++) {
+    string_cache_t *cache = parse_csv_parallel(text, len, threads, NULL);
+    mu_assert("Parallel parse differs.", caches_equal(expected, cache));
+    free_cache(cache);
+  }
+  FILE *output = fopen(FILENAME, "wb");
+  fwrite(text, 1, len, output);
+  fclose(output);
+  string_cache_t *loaded = load_csv(FILENAME, 3, NULL);
+  mu_assert("Loaded file differs.", loaded && caches_equal(expected, loaded));
+  free_cache(loaded);
+  remove(FILENAME);
+  free_cache(expected);
+  free(text);
+  return NULL;
+}
+
+char *test_csv() {
+  mu_run_test(reader_splits_lines_and_fields);
+  mu_run_test(reader_unescapes_quoted_fields);
+  mu_run_test(reader_handles_long_records);
+  mu_run_test(mapped_records_match_reader);
+  mu_run_test(index_skips_quoted_bytes);
+  mu_run_test(parse_matches_reader);
+  mu_run_test(parallel_parse_matches_parse);
+  return NULL;
+}
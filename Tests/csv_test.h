@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_CSV_TEST_H
+#define C_PROGRAMS_CSV_TEST_H
+
+char *test_csv();
+
+#endif // C_PROGRAMS_CSV_TEST_H
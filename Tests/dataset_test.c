@@ -1,6 +1,8 @@
 #include "dataset_test.h"
 #include "../StdLib/Data/csv.h"
 #include "../StdLib/Data/data.h"
+#include "../StdLib/String/number.h"
+#include "../StdLib/String/sort.h"
 #include "test.h"
 
 #include <stdlib.h>
@@ -54,8 +56,252 @@ static char *test_read_csv_record() {
   return NULL;
 }
 
+static char *test_sort_records_by_column() {
+  const char *rows[][2] = {{"pear", "3"}, {"apple", "1"}, {"fig", "2"},
+                           {"apple pie", "4"}, {"", "0"}};
+  record_t *records[5];
+  for (size_t i = 0; i < 5; i++) {
+    string_t **values = malloc(2 * sizeof(string_t *));
+    values[0] = convert_string(rows[i][0]);
+    values[1] = convert_string(rows[i][1]);
+    records[i] = new_record(2, values);
+  }
+
+  sort_records_by_column(records, 5, 0, 1);
+  const char *by_name[] = {"", "apple", "apple pie", "fig", "pear"};
+  for (size_t i = 0; i < 5; i++) {
+    string_t *expected = convert_string(by_name[i]);
+    mu_assert("Records are not sorted by the first column.",
+              string_cmp(records[i]->values[0], expected) == 0);
+    free_string(expected);
+  }
+  sort_records_by_column(records, 5, 1, 0);
+  for (size_t i = 0; i < 5; i++) {
+    mu_assert("Records are not sorted by the second column.",
+              records[i]->values[1]->data[0] == '0' + i);
+  }
+
+  for (size_t i = 0; i < 5; i++) {
+    free_record(records[i]);
+  }
+  return NULL;
+}
+
+static bool value_is(const dataset_t *dataset, size_t row, size_t col,
+                     const char *expected) {
+  const string_t *value = dataset_value(dataset, row, col);
+  return value && value->len == strlen(expected) &&
+         memcmp(value->data, expected, value->len) == 0;
+}
+
+static bool at_least_30(const dataset_t *dataset, size_t row, void *context) {
+  (void)context;
+  const string_t *age = dataset_value(dataset, row, 1);
+  return age && age->len == 2 && age->data[0] >= '3';
+}
+
+static char *test_dataset_views() {
+  const char *text = "name,age,city\nalice,30,paris\nbob,25,rome\n"
+                     "carol,35,oslo\ndave,40\n";
+  string_cache_t *cache = parse_csv((const uint8_t *)text, strlen(text), NULL);
+  dataset_t *all = new_dataset(cache);
+  mu_assert("Dataset does not share the cache.",
+            all->cache == cache && cache->references == 2);
+  // The datasets keep the cache alive on their own.
+  free_cache(cache);
+  mu_assert("Dataset has the wrong shape.", all->rows == 4 && all->cols == 3);
+  mu_assert("Missing value is not NULL.", !dataset_value(all, 3, 2));
+
+  dataset_t *older = select_rows(all, at_least_30, NULL);
+  mu_assert("Rows were selected incorrectly.",
+            older->rows == 3 && value_is(older, 0, 0, "alice") &&
+                value_is(older, 1, 0, "carol") &&
+                value_is(older, 2, 0, "dave"));
+
+  const size_t order[] = {2, 0};
+  dataset_t *projected = select_columns(older, order, 2);
+  mu_assert("Columns were projected incorrectly.",
+            projected->cols == 2 && projected->rows == 3 &&
+                value_is(projected, 1, 0, "oslo") &&
+                value_is(projected, 1, 1, "carol") &&
+                string_cmp(dataset_column_name(projected, 0),
+                           cache->header->values[2]) == 0);
+
+  dataset_t *sliced = slice_rows(projected, 1, 3);
+  const size_t picks[] = {1, 1, 0};
+  dataset_t *taken = take_rows(sliced, picks, 3);
+  mu_assert("Composed views are wrong.",
+            taken->rows == 3 && value_is(taken, 0, 1, "dave") &&
+                value_is(taken, 1, 1, "dave") &&
+                value_is(taken, 2, 0, "oslo") && !dataset_value(taken, 0, 0));
+  mu_assert("Views of views do not refer to the cache directly.",
+            taken->row_arr[2] == 2 && taken->col_arr[0] == 2 &&
+                cache->references == 5);
+
+  dataset_t *empty = slice_rows(taken, 3, 3);
+  mu_assert("Empty slice has rows.", empty->rows == 0 && empty->cols == 2);
+
+  // Any order of release frees the cache exactly once.
+  free_dataset(all);
+  free_dataset(taken);
+  free_dataset(older);
+  free_dataset(empty);
+  free_dataset(projected);
+  mu_assert("Cache was released early.",
+            cache->references == 1 && value_is(sliced, 0, 1, "carol"));
+  free_dataset(sliced);
+  return NULL;
+}
+
+// The reference order: a stable sort that parses every value it compares.
+typedef struct reference_sort {
+  const dataset_t *dataset;
+  const dataset_sort_key_t *keys;
+  size_t count;
+} reference_sort_t;
+
+static reference_sort_t reference;
+
+static int compare_values(const string_t *left, const string_t *right,
+                          const dataset_sort_key_t *key) {
+  const string_t empty = {0, NULL};
+  left = left ? left : &empty;
+  right = right ? right : &empty;
+  if (!key->numeric) {
+    size_t len = left->len < right->len ? left->len : right->len;
+    int result = len ? memcmp(left->data, right->data, len) : 0;
+    if (result) {
+      return result;
+    }
+    return (left->len > right->len) - (left->len < right->len);
+  }
+  double a, b;
+  bool left_number = string_to_double(left, &a) && a == a;
+  bool right_number = string_to_double(right, &b) && b == b;
+  if (!left_number || !right_number) {
+    return left_number - right_number ? (left_number ? -1 : 1) : 0;
+  }
+  return (a > b) - (a < b);
+}
+
+static int compare_rows(const void *left, const void *right) {
+  size_t i = *(const size_t *)left;
+  size_t j = *(const size_t *)right;
+  for (size_t k = 0; k < reference.count; k++) {
+    const dataset_sort_key_t *key = &reference.keys[k];
+    int result =
+        compare_values(dataset_value(reference.dataset, i, key->column),
+                       dataset_value(reference.dataset, j, key->column), key);
+    if (result) {
+      return key->descending ? -result : result;
+    }
+  }
+  return (i > j) - (i < j);
+}
+
+/*
+ * A text whose first column holds strings with zero bytes and common
+ * prefixes longer than eight bytes, whose second holds numbers of both signs,
+ * zeros of both signs and values that are not numbers, and whose third is
+ * missing from some rows.
+ */
+static string_cache_t *sort_fixture(size_t rows) {
+  static const char *names[] = {"",          "a",          "a\0",
+                                "a\0b",     "ab",         "b",
+                                "prefix-00", "prefix-001", "prefix-01"};
+  static const size_t name_lens[] = {0, 1, 2, 3, 2, 1, 9, 10, 9};
+  static const char *numbers[] = {"-3", "0", "-0", "2.5", "",
+                                  "x",  "nan", "1e3", "-inf", "10"};
+  string_t *text = new_string(rows * 32 + 16);
+  text->len = 0;
+  text->len += sprintf((char *)text->data, "name,number,tag\n");
+  uint64_t state = 7;
+  for (size_t i = 0; i < rows; i++) {
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    size_t name = (state >> 33) % 9;
+    size_t number = (state >> 45) % 10;
+    memcpy(text->data + text->len, names[name], name_lens[name]);
+    text->len += name_lens[name];
+    text->len += sprintf((char *)text->data + text->len, ",%s",
+                         numbers[number]);
+    if ((state >> 20) % 5) {
+      text->len +=
+          sprintf((char *)text->data + text->len, ",%u", (unsigned)(i % 3));
+    }
+    text->data[text->len++] = '\n';
+  }
+  string_cache_t *cache = parse_csv(text->data, text->len, NULL);
+  free_string(text);
+  return cache;
+}
+
+static bool even_row(const dataset_t *dataset, size_t row, void *context) {
+  (void)dataset;
+  (void)context;
+  return row % 2 == 0;
+}
+
+static bool sorts_like_reference(string_cache_t *cache,
+                                 const dataset_sort_key_t *keys, size_t count,
+                                 size_t threads) {
+  dataset_t *all = new_dataset(cache);
+  // Sort a view of every other row, to check that only row_arr is used.
+  dataset_t *dataset = select_rows(all, even_row, NULL);
+  free_dataset(all);
+  size_t *expected = malloc(dataset->rows * sizeof(size_t));
+  for (size_t i = 0; i < dataset->rows; i++) {
+    expected[i] = i;
+  }
+  reference.dataset = dataset;
+  reference.keys = keys;
+  reference.count = count;
+  qsort(expected, dataset->rows, sizeof(size_t), compare_rows);
+  for (size_t i = 0; i < dataset->rows; i++) {
+    expected[i] = dataset->row_arr[expected[i]];
+  }
+  sort_dataset(dataset, keys, count, threads);
+  bool same =
+      memcmp(expected, dataset->row_arr, dataset->rows * sizeof(size_t)) == 0;
+  free(expected);
+  free_dataset(dataset);
+  return same;
+}
+
+static char *test_sort_dataset() {
+  const dataset_sort_key_t by_name[] = {{0, false, false}};
+  const dataset_sort_key_t by_number[] = {{1, false, true}};
+  const dataset_sort_key_t mixed[] = {
+      {2, true, false}, {1, true, true}, {0, false, false}};
+  const dataset_sort_key_t names_down[] = {{0, true, false}, {2, false, true}};
+
+  string_cache_t *small = sort_fixture(500);
+  mu_assert("Empty key list moved rows.",
+            sorts_like_reference(small, NULL, 0, 1));
+  mu_assert("Lexical sort is wrong.",
+            sorts_like_reference(small, by_name, 1, 1));
+  mu_assert("Numeric sort is wrong.",
+            sorts_like_reference(small, by_number, 1, 1));
+  mu_assert("Mixed sort is wrong.", sorts_like_reference(small, mixed, 3, 1));
+  mu_assert("Descending sort is wrong.",
+            sorts_like_reference(small, names_down, 2, 1));
+  free_cache(small);
+
+  string_cache_t *large = sort_fixture(2 * SORT_PARALLEL_THRESHOLD + 6001);
+  for (size_t threads = 1; threads <= 4; threads++) {
+    mu_assert("Parallel mixed sort is wrong.",
+              sorts_like_reference(large, mixed, 3, threads));
+  }
+  mu_assert("Parallel descending sort is wrong.",
+            sorts_like_reference(large, names_down, 2, 3));
+  free_cache(large);
+  return NULL;
+}
+
 char *test_dataset() {
   mu_run_test(test_new_record);
   mu_run_test(test_read_csv_record);
+  mu_run_test(test_sort_records_by_column);
+  mu_run_test(test_dataset_views);
+  mu_run_test(test_sort_dataset);
   return NULL;
 }
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include "distance_test.h"
+#include "../StdLib/String/distance.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * The textbook dynamic program, one row at a time.
+ */
+static size_t naive_distance(const uint8_t *left, size_t m,
+                             const uint8_t *right, size_t n) {
+  size_t *row = malloc((n + 1) * sizeof(size_t));
+  for (size_t j = 0; j <= n; j++) {
+    row[j] = j;
+  }
+  for (size_t i = 1; i <= m; i++) {
+    size_t diagonal = row[0];
+    row[0] = i;
+    for (size_t j = 1; j <= n; j++) {
+      size_t best = diagonal + (left[i - 1] != right[j - 1]);
+      if (row[j] + 1 < best) {
+        best = row[j] + 1;
+      }
+      if (row[j - 1] + 1 < best) {
+        best = row[j - 1] + 1;
+      }
+      diagonal = row[j];
+      row[j] = best;
+    }
+  }
+  size_t distance = row[n];
+  free(row);
+  return distance;
+}
+
+/**
+ * The start of the first approximate occurrence, tried one end and then one
+ * start at a time (latest first).
+ */
+static size_t naive_index(const string_t *text, const string_t *pattern,
+                          size_t k) {
+  for (size_t end = 0; end <= text->len; end++) {
+    for (size_t start = end + 1; start-- > 0;) {
+      if (naive_distance(text->data + start, end - start, pattern->data,
+                         pattern->len) <= k) {
+        return start;
+      }
+    }
+  }
+  return text->len + 1;
+}
+
+/**
+ * Fills the buffer with bytes from a small alphabet and returns a view of
+ * it; mutate makes it a noisy copy of the source instead.
+ */
+static string_t random_view(uint8_t *buffer, size_t len, int alphabet) {
+  for (size_t i = 0; i < len; i++) {
+    buffer[i] = (uint8_t)('a' + rand() % alphabet);
+  }
+  string_t view = {len, buffer};
+  return view;
+}
+
+static string_t mutate(uint8_t *buffer, const string_t *source, size_t edits) {
+  memcpy(buffer, source->data, source->len);
+  size_t len = source->len;
+  for (size_t e = 0; e < edits; e++) {
+    size_t at = len ? (size_t)rand() % len : 0;
+    switch (rand() % 3) {
+    case 0:
+      if (len) {
+        buffer[at] = (uint8_t)('a' + rand() % 4);
+      }
+      break;
+    case 1:
+      memmove(buffer + at + 1, buffer + at, len - at);
+      buffer[at] = (uint8_t)('a' + rand() % 4);
+      len++;
+      break;
+    default:
+      if (len) {
+        memmove(buffer + at, buffer + at + 1, len - at - 1);
+        len--;
+      }
+    }
+  }
+  string_t view = {len, buffer};
+  return view;
+}
+
+static char *distances_match_dynamic_programming() {
+  const char *pairs[][3] = {{"", "", "0"},
+                            {"", "abc", "3"},
+                            {"kitten", "sitting", "3"},
+                            {"flaw", "lawn", "2"},
+                            {"intention", "execution", "5"},
+                            {"same", "same", "0"}};
+  for (size_t p = 0; p < 6; p++) {
+    string_t left = {strlen(pairs[p][0]), (uint8_t *)pairs[p][0]};
+    string_t right = {strlen(pairs[p][1]), (uint8_t *)pairs[p][1]};
+    size_t expected = (size_t)atoi(pairs[p][2]);
+    mu_assert("Wrong distance for a known pair.",
+              string_edit_distance(&left, &right) == expected &&
+                  string_edit_distance(&right, &left) == expected);
+  }
+
+  srand(35);
+  static uint8_t first[1200], second[1400];
+  for (size_t t = 0; t < 400; t++) {
+    // Lengths on both sides of the 64 byte blocks.
+    size_t len = t % 4 == 0 ? (size_t)rand() % 70 : (size_t)rand() % 600;
+    string_t left = random_view(first, len, 1 + rand() % 4);
+    string_t right = t % 2 ? mutate(second, &left, (size_t)rand() % 40)
+                           : random_view(second, (size_t)rand() % 600, 4);
+    size_t expected = naive_distance(left.data, left.len, right.data,
+                                     right.len);
+    mu_assert("Wrong edit distance.",
+              string_edit_distance(&left, &right) == expected);
+    size_t bounds[] = {0, 1, expected / 2, expected, expected + 3, 5, 100};
+    for (size_t b = 0; b < 7; b++) {
+      size_t within = string_edit_distance_within(&left, &right, bounds[b]);
+      mu_assert("Wrong bounded edit distance.",
+                within == (expected <= bounds[b] ? expected : bounds[b] + 1));
+    }
+  }
+  return NULL;
+}
+
+static char *batch_matches_single_comparisons() {
+  srand(350);
+  static uint8_t buffers[50][300];
+  static uint8_t query_buffer[200];
+  string_t values[50];
+  string_t *candidates[50];
+  for (size_t round = 0; round < 10; round++) {
+    string_t query = random_view(query_buffer, (size_t)rand() % 200, 3);
+    for (size_t i = 0; i < 50; i++) {
+      values[i] = i % 2 ? mutate(buffers[i], &query, (size_t)rand() % 12)
+                        : random_view(buffers[i], (size_t)rand() % 200, 3);
+      candidates[i] = &values[i];
+    }
+    size_t distances[50];
+    size_t bound = round == 0 ? SIZE_MAX - 1 : (size_t)rand() % 20;
+    string_edit_distances(&query, candidates, 50, bound, distances);
+    for (size_t i = 0; i < 50; i++) {
+      mu_assert("Batch distance differs.",
+                distances[i] == string_edit_distance_within(
+                                    &query, candidates[i], bound));
+    }
+  }
+  return NULL;
+}
+
+static char *approximate_occurrences_are_found() {
+  string_t text = {30, (uint8_t *)"the quick brown fox jumps over"};
+  string_t typo = {5, (uint8_t *)"brwon"};
+  mu_assert("Misspelled word not found.",
+            index_of_string_approx(&text, &typo, 2) == 10);
+  mu_assert("Misspelled word found without edits.",
+            index_of_string_approx(&text, &typo, 0) == text.len + 1);
+  string_t word = {5, (uint8_t *)"jumps"};
+  mu_assert("Exact word not found.",
+            index_of_string_approx(&text, &word, 0) == 20);
+
+  srand(3500);
+  static uint8_t haystack[300], needle[140];
+  for (size_t t = 0; t < 300; t++) {
+    string_t bigger = random_view(haystack, (size_t)rand() % 300, 3);
+    size_t len = t % 3 ? (size_t)rand() % 12 : 60 + (size_t)rand() % 80;
+    string_t smaller = random_view(needle, len, 3);
+    if (bigger.len > len && t % 2) {
+      // Plant a noisy copy of the needle.
+      size_t at = (size_t)rand() % (bigger.len - len);
+      memcpy(haystack + at, needle, len);
+      for (size_t e = 0; e < 3 && len; e++) {
+        haystack[at + (size_t)rand() % len] = 'z';
+      }
+    }
+    size_t k = (size_t)rand() % 6;
+    mu_assert("Wrong approximate occurrence.",
+              index_of_string_approx(&bigger, &smaller, k) ==
+                  naive_index(&bigger, &smaller, k));
+  }
+  return NULL;
+}
+
+char *test_distance() {
+  mu_run_test(distances_match_dynamic_programming);
+  mu_run_test(batch_matches_single_comparisons);
+  mu_run_test(approximate_occurrences_are_found);
+  return NULL;
+}
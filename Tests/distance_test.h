@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_DISTANCE_TEST_H
+#define C_PROGRAMS_DISTANCE_TEST_H
+
+char *test_distance();
+
+#endif // C_PROGRAMS_DISTANCE_TEST_H
@@ -0,0 +1,174 @@
+#include "encoding_test.h"
+#include "../StdLib/String/encoding.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static string_t view(const char *text) {
+  string_t string = {strlen(text), (uint8_t *)text};
+  return string;
+}
+
+static bool equals_text(const string_t *string, const char *text) {
+  return string->len == strlen(text) &&
+         memcmp(string->data, text, string->len) == 0;
+}
+
+static bool encodes_to(const char *text, const char *standard,
+                       const char *url) {
+  string_t input = view(text);
+  uint8_t buffer[64];
+  string_t output = {sizeof(buffer), buffer};
+  base64_encode(&input, &output, BASE64_STANDARD);
+  bool same = equals_text(&output, standard);
+  output.len = sizeof(buffer);
+  base64_encode(&input, &output, BASE64_URL);
+  return same && equals_text(&output, url);
+}
+
+static bool decodes(const char *text, base64_alphabet_t alphabet) {
+  string_t input = view(text);
+  uint8_t buffer[256];
+  string_t output = {sizeof(buffer), buffer};
+  return base64_decode(&input, &output, alphabet);
+}
+
+/**
+ * Encodes six bits at a time, the way the standard describes it.
+ */
+static size_t reference_base64(const uint8_t *data, size_t len,
+                               const char *digits, bool padded,
+                               uint8_t *out) {
+  size_t written = 0;
+  for (size_t bit = 0; bit < len * 8; bit += 6) {
+    unsigned index = 0;
+    for (size_t b = bit; b < bit + 6; b++) {
+      unsigned value = b < len * 8 ? (data[b / 8] >> (7 - b % 8)) & 1 : 0;
+      index = index << 1 | value;
+    }
+    out[written++] = (uint8_t)digits[index];
+  }
+  while (padded && written % 4 != 0) {
+    out[written++] = '=';
+  }
+  return written;
+}
+
+static char *known_values_are_encoded() {
+  mu_assert("Wrong encoding of the empty string.", encodes_to("", "", ""));
+  mu_assert("Wrong encoding of f.", encodes_to("f", "Zg==", "Zg"));
+  mu_assert("Wrong encoding of fo.", encodes_to("fo", "Zm8=", "Zm8"));
+  mu_assert("Wrong encoding of foo.", encodes_to("foo", "Zm9v", "Zm9v"));
+  mu_assert("Wrong encoding of foob.",
+            encodes_to("foob", "Zm9vYg==", "Zm9vYg"));
+  mu_assert("Wrong encoding of foobar.",
+            encodes_to("foobar", "Zm9vYmFy", "Zm9vYmFy"));
+  mu_assert("Wrong encoding of the last two digits.",
+            encodes_to("\xfb\xff\xbf", "+/+/", "-_-_"));
+
+  string_t input = view("\x01\xab\xff");
+  uint8_t buffer[8];
+  string_t output = {sizeof(buffer), buffer};
+  hex_encode(&input, &output);
+  mu_assert("Wrong hexadecimal encoding.", equals_text(&output, "01abff"));
+  input = view("01ABfF");
+  output.len = sizeof(buffer);
+  mu_assert("Hexadecimal not decoded.", hex_decode(&input, &output));
+  mu_assert("Wrong hexadecimal decoding.",
+            output.len == 3 && memcmp(buffer, "\x01\xab\xff", 3) == 0);
+  return NULL;
+}
+
+static char *invalid_inputs_are_rejected() {
+  const char *standard[] = {"Zg=",      "Zg",   "Zh==", "Zm9=", "Zm9v\n",
+                            "Zm9=vYg=", "Z===", "====", "Zm-v", "Zm8=Zm8="};
+  for (size_t i = 0; i < 10; i++) {
+    mu_assert("Invalid standard Base64 accepted.",
+              !decodes(standard[i], BASE64_STANDARD));
+  }
+  const char *url[] = {"Zg==", "Z", "Zh", "Zm9", "Zm+v", "Zm/v", "Zm9vY"};
+  for (size_t i = 0; i < 7; i++) {
+    mu_assert("Invalid URL-safe Base64 accepted.",
+              !decodes(url[i], BASE64_URL));
+  }
+  mu_assert("Valid Base64 rejected.",
+            decodes("Zm9vYg==", BASE64_STANDARD) && decodes("", BASE64_URL) &&
+                decodes("Zm9vYg", BASE64_URL));
+
+  const char *hex[] = {"0", "0g", "zz", " 1", "1 "};
+  for (size_t i = 0; i < 5; i++) {
+    string_t input = view(hex[i]);
+    uint8_t buffer[4];
+    string_t output = {sizeof(buffer), buffer};
+    mu_assert("Invalid hexadecimal accepted.", !hex_decode(&input, &output));
+  }
+  return NULL;
+}
+
+static char *random_data_round_trips() {
+  srand(38);
+  const char *digits[] = {
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"};
+  static uint8_t data[400], encoded[1000], expected[1000], decoded[1000];
+  for (size_t t = 0; t < 1000; t++) {
+    size_t len = (size_t)rand() % 400;
+    for (size_t i = 0; i < len; i++) {
+      data[i] = (uint8_t)rand();
+    }
+    string_t input = {len, data};
+    for (int a = 0; a < 2; a++) {
+      base64_alphabet_t alphabet = a ? BASE64_URL : BASE64_STANDARD;
+      string_t output = {base64_encoded_len(len, alphabet), encoded};
+      base64_encode(&input, &output, alphabet);
+      size_t expected_len =
+          reference_base64(data, len, digits[a], !a, expected);
+      mu_assert("Base64 differs from the reference.",
+                output.len == expected_len &&
+                    memcmp(encoded, expected, expected_len) == 0);
+
+      string_t back = {base64_decoded_len(output.len), decoded};
+      mu_assert("Base64 does not decode.",
+                base64_decode(&output, &back, alphabet));
+      mu_assert("Base64 does not round trip.",
+                back.len == len && memcmp(decoded, data, len) == 0);
+
+      // A byte outside the alphabet anywhere must be noticed.
+      if (output.len > 0) {
+        size_t at = (size_t)rand() % output.len;
+        uint8_t saved = encoded[at];
+        encoded[at] = (uint8_t)"!*.\n\x80"[rand() % 5];
+        back.len = base64_decoded_len(output.len);
+        mu_assert("Corrupted Base64 accepted.",
+                  !base64_decode(&output, &back, alphabet));
+        encoded[at] = saved;
+      }
+    }
+
+    string_t hex = {hex_encoded_len(len), encoded};
+    hex_encode(&input, &hex);
+    for (size_t i = 0; i < len; i++) {
+      mu_assert("Wrong hexadecimal digits.",
+                encoded[2 * i] == "0123456789abcdef"[data[i] >> 4] &&
+                    encoded[2 * i + 1] == "0123456789abcdef"[data[i] & 15]);
+    }
+    string_t back = {len, decoded};
+    mu_assert("Hexadecimal does not round trip.",
+              hex_decode(&hex, &back) && back.len == len &&
+                  memcmp(decoded, data, len) == 0);
+    if (len > 0) {
+      encoded[(size_t)rand() % (2 * len)] = 'g';
+      back.len = len;
+      mu_assert("Corrupted hexadecimal accepted.", !hex_decode(&hex, &back));
+    }
+  }
+  return NULL;
+}
+
+char *test_encoding() {
+  mu_run_test(known_values_are_encoded);
+  mu_run_test(invalid_inputs_are_rejected);
+  mu_run_test(random_data_round_trips);
+  return NULL;
+}
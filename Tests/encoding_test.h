@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_ENCODING_TEST_H
+#define C_PROGRAMS_ENCODING_TEST_H
+
+char *test_encoding();
+
+#endif // C_PROGRAMS_ENCODING_TEST_H
@@ -0,0 +1,123 @@
+#include "fm_index_test.h"
+#include "../StdLib/String/fm_index.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static size_t naive_count(const string_t *text, const string_t *pattern) {
+  // The empty pattern is counted once per position, like in the index.
+  size_t count = 0;
+  for (size_t i = 0; i < text->len && i + pattern->len <= text->len; i++) {
+    count += memcmp(text->data + i, pattern->data, pattern->len) == 0;
+  }
+  return count;
+}
+
+static int compare_positions(const void *a, const void *b) {
+  size_t left = *(const size_t *)a, right = *(const size_t *)b;
+  return left < right ? -1 : left > right;
+}
+
+/**
+ * Checks count and locate against a scan of the text for patterns taken
+ * from the text and for random ones.
+ */
+static bool answers_queries(const fm_index_t *index, const string_t *text,
+                            int alphabet) {
+  for (size_t q = 0; q < 200; q++) {
+    uint8_t bytes[24];
+    size_t len = (size_t)rand() % sizeof(bytes);
+    if (len > text->len) {
+      len = text->len;
+    }
+    if (q % 2 == 0 && text->len > 0) {
+      memcpy(bytes, text->data + (size_t)rand() % (text->len - len + 1), len);
+    } else {
+      for (size_t i = 0; i < len; i++) {
+        bytes[i] = (uint8_t)(rand() % alphabet);
+      }
+    }
+    string_t pattern = {len, bytes};
+    size_t expected = naive_count(text, &pattern);
+    if (fm_index_count(index, &pattern) != expected) {
+      return false;
+    }
+    size_t count;
+    size_t *positions = fm_index_locate(index, &pattern, &count);
+    qsort(positions, count, sizeof(size_t), compare_positions);
+    bool correct = count == expected;
+    for (size_t i = 0; correct && i < count; i++) {
+      correct = positions[i] + len <= text->len &&
+                memcmp(text->data + positions[i], bytes, len) == 0 &&
+                (i == 0 || positions[i] > positions[i - 1]);
+    }
+    free(positions);
+    if (!correct) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static char *queries_match_naive_search() {
+  srand(35);
+  // Include zero bytes, which share their slot with the primary row.
+  const int alphabets[] = {1, 2, 4, 256};
+  for (size_t t = 0; t < 40; t++) {
+    int alphabet = alphabets[t % 4];
+    size_t len = t < 4 ? t : (size_t)rand() % (t % 5 == 0 ? 70000 : 3000);
+    string_t *text = new_string(len);
+    for (size_t i = 0; i < len; i++) {
+      text->data[i] = (uint8_t)(rand() % alphabet);
+    }
+    fm_index_t *index = new_fm_index(text, 1 + t % 9);
+    mu_assert("Wrong length.", fm_index_length(index) == len);
+    mu_assert("Queries differ from a naive search.",
+              answers_queries(index, text, alphabet));
+    free_fm_index(index);
+    free_string(text);
+  }
+  return NULL;
+}
+
+static char *index_survives_a_round_trip() {
+  const char *filename = "fm_index_test.tmp";
+  string_t *text = convert_string("she sells sea shells by the sea shore");
+  fm_index_t *index = new_fm_index(text, 0);
+  mu_assert("Index could not be saved.", save_fm_index(index, filename));
+  free_fm_index(index);
+
+  fm_index_t *loaded = load_fm_index(filename);
+  mu_assert("Index could not be loaded.", loaded != NULL);
+  string_t *sea = convert_string("sea");
+  string_t *sh = convert_string("sh");
+  mu_assert("Loaded index counts wrongly.", fm_index_count(loaded, sea) == 2);
+  size_t count;
+  size_t *positions = fm_index_locate(loaded, sh, &count);
+  qsort(positions, count, sizeof(size_t), compare_positions);
+  mu_assert("Loaded index locates wrongly.",
+            count == 3 && positions[0] == 0 && positions[1] == 14 &&
+                positions[2] == 32);
+  free(positions);
+  free_fm_index(loaded);
+
+  FILE *file = fopen(filename, "wb");
+  fputs("not an index", file);
+  fclose(file);
+  mu_assert("Invalid file accepted.", load_fm_index(filename) == NULL);
+  remove(filename);
+  mu_assert("Missing file accepted.", load_fm_index(filename) == NULL);
+
+  free_string(text);
+  free_string(sea);
+  free_string(sh);
+  return NULL;
+}
+
+char *test_fm_index() {
+  mu_run_test(queries_match_naive_search);
+  mu_run_test(index_survives_a_round_trip);
+  return NULL;
+}
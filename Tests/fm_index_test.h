@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_FM_INDEX_TEST_H
+#define C_PROGRAMS_FM_INDEX_TEST_H
+
+char *test_fm_index();
+
+#endif // C_PROGRAMS_FM_INDEX_TEST_H
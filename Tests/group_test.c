@@ -0,0 +1,184 @@
+#include "group_test.h"
+#include "../StdLib/Data/csv.h"
+#include "../StdLib/Data/group.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool value_is(const dataset_t *dataset, size_t row, size_t col,
+                     const char *text) {
+  const string_t *value = dataset_value(dataset, row, col);
+  return value && value->len == strlen(text) &&
+         memcmp(value->data, text, value->len) == 0;
+}
+
+static bool row_is(const dataset_t *dataset, size_t row,
+                   const char *const *texts) {
+  for (size_t col = 0; col < dataset->cols; col++) {
+    if (!value_is(dataset, row, col, texts[col])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool header_is(const dataset_t *dataset, const char *const *names) {
+  for (size_t col = 0; col < dataset->cols; col++) {
+    const string_t *name = dataset_column_name(dataset, col);
+    if (!name || name->len != strlen(names[col]) ||
+        memcmp(name->data, names[col], name->len) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static dataset_t *sales(void) {
+  const char *text = "city,item,price\noslo,pen,3\nrome,cup,10\noslo,ink,\n"
+                     "rome,cup,x\noslo,pen,5.5\nparis,pen,-2\nrome\n";
+  string_cache_t *cache = parse_csv((const uint8_t *)text, strlen(text), NULL);
+  dataset_t *dataset = new_dataset(cache);
+  free_cache(cache);
+  return dataset;
+}
+
+static const aggregate_t ALL_AGGREGATES[] = {
+    {AGGREGATE_COUNT, 0}, {AGGREGATE_SUM, 2},  {AGGREGATE_MIN, 2},
+    {AGGREGATE_MAX, 2},   {AGGREGATE_MEAN, 2}, {AGGREGATE_COUNT_DISTINCT, 1}};
+
+static char *groups_aggregate_values() {
+  dataset_t *dataset = sales();
+  const size_t by_city[] = {0};
+  dataset_t *groups = group_dataset(dataset, by_city, 1, ALL_AGGREGATES, 6, 1);
+  const char *names[] = {"city",       "count",      "sum(price)",
+                         "min(price)", "max(price)", "mean(price)",
+                         "count_distinct(item)"};
+  mu_assert("Groups have the wrong shape.",
+            groups->rows == 3 && groups->cols == 7);
+  mu_assert("Group columns are misnamed.", header_is(groups, names));
+  const char *oslo[] = {"oslo", "3", "8.5", "3", "5.5", "4.25", "2"};
+  const char *rome[] = {"rome", "3", "10", "10", "10", "10", "1"};
+  const char *paris[] = {"paris", "1", "-2", "-2", "-2", "-2", "1"};
+  mu_assert("Groups are not in order of appearance.",
+            row_is(groups, 0, oslo) && row_is(groups, 1, rome) &&
+                row_is(groups, 2, paris));
+  free_dataset(groups);
+
+  // Missing values group with empty ones.
+  const size_t by_city_and_item[] = {0, 1};
+  const aggregate_t min_price[] = {{AGGREGATE_COUNT, 0}, {AGGREGATE_MIN, 2}};
+  groups = group_dataset(dataset, by_city_and_item, 2, min_price, 2, 1);
+  const char *pairs[][4] = {{"oslo", "pen", "2", "3"},
+                            {"rome", "cup", "2", "10"},
+                            {"oslo", "ink", "1", ""},
+                            {"paris", "pen", "1", "-2"},
+                            {"rome", "", "1", ""}};
+  mu_assert("Wrong number of groups on two keys.", groups->rows == 5);
+  for (size_t row = 0; row < 5; row++) {
+    mu_assert("Group on two keys is wrong.", row_is(groups, row, pairs[row]));
+  }
+  free_dataset(groups);
+
+  // Without keys there is always exactly one group.
+  groups = group_dataset(dataset, NULL, 0, ALL_AGGREGATES, 6, 1);
+  const char *everything[] = {"7", "16.5", "-2", "10", "4.125", "3"};
+  mu_assert("Grouping without keys is wrong.",
+            groups->rows == 1 && row_is(groups, 0, everything));
+  free_dataset(groups);
+  dataset_t *none = slice_rows(dataset, 0, 0);
+  groups = group_dataset(none, NULL, 0, ALL_AGGREGATES, 6, 1);
+  const char *nothing[] = {"0", "0", "", "", "", "0"};
+  mu_assert("Grouping no rows without keys is wrong.",
+            groups->rows == 1 && row_is(groups, 0, nothing));
+  free_dataset(groups);
+  groups = group_dataset(none, by_city, 1, ALL_AGGREGATES, 6, 1);
+  mu_assert("Grouping no rows made groups.", groups->rows == 0);
+  free_dataset(groups);
+  free_dataset(none);
+  free_dataset(dataset);
+  return NULL;
+}
+
+// Every value of two datasets, and their names, are equal.
+static bool same_dataset(const dataset_t *left, const dataset_t *right) {
+  if (left->rows != right->rows || left->cols != right->cols) {
+    return false;
+  }
+  for (size_t col = 0; col < left->cols; col++) {
+    if (string_cmp(dataset_column_name(left, col),
+                   dataset_column_name(right, col)) != 0) {
+      return false;
+    }
+    for (size_t row = 0; row < left->rows; row++) {
+      if (string_cmp(dataset_value(left, row, col),
+                     dataset_value(right, row, col)) != 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static char *threads_agree() {
+  const size_t rows = 4 * GROUP_PARALLEL_ROWS + 1234;
+  string_t *text = new_string(rows * 24 + 32);
+  char *out = (char *)text->data;
+  size_t len = (size_t)sprintf(out, "key,value,name\n");
+  for (size_t i = 0; i < rows; i++) {
+    len += (size_t)sprintf(out + len, "k%zu,%zu,n%zu\n", i * 7 % 1000, i % 13,
+                           i % 37);
+  }
+  text->len = len;
+  string_cache_t *cache = parse_csv(text->data, text->len, NULL);
+  dataset_t *dataset = new_dataset(cache);
+  free_cache(cache);
+  free_string(text);
+
+  const size_t keys[] = {0};
+  const aggregate_t aggregates[] = {{AGGREGATE_COUNT, 0},
+                                    {AGGREGATE_SUM, 1},
+                                    {AGGREGATE_MIN, 1},
+                                    {AGGREGATE_MAX, 1},
+                                    {AGGREGATE_COUNT_DISTINCT, 2}};
+  dataset_t *expected = group_dataset(dataset, keys, 1, aggregates, 5, 1);
+  mu_assert("Wrong number of groups.", expected->rows == 1000);
+  mu_assert("First group is not the key of the first row.",
+            value_is(expected, 0, 0, "k0") && value_is(expected, 1, 0, "k7"));
+
+  // The rows of key k0 are the multiples of 1000.
+  bool names[37] = {false};
+  size_t count = 0, sum = 0, distinct = 0;
+  for (size_t i = 0; i < rows; i += 1000) {
+    count++;
+    sum += i % 13;
+    distinct += !names[i % 37];
+    names[i % 37] = true;
+  }
+  char expected_count[32], expected_sum[32], expected_distinct[32];
+  sprintf(expected_count, "%zu", count);
+  sprintf(expected_sum, "%zu", sum);
+  sprintf(expected_distinct, "%zu", distinct);
+  mu_assert("Aggregates of a group are wrong.",
+            value_is(expected, 0, 1, expected_count) &&
+                value_is(expected, 0, 2, expected_sum) &&
+                value_is(expected, 0, 3, "0") &&
+                value_is(expected, 0, 4, "12") &&
+                value_is(expected, 0, 5, expected_distinct));
+
+  for (size_t threads = 2; threads <= 5; threads++) {
+    dataset_t *groups = group_dataset(dataset, keys, 1, aggregates, 5, threads);
+    mu_assert("Threads disagree.", same_dataset(expected, groups));
+    free_dataset(groups);
+  }
+  free_dataset(expected);
+  free_dataset(dataset);
+  return NULL;
+}
+
+char *test_group() {
+  mu_run_test(groups_aggregate_values);
+  mu_run_test(threads_agree);
+  return NULL;
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_GROUP_TEST_H
+#define C_PROGRAMS_GROUP_TEST_H
+
+char *test_group();
+
+#endif // C_PROGRAMS_GROUP_TEST_H
@@ -0,0 +1,106 @@
+#include "intern_test.h"
+#include "../StdLib/String/intern.h"
+#include "test.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+static char *interned_strings_are_canonical() {
+  intern_pool_t *pool = new_intern_pool();
+  string_t *a = convert_string("category");
+  string_t *b = convert_string("category");
+  string_t *c = convert_string("other");
+
+  const string_t *ia = intern_string(pool, a);
+  const string_t *ib = intern_string(pool, b);
+  const string_t *ic = intern_string(pool, c);
+
+  mu_assert("Equal strings were interned to different pointers.", ia == ib);
+  mu_assert("Different strings were interned to the same pointer.", ia != ic);
+  mu_assert("Interned contents differ.", string_cmp(ia, a) == 0);
+  mu_assert("The pool should contain two strings.",
+            intern_pool_size(pool) == 2);
+  mu_assert("Lookup did not find the interned string.",
+            find_interned(pool, b) == ia);
+
+  string_t *missing = convert_string("missing");
+  mu_assert("Lookup found a string that was never interned.",
+            find_interned(pool, missing) == NULL);
+
+  free_string(a);
+  free_string(b);
+  free_string(c);
+  free_string(missing);
+  free_intern_pool(pool);
+  return NULL;
+}
+
+static char *pool_survives_growth() {
+  intern_pool_t *pool = new_intern_pool();
+  const string_t *first[1000];
+  char buffer[32];
+
+  for (size_t i = 0; i < 1000; i++) {
+    int len = snprintf(buffer, sizeof(buffer), "value-%zu", i);
+    first[i] = intern_bytes(pool, (const uint8_t *)buffer, (size_t)len);
+  }
+  mu_assert("The pool lost entries while growing.",
+            intern_pool_size(pool) == 1000);
+
+  for (size_t i = 0; i < 1000; i++) {
+    int len = snprintf(buffer, sizeof(buffer), "value-%zu", i);
+    mu_assert("Re-interning returned a different pointer.",
+              intern_bytes(pool, (const uint8_t *)buffer, (size_t)len) ==
+                  first[i]);
+  }
+  mu_assert("The empty string was not interned.",
+            intern_bytes(pool, NULL, 0)->len == 0);
+
+  free_intern_pool(pool);
+  return NULL;
+}
+
+static intern_pool_t *shared_pool;
+static const string_t *thread_results[4][256];
+
+static void *intern_worker(void *arg) {
+  size_t id = (size_t)arg;
+  char buffer[32];
+  for (size_t i = 0; i < 256; i++) {
+    int len = snprintf(buffer, sizeof(buffer), "key-%zu", i);
+    thread_results[id][i] =
+        intern_bytes(shared_pool, (const uint8_t *)buffer, (size_t)len);
+  }
+  return NULL;
+}
+
+static char *concurrent_pool_agrees_across_threads() {
+  shared_pool = new_concurrent_intern_pool(8);
+  pthread_t threads[4];
+  for (size_t i = 0; i < 4; i++) {
+    pthread_create(&threads[i], NULL, intern_worker, (void *)i);
+  }
+  for (size_t i = 0; i < 4; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  mu_assert("Concurrent pool has the wrong number of strings.",
+            intern_pool_size(shared_pool) == 256);
+  for (size_t i = 0; i < 256; i++) {
+    for (size_t t = 1; t < 4; t++) {
+      mu_assert("Threads received different canonical strings.",
+                thread_results[t][i] == thread_results[0][i]);
+    }
+  }
+
+  free_intern_pool(shared_pool);
+  return NULL;
+}
+
+char *test_intern() {
+  mu_run_test(interned_strings_are_canonical);
+  mu_run_test(pool_survives_growth);
+  mu_run_test(concurrent_pool_agrees_across_threads);
+  return NULL;
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_INTERN_TEST_H
+#define C_PROGRAMS_INTERN_TEST_H
+
+char *test_intern();
+
+#endif // C_PROGRAMS_INTERN_TEST_H
@@ -0,0 +1,125 @@
+#include "matcher_test.h"
+#include "../StdLib/String/matcher.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static bool matches(matcher_t *matcher, const char *text) {
+  string_t string = {strlen(text), (uint8_t *)text};
+  return matcher_matches(matcher, &string);
+}
+
+typedef struct example {
+  const char *pattern;
+  const char *text;
+  bool expected;
+} example_t;
+
+static char *regexes_match() {
+  const example_t examples[] = {
+      {"abc", "xxabcxx", true},
+      {"abc", "ab", false},
+      {"^abc$", "abc", true},
+      {"^abc$", "abcd", false},
+      {"a.c", "a-c", true},
+      {"colou?r", "color", true},
+      {"colou?r", "colouur", false},
+      {"ab*c", "ac", true},
+      {"ab+c", "ac", false},
+      {"(cat|dog)s", "hotdogs", true},
+      {"(?:cat|dog)s", "cows", false},
+      {"^[a-z_][a-z0-9_]*$", "snake_case_1", true},
+      {"^[a-z_][a-z0-9_]*$", "1abc", false},
+      {"[^0-9]", "12345", false},
+      {"^\\d{3}-\\d{4}$", "555-1234", true},
+      {"^\\d{3}-\\d{4}$", "555-12345", false},
+      {"^a{2,3}$", "aaa", true},
+      {"^a{2,3}$", "aaaa", false},
+      {"^a{2,}$", "aaaaaaa", true},
+      {"\\w+@\\w+\\.com", "mail me at joe@example.com", true},
+      {"\\s", "nospace", false},
+      {"\\.csv$", "data.csv", true},
+      {"\\.csv$", "data.csv.gz", false},
+      {"\\x41", "A", true},
+      {"[]a]", "]", true},
+      {"[a-]", "-", true},
+      {"a$|^b", "ba", true},
+      {"a$b", "ab", false},
+      {"", "anything", true},
+      {"x*", "", true},
+      {"^$", "", true},
+      {"^$", "a", false},
+  };
+  for (size_t i = 0; i < sizeof(examples) / sizeof(examples[0]); i++) {
+    matcher_t *matcher = compile_regex(examples[i].pattern);
+    mu_assert("Valid regex rejected.", matcher != NULL);
+    mu_assert("Regex gave the wrong answer.",
+              matches(matcher, examples[i].text) == examples[i].expected);
+    // A second run uses the cached states.
+    mu_assert("Cached regex gave the wrong answer.",
+              matches(matcher, examples[i].text) == examples[i].expected);
+    free_matcher(matcher);
+  }
+
+  const char *invalid[] = {"(",  "a)",   "[a",     "*a",    "a{2,1}",
+                           "a{", "\\q", "a{1001}", "(?x)", "a||b)"};
+  for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    mu_assert("Invalid regex accepted.", compile_regex(invalid[i]) == NULL);
+  }
+  return NULL;
+}
+
+static char *globs_match() {
+  const example_t examples[] = {
+      {"*.csv", "data.csv", true},
+      {"*.csv", "data.csv.bak", false},
+      {"data-??.txt", "data-01.txt", true},
+      {"data-??.txt", "data-1.txt", false},
+      {"[a-c]*", "banana", true},
+      {"[!a-c]*", "banana", false},
+      {"\\*", "*", true},
+      {"\\*", "a", false},
+      {"*", "", true},
+      {"a*b*c", "a/b/c", true},
+  };
+  for (size_t i = 0; i < sizeof(examples) / sizeof(examples[0]); i++) {
+    matcher_t *matcher = compile_glob(examples[i].pattern);
+    mu_assert("Valid glob rejected.", matcher != NULL);
+    mu_assert("Glob gave the wrong answer.",
+              matches(matcher, examples[i].text) == examples[i].expected);
+    free_matcher(matcher);
+  }
+  mu_assert("Invalid glob accepted.", compile_glob("[ab") == NULL);
+  return NULL;
+}
+
+static char *large_dfas_are_rebuilt() {
+  // The DFA of this pattern has 2^14 states, more than the cache holds.
+  matcher_t *matcher = compile_regex("a[ab]{13}$");
+  enum { LEN = 100000 };
+  char *text = malloc(LEN + 1);
+  srand(36);
+  for (size_t i = 0; i < LEN; i++) {
+    text[i] = rand() % 2 ? 'a' : 'b';
+  }
+  text[LEN] = '\0';
+  for (size_t round = 0; round < 20; round++) {
+    size_t position = LEN - 14 - (size_t)rand() % 100;
+    string_t string = {position + 14, (uint8_t *)text};
+    mu_assert("Wrong answer after rebuilding the cache.",
+              matcher_matches(matcher, &string) == (text[position] == 'a'));
+  }
+  mu_assert("Cache exceeded its limit.",
+            matcher->state_count <= MATCHER_MAX_STATES);
+  free(text);
+  free_matcher(matcher);
+  return NULL;
+}
+
+char *test_matcher() {
+  mu_run_test(regexes_match);
+  mu_run_test(globs_match);
+  mu_run_test(large_dfas_are_rebuilt);
+  return NULL;
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_MATCHER_TEST_H
+#define C_PROGRAMS_MATCHER_TEST_H
+
+char *test_matcher();
+
+#endif // C_PROGRAMS_MATCHER_TEST_H
@@ -0,0 +1,181 @@
+#include "number_test.h"
+#include "../StdLib/String/number.h"
+#include "test.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static string_t view(const char *text) {
+  string_t string = {strlen(text), (uint8_t *)text};
+  return string;
+}
+
+static bool parses_to_int(const char *text, int64_t expected) {
+  string_t string = view(text);
+  int64_t value;
+  return string_to_int64(&string, &value) && value == expected;
+}
+
+static bool rejects_int(const char *text) {
+  string_t string = view(text);
+  int64_t value;
+  return !string_to_int64(&string, &value);
+}
+
+static bool parses_like_strtod(const char *text) {
+  string_t string = view(text);
+  double value;
+  double expected = strtod(text, NULL);
+  return string_to_double(&string, &value) &&
+         memcmp(&value, &expected, sizeof(double)) == 0;
+}
+
+static bool formats_as(double value, const char *expected) {
+  uint8_t buffer[NUMBER_BUFFER_SIZE];
+  size_t len = format_double(value, buffer);
+  return len == strlen(expected) && memcmp(buffer, expected, len) == 0;
+}
+
+static char *integers_are_parsed() {
+  mu_assert("Simple integer not parsed.", parses_to_int("42", 42));
+  mu_assert("Signed integer not parsed.", parses_to_int("-17", -17));
+  mu_assert("Plus sign not accepted.", parses_to_int("+8", 8));
+  mu_assert("Leading zeros not skipped.",
+            parses_to_int("0000000000000000000000123", 123));
+  mu_assert("Long integer not parsed.",
+            parses_to_int("1234567890123456", 1234567890123456LL));
+  mu_assert("Maximum not parsed.",
+            parses_to_int("9223372036854775807", INT64_MAX));
+  mu_assert("Minimum not parsed.",
+            parses_to_int("-9223372036854775808", INT64_MIN));
+
+  mu_assert("Overflow accepted.", rejects_int("9223372036854775808"));
+  mu_assert("Underflow accepted.", rejects_int("-9223372036854775809"));
+  mu_assert("Twenty digits accepted.", rejects_int("12345678901234567890"));
+  mu_assert("Empty string accepted.", rejects_int(""));
+  mu_assert("Lone sign accepted.", rejects_int("-"));
+  mu_assert("Trailing bytes accepted.", rejects_int("12345678x"));
+  mu_assert("Whitespace accepted.", rejects_int(" 1"));
+  return NULL;
+}
+
+static char *doubles_are_parsed() {
+  const char *valid[] = {"0",
+                         "-0",
+                         "3.25",
+                         ".5",
+                         "5.",
+                         "0.1",
+                         "6.02e23",
+                         "1E-7",
+                         "9007199254740993",
+                         "2.2250738585072014e-308",
+                         "4.9e-324",
+                         "2.4703282292062328e-324",
+                         "1.7976931348623157e308",
+                         "1e400",
+                         "1e-400",
+                         "0.000000000000000000000000000001234",
+                         "123456789012345678901234567890.5"};
+  for (size_t i = 0; i < sizeof(valid) / sizeof(valid[0]); i++) {
+    mu_assert("Double differs from strtod.", parses_like_strtod(valid[i]));
+  }
+
+  const char *invalid[] = {"", "+", ".", "e5", "1e", "1e+", "1.2.3",
+                           "1 ", "0x10", "1,5", "infinit"};
+  for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+    string_t string = view(invalid[i]);
+    double value;
+    mu_assert("Invalid double accepted.", !string_to_double(&string, &value));
+  }
+
+  string_t string = view("-Infinity");
+  double value;
+  mu_assert("Infinity not parsed.",
+            string_to_double(&string, &value) && isinf(value) && value < 0);
+  string = view("NaN");
+  mu_assert("NaN not parsed.",
+            string_to_double(&string, &value) && isnan(value));
+  return NULL;
+}
+
+static char *random_doubles_round_trip() {
+  uint64_t state = 0x9e3779b97f4a7c15ULL;
+  char text[NUMBER_BUFFER_SIZE + 1];
+  for (size_t i = 0; i < 100000; i++) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    double value;
+    memcpy(&value, &state, sizeof(value));
+    if (!isfinite(value)) {
+      continue;
+    }
+    size_t len = format_double(value, (uint8_t *)text);
+    text[len] = '\0';
+    double back = strtod(text, NULL);
+    mu_assert("Formatted double does not round trip.",
+              memcmp(&back, &value, sizeof(value)) == 0);
+    mu_assert("Formatted double is parsed differently than strtod.",
+              parses_like_strtod(text));
+
+    // Digits printed with printf must parse like strtod parses them.
+    snprintf(text, sizeof(text), "%.*g", (int)(state % 17) + 1, value);
+    mu_assert("Printed double is parsed differently than strtod.",
+              parses_like_strtod(text));
+  }
+  return NULL;
+}
+
+static char *doubles_are_formatted() {
+  mu_assert("Zero formatted wrongly.", formats_as(0.0, "0"));
+  mu_assert("Negative zero formatted wrongly.", formats_as(-0.0, "-0"));
+  mu_assert("Integer formatted wrongly.", formats_as(1500, "1500"));
+  mu_assert("Fraction formatted wrongly.", formats_as(-3.25, "-3.25"));
+  mu_assert("Output is not the shortest.",
+            formats_as(0.1 + 0.2, "0.30000000000000004"));
+  mu_assert("Small number formatted wrongly.", formats_as(0.000001, "0.000001"));
+  mu_assert("Tiny number formatted wrongly.", formats_as(2.5e-7, "2.5e-7"));
+  mu_assert("Large integer formatted wrongly.",
+            formats_as(1e20, "100000000000000000000"));
+  mu_assert("Huge number formatted wrongly.", formats_as(1e21, "1e+21"));
+  mu_assert("Maximum formatted wrongly.",
+            formats_as(1.7976931348623157e308, "1.7976931348623157e+308"));
+  mu_assert("Denormal formatted wrongly.", formats_as(5e-324, "5e-324"));
+  mu_assert("Infinity formatted wrongly.", formats_as(-INFINITY, "-inf"));
+  mu_assert("NaN formatted wrongly.", formats_as(NAN, "nan"));
+  return NULL;
+}
+
+static char *integers_are_formatted() {
+  const int64_t values[] = {0, 7, -7, 10, 99, 100, 1234567890,
+                            INT64_MAX, INT64_MIN};
+  const char *expected[] = {"0",          "7",
+                            "-7",         "10",
+                            "99",         "100",
+                            "1234567890", "9223372036854775807",
+                            "-9223372036854775808"};
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    string_t *string = int64_to_string(values[i]);
+    string_t wanted = view(expected[i]);
+    mu_assert("Integer formatted wrongly.", string_equals(string, &wanted));
+    free_string(string);
+  }
+
+  string_t *string = double_to_string(6.02e23);
+  string_t wanted = view("6.02e+23");
+  mu_assert("Double converted wrongly.", string_equals(string, &wanted));
+  free_string(string);
+  return NULL;
+}
+
+char *test_number() {
+  mu_run_test(integers_are_parsed);
+  mu_run_test(doubles_are_parsed);
+  mu_run_test(random_doubles_round_trip);
+  mu_run_test(doubles_are_formatted);
+  mu_run_test(integers_are_formatted);
+  return NULL;
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_NUMBER_TEST_H
+#define C_PROGRAMS_NUMBER_TEST_H
+
+char *test_number();
+
+#endif // C_PROGRAMS_NUMBER_TEST_H
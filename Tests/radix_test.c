@@ -0,0 +1,181 @@
+#include "radix_test.h"
+#include "../StdLib/String/radix.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const size_t KEYS = 3000;
+
+static string_t view(const char *text) {
+  string_t string = {strlen(text), (uint8_t *)text};
+  return string;
+}
+
+static int compare_strings(const void *left, const void *right) {
+  return string_cmp(*(string_t *const *)left, *(string_t *const *)right);
+}
+
+/**
+ * Random keys over a small alphabet, so that they share long prefixes and
+ * many are prefixes of others, plus keys that make nodes of every size.
+ * The returned array is sorted and free of duplicates.
+ */
+static string_t **make_keys(size_t *count) {
+  string_t **keys = malloc((KEYS + 306) * sizeof(string_t *));
+  srand(11);
+  size_t used = 0;
+  for (size_t i = 0; i < KEYS; i++) {
+    keys[used] = new_string((size_t)rand() % 12);
+    for (size_t j = 0; j < keys[used]->len; j++) {
+      keys[used]->data[j] = (uint8_t)("abcd"[rand() % 4]);
+    }
+    used++;
+  }
+  // Nodes with 256, up to 48 and up to 16 children.
+  const char *stems[] = {"ab", "ba", "cc"};
+  const size_t fanouts[] = {256, 40, 10};
+  for (size_t stem = 0; stem < 3; stem++) {
+    for (size_t byte = 0; byte < fanouts[stem]; byte++) {
+      keys[used] = new_string(3);
+      memcpy(keys[used]->data, stems[stem], 2);
+      keys[used++]->data[2] = (uint8_t)byte;
+    }
+  }
+  qsort(keys, used, sizeof(string_t *), compare_strings);
+  size_t unique = 0;
+  for (size_t i = 0; i < used; i++) {
+    if (unique > 0 && string_equals(keys[unique - 1], keys[i])) {
+      free_string(keys[i]);
+    } else {
+      keys[unique++] = keys[i];
+    }
+  }
+  *count = unique;
+  return keys;
+}
+
+static void free_keys(string_t **keys, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    free_string(keys[i]);
+  }
+  free(keys);
+}
+
+static bool starts_with(const string_t *string, const string_t *prefix) {
+  return string->len >= prefix->len &&
+         memcmp(string->data, prefix->data, prefix->len) == 0;
+}
+
+typedef struct collected {
+  const string_t **keys;
+  size_t count;
+  size_t limit;
+} collected_t;
+
+static bool collect(const radix_entry_t *entry, void *context) {
+  collected_t *collected = context;
+  collected->keys[collected->count++] = &entry->key;
+  return collected->count < collected->limit;
+}
+
+static char *insert_and_find() {
+  size_t count;
+  string_t **keys = make_keys(&count);
+  radix_tree_t *tree = new_radix_tree();
+  for (size_t i = count; i-- > 0;) {
+    radix_insert(tree, keys[i], (void *)(i + 1));
+  }
+  mu_assert("Wrong number of entries.", tree->count == count);
+  mu_assert("Nodes of every size expected.",
+            tree->nodes[0] && tree->nodes[1] && tree->nodes[2] &&
+                tree->nodes[3]);
+  for (size_t i = 0; i < count; i++) {
+    const radix_entry_t *entry = radix_find(tree, keys[i]);
+    mu_assert("Inserted key not found.",
+              entry && entry->value == (void *)(i + 1) &&
+                  string_equals(&entry->key, keys[i]));
+  }
+  string_t missing = view("abcdabcdabcdabcd");
+  mu_assert("Missing key found.", !radix_find(tree, &missing));
+  missing = view("ab");
+  missing.len = 1;
+  const radix_entry_t *entry = radix_find(tree, &missing);
+  mu_assert("Short key lookup is wrong.",
+            !entry == !bsearch(&(string_t *){&missing}, keys, count,
+                                sizeof(string_t *), compare_strings));
+
+  size_t memory = tree->memory;
+  radix_insert(tree, keys[0], NULL);
+  mu_assert("Replacing a value added an entry.",
+            tree->count == count && tree->memory == memory);
+  mu_assert("Value was not replaced.", radix_find(tree, keys[0])->value == NULL);
+  free_radix_tree(tree);
+  free_keys(keys, count);
+  return NULL;
+}
+
+static char *longest_prefix_matches_scan() {
+  size_t count;
+  string_t **keys = make_keys(&count);
+  radix_tree_t *tree = new_radix_tree();
+  for (size_t i = 0; i < count; i += 2) {
+    radix_insert(tree, keys[i], NULL);
+  }
+  for (size_t i = 0; i < count; i++) {
+    const string_t *best = NULL;
+    for (size_t j = 0; j < count; j += 2) {
+      if (starts_with(keys[i], keys[j]) &&
+          (!best || keys[j]->len > best->len)) {
+        best = keys[j];
+      }
+    }
+    const radix_entry_t *entry = radix_longest_prefix(tree, keys[i]);
+    mu_assert("Longest prefix differs from a scan.",
+              best ? entry && string_equals(&entry->key, best) : !entry);
+  }
+  free_radix_tree(tree);
+  free_keys(keys, count);
+  return NULL;
+}
+
+static char *prefix_visit_is_sorted() {
+  size_t count;
+  string_t **keys = make_keys(&count);
+  radix_tree_t *tree = new_radix_tree();
+  for (size_t i = 0; i < count; i++) {
+    radix_insert(tree, keys[(i * 7919) % count], NULL);
+  }
+  const string_t **found = malloc(count * sizeof(string_t *));
+  const char *prefixes[] = {"", "a", "ab", "abc", "dcba", "ba", "abx", "e"};
+  for (size_t p = 0; p < sizeof(prefixes) / sizeof(prefixes[0]); p++) {
+    string_t prefix = view(prefixes[p]);
+    collected_t collected = {found, 0, count + 1};
+    size_t visited = radix_visit_prefix(tree, &prefix, collect, &collected);
+    size_t expected = 0;
+    for (size_t i = 0; i < count; i++) {
+      if (starts_with(keys[i], &prefix)) {
+        mu_assert("Visit missed a key or is out of order.",
+                  expected < visited &&
+                      string_equals(found[expected], keys[i]));
+        expected++;
+      }
+    }
+    mu_assert("Visit found extra keys.", expected == visited);
+  }
+  string_t prefix = view("a");
+  collected_t collected = {found, 0, 5};
+  mu_assert("Visit did not stop.",
+            radix_visit_prefix(tree, &prefix, collect, &collected) == 5);
+  free(found);
+  free_radix_tree(tree);
+  free_keys(keys, count);
+  return NULL;
+}
+
+char *test_radix() {
+  mu_run_test(insert_and_find);
+  mu_run_test(longest_prefix_matches_scan);
+  mu_run_test(prefix_visit_is_sorted);
+  return NULL;
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_RADIX_TEST_H
+#define C_PROGRAMS_RADIX_TEST_H
+
+char *test_radix();
+
+#endif // C_PROGRAMS_RADIX_TEST_H
@@ -0,0 +1,141 @@
+#include "replace_test.h"
+#include "../StdLib/String/replace.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static string_t view(const char *text) {
+  string_t string = {strlen(text), (uint8_t *)text};
+  return string;
+}
+
+static bool equals_text(const string_t *string, const char *text) {
+  return string->len == strlen(text) &&
+         memcmp(string->data, text, string->len) == 0;
+}
+
+static bool replaces_to(const char *text, const char *needle,
+                        const char *replacement, const char *expected) {
+  string_t source = view(text);
+  string_t wanted = view(needle);
+  string_t with = view(replacement);
+  string_t *result = string_replace_all(&source, &wanted, &with);
+  bool same = equals_text(result, expected);
+  free_string(result);
+  return same;
+}
+
+static char *find_all_is_left_to_right() {
+  string_t haystack = view("abcabcaaaaabc");
+  string_t needle = view("abc");
+  size_t count;
+  size_t *offsets = string_find_all(&haystack, &needle, &count);
+  mu_assert("Wrong number of occurrences.", count == 3);
+  mu_assert("Wrong offsets.",
+            offsets[0] == 0 && offsets[1] == 3 && offsets[2] == 10);
+  free(offsets);
+
+  needle = view("aa");
+  offsets = string_find_all(&haystack, &needle, &count);
+  mu_assert("Occurrences must not overlap.", count == 2);
+  mu_assert("Wrong offsets for overlapping needle.",
+            offsets[0] == 6 && offsets[1] == 8);
+  mu_assert("Count disagrees with find all.",
+            string_count(&haystack, &needle) == 2);
+  free(offsets);
+
+  needle = view("abcabcaaaaabcd");
+  offsets = string_find_all(&haystack, &needle, &count);
+  mu_assert("Needle longer than haystack found.", count == 0 && !offsets);
+  return NULL;
+}
+
+static char *replace_all_resizes() {
+  mu_assert("Same length replacement failed.",
+            replaces_to("a-b-c", "-", "+", "a+b+c"));
+  mu_assert("Growing replacement failed.",
+            replaces_to("a-b-c", "-", "<->", "a<->b<->c"));
+  mu_assert("Shrinking replacement failed.",
+            replaces_to("one, two, three", ", ", ",", "one,two,three"));
+  mu_assert("Deletion failed.", replaces_to("aaaaa", "aa", "", "a"));
+  mu_assert("Whole string not replaced.", replaces_to("abc", "abc", "x", "x"));
+  mu_assert("String without needle changed.",
+            replaces_to("abc", "d", "x", "abc"));
+  mu_assert("Empty string changed.", replaces_to("", "d", "x", ""));
+  return NULL;
+}
+
+/**
+ * Feeds the text to a stream replacer in chunks of random length and checks
+ * that the output is the one of string_replace_all.
+ */
+static bool streams_like_replace_all(const string_t *text,
+                                     const string_t *needle,
+                                     const string_t *replacement,
+                                     size_t max_chunk) {
+  char *buffer = NULL;
+  size_t size = 0;
+  FILE *stream = open_memstream(&buffer, &size);
+  string_writer_t *writer = new_stream_writer(stream, 16);
+  stream_replacer_t *replacer = new_stream_replacer(needle, replacement);
+  size_t index = 0;
+  while (index < text->len) {
+    string_t chunk = {(size_t)rand() % (max_chunk + 1), text->data + index};
+    if (chunk.len > text->len - index) {
+      chunk.len = text->len - index;
+    }
+    stream_replace(replacer, &chunk, writer);
+    index += chunk.len;
+  }
+  stream_replace_finish(replacer, writer);
+  writer_flush(writer);
+  fclose(stream);
+
+  size_t count;
+  size_t *offsets = string_find_all(text, needle, &count);
+  string_t *expected = string_replace_all(text, needle, replacement);
+  bool same = size == expected->len &&
+              memcmp(buffer, expected->data, size) == 0 &&
+              replacer->matches == count;
+  free(offsets);
+  free_string(expected);
+  free_stream_replacer(replacer);
+  free_writer(writer);
+  free(buffer);
+  return same;
+}
+
+static char *stream_handles_chunk_boundaries() {
+  static uint8_t text[4000];
+  srand(7);
+  for (size_t i = 0; i < sizeof(text); i++) {
+    text[i] = (uint8_t)('a' + rand() % 3);
+  }
+  string_t source = {sizeof(text), text};
+  const char *needles[] = {"a", "ab", "aab", "abcab", "aaaa", "cabacab"};
+  const char *replacements[] = {"", "X", "<match>"};
+  for (size_t n = 0; n < sizeof(needles) / sizeof(needles[0]); n++) {
+    for (size_t r = 0; r < 3; r++) {
+      string_t needle = view(needles[n]);
+      string_t replacement = view(replacements[r]);
+      for (size_t max_chunk = 1; max_chunk < 20; max_chunk += 3) {
+        mu_assert("Streamed output differs from replace all.",
+                  streams_like_replace_all(&source, &needle, &replacement,
+                                           max_chunk));
+      }
+      mu_assert("Streamed output with large chunks differs.",
+                streams_like_replace_all(&source, &needle, &replacement,
+                                         1000));
+    }
+  }
+  return NULL;
+}
+
+char *test_replace() {
+  mu_run_test(find_all_is_left_to_right);
+  mu_run_test(replace_all_resizes);
+  mu_run_test(stream_handles_chunk_boundaries);
+  return NULL;
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_REPLACE_TEST_H
+#define C_PROGRAMS_REPLACE_TEST_H
+
+char *test_replace();
+
+#endif // C_PROGRAMS_REPLACE_TEST_H
@@ -0,0 +1,167 @@
+#include "rope_test.h"
+#include "../StdLib/String/rope.h"
+#include "test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Checks the AVL invariant and the cached lengths of every node.
+ */
+static bool is_balanced(const rope_node_t *node) {
+  if (!node || node->buffer) {
+    return true;
+  }
+  int diff = node->left->height - node->right->height;
+  int tallest = node->left->height > node->right->height ? node->left->height
+                                                         : node->right->height;
+  return diff >= -1 && diff <= 1 && node->height == tallest + 1 &&
+         node->len == node->left->len + node->right->len &&
+         is_balanced(node->left) && is_balanced(node->right);
+}
+
+static bool rope_equals(const rope_t *rope, const uint8_t *expected,
+                        size_t len) {
+  string_t *flat = flatten_rope(rope);
+  bool same = flat->len == len && memcmp(flat->data, expected, len) == 0;
+  free_string(flat);
+  return same;
+}
+
+static char *basic_editing_works() {
+  string_t *hello = convert_string("Hello World");
+  string_t *comma = convert_string(",");
+  rope_t *rope = new_rope(hello);
+
+  rope_t *edited = insert_rope(rope, 5, comma);
+  mu_assert("Insertion failed.",
+            rope_equals(edited, (const uint8_t *)"Hello, World", 12));
+  mu_assert("The original rope was modified.",
+            rope_equals(rope, (const uint8_t *)"Hello World", 11));
+
+  rope_t *deleted = delete_rope(edited, 0, 7);
+  mu_assert("Deletion failed.", rope_equals(deleted, (const uint8_t *)"World", 5));
+  mu_assert("Wrong byte returned.", rope_byte_at(deleted, 1) == 'o');
+
+  rope_t *left, *right;
+  split_rope(edited, 6, &left, &right);
+  mu_assert("Split produced the wrong left half.",
+            rope_equals(left, (const uint8_t *)"Hello,", 6));
+  mu_assert("Split produced the wrong right half.",
+            rope_equals(right, (const uint8_t *)" World", 6));
+
+  rope_t *joined = concat_rope(right, left);
+  mu_assert("Concatenation failed.",
+            rope_equals(joined, (const uint8_t *)" WorldHello,", 12));
+
+  free_rope(rope);
+  free_rope(edited);
+  free_rope(deleted);
+  free_rope(left);
+  free_rope(right);
+  free_rope(joined);
+  free_string(hello);
+  free_string(comma);
+  return NULL;
+}
+
+static char *random_edits_match_model() {
+  // Mirror every edit on a flat buffer and compare after each step.
+  enum { CAPACITY = 1 << 16 };
+  uint8_t *model = malloc(CAPACITY);
+  uint8_t *scratch = malloc(CAPACITY);
+  size_t len = 0;
+  rope_t *rope = new_rope_owning(new_string(0));
+  srand(31);
+
+  for (size_t step = 0; step < 3000; step++) {
+    rope_t *next;
+    size_t a = len ? (size_t)rand() % (len + 1) : 0;
+    size_t b = len ? (size_t)rand() % (len + 1) : 0;
+    size_t start = a < b ? a : b, end = a < b ? b : a;
+    int operation = rand() % 4;
+    if (operation <= 1 || len < 64) {
+      // Mostly insertions, of both short and long strings.
+      size_t insert_len = (size_t)(rand() % 2 ? rand() % 8 : rand() % 400);
+      if (len + insert_len > CAPACITY) {
+        continue;
+      }
+      string_t *piece = new_string(insert_len);
+      for (size_t i = 0; i < insert_len; i++) {
+        piece->data[i] = (uint8_t)('a' + rand() % 26);
+      }
+      next = insert_rope(rope, start, piece);
+      memmove(model + start + insert_len, model + start, len - start);
+      memcpy(model + start, piece->data, insert_len);
+      len += insert_len;
+      free_string(piece);
+    } else if (operation == 2) {
+      next = delete_rope(rope, start, end);
+      memmove(model + start, model + end, len - end);
+      len -= end - start;
+    } else {
+      // Move a range to the front: split, then concatenate the pieces.
+      rope_t *middle = subrope(rope, start, end);
+      rope_t *rest = delete_rope(rope, start, end);
+      next = concat_rope(middle, rest);
+      memcpy(scratch, model + start, end - start);
+      memmove(model + (end - start), model, start);
+      memcpy(model, scratch, end - start);
+      free_rope(middle);
+      free_rope(rest);
+    }
+    free_rope(rope);
+    rope = next;
+    mu_assert("Rope length does not match the model.",
+              rope_length(rope) == len);
+    mu_assert("Rope is not balanced.", is_balanced(rope->root));
+    if (step % 50 == 0) {
+      mu_assert("Rope contents do not match the model.",
+                rope_equals(rope, model, len));
+    }
+  }
+  mu_assert("Rope contents do not match the model.",
+            rope_equals(rope, model, len));
+
+  free_rope(rope);
+  free(model);
+  free(scratch);
+  return NULL;
+}
+
+static char *leaves_can_be_printed() {
+  const char *filename = "rope_print_test.tmp";
+  string_t *first = convert_string("first part, ");
+  string_t *second = convert_string("second part");
+  rope_t *a = new_rope(first);
+  rope_t *b = new_rope(second);
+  rope_t *both = concat_rope(a, b);
+
+  FILE *tmp = fopen(filename, "w");
+  fprint_rope(both, tmp);
+  fclose(tmp);
+
+  char buffer[64] = {0};
+  tmp = fopen(filename, "r");
+  size_t read = fread(buffer, 1, sizeof(buffer) - 1, tmp);
+  fclose(tmp);
+  remove(filename);
+
+  mu_assert("Printed rope differs.",
+            read == 23 && strcmp(buffer, "first part, second part") == 0);
+
+  free_rope(a);
+  free_rope(b);
+  free_rope(both);
+  free_string(first);
+  free_string(second);
+  return NULL;
+}
+
+char *test_rope() {
+  mu_run_test(basic_editing_works);
+  mu_run_test(random_edits_match_model);
+  mu_run_test(leaves_can_be_printed);
+  return NULL;
+}
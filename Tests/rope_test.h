@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_ROPE_TEST_H
+#define C_PROGRAMS_ROPE_TEST_H
+
+char *test_rope();
+
+#endif // C_PROGRAMS_ROPE_TEST_H
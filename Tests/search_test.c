@@ -0,0 +1,120 @@
+#include "search_test.h"
+#include "../StdLib/String/search.h"
+#include "../StdLib/String/string.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static size_t naive_search(const uint8_t *haystack, size_t len,
+                           const uint8_t *needle, size_t needle_len) {
+  for (size_t i = 0; i + needle_len <= len; i++) {
+    if (memcmp(haystack + i, needle, needle_len) == 0) {
+      return i;
+    }
+  }
+  return len;
+}
+
+static char *byte_search_finds_first_match() {
+  uint8_t buffer[200];
+  memset(buffer, 'a', sizeof(buffer));
+  mu_assert("Found a byte that is not there.",
+            search_byte(buffer, sizeof(buffer), 'b') == sizeof(buffer));
+  for (size_t i = 0; i < sizeof(buffer); i++) {
+    buffer[i] = 'b';
+    mu_assert("Byte search returned the wrong index.",
+              search_byte(buffer, sizeof(buffer), 'b') == i);
+    mu_assert("Byte search read past the end.",
+              search_byte(buffer, i, 'b') == i);
+    buffer[i] = 'a';
+  }
+  return NULL;
+}
+
+static char *byte_set_search_works() {
+  const char *members = " \t,;\x80\xff";
+  byte_set_t set = new_byte_set((const uint8_t *)members, strlen(members));
+  mu_assert("Byte set has the wrong size.", set.count == 6);
+  for (size_t byte = 0; byte < 256; byte++) {
+    bool expected = byte && strchr(members, (int)byte) != NULL;
+    mu_assert("Byte set membership is wrong.",
+              byte_set_contains(&set, (uint8_t)byte) == expected);
+  }
+
+  uint8_t buffer[100];
+  memset(buffer, 'x', sizeof(buffer));
+  for (size_t i = 0; i < sizeof(buffer); i++) {
+    for (size_t m = 0; m < set.count; m++) {
+      buffer[i] = (uint8_t)members[m];
+      mu_assert("Byte set search returned the wrong index.",
+                search_byte_set(buffer, sizeof(buffer), &set) == i);
+    }
+    buffer[i] = 'x';
+  }
+
+  byte_set_t blank = new_byte_set((const uint8_t *)" \t", 2);
+  memset(buffer, ' ', sizeof(buffer));
+  mu_assert("Skipped past the end of the buffer.",
+            search_not_byte_set(buffer, sizeof(buffer), &blank) ==
+                sizeof(buffer));
+  for (size_t i = 0; i < sizeof(buffer); i++) {
+    buffer[i] = 'x';
+    mu_assert("Did not stop at the first non-member.",
+              search_not_byte_set(buffer, sizeof(buffer), &blank) == i);
+    buffer[i] = '\t';
+  }
+  return NULL;
+}
+
+static char *substring_search_matches_naive() {
+  uint8_t haystack[300];
+  srand(7);
+  for (size_t round = 0; round < 500; round++) {
+    // A small alphabet produces plenty of partial matches.
+    size_t len = (size_t)rand() % sizeof(haystack);
+    for (size_t i = 0; i < len; i++) {
+      haystack[i] = (uint8_t)('a' + rand() % 3);
+    }
+    for (size_t needle_len = 1; needle_len <= 12; needle_len++) {
+      uint8_t needle[12];
+      for (size_t i = 0; i < needle_len; i++) {
+        needle[i] = (uint8_t)('a' + rand() % 3);
+      }
+      mu_assert("Substring search disagrees with the naive search.",
+                search_bytes(haystack, len, needle, needle_len) ==
+                    naive_search(haystack, len, needle, needle_len));
+    }
+  }
+  return NULL;
+}
+
+static char *index_of_string_works() {
+  string_t *text = convert_string("the needle is somewhere in this haystack, "
+                                  "past all of the padding: needle!");
+  string_t *needle = convert_string("needle!");
+  string_t *missing = convert_string("pins");
+  string_t *empty = new_string(0);
+
+  mu_assert("Did not find the needle.", index_of_string(text, needle) == 67);
+  mu_assert("Found something that is not there.",
+            index_of_string(text, missing) > text->len);
+  mu_assert("The empty string should match at the start.",
+            index_of_string(text, empty) == 0);
+  mu_assert("A string should be found in itself.",
+            index_of_string(text, text) == 0);
+
+  free_string(text);
+  free_string(needle);
+  free_string(missing);
+  free_string(empty);
+  return NULL;
+}
+
+char *test_search() {
+  mu_run_test(byte_search_finds_first_match);
+  mu_run_test(byte_set_search_works);
+  mu_run_test(substring_search_matches_naive);
+  mu_run_test(index_of_string_works);
+  return NULL;
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_SEARCH_TEST_H
+#define C_PROGRAMS_SEARCH_TEST_H
+
+char *test_search();
+
+#endif // C_PROGRAMS_SEARCH_TEST_H
@@ -0,0 +1,121 @@
+#include "sort_test.h"
+#include "../StdLib/String/sort.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static int compare_pointers(const void *left, const void *right) {
+  return string_cmp(*(string_t *const *)left, *(string_t *const *)right);
+}
+
+/**
+ * Builds strings that share long prefixes and differ around the eight byte
+ * boundaries of the cached prefixes, including zero bytes, empty strings and
+ * strings that are prefixes of others.
+ */
+static string_t **random_strings(size_t count, string_t **values_out,
+                                 uint8_t **storage) {
+  const size_t max_len = 40;
+  *storage = malloc(count * max_len + 1);
+  string_t *values = malloc((count + 1) * sizeof(string_t));
+  string_t **strings = malloc((count + 1) * sizeof(string_t *));
+  *values_out = values;
+  for (size_t i = 0; i < count; i++) {
+    uint8_t *data = *storage + i * max_len;
+    size_t len = (size_t)rand() % max_len;
+    size_t shared = (size_t)rand() % (len + 1);
+    memset(data, 'x', shared);
+    for (size_t j = shared; j < len; j++) {
+      data[j] = (uint8_t)(rand() % 4 == 0 ? 0 : 'a' + rand() % 3);
+    }
+    values[i].len = len;
+    values[i].data = data;
+    strings[i] = &values[i];
+  }
+  return strings;
+}
+
+static char *strings_are_sorted() {
+  srand(36);
+  const size_t sizes[] = {0, 1, 2, 13, 63, 64, 500, 5000};
+  for (size_t s = 0; s < 8; s++) {
+    const size_t count = sizes[s];
+    uint8_t *storage;
+    string_t *values;
+    string_t **strings = random_strings(count, &values, &storage);
+    string_t **expected = malloc((count + 1) * sizeof(string_t *));
+    memcpy(expected, strings, count * sizeof(string_t *));
+    qsort(expected, count, sizeof(string_t *), compare_pointers);
+
+    sort_strings(strings, count, 1);
+    for (size_t i = 0; i < count; i++) {
+      mu_assert("Strings are not in order.",
+                string_cmp(strings[i], expected[i]) == 0);
+    }
+    free(expected);
+    free(strings);
+    free(values);
+    free(storage);
+  }
+  return NULL;
+}
+
+static char *equal_and_long_strings_are_sorted() {
+  // Long runs of the same byte exercise the loop over the largest bucket.
+  const size_t count = 3000;
+  uint8_t *storage = malloc(count);
+  memset(storage, 'q', count);
+  string_t *values = malloc(count * sizeof(string_t));
+  string_t **strings = malloc(count * sizeof(string_t *));
+  for (size_t i = 0; i < count; i++) {
+    values[i].len = (i * 7919) % count;
+    values[i].data = storage;
+    strings[i] = &values[i];
+  }
+  sort_strings(strings, count, 1);
+  for (size_t i = 0; i < count; i++) {
+    mu_assert("Prefixes are not in order.", strings[i]->len == i);
+  }
+  for (size_t i = 0; i < count; i++) {
+    values[i].len = 100;
+  }
+  sort_strings(strings, count, 1);
+  mu_assert("Equal strings are lost.", strings[count - 1]->len == 100);
+  free(strings);
+  free(values);
+  free(storage);
+  return NULL;
+}
+
+static char *threads_give_the_same_order() {
+  srand(360);
+  const size_t count = SORT_PARALLEL_THRESHOLD + 1000;
+  uint8_t *storage;
+  string_t *values;
+  string_t **strings = random_strings(count, &values, &storage);
+  string_t **parallel = malloc(count * sizeof(string_t *));
+  memcpy(parallel, strings, count * sizeof(string_t *));
+  sort_strings(strings, count, 1);
+  sort_strings(parallel, count, 4);
+  for (size_t i = 0; i < count; i++) {
+    mu_assert("Threads change the order.",
+              string_cmp(strings[i], parallel[i]) == 0);
+    if (i > 0) {
+      mu_assert("Strings are not in order.",
+                string_cmp(strings[i - 1], strings[i]) <= 0);
+    }
+  }
+  free(parallel);
+  free(strings);
+  free(values);
+  free(storage);
+  return NULL;
+}
+
+char *test_sort() {
+  mu_run_test(strings_are_sorted);
+  mu_run_test(equal_and_long_strings_are_sorted);
+  mu_run_test(threads_give_the_same_order);
+  return NULL;
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_SORT_TEST_H
+#define C_PROGRAMS_SORT_TEST_H
+
+char *test_sort();
+
+#endif // C_PROGRAMS_SORT_TEST_H
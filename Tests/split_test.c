@@ -0,0 +1,116 @@
+#include "split_test.h"
+#include "../StdLib/String/split.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Runs the tokenizer to completion and checks the tokens against the
+ * expected C strings.
+ */
+static char *expect_tokens(tokenizer_t tokenizer, const char *expected[],
+                           size_t count) {
+  string_t token;
+  size_t index = 0;
+  while (next_token(&tokenizer, &token)) {
+    mu_assert("Too many tokens.", index < count);
+    string_t *wanted = convert_string(expected[index++]);
+    bool same = string_cmp(&token, wanted) == 0;
+    free_string(wanted);
+    mu_assert("Token has the wrong contents.", same);
+  }
+  mu_assert("Too few tokens.", index == count);
+  mu_assert("Exhausted tokenizer produced a token.",
+            !next_token(&tokenizer, &token));
+  return NULL;
+}
+
+static char *byte_tokenizer_keeps_empty_tokens() {
+  char *message;
+  string_t *source = convert_string(",alpha,,beta,");
+  const char *expected[] = {"", "alpha", "", "beta", ""};
+  message = expect_tokens(byte_tokenizer(source, ','), expected, 5);
+  free_string(source);
+  if (message) {
+    return message;
+  }
+
+  string_t *empty = new_string(0);
+  const char *single[] = {""};
+  message = expect_tokens(byte_tokenizer(empty, ','), single, 1);
+  free_string(empty);
+  return message;
+}
+
+static char *set_tokenizer_splits_on_any_byte() {
+  string_t *source = convert_string("one two\tthree;four");
+  const char *expected[] = {"one", "two", "three", "four"};
+  char *message = expect_tokens(set_tokenizer(source, " \t;"), expected, 4);
+  free_string(source);
+  return message;
+}
+
+static char *string_tokenizer_splits_on_separator() {
+  string_t *source = convert_string("a::b:c::::d::");
+  string_t *separator = convert_string("::");
+  const char *expected[] = {"a", "b:c", "", "d", ""};
+  char *message =
+      expect_tokens(string_tokenizer(source, separator), expected, 5);
+  free_string(source);
+  free_string(separator);
+  return message;
+}
+
+static char *tokens_are_views() {
+  string_t *source = convert_string("key=value");
+  tokenizer_t tokenizer = byte_tokenizer(source, '=');
+  string_t token;
+  next_token(&tokenizer, &token);
+  mu_assert("First token is not a view of the source.",
+            token.data == source->data && token.len == 3);
+  next_token(&tokenizer, &token);
+  mu_assert("Second token is not a view of the source.",
+            token.data == source->data + 4 && token.len == 5);
+  free_string(source);
+  return NULL;
+}
+
+static char *split_offsets_match_tokenizer() {
+  // Long enough to cover the vector loop and the scalar tail.
+  string_t *source = new_string(1000);
+  srand(11);
+  for (size_t i = 0; i < source->len; i++) {
+    source->data[i] = rand() % 5 ? (uint8_t)('a' + rand() % 26) : '|';
+  }
+
+  size_t count = 0;
+  size_t *starts = split_offsets(source, '|', &count);
+  mu_assert("The final offset is wrong.", starts[count] == source->len + 1);
+
+  tokenizer_t tokenizer = byte_tokenizer(source, '|');
+  string_t token;
+  size_t index = 0;
+  while (next_token(&tokenizer, &token)) {
+    mu_assert("Offsets produced too few tokens.", index < count);
+    mu_assert("Token start differs.",
+              token.data == source->data + starts[index]);
+    mu_assert("Token length differs.",
+              token.len == starts[index + 1] - 1 - starts[index]);
+    index++;
+  }
+  mu_assert("Offsets produced too many tokens.", index == count);
+
+  free(starts);
+  free_string(source);
+  return NULL;
+}
+
+char *test_split() {
+  mu_run_test(byte_tokenizer_keeps_empty_tokens);
+  mu_run_test(set_tokenizer_splits_on_any_byte);
+  mu_run_test(string_tokenizer_splits_on_separator);
+  mu_run_test(tokens_are_views);
+  mu_run_test(split_offsets_match_tokenizer);
+  return NULL;
+}
@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_SPLIT_TEST_H
+#define C_PROGRAMS_SPLIT_TEST_H
+
+char *test_split();
+
+#endif // C_PROGRAMS_SPLIT_TEST_H
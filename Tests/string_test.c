@@ -103,9 +103,175 @@ static char *fprint_works() {
   return NULL;
 }
 
+static char *lexicographic_str_cmp() {
+  string_t *shorter = convert_string("apple");
+  string_t *longer = convert_string("apples");
+  string_t *later = convert_string("b");
+
+  mu_assert("A prefix must come before the longer string.",
+            string_cmp(shorter, longer) < 0);
+  mu_assert("A prefix must come before the longer string.",
+            string_cmp(longer, shorter) > 0);
+  mu_assert("Comparison must be by content, not by length.",
+            string_cmp(later, longer) > 0);
+
+  free_string(shorter);
+  free_string(longer);
+  free_string(later);
+  return NULL;
+}
+
+static char *wide_str_cmp_finds_every_mismatch() {
+  // Exercise the vector, word and byte loops with a mismatch at every
+  // position of a 100 byte string.
+  string_t *a = new_string(100);
+  memset(a->data, 'x', a->len);
+  string_t *b = copy_string(a);
+
+  mu_assert("Copies must compare equal.", string_cmp(a, b) == 0);
+  mu_assert("Copies must be equal.", string_equals(a, b));
+
+  for (size_t idx = 0; idx < b->len; idx++) {
+    b->data[idx] = 'y';
+    mu_assert("Mismatch was not detected.", string_cmp(a, b) < 0);
+    mu_assert("Mismatch was not detected.", string_cmp(b, a) > 0);
+    mu_assert("Different strings seem equal.", !string_equals(a, b));
+    b->data[idx] = 'x';
+  }
+  b->data[99] = 0xff;
+  mu_assert("Bytes must be compared as unsigned.", string_cmp(b, a) > 0);
+
+  free_string(a);
+  free_string(b);
+  return NULL;
+}
+
+static char *hash_is_consistent() {
+  string_t *a = convert_string("The quick brown fox jumps over the lazy dog, "
+                               "then does it again and again.");
+  string_t *b = copy_string(a);
+  string_t *c = left_string(a, a->len - 1);
+
+  mu_assert("Equal strings have different hashes.",
+            string_hash(a, 42) == string_hash(b, 42));
+  mu_assert("Seed does not affect the hash.",
+            string_hash(a, 1) != string_hash(a, 2));
+  mu_assert("Different strings have the same hash.",
+            string_hash(a, 0) != string_hash(c, 0));
+  mu_assert("Hashed equality gave the wrong answer.",
+            string_equals_hashed(a, string_hash(a, 0), b, string_hash(b, 0)));
+  mu_assert("Hashed equality gave the wrong answer.",
+            !string_equals_hashed(a, string_hash(a, 0), c, string_hash(c, 0)));
+
+  // Every length up to the stride of the bulk loop must hash all bytes.
+  for (size_t len = 1; len <= 100; len++) {
+    string_t *prefix = left_string(a, len < a->len ? len : a->len);
+    uint64_t before = string_hash(prefix, 0);
+    prefix->data[prefix->len - 1] ^= 1;
+    mu_assert("Changing the last byte did not change the hash.",
+              string_hash(prefix, 0) != before);
+    prefix->data[prefix->len - 1] ^= 1;
+    prefix->data[0] ^= 1;
+    mu_assert("Changing the first byte did not change the hash.",
+              string_hash(prefix, 0) != before);
+    free_string(prefix);
+  }
+
+  free_string(a);
+  free_string(b);
+  free_string(c);
+  return NULL;
+}
+
+static char *case_conversion_works() {
+  // Long enough to exercise the vector loops, with every ASCII boundary
+  // character and some UTF-8 bytes that must not be touched.
+  const char *mixed = "@AZ[`az{ Hello, World! \xc3\x89t\xc3\xa9 MiXeD CaSe "
+                      "0123456789 THE END";
+  const char *lower = "@az[`az{ hello, world! \xc3\x89t\xc3\xa9 mixed case "
+                      "0123456789 the end";
+  const char *upper = "@AZ[`AZ{ HELLO, WORLD! \xc3\x89T\xc3\xa9 MIXED CASE "
+                      "0123456789 THE END";
+  string_t *string = convert_string(mixed);
+  string_t *expected = convert_string(lower);
+
+  string_to_lower(string);
+  mu_assert("Lower case conversion failed.", string_cmp(string, expected) == 0);
+
+  free_string(expected);
+  expected = convert_string(upper);
+  string_to_upper(string);
+  mu_assert("Upper case conversion failed.", string_cmp(string, expected) == 0);
+
+  free_string(string);
+  free_string(expected);
+  return NULL;
+}
+
+static char *case_insensitive_cmp_and_search() {
+  string_t *a = convert_string("Content-Type: text/html; charset=UTF-8");
+  string_t *b = convert_string("content-type: TEXT/HTML; CHARSET=utf-8");
+  string_t *c = convert_string("content-type: text/plain");
+  string_t *needle = convert_string("CHARSET");
+  string_t *missing = convert_string("charset=latin1");
+
+  mu_assert("Strings differing in case must be equal.",
+            string_case_cmp(a, b) == 0);
+  mu_assert("Case-insensitive order is wrong.", string_case_cmp(a, c) < 0);
+  mu_assert("Case-insensitive order is wrong.", string_case_cmp(c, b) > 0);
+  mu_assert("Case-insensitive search failed.",
+            index_of_string_ignore_case(a, needle) == 25);
+  mu_assert("Case-insensitive search found a missing needle.",
+            index_of_string_ignore_case(b, missing) > b->len);
+  // '@' and '`' differ only in the case bit but are not letters.
+  string_t *at = convert_string("@");
+  string_t *grave = convert_string("`");
+  mu_assert("Non-letters must not be folded.", string_case_cmp(at, grave) != 0);
+
+  free_string(a);
+  free_string(b);
+  free_string(c);
+  free_string(needle);
+  free_string(missing);
+  free_string(at);
+  free_string(grave);
+  return NULL;
+}
+
+static char *trimming_returns_views() {
+  string_t *padded = convert_string(" \t\r\n  some value \n");
+  string_t *expected = convert_string("some value");
+
+  string_t view = trim_string(padded);
+  mu_assert("Trimmed contents differ.", string_cmp(&view, expected) == 0);
+  mu_assert("Trim must return a view.", view.data == padded->data + 6);
+
+  view = trim_left_string(padded);
+  mu_assert("Left trim kept the wrong suffix.", view.len == padded->len - 6);
+  view = trim_right_string(padded);
+  mu_assert("Right trim kept the wrong prefix.", view.len == padded->len - 2);
+
+  string_t *blank = convert_string("   \t ");
+  view = trim_string(blank);
+  mu_assert("A blank string must trim to nothing.", view.len == 0);
+  mu_assert("Wrong span of leading bytes.",
+            index_of_first_not_in(padded, " \t\r\n") == 6);
+
+  free_string(padded);
+  free_string(expected);
+  free_string(blank);
+  return NULL;
+}
+
 char *test_string() {
   mu_run_test(eq_len_str_cmp);
   mu_run_test(diff_len_str_cmp);
   mu_run_test(fprint_works);
+  mu_run_test(lexicographic_str_cmp);
+  mu_run_test(wide_str_cmp_finds_every_mismatch);
+  mu_run_test(hash_is_consistent);
+  mu_run_test(case_conversion_works);
+  mu_run_test(case_insensitive_cmp_and_search);
+  mu_run_test(trimming_returns_views);
   return NULL;
 }
\ No newline at end of file
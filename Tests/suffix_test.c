@@ -0,0 +1,115 @@
+#include "suffix_test.h"
+#include "../StdLib/String/suffix.h"
+#include "test.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static const string_t *sorted_text;
+
+static int compare_suffixes(const void *a, const void *b) {
+  size_t left = *(const size_t *)a, right = *(const size_t *)b;
+  size_t left_len = sorted_text->len - left;
+  size_t right_len = sorted_text->len - right;
+  size_t shorter = left_len < right_len ? left_len : right_len;
+  int order = memcmp(sorted_text->data + left, sorted_text->data + right,
+                     shorter);
+  if (order != 0) {
+    return order;
+  }
+  return left_len < right_len ? -1 : 1;
+}
+
+/**
+ * Fills the text with random bytes from a small alphabet, which produces
+ * many repeats and deep recursion in SA-IS.
+ */
+static string_t *random_text(size_t len, int alphabet) {
+  string_t *text = new_string(len);
+  for (size_t i = 0; i < len; i++) {
+    text->data[i] = (uint8_t)('a' + rand() % alphabet);
+  }
+  return text;
+}
+
+static char *suffix_array_matches_sorting() {
+  srand(33);
+  const char *fixed[] = {"", "a", "banana", "mississippi", "aaaaaaaaaa",
+                         "abababababab"};
+  for (size_t t = 0; t < 6 + 200; t++) {
+    string_t *text = t < 6 ? convert_string(fixed[t])
+                           : random_text((size_t)(rand() % 2000),
+                                         1 + rand() % 4);
+    size_t *expected = malloc((text->len + 1) * sizeof(size_t));
+    for (size_t i = 0; i < text->len; i++) {
+      expected[i] = i;
+    }
+    sorted_text = text;
+    qsort(expected, text->len, sizeof(size_t), compare_suffixes);
+
+    size_t *suffixes = build_suffix_array(text);
+    mu_assert("Suffix array is not sorted correctly.",
+              memcmp(suffixes, expected, text->len * sizeof(size_t)) == 0);
+
+    size_t *lcp = build_lcp_array(text, suffixes);
+    for (size_t i = 1; i < text->len; i++) {
+      size_t a = suffixes[i - 1], b = suffixes[i], common = 0;
+      while (a + common < text->len && b + common < text->len &&
+             text->data[a + common] == text->data[b + common]) {
+        common++;
+      }
+      mu_assert("Wrong longest common prefix.", lcp[i] == common);
+    }
+    free(expected);
+    free(suffixes);
+    free(lcp);
+    free_string(text);
+  }
+  return NULL;
+}
+
+static char *occurrences_are_found() {
+  srand(34);
+  string_t *text = random_text(5000, 3);
+  size_t *suffixes = build_suffix_array(text);
+  for (size_t q = 0; q < 300; q++) {
+    size_t start = (size_t)rand() % text->len;
+    size_t len = (size_t)rand() % 12;
+    if (start + len > text->len) {
+      len = text->len - start;
+    }
+    uint8_t random[16];
+    string_t pattern = {len, text->data + start};
+    if (q % 3 == 0) {
+      // Also look for patterns that may not occur at all.
+      for (size_t i = 0; i < len; i++) {
+        random[i] = (uint8_t)('a' + rand() % 3);
+      }
+      pattern.data = random;
+    }
+    size_t expected = 0;
+    for (size_t i = 0; i < text->len && i + len <= text->len; i++) {
+      expected += memcmp(text->data + i, pattern.data, len) == 0;
+    }
+    suffix_range_t range = find_suffix_range(text, suffixes, &pattern);
+    mu_assert("Wrong number of occurrences.",
+              range.end - range.start == expected);
+    for (size_t r = range.start; r < range.end; r++) {
+      mu_assert("Row does not start with the pattern.",
+                suffixes[r] + len <= text->len &&
+                    memcmp(text->data + suffixes[r], pattern.data, len) == 0);
+    }
+  }
+  string_t missing = {3, (uint8_t *)"xyz"};
+  mu_assert("Missing pattern counted.",
+            count_occurrences(text, suffixes, &missing) == 0);
+  free(suffixes);
+  free_string(text);
+  return NULL;
+}
+
+char *test_suffix() {
+  mu_run_test(suffix_array_matches_sorting);
+  mu_run_test(occurrences_are_found);
+  return NULL;
+}
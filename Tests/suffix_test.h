@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_SUFFIX_TEST_H
+#define C_PROGRAMS_SUFFIX_TEST_H
+
+char *test_suffix();
+
+#endif // C_PROGRAMS_SUFFIX_TEST_H
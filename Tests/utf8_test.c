@@ -0,0 +1,180 @@
+#include "utf8_test.h"
+#include "../StdLib/String/utf8.h"
+#include "test.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Encodes a code point the obvious way, to build test inputs.
+ */
+static size_t encode(uint32_t cp, uint8_t *out) {
+  if (cp < 0x80) {
+    out[0] = (uint8_t)cp;
+    return 1;
+  }
+  if (cp < 0x800) {
+    out[0] = (uint8_t)(0xc0 | (cp >> 6));
+    out[1] = (uint8_t)(0x80 | (cp & 0x3f));
+    return 2;
+  }
+  if (cp < 0x10000) {
+    out[0] = (uint8_t)(0xe0 | (cp >> 12));
+    out[1] = (uint8_t)(0x80 | ((cp >> 6) & 0x3f));
+    out[2] = (uint8_t)(0x80 | (cp & 0x3f));
+    return 3;
+  }
+  out[0] = (uint8_t)(0xf0 | (cp >> 18));
+  out[1] = (uint8_t)(0x80 | ((cp >> 12) & 0x3f));
+  out[2] = (uint8_t)(0x80 | ((cp >> 6) & 0x3f));
+  out[3] = (uint8_t)(0x80 | (cp & 0x3f));
+  return 4;
+}
+
+/**
+ * A slow but obviously correct validator: decode each sequence and check
+ * that the result is in range and minimally encoded.
+ */
+static bool reference_valid(const uint8_t *data, size_t len) {
+  size_t index = 0;
+  while (index < len) {
+    uint8_t byte = data[index];
+    size_t extra;
+    uint32_t cp, min;
+    if (byte < 0x80) {
+      index++;
+      continue;
+    } else if ((byte & 0xe0) == 0xc0) {
+      extra = 1, cp = byte & 0x1f, min = 0x80;
+    } else if ((byte & 0xf0) == 0xe0) {
+      extra = 2, cp = byte & 0x0f, min = 0x800;
+    } else if ((byte & 0xf8) == 0xf0) {
+      extra = 3, cp = byte & 0x07, min = 0x10000;
+    } else {
+      return false;
+    }
+    if (index + extra >= len) {
+      return false;
+    }
+    for (size_t k = 1; k <= extra; k++) {
+      if ((data[index + k] & 0xc0) != 0x80) {
+        return false;
+      }
+      cp = (cp << 6) | (data[index + k] & 0x3f);
+    }
+    if (cp < min || cp > 0x10ffff || (cp >= 0xd800 && cp <= 0xdfff)) {
+      return false;
+    }
+    index += extra + 1;
+  }
+  return true;
+}
+
+static char *known_sequences_are_classified() {
+  const char *valid[] = {"", "plain ascii", "caf\xc3\xa9", "\xe2\x82\xac",
+                         "\xf0\x9f\x98\x80", "\xf4\x8f\xbf\xbf",
+                         "\xed\x9f\xbf"};
+  const char *invalid[] = {"\x80", "\xc0\xaf", "\xc1\xbf", "\xe0\x80\xaf",
+                           "\xed\xa0\x80", "\xf4\x90\x80\x80", "\xf5\x80",
+                           "\xc3", "\xe2\x82", "\xf0\x9f\x98", "\xc3\xa9\xa9",
+                           "\xff"};
+  uint8_t buffer[128];
+
+  // Place every sample at every offset of a 96 byte ASCII buffer, so that it
+  // straddles the vector block boundaries in every possible way.
+  for (size_t offset = 0; offset < 92; offset++) {
+    for (size_t i = 0; i < sizeof(valid) / sizeof(valid[0]); i++) {
+      size_t len = strlen(valid[i]);
+      memset(buffer, 'a', 96);
+      memcpy(buffer + offset, valid[i], len);
+      mu_assert("Valid UTF-8 was rejected.", utf8_is_valid_bytes(buffer, 96));
+    }
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+      size_t len = strlen(invalid[i]);
+      memset(buffer, 'a', 96);
+      memcpy(buffer + offset, invalid[i], len);
+      mu_assert("Invalid UTF-8 was accepted.",
+                !utf8_is_valid_bytes(buffer, offset + len) &&
+                    !utf8_is_valid_bytes(buffer, 96));
+    }
+  }
+  return NULL;
+}
+
+static char *random_mutations_match_reference() {
+  uint8_t buffer[512];
+  srand(2019);
+  for (size_t round = 0; round < 2000; round++) {
+    size_t len = 0;
+    while (len + 4 <= sizeof(buffer) - 64) {
+      uint32_t cp;
+      switch (rand() % 4) {
+      case 0:
+        cp = (uint32_t)(rand() % 0x80);
+        break;
+      case 1:
+        cp = 0x80 + (uint32_t)(rand() % 0x780);
+        break;
+      case 2:
+        cp = 0x800 + (uint32_t)(rand() % 0xf800);
+        if (cp >= 0xd800 && cp <= 0xdfff) {
+          cp -= 0x800;
+        }
+        break;
+      default:
+        cp = 0x10000 + (uint32_t)(rand() % 0x100000);
+        break;
+      }
+      len += encode(cp, buffer + len);
+    }
+    mu_assert("Valid random UTF-8 was rejected.",
+              utf8_is_valid_bytes(buffer, len));
+    size_t position = (size_t)rand() % len;
+    buffer[position] = (uint8_t)rand();
+    mu_assert("Validator disagrees with the reference.",
+              utf8_is_valid_bytes(buffer, len) == reference_valid(buffer, len));
+  }
+  return NULL;
+}
+
+static char *code_points_are_decoded() {
+  uint32_t expected[200];
+  uint8_t bytes[800];
+  size_t len = 0;
+  for (size_t i = 0; i < 200; i++) {
+    // Long ASCII runs interrupted by multi-byte characters.
+    expected[i] = i % 37 == 0 ? 0x1f600 + (uint32_t)i
+                  : i % 23 == 0 ? 0xe9
+                  : i % 29 == 0 ? 0x20ac
+                                : 'a' + (uint32_t)(i % 26);
+    len += encode(expected[i], bytes + len);
+  }
+  string_t *string = new_string(len);
+  memcpy(string->data, bytes, len);
+
+  mu_assert("Wrong number of code points.",
+            utf8_count_code_points(string) == 200);
+
+  size_t count = 0;
+  uint32_t *decoded = convert_utf8_to_utf32(string, &count);
+  mu_assert("Valid string could not be decoded.", decoded != NULL);
+  mu_assert("Wrong number of code points decoded.", count == 200);
+  mu_assert("Decoded code points differ.",
+            memcmp(decoded, expected, sizeof(expected)) == 0);
+  free(decoded);
+
+  string->data[len - 1] = 0xff;
+  mu_assert("Invalid string was decoded.",
+            convert_utf8_to_utf32(string, &count) == NULL && count == 0);
+
+  free_string(string);
+  return NULL;
+}
+
+char *test_utf8() {
+  mu_run_test(known_sequences_are_classified);
+  mu_run_test(random_mutations_match_reference);
+  mu_run_test(code_points_are_decoded);
+  return NULL;
+}
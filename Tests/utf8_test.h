@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_UTF8_TEST_H
+#define C_PROGRAMS_UTF8_TEST_H
+
+char *test_utf8();
+
+#endif // C_PROGRAMS_UTF8_TEST_H
@@ -0,0 +1,111 @@
+#include "writer_test.h"
+#include "../StdLib/String/writer.h"
+#include "test.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static const char *FILENAME = "writer.txt";
+
+/**
+ * Writes lines of fields of growing length, some of them longer than the
+ * writer's buffer, and builds the expected output alongside.
+ */
+static size_t write_lines(string_writer_t *writer, uint8_t *expected) {
+  static uint8_t letters[300];
+  for (size_t i = 0; i < sizeof(letters); i++) {
+    letters[i] = (uint8_t)('a' + i % 26);
+  }
+  size_t len = 0;
+  for (size_t line = 0; line < 100; line++) {
+    string_t fields[3];
+    string_t *pointers[3];
+    for (size_t f = 0; f < 3; f++) {
+      fields[f].len = (line * 7 + f * 13) % (f == 2 ? 300 : 20);
+      fields[f].data = letters;
+      pointers[f] = &fields[f];
+      if (f > 0) {
+        expected[len++] = ',';
+      }
+      memcpy(expected + len, letters, fields[f].len);
+      len += fields[f].len;
+    }
+    expected[len++] = '\n';
+    writer_write_line(writer, pointers, 3, ',');
+  }
+  return len;
+}
+
+static bool file_holds(const uint8_t *expected, size_t len) {
+  FILE *input = fopen(FILENAME, "rb");
+  uint8_t *actual = malloc(len + 1);
+  size_t read = fread(actual, 1, len + 1, input);
+  fclose(input);
+  bool same = read == len && memcmp(actual, expected, len) == 0;
+  free(actual);
+  return same;
+}
+
+static char *fd_writer_writes_everything() {
+  uint8_t *expected = malloc(100 * 400);
+  int fd = open(FILENAME, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  string_writer_t *writer = new_fd_writer(fd, 64);
+  size_t len = write_lines(writer, expected);
+  mu_assert("Flush failed.", writer_flush(writer));
+  mu_assert("Wrong number of bytes written.", writer->bytes_written == len);
+  mu_assert("Writes were not batched.",
+            writer->flushes > 0 && writer->flushes < 300);
+  free_writer(writer);
+  close(fd);
+  mu_assert("File does not hold the output.", file_holds(expected, len));
+  remove(FILENAME);
+  free(expected);
+  return NULL;
+}
+
+static char *stream_writer_keeps_order() {
+  uint8_t *expected = malloc(100 * 400 + 2);
+  FILE *output = fopen(FILENAME, "wb");
+  fputc('<', output);
+  string_writer_t *writer = new_stream_writer(output, 0);
+  size_t len = write_lines(writer, expected + 1);
+  mu_assert("Flush failed.", writer_flush(writer));
+  mu_assert("Wrong number of bytes written.", writer->bytes_written == len);
+  mu_assert("Small output took more than one flush.", writer->flushes == 1);
+  free_writer(writer);
+  fputc('>', output);
+  fclose(output);
+  expected[0] = '<';
+  expected[len + 1] = '>';
+  mu_assert("File does not hold the output.", file_holds(expected, len + 2));
+  remove(FILENAME);
+  free(expected);
+  return NULL;
+}
+
+static char *failures_are_reported() {
+  FILE *create = fopen(FILENAME, "wb");
+  fclose(create);
+  int fd = open(FILENAME, O_RDONLY);
+  string_writer_t *writer = new_fd_writer(fd, 0);
+  string_t text = {5, (uint8_t *)"hello"};
+  writer_write(writer, &text);
+  mu_assert("Nothing should be written before a flush.",
+            writer->bytes_written == 0);
+  mu_assert("Failed write was not reported.", !writer_flush(writer));
+  writer_write(writer, &text);
+  mu_assert("Failure is not sticky.", !writer_flush(writer));
+  free_writer(writer);
+  close(fd);
+  remove(FILENAME);
+  return NULL;
+}
+
+char *test_writer() {
+  mu_run_test(fd_writer_writes_everything);
+  mu_run_test(stream_writer_keeps_order);
+  mu_run_test(failures_are_reported);
+  return NULL;
+}
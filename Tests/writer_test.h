@@ -0,0 +1,6 @@
+#ifndef C_PROGRAMS_WRITER_TEST_H
+#define C_PROGRAMS_WRITER_TEST_H
+
+char *test_writer();
+
+#endif // C_PROGRAMS_WRITER_TEST_H
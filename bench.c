@@ -0,0 +1,62 @@
+#include "Benchmarks/bench.h"
+#include "Benchmarks/column_bench.h"
+#include "Benchmarks/csv_bench.h"
+#include "Benchmarks/dataset_bench.h"
+#include "Benchmarks/distance_bench.h"
+#include "Benchmarks/encoding_bench.h"
+#include "Benchmarks/group_bench.h"
+#include "Benchmarks/matcher_bench.h"
+#include "Benchmarks/number_bench.h"
+#include "Benchmarks/radix_bench.h"
+#include "Benchmarks/replace_bench.h"
+#include "Benchmarks/sort_bench.h"
+#include "Benchmarks/suffix_bench.h"
+#include "Benchmarks/utf8_bench.h"
+#include "Benchmarks/writer_bench.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+volatile size_t bench_sink = 0;
+
+typedef void (*bench_func)();
+
+typedef struct bench_entry {
+  const char *name;
+  bench_func run;
+} bench_entry_t;
+
+bench_entry_t benches[] = {
+    {"utf8", bench_utf8},
+    {"number", bench_number},
+    {"suffix", bench_suffix},
+    {"matcher", bench_matcher},
+    {"distance", bench_distance},
+    {"sort", bench_sort},
+    {"writer", bench_writer},
+    {"encoding", bench_encoding},
+    {"replace", bench_replace},
+    {"radix", bench_radix},
+    {"csv", bench_csv},
+    {"column", bench_column},
+    {"dataset", bench_dataset},
+    {"group", bench_group}
+};
+
+/**
+ * Runs every benchmark, or only those named on the command line, e.g.
+ * ./bench utf8
+ */
+int main(int argc, char *argv[]) {
+  for (size_t idx = 0; idx < sizeof(benches) / sizeof(bench_entry_t); idx++) {
+    bool selected = argc < 2;
+    for (int arg = 1; arg < argc; arg++) {
+      selected |= strcmp(argv[arg], benches[idx].name) == 0;
+    }
+    if (selected) {
+      benches[idx].run();
+    }
+  }
+  return EXIT_SUCCESS;
+}
@@ -1,7 +1,25 @@
 #include "Tests/test.h"
 #include "Tests/arraylist_test.h"
+#include "Tests/column_test.h"
+#include "Tests/csv_test.h"
 #include "Tests/dataset_test.h"
+#include "Tests/distance_test.h"
+#include "Tests/encoding_test.h"
+#include "Tests/fm_index_test.h"
+#include "Tests/group_test.h"
+#include "Tests/intern_test.h"
+#include "Tests/matcher_test.h"
+#include "Tests/number_test.h"
+#include "Tests/radix_test.h"
+#include "Tests/replace_test.h"
+#include "Tests/rope_test.h"
+#include "Tests/search_test.h"
+#include "Tests/sort_test.h"
+#include "Tests/split_test.h"
 #include "Tests/string_test.h"
+#include "Tests/suffix_test.h"
+#include "Tests/utf8_test.h"
+#include "Tests/writer_test.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -14,7 +32,25 @@ typedef char *(*test_func)();
 test_func tests[] = {
     test_arraylist,
     test_dataset,
-    test_string
+    test_string,
+    test_intern,
+    test_utf8,
+    test_search,
+    test_split,
+    test_rope,
+    test_number,
+    test_suffix,
+    test_fm_index,
+    test_matcher,
+    test_distance,
+    test_sort,
+    test_writer,
+    test_encoding,
+    test_replace,
+    test_radix,
+    test_csv,
+    test_column,
+    test_group
 };
 
 static char *all_test_modules() {